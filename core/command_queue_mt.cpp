@@ -32,24 +32,63 @@
 
 #include "core/os/os.h"
 
-void CommandQueueMT::lock() {
-	mutex.lock();
+void CommandQueueMT::wait_for_flush() {
+	// wait one millisecond for a flush to happen
+	OS::get_singleton()->delay_usec(1000);
 }
 
-void CommandQueueMT::unlock() {
-	mutex.unlock();
+void CommandQueueMT::_wait_for_commands() {
+	// Producers only post the semaphore when they see this flag, so check for
+	// commands again after raising it, a push may have happened in between.
+	flusher_waiting.store(true);
+	if (!_has_commands()) {
+		sync->wait();
+	}
+	flusher_waiting.store(false);
 }
 
-void CommandQueueMT::wait_for_flush() {
-	// wait one millisecond for a flush to happen
-	OS::get_singleton()->delay_usec(1000);
+CommandQueueMT::Segment *CommandQueueMT::_alloc_segment() {
+	free_lock.lock();
+	Segment *segment = free_segments;
+	if (segment) {
+		free_segments = segment->free_next;
+	}
+	free_lock.unlock();
+
+	if (segment) {
+		segment->committed.store(0, std::memory_order_relaxed);
+		segment->next.store(nullptr, std::memory_order_relaxed);
+		return segment;
+	}
+
+	// Only called with write_lock held, so the count can't change in between.
+	if (segment_count.load(std::memory_order_relaxed) < COMMAND_MEM_MAX_SIZE_KB / COMMAND_SEGMENT_SIZE_KB) {
+		segment_count.fetch_add(1, std::memory_order_relaxed);
+		return memnew(Segment);
+	}
+
+	return nullptr;
+}
+
+void CommandQueueMT::_wait_for_segment() {
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	wait_for_flush();
+	stall_usec.fetch_add(OS::get_singleton()->get_ticks_usec() - from, std::memory_order_relaxed);
+	stall_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CommandQueueMT::_free_segment(Segment *p_segment) {
+	free_lock.lock();
+	p_segment->free_next = free_segments;
+	free_segments = p_segment;
+	free_lock.unlock();
 }
 
 CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 	int idx = -1;
 
 	while (true) {
-		lock();
+		sync_sems_lock.lock();
 		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 			if (!sync_sems[i].in_use) {
 				sync_sems[i].in_use = true;
@@ -57,7 +96,7 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 				break;
 			}
 		}
-		unlock();
+		sync_sems_lock.unlock();
 
 		if (idx == -1) {
 			wait_for_flush();
@@ -69,39 +108,44 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 	return &sync_sems[idx];
 }
 
-bool CommandQueueMT::dealloc_one() {
-tryagain:
-	if (dealloc_ptr == write_ptr) {
-		// The queue is empty
-		return false;
-	}
-
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
-
-	if (size == 0) {
-		// End of command buffer wrap down
-		dealloc_ptr = 0;
-		goto tryagain;
-	}
-
-	if (size & 1) {
-		// Still used, nothing can be deallocated
-		return false;
-	}
-
-	dealloc_ptr += (size >> 1) + 8;
-	return true;
-}
-
 CommandQueueMT::CommandQueueMT(bool p_sync) {
 	if (p_sync) {
 		sync = memnew(Semaphore);
 	}
+
+	flusher_waiting.store(false);
+	push_count.store(0);
+	flush_count.store(0);
+	stall_count.store(0);
+	stall_usec.store(0);
+
+	segment_count.store(COMMAND_MEM_SIZE_KB / COMMAND_SEGMENT_SIZE_KB);
+	for (uint32_t i = 0; i < segment_count.load(); i++) {
+		Segment *segment = memnew(Segment);
+		if (i == 0) {
+			write_segment = segment;
+			read_segment = segment;
+		} else {
+			_free_segment(segment);
+		}
+	}
 }
 
 CommandQueueMT::~CommandQueueMT() {
 	if (sync) {
 		memdelete(sync);
 	}
-	memfree(command_mem);
+
+	Segment *segment = read_segment;
+	while (segment) {
+		Segment *next = segment->next.load();
+		memdelete(segment);
+		segment = next;
+	}
+
+	while (free_segments) {
+		Segment *next = free_segments->free_next;
+		memdelete(free_segments);
+		free_segments = next;
+	}
 }
@@ -32,11 +32,13 @@
 #define COMMAND_QUEUE_MT_H
 
 #include "core/os/memory.h"
-#include "core/os/mutex.h"
 #include "core/os/semaphore.h"
 #include "core/simple_type.h"
+#include "core/spin_lock.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+
 #define COMMA(N) _COMMA_##N
 #define _COMMA_0
 #define _COMMA_1 ,
@@ -252,9 +254,7 @@
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
-		if (sync)                                                            \
-			sync->post();                                                    \
+		commit_and_unlock();                                                 \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -269,9 +269,7 @@
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
-		if (sync)                                                                              \
-			sync->post();                                                                      \
+		commit_and_unlock();                                                                   \
 		ss->sem.wait();                                                                        \
 		ss->in_use = false;                                                                    \
 	}
@@ -287,9 +285,7 @@
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
-		if (sync)                                                                     \
-			sync->post();                                                             \
+		commit_and_unlock();                                                          \
 		ss->sem.wait();                                                               \
 		ss->in_use = false;                                                           \
 	}
@@ -299,7 +295,7 @@
 class CommandQueueMT {
 	struct SyncSemaphore {
 		Semaphore sem;
-		bool in_use = false;
+		std::atomic<bool> in_use = { false };
 	};
 
 	struct CommandBase {
@@ -329,141 +325,160 @@ class CommandQueueMT {
 
 	/***** BASE *******/
 
+	/*
+	 * Commands are written to a chain of fixed size segments. Producers are
+	 * serialized with a spin lock, but the flushing thread never takes a lock:
+	 * it follows the committed offset of each segment and recycles segments
+	 * it has finished with. When all segments are in use, a new one is
+	 * allocated, up to COMMAND_MEM_MAX_SIZE_KB. Only past that limit does a
+	 * producer stall until commands are flushed, without holding the lock.
+	 *
+	 * Only one thread may flush the queue at a time.
+	 */
+
 	enum {
+		COMMAND_SEGMENT_SIZE_KB = 64,
+		COMMAND_SEGMENT_SIZE = COMMAND_SEGMENT_SIZE_KB * 1024,
 		COMMAND_MEM_SIZE_KB = 256,
-		COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024,
+		COMMAND_MEM_MAX_SIZE_KB = 16384,
 		SYNC_SEMAPHORES = 8
 	};
 
-	uint8_t *command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
-	uint32_t read_ptr = 0;
-	uint32_t write_ptr = 0;
-	uint32_t dealloc_ptr = 0;
-	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex mutex;
-	Semaphore *sync = nullptr;
+	struct Segment {
+		std::atomic<uint32_t> committed; // Bytes that are written and can be flushed.
+		std::atomic<Segment *> next;
+		Segment *free_next = nullptr;
+		alignas(16) uint8_t data[COMMAND_SEGMENT_SIZE];
 
-	template <class T>
-	T *allocate() {
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1)) + 8;
-
-	tryagain:
-
-		if (write_ptr < dealloc_ptr) {
-			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
-				// There is no more room, try to deallocate something
-				if (dealloc_one()) {
-					goto tryagain;
-				}
-				return nullptr;
-			}
-		} else {
-			// ahead of dealloc_ptr, check that there is room
+		Segment() {
+			committed.store(0, std::memory_order_relaxed);
+			next.store(nullptr, std::memory_order_relaxed);
+		}
+	};
 
-			if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + sizeof(uint32_t)) {
-				// no room at the end, wrap down;
+	// Producer side, protected by write_lock.
+	SpinLock write_lock;
+	Segment *write_segment = nullptr;
+	uint32_t write_offset = 0;
 
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
+	// Flusher side.
+	Segment *read_segment = nullptr;
+	uint32_t read_offset = 0;
 
-					// There is no more room, try to deallocate something
-					if (dealloc_one()) {
-						goto tryagain;
-					}
-					return nullptr;
-				}
+	SpinLock free_lock;
+	Segment *free_segments = nullptr;
+	std::atomic<uint32_t> segment_count;
 
-				// if this happens, it's a bug
-				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < 8, nullptr);
-				// zero means, wrap to beginning
+	SpinLock sync_sems_lock;
+	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
+	Semaphore *sync = nullptr;
+	std::atomic<bool> flusher_waiting;
+
+	std::atomic<uint64_t> push_count;
+	std::atomic<uint64_t> flush_count;
+	std::atomic<uint64_t> stall_count;
+	std::atomic<uint64_t> stall_usec;
 
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-				*p = 0;
-				write_ptr = 0;
-				goto tryagain;
+	template <class T>
+	T *allocate() {
+		// 8 bytes holding the size, then the command itself
+		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
+		uint32_t alloc_size = size + 8;
+		static_assert(sizeof(T) + 8 <= COMMAND_SEGMENT_SIZE, "Command is too large for a command queue segment.");
+
+		while (write_offset + alloc_size > COMMAND_SEGMENT_SIZE) {
+			Segment *segment = _alloc_segment();
+			if (!segment) {
+				// Out of memory budget, wait until the flushing thread recycles a segment.
+				// Other producers must not spin on the lock meanwhile, and one of them may
+				// link a new segment first, so check again once it's locked.
+				write_lock.unlock();
+				_wait_for_segment();
+				write_lock.lock();
+				continue;
 			}
+
+			// Everything written so far in this segment is committed, so linking
+			// the next one tells the flusher this segment is complete.
+			write_segment->next.store(segment, std::memory_order_release);
+			write_segment = segment;
+			write_offset = 0;
 		}
-		// Allocate the size and the 'in use' bit.
-		// First bit used to mark if command is still in use (1)
-		// or if it has been destroyed and can be deallocated (0).
-		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = (size << 1) | 1;
-		write_ptr += 8;
-		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += size;
+
+		*(uint32_t *)&write_segment->data[write_offset] = size;
+		T *cmd = memnew_placement(&write_segment->data[write_offset + 8], T);
+		write_offset += alloc_size;
 		return cmd;
 	}
 
 	template <class T>
 	T *allocate_and_lock() {
-		lock();
-		T *ret;
-
-		while ((ret = allocate<T>()) == nullptr) {
-			unlock();
-			// sleep a little until fetch happened and some room is made
-			wait_for_flush();
-			lock();
-		}
-
-		return ret;
+		write_lock.lock();
+		return allocate<T>();
 	}
 
-	bool flush_one(bool p_lock = true) {
-		if (p_lock) {
-			lock();
-		}
-	tryagain:
+	_FORCE_INLINE_ void commit_and_unlock() {
+		// Sequentially consistent, so it is ordered with the check of flusher_waiting below.
+		write_segment->committed.store(write_offset);
+		push_count.fetch_add(1, std::memory_order_relaxed);
+		write_lock.unlock();
 
-		// tried to read an empty queue
-		if (read_ptr == write_ptr) {
-			if (p_lock) {
-				unlock();
-			}
-			return false;
+		if (sync && flusher_waiting.load() && flusher_waiting.exchange(false)) {
+			sync->post();
 		}
+	}
 
-		uint32_t size_ptr = read_ptr;
-		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
-
-		if (size == 0) {
-			//end of ringbuffer, wrap
-			read_ptr = 0;
-			goto tryagain;
-		}
+	bool _has_commands() const {
+		return read_offset < read_segment->committed.load() || read_segment->next.load() != nullptr;
+	}
 
-		read_ptr += 8;
+	CommandBase *_get_next_command(uint32_t &r_size) {
+		while (true) {
+			if (read_offset < read_segment->committed.load(std::memory_order_acquire)) {
+				r_size = *(uint32_t *)&read_segment->data[read_offset];
+				return reinterpret_cast<CommandBase *>(&read_segment->data[read_offset + 8]);
+			}
 
-		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
+			Segment *next = read_segment->next.load(std::memory_order_acquire);
+			if (!next) {
+				return nullptr;
+			}
 
-		read_ptr += size;
+			// The producer commits before linking, check again for the last commands.
+			if (read_offset < read_segment->committed.load(std::memory_order_acquire)) {
+				continue;
+			}
 
-		if (p_lock) {
-			unlock();
+			Segment *done = read_segment;
+			read_segment = next;
+			read_offset = 0;
+			_free_segment(done);
 		}
-		cmd->call();
-		if (p_lock) {
-			lock();
+	}
+
+	bool flush_one() {
+		uint32_t size;
+		CommandBase *cmd = _get_next_command(size);
+		if (!cmd) {
+			return false;
 		}
 
+		cmd->call();
 		cmd->post();
 		cmd->~CommandBase();
-		*(uint32_t *)&command_mem[size_ptr] &= ~1;
 
-		if (p_lock) {
-			unlock();
-		}
+		// The space is only reused once the segment is recycled, after the command is destroyed.
+		read_offset += size + 8;
+		flush_count.fetch_add(1, std::memory_order_relaxed);
 		return true;
 	}
 
-	void lock();
-	void unlock();
 	void wait_for_flush();
+	void _wait_for_commands();
+	Segment *_alloc_segment();
+	void _wait_for_segment();
+	void _free_segment(Segment *p_segment);
 	SyncSemaphore *_alloc_sync_sem();
-	bool dealloc_one();
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -480,18 +495,29 @@ public:
 
 	void wait_and_flush_one() {
 		ERR_FAIL_COND(!sync);
-		sync->wait();
+		_wait_for_commands();
 		flush_one();
 	}
 
+	// Sleeps until commands are available, then flushes all of them.
+	void wait_and_flush() {
+		ERR_FAIL_COND(!sync);
+		_wait_for_commands();
+		flush_all();
+	}
+
 	void flush_all() {
-		//ERR_FAIL_COND(sync);
-		lock();
-		while (flush_one(false)) {
+		while (flush_one()) {
 		}
-		unlock();
 	}
 
+	// Statistics, can be read from any thread.
+	uint64_t get_push_count() const { return push_count.load(std::memory_order_relaxed); }
+	uint64_t get_flush_count() const { return flush_count.load(std::memory_order_relaxed); }
+	uint64_t get_stall_count() const { return stall_count.load(std::memory_order_relaxed); }
+	uint64_t get_stall_usec() const { return stall_usec.load(std::memory_order_relaxed); }
+	uint64_t get_memory_size() const { return uint64_t(segment_count.load(std::memory_order_relaxed)) * COMMAND_SEGMENT_SIZE; }
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
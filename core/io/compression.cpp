@@ -39,6 +39,16 @@
 #include <zlib.h>
 #include <zstd.h>
 
+struct ZSTDDecompressContext {
+	ZSTD_DCtx *dctx = nullptr;
+
+	~ZSTDDecompressContext() {
+		if (dctx) {
+			ZSTD_freeDCtx(dctx);
+		}
+	}
+};
+
 int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode) {
 	switch (p_mode) {
 		case MODE_FASTLZ: {
@@ -167,13 +177,14 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 			return total;
 		} break;
 		case MODE_ZSTD: {
-			ZSTD_DCtx *dctx = ZSTD_createDCtx();
-			if (zstd_long_distance_matching) {
-				ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, zstd_window_log_size);
+			// Creating a context costs more than decompressing a small block, so each thread keeps one.
+			static thread_local ZSTDDecompressContext context;
+			if (!context.dctx) {
+				context.dctx = ZSTD_createDCtx();
 			}
-			int ret = ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
-			ZSTD_freeDCtx(dctx);
-			return ret;
+			// 0 restores the default.
+			ZSTD_DCtx_setParameter(context.dctx, ZSTD_d_windowLogMax, zstd_long_distance_matching ? zstd_window_log_size : 0);
+			return ZSTD_decompressDCtx(context.dctx, p_dst, p_dst_max_size, p_src, p_src_size);
 		} break;
 	}
 
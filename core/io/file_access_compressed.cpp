@@ -30,6 +30,7 @@
 
 #include "file_access_compressed.h"
 
+#include "core/os/copymem.h"
 #include "core/print_string.h"
 
 void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, int p_block_size) {
@@ -80,21 +81,187 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	}
 
 	comp_buffer.resize(max_bs);
-	buffer.resize(block_size);
-	read_ptr = buffer.ptrw();
-	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
 	at_end = false;
 	read_eof = false;
 	read_block_count = bc;
-	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
 
-	Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
-	read_block = 0;
+	// Blocks are small, so they are read ahead in groups large enough to be worth a worker thread.
+	prefetch_blocks = 0;
+	if (bc > 1 && ThreadWorkPool::get_singleton() && ThreadWorkPool::get_singleton()->get_thread_count() > 0) {
+		prefetch_blocks = MIN(MAX(1, int(PREFETCH_BYTES / block_size)), bc - 1);
+	}
+	// Room for the current block, the blocks being prefetched and the ones prefetched before.
+	cache.resize(MIN(prefetch_blocks * 2 + 2, bc));
+	current_slot = -1;
+
+	_load_block(0);
 	read_pos = 0;
 
 	return OK;
 }
 
+int FileAccessCompressed::_find_cached(int p_block) const {
+	for (uint32_t i = 0; i < cache.size(); i++) {
+		if (cache[i].block == p_block) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int FileAccessCompressed::_get_free_slot() const {
+	int slot = -1;
+	bool slot_ahead = false;
+	for (uint32_t i = 0; i < cache.size(); i++) {
+		if (cache[i].prefetching || int(i) == current_slot) {
+			continue;
+		}
+		bool ahead = cache[i].unread && cache[i].block > read_block;
+		if (slot == -1 || (slot_ahead && !ahead)) {
+			slot = i;
+			slot_ahead = ahead;
+		} else if (ahead == slot_ahead && (ahead ? cache[i].block > cache[slot].block : cache[i].last_used < cache[slot].last_used)) {
+			slot = i;
+		}
+	}
+	return slot;
+}
+
+void FileAccessCompressed::_read_compressed(int p_offset, uint8_t *p_dst, int p_size) const {
+	if (f->get_position() != size_t(p_offset)) {
+		f->seek(p_offset);
+	}
+	f->get_buffer(p_dst, p_size);
+}
+
+void FileAccessCompressed::_load_block(int p_block) const {
+	int slot = _find_cached(p_block);
+	if (slot != -1 && cache[slot].prefetching) {
+		_finish_prefetch();
+	}
+
+	if (slot == -1) {
+		slot = _get_free_slot();
+		ERR_FAIL_COND(slot == -1);
+
+		CachedBlock &cb = cache[slot];
+		cb.block = p_block;
+		cb.data.resize(block_size);
+		_read_compressed(read_blocks[p_block].offset, comp_buffer.ptrw(), read_blocks[p_block].csize);
+		Compression::decompress(cb.data.ptrw(), block_size, comp_buffer.ptr(), read_blocks[p_block].csize, cmode);
+	}
+
+	cache[slot].last_used = ++cache_tick;
+	cache[slot].unread = false;
+	current_slot = slot;
+	read_block = p_block;
+	read_ptr = cache[slot].data.ptr();
+	read_block_size = _get_block_size(p_block);
+
+	_prefetch(p_block + 1);
+}
+
+void FileAccessCompressed::_prefetch(int p_block) const {
+	if (!prefetch_blocks || prefetch_group != ThreadWorkPool::INVALID_GROUP_ID || !ThreadWorkPool::get_singleton()) {
+		return;
+	}
+
+	// Only the blocks past the ones already read ahead, so a new group starts
+	// while the previous one is being consumed.
+	int end = MIN(p_block + prefetch_blocks, read_block_count);
+	int first = p_block;
+	while (first < end && _find_cached(first) != -1) {
+		first++;
+	}
+	int count = 0;
+	while (count < prefetch_blocks && first + count < read_block_count && _find_cached(first + count) == -1) {
+		count++;
+	}
+	if (first == end || count == 0) {
+		return;
+	}
+
+	// Compressed blocks are contiguous, so they are read at once.
+	int offset = read_blocks[first].offset;
+	int size = read_blocks[first + count - 1].offset + read_blocks[first + count - 1].csize - offset;
+	prefetch_buffer.resize(size);
+	_read_compressed(offset, prefetch_buffer.ptrw(), size);
+
+	prefetch_jobs.resize(count);
+	for (int i = 0; i < count; i++) {
+		int slot = _get_free_slot();
+		ERR_FAIL_COND(slot == -1);
+
+		CachedBlock &cb = cache[slot];
+		cb.block = first + i;
+		cb.prefetching = true;
+		cb.unread = true;
+		cb.last_used = ++cache_tick;
+		cb.data.resize(block_size);
+
+		DecompressJob &job = prefetch_jobs[i];
+		job.src = prefetch_buffer.ptr() + read_blocks[first + i].offset - offset;
+		job.src_size = read_blocks[first + i].csize;
+		job.dst = cb.data.ptrw();
+		job.dst_size = block_size;
+	}
+
+	prefetch_group = ThreadWorkPool::get_singleton()->add_group_task(this, &FileAccessCompressed::_decompress_job, prefetch_jobs.ptr(), count);
+}
+
+void FileAccessCompressed::_finish_prefetch() const {
+	if (prefetch_group == ThreadWorkPool::INVALID_GROUP_ID) {
+		return;
+	}
+
+	ThreadWorkPool::get_singleton()->wait_for_group(prefetch_group);
+	prefetch_group = ThreadWorkPool::INVALID_GROUP_ID;
+
+	for (uint32_t i = 0; i < cache.size(); i++) {
+		cache[i].prefetching = false;
+	}
+}
+
+void FileAccessCompressed::_decompress_parallel(int p_first, int p_count, uint8_t *p_dst) const {
+	_finish_prefetch();
+
+	int offset = read_blocks[p_first].offset;
+	int size = read_blocks[p_first + p_count - 1].offset + read_blocks[p_first + p_count - 1].csize - offset;
+	Vector<uint8_t> compressed;
+	compressed.resize(size);
+	_read_compressed(offset, compressed.ptrw(), size);
+
+	LocalVector<DecompressJob> jobs;
+	for (int i = 0; i < p_count; i++) {
+		int slot = _find_cached(p_first + i);
+		if (slot != -1) {
+			copymem(p_dst + i * block_size, cache[slot].data.ptr(), block_size);
+			continue;
+		}
+
+		DecompressJob job;
+		job.src = compressed.ptr() + read_blocks[p_first + i].offset - offset;
+		job.src_size = read_blocks[p_first + i].csize;
+		job.dst = p_dst + i * block_size;
+		job.dst_size = block_size;
+		jobs.push_back(job);
+	}
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (pool && jobs.size() > 1) {
+		pool->do_work(jobs.size(), this, &FileAccessCompressed::_decompress_job, jobs.ptr());
+	} else {
+		for (uint32_t i = 0; i < jobs.size(); i++) {
+			_decompress_job(i, jobs.ptr());
+		}
+	}
+}
+
+void FileAccessCompressed::_decompress_job(uint32_t p_index, DecompressJob *p_jobs) const {
+	const DecompressJob &job = p_jobs[p_index];
+	Compression::decompress(job.dst, job.dst_size, job.src, job.src_size, cmode);
+}
+
 Error FileAccessCompressed::_open(const String &p_path, int p_mode_flags) {
 	ERR_FAIL_COND_V(p_mode_flags == READ_WRITE, ERR_UNAVAILABLE);
 
@@ -177,6 +344,12 @@ void FileAccessCompressed::close() {
 		buffer.clear();
 
 	} else {
+		_finish_prefetch();
+		cache.clear();
+		current_slot = -1;
+		read_ptr = nullptr;
+		prefetch_buffer.clear();
+		prefetch_jobs.clear();
 		comp_buffer.clear();
 		buffer.clear();
 		read_blocks.clear();
@@ -206,11 +379,7 @@ void FileAccessCompressed::seek(size_t p_position) {
 			read_eof = false;
 			int block_idx = p_position / block_size;
 			if (block_idx != read_block) {
-				read_block = block_idx;
-				f->seek(read_blocks[read_block].offset);
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
+				_load_block(block_idx);
 			}
 
 			read_pos = p_position % block_size;
@@ -267,17 +436,10 @@ uint8_t FileAccessCompressed::get_8() const {
 
 	read_pos++;
 	if (read_pos >= read_block_size) {
-		read_block++;
-
-		if (read_block < read_block_count) {
-			//read another block of compressed data
-			f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-			Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
+		if (read_block + 1 < read_block_count && _get_block_size(read_block + 1) > 0) {
+			_load_block(read_block + 1);
 			read_pos = 0;
-
 		} else {
-			read_block--;
 			at_end = true;
 		}
 	}
@@ -294,28 +456,37 @@ int FileAccessCompressed::get_buffer(uint8_t *p_dst, int p_length) const {
 		return 0;
 	}
 
-	for (int i = 0; i < p_length; i++) {
-		p_dst[i] = read_ptr[read_pos];
-		read_pos++;
-		if (read_pos >= read_block_size) {
-			read_block++;
-
-			if (read_block < read_block_count) {
-				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-				read_pos = 0;
-
-			} else {
-				read_block--;
-				at_end = true;
-				if (i < p_length - 1) {
-					read_eof = true;
-				}
-				return i;
+	int dst_pos = 0;
+	while (dst_pos < p_length) {
+		int to_copy = MIN(read_block_size - read_pos, p_length - dst_pos);
+		copymem(p_dst + dst_pos, read_ptr + read_pos, to_copy);
+		read_pos += to_copy;
+		dst_pos += to_copy;
+
+		if (read_pos < read_block_size) {
+			break;
+		}
+
+		if (read_block + 1 >= read_block_count || _get_block_size(read_block + 1) == 0) {
+			at_end = true;
+			if (dst_pos < p_length) {
+				read_eof = true;
 			}
+			return dst_pos;
 		}
+
+		// Whole blocks go straight to the destination, decompressed in parallel.
+		// The last block is left out, so there is always a block to continue from.
+		int first = read_block + 1;
+		int count = MIN((p_length - dst_pos) / int(block_size), read_block_count - 2 - first);
+		if (count >= PARALLEL_MIN_BLOCKS && ThreadWorkPool::get_singleton() && ThreadWorkPool::get_singleton()->get_thread_count() > 0) {
+			_decompress_parallel(first, count, p_dst + dst_pos);
+			dst_pos += count * block_size;
+			first += count;
+		}
+
+		_load_block(first);
+		read_pos = 0;
 	}
 
 	return p_length;
@@ -32,7 +32,9 @@
 #define FILE_ACCESS_COMPRESSED_H
 
 #include "core/io/compression.h"
+#include "core/local_vector.h"
 #include "core/os/file_access.h"
+#include "core/thread_work_pool.h"
 
 class FileAccessCompressed : public FileAccess {
 	Compression::Mode cmode = Compression::MODE_ZSTD;
@@ -50,8 +52,41 @@ class FileAccessCompressed : public FileAccess {
 		int offset;
 	};
 
+	enum {
+		PREFETCH_BYTES = 256 * 1024, // Decompressed bytes read ahead at once, when worker threads are available.
+		PARALLEL_MIN_BLOCKS = 4, // Minimum amount of whole blocks for get_buffer() to decompress them in parallel.
+	};
+
+	// Decompressed blocks, reused in least recently used order. Blocks being
+	// prefetched can't be reused until the prefetch is done. Prefetched blocks
+	// ahead of the read position that were not read yet are only reused when
+	// nothing else is left, farthest first.
+	struct CachedBlock {
+		int block = -1;
+		uint64_t last_used = 0;
+		bool prefetching = false;
+		bool unread = false;
+		Vector<uint8_t> data;
+	};
+
+	struct DecompressJob {
+		const uint8_t *src;
+		int src_size;
+		uint8_t *dst;
+		int dst_size;
+	};
+
+	mutable LocalVector<CachedBlock> cache;
+	mutable uint64_t cache_tick = 0;
+	mutable int current_slot = -1;
+
+	int prefetch_blocks = 0;
+	mutable ThreadWorkPool::GroupID prefetch_group = ThreadWorkPool::INVALID_GROUP_ID;
+	mutable Vector<uint8_t> prefetch_buffer;
+	mutable LocalVector<DecompressJob> prefetch_jobs;
+
 	mutable Vector<uint8_t> comp_buffer;
-	uint8_t *read_ptr = nullptr;
+	mutable const uint8_t *read_ptr = nullptr;
 	mutable int read_block = 0;
 	int read_block_count = 0;
 	mutable int read_block_size = 0;
@@ -59,6 +94,16 @@ class FileAccessCompressed : public FileAccess {
 	Vector<ReadBlock> read_blocks;
 	uint32_t read_total = 0;
 
+	_FORCE_INLINE_ int _get_block_size(int p_block) const { return p_block == read_block_count - 1 ? read_total % block_size : block_size; }
+	int _find_cached(int p_block) const;
+	int _get_free_slot() const;
+	void _load_block(int p_block) const;
+	void _prefetch(int p_block) const;
+	void _finish_prefetch() const;
+	void _read_compressed(int p_offset, uint8_t *p_dst, int p_size) const;
+	void _decompress_parallel(int p_first, int p_count, uint8_t *p_dst) const;
+	void _decompress_job(uint32_t p_index, DecompressJob *p_jobs) const;
+
 	String magic = "GCMP";
 	mutable Vector<uint8_t> buffer;
 	FileAccess *f = nullptr;
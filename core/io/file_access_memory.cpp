@@ -30,6 +30,7 @@
 
 #include "file_access_memory.h"
 
+#include "core/io/marshalls.h"
 #include "core/map.h"
 #include "core/os/copymem.h"
 #include "core/os/dir_access.h"
@@ -76,6 +77,7 @@ Error FileAccessMemory::open_custom(const uint8_t *p_data, int p_len) {
 	data = (uint8_t *)p_data;
 	length = p_len;
 	pos = 0;
+	eof = false;
 	return OK;
 }
 
@@ -91,6 +93,7 @@ Error FileAccessMemory::_open(const String &p_path, int p_mode_flags) {
 	data = E->get().ptrw();
 	length = E->get().size();
 	pos = 0;
+	eof = false;
 
 	return OK;
 }
@@ -105,12 +108,14 @@ bool FileAccessMemory::is_open() const {
 
 void FileAccessMemory::seek(size_t p_position) {
 	ERR_FAIL_COND(!data);
-	pos = p_position;
+	pos = MIN(p_position, size_t(length) + 1);
+	eof = false;
 }
 
 void FileAccessMemory::seek_end(int64_t p_position) {
 	ERR_FAIL_COND(!data);
 	pos = length + p_position;
+	eof = false;
 }
 
 size_t FileAccessMemory::get_position() const {
@@ -124,7 +129,7 @@ size_t FileAccessMemory::get_len() const {
 }
 
 bool FileAccessMemory::eof_reached() const {
-	return pos > length;
+	return eof || pos > length;
 }
 
 uint8_t FileAccessMemory::get_8() const {
@@ -137,24 +142,54 @@ uint8_t FileAccessMemory::get_8() const {
 	return ret;
 }
 
+uint16_t FileAccessMemory::get_16() const {
+	if (pos + 2 > length) {
+		return FileAccess::get_16();
+	}
+	uint16_t ret = decode_uint16(&data[pos]);
+	pos += 2;
+	return endian_swap ? BSWAP16(ret) : ret;
+}
+
+uint32_t FileAccessMemory::get_32() const {
+	if (pos + 4 > length) {
+		return FileAccess::get_32();
+	}
+	uint32_t ret = decode_uint32(&data[pos]);
+	pos += 4;
+	return endian_swap ? BSWAP32(ret) : ret;
+}
+
+uint64_t FileAccessMemory::get_64() const {
+	if (pos + 8 > length) {
+		return FileAccess::get_64();
+	}
+	uint64_t ret = decode_uint64(&data[pos]);
+	pos += 8;
+	return endian_swap ? BSWAP64(ret) : ret;
+}
+
 int FileAccessMemory::get_buffer(uint8_t *p_dst, int p_length) const {
 	ERR_FAIL_COND_V(!data, -1);
 
-	int left = length - pos;
+	int left = pos < length ? length - pos : 0;
 	int read = MIN(p_length, left);
 
 	if (read < p_length) {
 		WARN_PRINT("Reading less data than requested");
+		eof = true;
 	}
 
-	copymem(p_dst, &data[pos], read);
-	pos += p_length;
+	if (read > 0) {
+		copymem(p_dst, &data[pos], read);
+		pos += read;
+	}
 
 	return read;
 }
 
 Error FileAccessMemory::get_error() const {
-	return pos >= length ? ERR_FILE_EOF : OK;
+	return eof || pos >= length ? ERR_FILE_EOF : OK;
 }
 
 void FileAccessMemory::flush() {
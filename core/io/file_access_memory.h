@@ -37,6 +37,7 @@ class FileAccessMemory : public FileAccess {
 	uint8_t *data = nullptr;
 	int length;
 	mutable int pos;
+	mutable bool eof = false; // A buffer read was cut short by the end of the data.
 
 	static FileAccess *create();
 
@@ -57,6 +58,9 @@ public:
 	virtual bool eof_reached() const; ///< reading passed EOF
 
 	virtual uint8_t get_8() const; ///< get a byte
+	virtual uint16_t get_16() const; ///< get 16 bits uint
+	virtual uint32_t get_32() const; ///< get 32 bits uint
+	virtual uint64_t get_64() const; ///< get 64 bits uint
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const; ///< get an array of bytes
 
@@ -276,6 +276,11 @@ int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::map(uint64_t p_offset, uint64_t p_length) {
+	ERR_FAIL_COND_V(p_offset + p_length > pf.size, nullptr);
+	return f->map(pf.offset + p_offset, p_length);
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
 	f->set_endian_swap(p_swap);
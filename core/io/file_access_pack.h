@@ -157,6 +157,8 @@ public:
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
 
+	virtual const uint8_t *map(uint64_t p_offset, uint64_t p_length);
+
 	virtual void set_endian_swap(bool p_swap);
 
 	virtual Error get_error() const;
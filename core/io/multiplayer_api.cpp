@@ -32,6 +32,7 @@
 
 #include "core/debugger/engine_debugger.h"
 #include "core/io/marshalls.h"
+#include "core/os/os.h"
 #include "scene/main/node.h"
 
 #include <stdint.h>
@@ -40,10 +41,6 @@
 #define NAME_ID_COMPRESSION_SHIFT 5
 #define BYTE_ONLY_OR_NO_ARGS_SHIFT 6
 
-#ifdef DEBUG_ENABLED
-#include "core/os/os.h"
-#endif
-
 _FORCE_INLINE_ bool _should_call_local(MultiplayerAPI::RPCMode mode, bool is_master, bool &r_skip_rpc) {
 	switch (mode) {
 		case MultiplayerAPI::RPC_MODE_DISABLED: {
@@ -128,6 +125,20 @@ void MultiplayerAPI::poll() {
 			break; // It's also possible that a packet or RPC caused a disconnection, so also check here.
 		}
 	}
+
+	if (!network_peer.is_valid() || network_peer->get_connection_status() != NetworkedMultiplayerPeer::CONNECTION_CONNECTED) {
+		return;
+	}
+
+	_send_replication_acks();
+
+	if (replication_batching) {
+		uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+		if (replication_tick_rate <= 0 || ticks - replication_last_flush >= 1000000 / uint64_t(replication_tick_rate)) {
+			replication_last_flush = ticks;
+			flush_replication();
+		}
+	}
 }
 
 void MultiplayerAPI::clear() {
@@ -136,6 +147,8 @@ void MultiplayerAPI::clear() {
 	path_send_cache.clear();
 	packet_cache.clear();
 	last_send_cache_id = 1;
+	replication_entries.clear();
+	replication_peers.clear();
 }
 
 void MultiplayerAPI::set_root_node(Node *p_node) {
@@ -310,6 +323,14 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 		case NETWORK_COMMAND_RAW: {
 			_process_raw(p_from, p_packet, p_packet_len);
 		} break;
+
+		case NETWORK_COMMAND_REPLICATION: {
+			_process_replication(p_from, p_packet, p_packet_len);
+		} break;
+
+		case NETWORK_COMMAND_REPLICATION_ACK: {
+			_process_replication_ack(p_from, p_packet, p_packet_len);
+		} break;
 	}
 }
 
@@ -452,11 +473,15 @@ void MultiplayerAPI::_process_rset(Node *p_node, const uint16_t p_rpc_property_i
 
 	ERR_FAIL_COND_MSG(err != OK, "Invalid packet received. Unable to decode RSET value.");
 
+	_set_remote_property(p_node, name, value);
+}
+
+void MultiplayerAPI::_set_remote_property(Node *p_node, const StringName &p_name, const Variant &p_value) {
 	bool valid;
 
-	p_node->set(name, value, &valid);
+	p_node->set(p_name, p_value, &valid);
 	if (!valid) {
-		String error = "Error setting remote property '" + String(name) + "', not found in object of type " + p_node->get_class() + ".";
+		String error = "Error setting remote property '" + String(p_name) + "', not found in object of type " + p_node->get_class() + ".";
 		ERR_PRINT(error);
 	}
 }
@@ -748,6 +773,17 @@ Error MultiplayerAPI::_decode_and_decompress_variant(Variant &r_variant, const u
 	return OK;
 }
 
+MultiplayerAPI::PathSentCache *MultiplayerAPI::_get_path_send_cache(const NodePath &p_path) {
+	PathSentCache *psc = path_send_cache.getptr(p_path);
+	if (!psc) {
+		// Path is not cached, create.
+		path_send_cache[p_path] = PathSentCache();
+		psc = path_send_cache.getptr(p_path);
+		psc->id = last_send_cache_id++;
+	}
+	return psc;
+}
+
 void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount) {
 	ERR_FAIL_COND_MSG(network_peer.is_null(), "Attempt to remote call/set when networking is not active in SceneTree.");
 
@@ -767,13 +803,7 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 	ERR_FAIL_COND_MSG(from_path.is_empty(), "Unable to send RPC. Relative path is empty. THIS IS LIKELY A BUG IN THE ENGINE!");
 
 	// See if the path is cached.
-	PathSentCache *psc = path_send_cache.getptr(from_path);
-	if (!psc) {
-		// Path is not cached, create.
-		path_send_cache[from_path] = PathSentCache();
-		psc = path_send_cache.getptr(from_path);
-		psc->id = last_send_cache_id++;
-	}
+	PathSentCache *psc = _get_path_send_cache(from_path);
 
 	// See if all peers have cached path (if so, call can be fast).
 	const bool has_all_peers = _send_confirm_path(p_from, from_path, psc, p_to);
@@ -976,6 +1006,18 @@ void MultiplayerAPI::_add_peer(int p_id) {
 
 void MultiplayerAPI::_del_peer(int p_id) {
 	connected_peers.erase(p_id);
+	replication_peers.erase(p_id);
+	// Values queued only for this peer won't be sent anymore.
+	LocalVector<ReplicationKey> targeted;
+	const ReplicationKey *k = nullptr;
+	while ((k = replication_entries.next(k))) {
+		if (k->target == p_id) {
+			targeted.push_back(*k);
+		}
+	}
+	for (uint32_t i = 0; i < targeted.size(); i++) {
+		replication_entries.erase(targeted[i]);
+	}
 	// Cleanup get cache.
 	path_get_cache.erase(p_id);
 	// Cleanup sent cache.
@@ -1126,6 +1168,12 @@ void MultiplayerAPI::rsetp(Node *p_node, int p_peer_id, bool p_unreliable, const
 	_profile_node_data("out_rset", p_node->get_instance_id());
 #endif
 
+	if (p_unreliable && replication_batching) {
+		// Sent with the other changes on the next network tick.
+		_queue_replication(p_node, p_peer_id, p_property, p_value);
+		return;
+	}
+
 	const Variant *vptr = &p_value;
 
 	_send_rpc(p_node, p_peer_id, p_unreliable, true, p_property, &vptr, 1);
@@ -1160,6 +1208,568 @@ void MultiplayerAPI::_process_raw(int p_from, const uint8_t *p_packet, int p_pac
 	emit_signal("network_peer_packet", p_from, out);
 }
 
+/* BATCHED REPLICATION */
+
+// With replication batching, rset_unreliable() only records the new value.
+// Every network tick, the values a peer didn't acknowledge yet are sent to it
+// in a single packet:
+// - NETWORK_COMMAND_REPLICATION, then the 16 bits sequence number of the packet.
+// - For each value, the node path ID and the property ID as variable length
+//   integers, then a byte with the encoding in the 2 LSB and the variant type.
+// - Numbers and vectors are quantized to integers. They are sent as is, or as
+//   the difference from the last value the peer acknowledged, preceded by how
+//   many packets ago that was. Each component is a zigzag variable length integer.
+// - Other values use the RPC variant encoding.
+// Peers acknowledge the last sequence number they received, with a mask of the
+// 32 previous ones. Lost packets are not resent, the values they carried stay
+// unacknowledged, so the next packets carry them if they didn't change since.
+
+enum {
+	REPLICATION_VALUE_VARIANT = 0,
+	REPLICATION_VALUE_ABSOLUTE,
+	REPLICATION_VALUE_DELTA,
+	REPLICATION_VALUE_MASK = 3,
+	REPLICATION_VALUE_TYPE_SHIFT = 2,
+	REPLICATION_QUAT_SCALE = 32767,
+};
+
+static _FORCE_INLINE_ uint32_t _zigzag_encode(int32_t p_value) {
+	return (uint32_t(p_value) << 1) ^ uint32_t(p_value >> 31);
+}
+
+static _FORCE_INLINE_ int32_t _zigzag_decode(uint32_t p_value) {
+	return int32_t(p_value >> 1) ^ -int32_t(p_value & 1);
+}
+
+static int _encode_varuint(uint32_t p_value, uint8_t *p_buf) {
+	int len = 0;
+	while (p_value >= 0x80) {
+		p_buf[len++] = uint8_t(p_value) | 0x80;
+		p_value >>= 7;
+	}
+	p_buf[len++] = p_value;
+	return len;
+}
+
+static bool _decode_varuint(const uint8_t *p_buf, int p_len, int &r_ofs, uint32_t &r_value) {
+	r_value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (r_ofs >= p_len) {
+			return false;
+		}
+		uint8_t b = p_buf[r_ofs++];
+		r_value |= uint32_t(b & 0x7F) << shift;
+		if (!(b & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static int _get_replication_components(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::INT:
+		case Variant::FLOAT:
+			return 1;
+		case Variant::VECTOR2:
+			return 2;
+		case Variant::VECTOR3:
+			return 3;
+		case Variant::QUAT:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+static _FORCE_INLINE_ bool _quantize_real(real_t p_value, float p_scale, int32_t &r_q) {
+	double q = Math::round(double(p_value) * p_scale);
+	if (!(q > -2147483647.0 && q < 2147483647.0)) {
+		return false; // Out of range, or NaN.
+	}
+	r_q = int32_t(q);
+	return true;
+}
+
+bool MultiplayerAPI::ReplicationValue::operator==(const ReplicationValue &p_other) const {
+	if (type != p_other.type || quantized != p_other.quantized) {
+		return false;
+	}
+	if (!quantized) {
+		return value == p_other.value;
+	}
+	return q[0] == p_other.q[0] && q[1] == p_other.q[1] && q[2] == p_other.q[2] && q[3] == p_other.q[3];
+}
+
+void MultiplayerAPI::_quantize_replication_value(const Variant &p_value, ReplicationValue &r_value) const {
+	r_value.type = p_value.get_type();
+	r_value.quantized = true;
+	r_value.value = Variant();
+	int32_t *q = r_value.q;
+	q[0] = q[1] = q[2] = q[3] = 0;
+
+	float scale = 1.0 / replication_quantization_step;
+
+	switch (r_value.type) {
+		case Variant::INT: {
+			int64_t v = p_value;
+			if (v >= INT32_MIN && v <= INT32_MAX) {
+				q[0] = v;
+				return;
+			}
+		} break;
+		case Variant::FLOAT: {
+			if (_quantize_real(p_value, scale, q[0])) {
+				return;
+			}
+		} break;
+		case Variant::VECTOR2: {
+			Vector2 v = p_value;
+			if (_quantize_real(v.x, scale, q[0]) && _quantize_real(v.y, scale, q[1])) {
+				return;
+			}
+		} break;
+		case Variant::VECTOR3: {
+			Vector3 v = p_value;
+			if (_quantize_real(v.x, scale, q[0]) && _quantize_real(v.y, scale, q[1]) && _quantize_real(v.z, scale, q[2])) {
+				return;
+			}
+		} break;
+		case Variant::QUAT: {
+			// Rotations are normalized, so they get a fixed precision instead.
+			Quat v = p_value;
+			if (_quantize_real(CLAMP(v.x, -1, 1), REPLICATION_QUAT_SCALE, q[0]) && _quantize_real(CLAMP(v.y, -1, 1), REPLICATION_QUAT_SCALE, q[1]) &&
+					_quantize_real(CLAMP(v.z, -1, 1), REPLICATION_QUAT_SCALE, q[2]) && _quantize_real(CLAMP(v.w, -1, 1), REPLICATION_QUAT_SCALE, q[3])) {
+				return;
+			}
+		} break;
+		default: {
+		}
+	}
+
+	q[0] = q[1] = q[2] = q[3] = 0;
+	r_value.quantized = false;
+	r_value.value = p_value;
+}
+
+Variant MultiplayerAPI::_dequantize_replication_value(Variant::Type p_type, const int32_t *p_q) const {
+	real_t step = replication_quantization_step;
+	switch (p_type) {
+		case Variant::INT:
+			return p_q[0];
+		case Variant::FLOAT:
+			return p_q[0] * step;
+		case Variant::VECTOR2:
+			return Vector2(p_q[0] * step, p_q[1] * step);
+		case Variant::VECTOR3:
+			return Vector3(p_q[0] * step, p_q[1] * step, p_q[2] * step);
+		case Variant::QUAT:
+			return Quat(p_q[0], p_q[1], p_q[2], p_q[3]) / REPLICATION_QUAT_SCALE;
+		default:
+			return Variant();
+	}
+}
+
+void MultiplayerAPI::_queue_replication(Node *p_node, int p_to, const StringName &p_property, const Variant &p_value) {
+	if (p_to != 0 && !connected_peers.has(ABS(p_to))) {
+		ERR_FAIL_COND_MSG(p_to == network_peer->get_unique_id(), "Attempt to remote set yourself! unique ID: " + itos(network_peer->get_unique_id()) + ".");
+
+		ERR_FAIL_MSG("Attempt to remote set unexisting ID: " + itos(p_to) + ".");
+	}
+
+	uint16_t property_id = p_node->get_node_rset_property_id(p_property);
+	if (property_id == UINT16_MAX && p_node->get_script_instance()) {
+		property_id = p_node->get_script_instance()->get_rset_property_id(p_property);
+	}
+	ERR_FAIL_COND_MSG(property_id == UINT16_MAX, "Unable to take the `property_id` for the property:" + p_property + ". this can happen only if this property is not marked as `remote`.");
+
+	NodePath path = (root_node->get_path()).rel_path_to(p_node->get_path());
+	ERR_FAIL_COND_MSG(path.is_empty(), "Unable to send RSET. Relative path is empty. THIS IS LIKELY A BUG IN THE ENGINE!");
+
+	PathSentCache *psc = _get_path_send_cache(path);
+
+	ReplicationKey key;
+	key.id = (uint64_t(uint32_t(psc->id)) << 16) | property_id;
+	key.target = p_to;
+	ReplicationEntry *entry = replication_entries.getptr(key);
+	if (!entry) {
+		replication_entries[key] = ReplicationEntry();
+		entry = replication_entries.getptr(key);
+		entry->path = path;
+		entry->path_cache = psc;
+		entry->property_id = property_id;
+		entry->target = p_to;
+	}
+	entry->node = p_node->get_instance_id();
+	entry->order = ++replication_order;
+	_quantize_replication_value(p_value, entry->value);
+}
+
+void MultiplayerAPI::_send_replication(int p_peer) {
+	ReplicationPeer &rp = replication_peers[p_peer];
+	ReplicationSent *sent = nullptr;
+	int ofs = 0;
+
+	// Several entries can include this peer for the same property, only the last one queued is sent.
+	HashMap<uint64_t, const ReplicationEntry *> latest;
+	const ReplicationKey *e = nullptr;
+	while ((e = replication_entries.next(e))) {
+		if ((e->target > 0 && e->target != p_peer) || (e->target < 0 && -e->target == p_peer)) {
+			continue;
+		}
+		const ReplicationEntry *entry = &replication_entries[*e];
+		const ReplicationEntry **L = latest.getptr(e->id);
+		if (!L) {
+			latest[e->id] = entry;
+		} else if ((*L)->order < entry->order) {
+			*L = entry;
+		}
+	}
+
+	const uint64_t *k = nullptr;
+	while ((k = latest.next(k))) {
+		const ReplicationEntry &entry = *latest[*k];
+
+		// Values are always sent with the path ID, so the peer must know it first.
+		Map<int, bool>::Element *F = entry.path_cache->confirmed_peers.find(p_peer);
+		if (!F) {
+			Node *node = Object::cast_to<Node>(ObjectDB::get_instance(entry.node));
+			if (node) {
+				_send_confirm_path(node, entry.path, entry.path_cache, p_peer);
+			}
+			continue;
+		}
+		if (!F->get()) {
+			continue;
+		}
+
+		const ReplicationAcked *acked = rp.acked.getptr(*k);
+		if (acked && acked->value == entry.value) {
+			continue; // The peer is up to date.
+		}
+
+		if (!sent) {
+			uint32_t seq = rp.next_seq++;
+			sent = &rp.sent[seq % REPLICATION_HISTORY];
+			sent->seq = seq;
+			sent->used = true;
+			sent->keys.clear();
+			sent->values.clear();
+
+			MAKE_ROOM(3);
+			packet_cache.write[0] = NETWORK_COMMAND_REPLICATION;
+			encode_uint16(seq, &packet_cache.write[1]);
+			ofs = 3;
+		}
+
+		int len = 0;
+		if (!entry.value.quantized) {
+			Error err = _encode_and_compress_variant(entry.value.value, nullptr, len);
+			ERR_CONTINUE_MSG(err != OK, "Unable to encode RSET value. THIS IS LIKELY A BUG IN THE ENGINE!");
+		}
+		MAKE_ROOM(ofs + 5 + 5 + 2 + 5 * 4 + len);
+		uint8_t *w = &packet_cache.write[ofs];
+
+		int l = 0;
+		l += _encode_varuint(entry.path_cache->id, &w[l]);
+		l += _encode_varuint(entry.property_id, &w[l]);
+
+		if (!entry.value.quantized) {
+			w[l++] = REPLICATION_VALUE_VARIANT | (entry.value.type << REPLICATION_VALUE_TYPE_SHIFT);
+			_encode_and_compress_variant(entry.value.value, &w[l], len);
+			l += len;
+		} else {
+			// The peer keeps the values it received in the last packets, a delta can refer to any of them.
+			bool delta = acked && acked->value.quantized && acked->value.type == entry.value.type && sent->seq - acked->seq < REPLICATION_HISTORY;
+			w[l++] = (delta ? REPLICATION_VALUE_DELTA : REPLICATION_VALUE_ABSOLUTE) | (entry.value.type << REPLICATION_VALUE_TYPE_SHIFT);
+			if (delta) {
+				w[l++] = sent->seq - acked->seq;
+			}
+
+			int components = _get_replication_components(entry.value.type);
+			for (int i = 0; i < components; i++) {
+				int32_t q = entry.value.q[i];
+				if (delta) {
+					q = int32_t(uint32_t(q) - uint32_t(acked->value.q[i])); // Wraps around, as decoding does.
+				}
+				l += _encode_varuint(_zigzag_encode(q), &w[l]);
+			}
+		}
+
+		ofs += l;
+		sent->keys.push_back(*k);
+		sent->values.push_back(entry.value);
+
+		if (ofs >= REPLICATION_MAX_PACKET_SIZE) {
+			network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+			network_peer->set_target_peer(p_peer);
+			network_peer->put_packet(packet_cache.ptr(), ofs);
+#ifdef DEBUG_ENABLED
+			_profile_bandwidth_data("out", ofs);
+#endif
+			sent = nullptr;
+		}
+	}
+
+	if (sent) {
+		network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+		network_peer->set_target_peer(p_peer);
+		network_peer->put_packet(packet_cache.ptr(), ofs);
+#ifdef DEBUG_ENABLED
+		_profile_bandwidth_data("out", ofs);
+#endif
+	}
+}
+
+void MultiplayerAPI::_send_replication_acks() {
+	const int *k = nullptr;
+	while ((k = replication_peers.next(k))) {
+		ReplicationPeer &rp = replication_peers[*k];
+		if (!rp.ack_pending) {
+			continue;
+		}
+		rp.ack_pending = false;
+
+		uint8_t packet[7];
+		packet[0] = NETWORK_COMMAND_REPLICATION_ACK;
+		encode_uint16(rp.received_seq, &packet[1]);
+		encode_uint32(rp.received_mask, &packet[3]);
+
+		network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+		network_peer->set_target_peer(*k);
+		network_peer->put_packet(packet, 7);
+	}
+}
+
+void MultiplayerAPI::_process_replication(int p_from, const uint8_t *p_packet, int p_packet_len) {
+	ERR_FAIL_COND_MSG(p_packet_len < 3, "Invalid packet received. Size too small.");
+
+	uint16_t seq = decode_uint16(&p_packet[1]);
+	// Only created for valid values, so bogus IDs don't allocate anything.
+	ReplicationPeer *rp = replication_peers.getptr(p_from);
+	bool dropped = false;
+
+	int ofs = 3;
+	while (ofs < p_packet_len) {
+		uint32_t node_id = 0;
+		uint32_t property_id = 0;
+		ERR_FAIL_COND_MSG(!_decode_varuint(p_packet, p_packet_len, ofs, node_id) || !_decode_varuint(p_packet, p_packet_len, ofs, property_id) || ofs >= p_packet_len, "Invalid packet received. Size too small.");
+		ERR_FAIL_COND_MSG((node_id & 0x80000000) || property_id > UINT16_MAX, "Invalid packet received. Replicated value has an invalid ID.");
+
+		uint8_t encoding = p_packet[ofs] & REPLICATION_VALUE_MASK;
+		Variant::Type type = Variant::Type(p_packet[ofs] >> REPLICATION_VALUE_TYPE_SHIFT);
+		ofs += 1;
+		ERR_FAIL_COND_MSG(type >= Variant::VARIANT_MAX, "Invalid packet received. Replicated value has an invalid type.");
+
+		// The history is only kept for properties the peer can set, values for
+		// anything else are decoded to reach the next one and dropped.
+		StringName name;
+		Node *node = _process_get_node(p_from, p_packet, node_id, p_packet_len);
+		if (node) {
+			name = node->get_node_rset_property(property_id);
+			RPCMode rset_mode = node->get_node_rset_mode_by_id(property_id);
+			if (name == StringName() && node->get_script_instance()) {
+				name = node->get_script_instance()->get_rset_property(property_id);
+				rset_mode = node->get_script_instance()->get_rset_mode_by_id(property_id);
+			}
+			if (name == StringName()) {
+				ERR_PRINT("Invalid packet received. Replicated property was not found.");
+			} else if (!_can_call_mode(node, rset_mode, p_from)) {
+				ERR_PRINT("RSET '" + String(name) + "' is not allowed on node " + node->get_path() + " from: " + itos(p_from) + ". Mode is " + itos((int)rset_mode) + ", master is " + itos(node->get_network_master()) + ".");
+				name = StringName();
+			}
+		}
+
+		ReplicationHistory *history = nullptr;
+		if (name != StringName()) {
+			if (!rp) {
+				rp = &replication_peers[p_from];
+			}
+			history = &rp->history[(uint64_t(node_id) << 16) | property_id];
+		} else {
+			dropped = true;
+		}
+
+		Variant value;
+		if (encoding == REPLICATION_VALUE_VARIANT) {
+			int len = 0;
+			Error err = _decode_and_decompress_variant(value, &p_packet[ofs], p_packet_len - ofs, &len);
+			ERR_FAIL_COND_MSG(err != OK, "Invalid packet received. Unable to decode replicated value.");
+			ofs += len;
+		} else {
+			int components = _get_replication_components(type);
+			ERR_FAIL_COND_MSG(components == 0 || encoding > REPLICATION_VALUE_DELTA, "Invalid packet received. Replicated value has an invalid encoding.");
+
+			uint16_t base_seq = seq;
+			if (encoding == REPLICATION_VALUE_DELTA) {
+				ERR_FAIL_COND_MSG(ofs >= p_packet_len, "Invalid packet received. Size too small.");
+				base_seq = seq - p_packet[ofs];
+				ofs += 1;
+			}
+
+			int32_t q[4] = {};
+			for (int i = 0; i < components; i++) {
+				uint32_t v = 0;
+				ERR_FAIL_COND_MSG(!_decode_varuint(p_packet, p_packet_len, ofs, v), "Invalid packet received. Size too small.");
+				q[i] = _zigzag_decode(v);
+			}
+
+			if (!history) {
+				continue;
+			}
+
+			if (encoding == REPLICATION_VALUE_DELTA) {
+				const ReplicationReceived &base = history->received[base_seq % REPLICATION_HISTORY];
+				ERR_FAIL_COND_MSG(!base.valid || base.seq != base_seq, "Invalid packet received. Replicated value refers to an unknown state.");
+				for (int i = 0; i < components; i++) {
+					q[i] = int32_t(uint32_t(base.q[i]) + uint32_t(q[i]));
+				}
+			}
+
+			// Packets arriving late must not replace the more recent values deltas can refer to.
+			ReplicationReceived &received = history->received[seq % REPLICATION_HISTORY];
+			if (!received.valid || int16_t(seq - received.seq) > 0) {
+				received.valid = true;
+				received.seq = seq;
+				for (int i = 0; i < 4; i++) {
+					received.q[i] = q[i];
+				}
+			}
+
+			value = _dequantize_replication_value(type, q);
+		}
+
+		if (!history) {
+			continue;
+		}
+		if (history->has_latest && int16_t(seq - history->latest_seq) <= 0) {
+			continue; // A more recent value was already applied.
+		}
+		history->has_latest = true;
+		history->latest_seq = seq;
+
+#ifdef DEBUG_ENABLED
+		_profile_node_data("in_rset", node->get_instance_id());
+#endif
+
+		_set_remote_property(node, name, value);
+	}
+
+	if (dropped) {
+		return; // Deltas can't refer to values that weren't kept, they must be sent again in full.
+	}
+
+	// Acknowledged with the next poll.
+	if (!rp) {
+		rp = &replication_peers[p_from];
+	}
+	if (!rp->has_received) {
+		rp->has_received = true;
+		rp->received_seq = seq;
+		rp->received_mask = 0;
+	} else {
+		int16_t diff = int16_t(seq - rp->received_seq);
+		if (diff > 0) {
+			rp->received_mask = diff > 32 ? 0 : uint32_t((uint64_t(rp->received_mask) << diff) | (uint64_t(1) << (diff - 1)));
+			rp->received_seq = seq;
+		} else if (diff < 0 && diff >= -32) {
+			rp->received_mask |= 1u << (-diff - 1);
+		}
+	}
+	rp->ack_pending = true;
+}
+
+void MultiplayerAPI::_process_replication_ack(int p_from, const uint8_t *p_packet, int p_packet_len) {
+	ERR_FAIL_COND_MSG(p_packet_len < 7, "Invalid packet received. Size too small.");
+
+	ReplicationPeer *rp = replication_peers.getptr(p_from);
+	if (!rp) {
+		return;
+	}
+
+	uint16_t seq = decode_uint16(&p_packet[1]);
+	uint32_t mask = decode_uint32(&p_packet[3]);
+
+	for (int i = 0; i <= 32; i++) {
+		if (i > 0 && !(mask & (1u << (i - 1)))) {
+			continue;
+		}
+
+		uint16_t acked_seq = seq - i;
+		ReplicationSent &sent = rp->sent[acked_seq % REPLICATION_HISTORY];
+		if (!sent.used || uint16_t(sent.seq) != acked_seq) {
+			continue; // Already processed, or too old.
+		}
+		sent.used = false;
+
+		for (uint32_t j = 0; j < sent.keys.size(); j++) {
+			ReplicationAcked *acked = rp->acked.getptr(sent.keys[j]);
+			if (!acked) {
+				rp->acked[sent.keys[j]] = ReplicationAcked();
+				acked = rp->acked.getptr(sent.keys[j]);
+			} else if (int32_t(sent.seq - acked->seq) <= 0) {
+				continue; // A more recent packet was acknowledged first.
+			}
+			acked->seq = sent.seq;
+			acked->value = sent.values[j];
+		}
+	}
+}
+
+void MultiplayerAPI::flush_replication() {
+	ERR_FAIL_COND_MSG(!network_peer.is_valid(), "Trying to flush replication while no network peer is active.");
+	ERR_FAIL_COND_MSG(network_peer->get_connection_status() != NetworkedMultiplayerPeer::CONNECTION_CONNECTED, "Trying to flush replication via a network peer which is not connected.");
+
+	if (replication_entries.empty()) {
+		return;
+	}
+
+	// Forget the values of freed nodes.
+	LocalVector<ReplicationKey> freed;
+	const ReplicationKey *k = nullptr;
+	while ((k = replication_entries.next(k))) {
+		if (!ObjectDB::get_instance(replication_entries[*k].node)) {
+			freed.push_back(*k);
+		}
+	}
+	for (uint32_t i = 0; i < freed.size(); i++) {
+		replication_entries.erase(freed[i]);
+		const int *p = nullptr;
+		while ((p = replication_peers.next(p))) {
+			replication_peers[*p].acked.erase(freed[i].id);
+		}
+	}
+
+	for (Set<int>::Element *E = connected_peers.front(); E; E = E->next()) {
+		_send_replication(E->get());
+	}
+}
+
+void MultiplayerAPI::set_replication_batching(bool p_enable) {
+	replication_batching = p_enable;
+}
+
+bool MultiplayerAPI::is_replication_batching() const {
+	return replication_batching;
+}
+
+void MultiplayerAPI::set_replication_tick_rate(int p_rate) {
+	replication_tick_rate = MAX(p_rate, 0);
+}
+
+int MultiplayerAPI::get_replication_tick_rate() const {
+	return replication_tick_rate;
+}
+
+void MultiplayerAPI::set_replication_quantization_step(float p_step) {
+	ERR_FAIL_COND_MSG(p_step <= 0, "The quantization step must be greater than 0.");
+	replication_quantization_step = p_step;
+}
+
+float MultiplayerAPI::get_replication_quantization_step() const {
+	return replication_quantization_step;
+}
+
 int MultiplayerAPI::get_network_unique_id() const {
 	ERR_FAIL_COND_V_MSG(!network_peer.is_valid(), 0, "No network peer is assigned. Unable to get unique network ID.");
 	return network_peer->get_unique_id();
@@ -1217,10 +1827,20 @@ void MultiplayerAPI::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_refusing_new_network_connections"), &MultiplayerAPI::is_refusing_new_network_connections);
 	ClassDB::bind_method(D_METHOD("set_allow_object_decoding", "enable"), &MultiplayerAPI::set_allow_object_decoding);
 	ClassDB::bind_method(D_METHOD("is_object_decoding_allowed"), &MultiplayerAPI::is_object_decoding_allowed);
+	ClassDB::bind_method(D_METHOD("set_replication_batching", "enable"), &MultiplayerAPI::set_replication_batching);
+	ClassDB::bind_method(D_METHOD("is_replication_batching"), &MultiplayerAPI::is_replication_batching);
+	ClassDB::bind_method(D_METHOD("set_replication_tick_rate", "rate"), &MultiplayerAPI::set_replication_tick_rate);
+	ClassDB::bind_method(D_METHOD("get_replication_tick_rate"), &MultiplayerAPI::get_replication_tick_rate);
+	ClassDB::bind_method(D_METHOD("set_replication_quantization_step", "step"), &MultiplayerAPI::set_replication_quantization_step);
+	ClassDB::bind_method(D_METHOD("get_replication_quantization_step"), &MultiplayerAPI::get_replication_quantization_step);
+	ClassDB::bind_method(D_METHOD("flush_replication"), &MultiplayerAPI::flush_replication);
 
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "allow_object_decoding"), "set_allow_object_decoding", "is_object_decoding_allowed");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "refuse_new_network_connections"), "set_refuse_new_network_connections", "is_refusing_new_network_connections");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "network_peer", PROPERTY_HINT_RESOURCE_TYPE, "NetworkedMultiplayerPeer", 0), "set_network_peer", "get_network_peer");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "replication_batching"), "set_replication_batching", "is_replication_batching");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "replication_tick_rate", PROPERTY_HINT_RANGE, "0,240,1"), "set_replication_tick_rate", "get_replication_tick_rate");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "replication_quantization_step", PROPERTY_HINT_RANGE, "0.0001,1,0.0001,or_greater"), "set_replication_quantization_step", "get_replication_quantization_step");
 	ADD_PROPERTY_DEFAULT("refuse_new_network_connections", false);
 
 	ADD_SIGNAL(MethodInfo("network_peer_connected", PropertyInfo(Variant::INT, "id")));
@@ -32,6 +32,7 @@
 #define MULTIPLAYER_API_H
 
 #include "core/io/networked_multiplayer_peer.h"
+#include "core/local_vector.h"
 #include "core/reference.h"
 
 class MultiplayerAPI : public Reference {
@@ -54,6 +55,82 @@ private:
 		Map<int, NodeInfo> nodes;
 	};
 
+	enum {
+		REPLICATION_HISTORY = 32, // Sent and received snapshots kept per peer, matches the ack mask.
+		REPLICATION_MAX_PACKET_SIZE = 1200,
+	};
+
+	// A replicated value, quantized to integers when it's a number or a vector.
+	struct ReplicationValue {
+		Variant::Type type = Variant::NIL;
+		bool quantized = false;
+		int32_t q[4] = {};
+		Variant value; // Only when not quantized.
+
+		bool operator==(const ReplicationValue &p_other) const;
+		bool operator!=(const ReplicationValue &p_other) const { return !(*this == p_other); }
+	};
+
+	// The latest value set with rset_unreliable() on a node property.
+	struct ReplicationEntry {
+		ObjectID node;
+		NodePath path;
+		PathSentCache *path_cache = nullptr; // path_send_cache entries are only removed by clear(), with these.
+		uint16_t property_id = 0;
+		int target = 0;
+		uint64_t order = 0; // When it was queued, the last entry queued for a peer wins.
+		ReplicationValue value;
+	};
+
+	// Values queued for different targets are kept apart, so setting a
+	// property for one peer doesn't drop the value queued for another.
+	struct ReplicationKey {
+		uint64_t id = 0; // Path and property IDs, as sent.
+		int target = 0;
+
+		bool operator==(const ReplicationKey &p_key) const { return id == p_key.id && target == p_key.target; }
+		static uint32_t hash(const ReplicationKey &p_key) { return hash_djb2_one_32(p_key.target, hash_djb2_one_64(p_key.id)); }
+	};
+
+	struct ReplicationSent {
+		uint32_t seq = 0;
+		bool used = false;
+		LocalVector<uint64_t> keys;
+		LocalVector<ReplicationValue> values;
+	};
+
+	struct ReplicationAcked {
+		uint32_t seq = 0;
+		ReplicationValue value;
+	};
+
+	struct ReplicationReceived {
+		uint16_t seq = 0;
+		bool valid = false;
+		int32_t q[4] = {};
+	};
+
+	struct ReplicationHistory {
+		uint16_t latest_seq = 0;
+		bool has_latest = false;
+		ReplicationReceived received[REPLICATION_HISTORY];
+	};
+
+	struct ReplicationPeer {
+		// Sending side, deltas are encoded against the last state acknowledged by the peer.
+		// Sequence numbers are sent truncated to 16 bits.
+		uint32_t next_seq = 0;
+		ReplicationSent sent[REPLICATION_HISTORY];
+		HashMap<uint64_t, ReplicationAcked> acked;
+
+		// Receiving side, keeps the recent values deltas may refer to.
+		uint16_t received_seq = 0;
+		uint32_t received_mask = 0; // Bit N set if received_seq - N - 1 was received.
+		bool has_received = false;
+		bool ack_pending = false;
+		HashMap<uint64_t, ReplicationHistory> history;
+	};
+
 	Ref<NetworkedMultiplayerPeer> network_peer;
 	int rpc_sender_id = 0;
 	Set<int> connected_peers;
@@ -64,6 +141,14 @@ private:
 	Node *root_node = nullptr;
 	bool allow_object_decoding = false;
 
+	bool replication_batching = false;
+	int replication_tick_rate = 0;
+	float replication_quantization_step = 1.0 / 1024.0;
+	uint64_t replication_last_flush = 0;
+	uint64_t replication_order = 0;
+	HashMap<ReplicationKey, ReplicationEntry, ReplicationKey> replication_entries;
+	HashMap<int, ReplicationPeer> replication_peers;
+
 protected:
 	static void _bind_methods();
 
@@ -73,10 +158,20 @@ protected:
 	Node *_process_get_node(int p_from, const uint8_t *p_packet, uint32_t p_node_target, int p_packet_len);
 	void _process_rpc(Node *p_node, const uint16_t p_rpc_method_id, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_rset(Node *p_node, const uint16_t p_rpc_property_id, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
+	void _set_remote_property(Node *p_node, const StringName &p_name, const Variant &p_value);
 	void _process_raw(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replication(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replication_ack(int p_from, const uint8_t *p_packet, int p_packet_len);
 
 	void _send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount);
 	bool _send_confirm_path(Node *p_node, NodePath p_path, PathSentCache *psc, int p_target);
+	PathSentCache *_get_path_send_cache(const NodePath &p_path);
+
+	void _queue_replication(Node *p_node, int p_to, const StringName &p_property, const Variant &p_value);
+	void _quantize_replication_value(const Variant &p_value, ReplicationValue &r_value) const;
+	Variant _dequantize_replication_value(Variant::Type p_type, const int32_t *p_q) const;
+	void _send_replication(int p_peer);
+	void _send_replication_acks();
 
 	Error _encode_and_compress_variant(const Variant &p_variant, uint8_t *p_buffer, int &r_len);
 	Error _decode_and_decompress_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len);
@@ -88,6 +183,8 @@ public:
 		NETWORK_COMMAND_SIMPLIFY_PATH,
 		NETWORK_COMMAND_CONFIRM_PATH,
 		NETWORK_COMMAND_RAW,
+		NETWORK_COMMAND_REPLICATION,
+		NETWORK_COMMAND_REPLICATION_ACK,
 	};
 
 	enum NetworkNodeIdCompression {
@@ -141,6 +238,14 @@ public:
 	void set_allow_object_decoding(bool p_enable);
 	bool is_object_decoding_allowed() const;
 
+	void set_replication_batching(bool p_enable);
+	bool is_replication_batching() const;
+	void set_replication_tick_rate(int p_rate);
+	int get_replication_tick_rate() const;
+	void set_replication_quantization_step(float p_step);
+	float get_replication_quantization_step() const;
+	void flush_replication();
+
 	MultiplayerAPI();
 	~MultiplayerAPI();
 };
@@ -30,7 +30,112 @@
 
 #include "net_socket.h"
 
+#include "core/os/os.h"
+
 NetSocket *(*NetSocket::_create)() = nullptr;
+NetSocket::PollGroup *(*NetSocket::_create_poll_group)() = nullptr;
+
+// Fallback for platforms without a native implementation, checks every
+// socket with NetSocket::poll(). No faster than polling them one by one,
+// but lets callers use a single code path.
+class NetSocketGenericPollGroup : public NetSocket::PollGroup {
+	struct Entry {
+		Ref<NetSocket> sock;
+		NetSocket::PollType type = NetSocket::POLL_TYPE_IN;
+		uint64_t id = 0;
+	};
+
+	LocalVector<Entry> entries;
+
+	int _find(uint64_t p_id) const {
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			if (entries[i].id == p_id) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	void _check(LocalVector<Event> &r_events) {
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			const Entry &e = entries[i];
+			if (!e.sock->is_open()) {
+				continue;
+			}
+			Event ev;
+			ev.id = e.id;
+			if (e.type != NetSocket::POLL_TYPE_OUT) {
+				Error err = e.sock->poll(NetSocket::POLL_TYPE_IN, 0);
+				ev.readable = err == OK;
+				ev.error = err != OK && err != ERR_BUSY;
+			}
+			if (e.type != NetSocket::POLL_TYPE_IN) {
+				Error err = e.sock->poll(NetSocket::POLL_TYPE_OUT, 0);
+				ev.writable = err == OK;
+				ev.error = ev.error || (err != OK && err != ERR_BUSY);
+			}
+			if (ev.readable || ev.writable || ev.error) {
+				r_events.push_back(ev);
+			}
+		}
+	}
+
+public:
+	virtual Error add(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, uint64_t p_id) {
+		ERR_FAIL_COND_V(p_sock.is_null() || !p_sock->is_open(), ERR_INVALID_PARAMETER);
+		ERR_FAIL_COND_V(_find(p_id) != -1, ERR_ALREADY_EXISTS);
+		Entry e;
+		e.sock = p_sock;
+		e.type = p_type;
+		e.id = p_id;
+		entries.push_back(e);
+		return OK;
+	}
+
+	virtual Error modify(uint64_t p_id, NetSocket::PollType p_type) {
+		int idx = _find(p_id);
+		ERR_FAIL_COND_V(idx == -1, ERR_DOES_NOT_EXIST);
+		entries[idx].type = p_type;
+		return OK;
+	}
+
+	virtual void remove(uint64_t p_id) {
+		int idx = _find(p_id);
+		ERR_FAIL_COND(idx == -1);
+		entries[idx] = entries[entries.size() - 1];
+		entries.resize(entries.size() - 1);
+	}
+
+	virtual bool has(uint64_t p_id) const {
+		return _find(p_id) != -1;
+	}
+
+	virtual int get_socket_count() const {
+		return entries.size();
+	}
+
+	virtual Error wait(LocalVector<Event> &r_events, int p_timeout) {
+		r_events.clear();
+		uint64_t start = OS::get_singleton()->get_ticks_msec();
+		while (true) {
+			_check(r_events);
+			if (r_events.size()) {
+				return OK;
+			}
+			if (p_timeout == 0 || (p_timeout > 0 && OS::get_singleton()->get_ticks_msec() - start >= (uint64_t)p_timeout)) {
+				return ERR_BUSY;
+			}
+			OS::get_singleton()->delay_usec(1000);
+		}
+	}
+};
+
+NetSocket::PollGroup *NetSocket::create_poll_group() {
+	if (_create_poll_group) {
+		return _create_poll_group();
+	}
+	return memnew(NetSocketGenericPollGroup);
+}
 
 NetSocket *NetSocket::create() {
 	if (_create) {
@@ -32,14 +32,20 @@
 #define NET_SOCKET_H
 
 #include "core/io/ip.h"
+#include "core/local_vector.h"
 #include "core/reference.h"
 
 class NetSocket : public Reference {
+public:
+	class PollGroup;
+
 protected:
 	static NetSocket *(*_create)();
+	static PollGroup *(*_create_poll_group)();
 
 public:
 	static NetSocket *create();
+	static PollGroup *create_poll_group();
 
 	enum PollType {
 		POLL_TYPE_IN,
@@ -47,6 +53,36 @@ public:
 		POLL_TYPE_IN_OUT
 	};
 
+	/*
+	 * Waits on many sockets at once and reports only the ready ones, so
+	 * servers don't need a poll() call per connection every frame.
+	 * Sockets are registered with a user chosen id, which is what wait()
+	 * reports back. Groups must only be given sockets created by the same
+	 * platform (NetSocket::create()). Sockets closed while registered stop
+	 * reporting events, but should still be removed.
+	 */
+	class PollGroup {
+	public:
+		struct Event {
+			uint64_t id = 0;
+			bool readable = false;
+			bool writable = false;
+			bool error = false; // Hang up or socket error, the next recv/send will report it.
+		};
+
+		virtual Error add(const Ref<NetSocket> &p_sock, PollType p_type, uint64_t p_id) = 0;
+		virtual Error modify(uint64_t p_id, PollType p_type) = 0;
+		virtual void remove(uint64_t p_id) = 0;
+		virtual bool has(uint64_t p_id) const = 0;
+		virtual int get_socket_count() const = 0;
+
+		// Waits up to p_timeout msec (-1 blocks) for any socket to be ready.
+		// Returns OK and fills r_events, ERR_BUSY on timeout, FAILED on error.
+		virtual Error wait(LocalVector<Event> &r_events, int p_timeout) = 0;
+
+		virtual ~PollGroup() {}
+	};
+
 	enum Type {
 		TYPE_NONE,
 		TYPE_TCP,
@@ -32,6 +32,7 @@
 
 #include "core/image.h"
 #include "core/io/file_access_compressed.h"
+#include "core/io/file_access_memory.h"
 #include "core/io/marshalls.h"
 #include "core/os/dir_access.h"
 #include "core/project_settings.h"
@@ -743,6 +744,11 @@ Error ResourceLoaderBinary::load() {
 
 			res->set(name, value);
 		}
+
+		if (f->eof_reached()) {
+			error = ERR_FILE_CORRUPT;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Premature end of file (EOF): " + local_path + ".");
+		}
 #ifdef TOOLS_ENABLED
 		res->set_edited(false);
 #endif
@@ -839,6 +845,20 @@ void ResourceLoaderBinary::open(FileAccess *p_f) {
 		error = ERR_FILE_UNRECOGNIZED;
 		f->close();
 		ERR_FAIL_MSG("Unrecognized binary resource file: " + local_path + ".");
+
+	} else {
+		// Read straight from memory when the file (or the pack containing it) can be mapped.
+		// Besides skipping a copy for large arrays, it avoids going through stdio for every
+		// small value.
+		size_t len = f->get_len();
+		const uint8_t *data = len <= 0x7FFFFFFF ? f->map(0, len) : nullptr;
+		if (data) {
+			FileAccessMemory *fam = memnew(FileAccessMemory);
+			fam->open_custom(data, len);
+			fam->seek(4);
+			mapped_f = f;
+			f = fam;
+		}
 	}
 
 	bool big_endian = f->get_32();
@@ -960,6 +980,9 @@ ResourceLoaderBinary::~ResourceLoaderBinary() {
 	if (f) {
 		memdelete(f);
 	}
+	if (mapped_f) {
+		memdelete(mapped_f);
+	}
 }
 
 RES ResourceFormatLoaderBinary::load(const String &p_path, const String &p_original_path, Error *r_error, bool p_use_sub_threads, float *r_progress, bool p_no_cache) {
@@ -44,6 +44,7 @@ class ResourceLoaderBinary {
 	uint32_t ver_format = 0;
 
 	FileAccess *f = nullptr;
+	FileAccess *mapped_f = nullptr; // Owns the mapping f reads from, if any.
 
 	uint64_t importmd_ofs = 0;
 
@@ -209,10 +209,6 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 	ThreadLoadTask &load_task = *(ThreadLoadTask *)p_userdata;
 	load_task.loader_id = Thread::get_caller_id();
 
-	if (load_task.semaphore) {
-		//this is an actual thread, so wait for Ok fom semaphore
-		thread_load_semaphore->wait(); //wait until its ok to start loading
-	}
 	load_task.resource = _load(load_task.remapped_path, load_task.remapped_path != load_task.local_path ? load_task.local_path : String(), load_task.type_hint, false, &load_task.error, load_task.use_sub_threads, &load_task.progress);
 
 	load_task.progress = 1.0; //it was fully loaded at this point, so force progress to 1.0
@@ -224,15 +220,7 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 		load_task.status = THREAD_LOAD_LOADED;
 	}
 	if (load_task.semaphore) {
-		if (load_task.start_next && thread_waiting_count > 0) {
-			thread_waiting_count--;
-			//thread loading count remains constant, this ends but another one begins
-			thread_load_semaphore->post();
-		} else {
-			thread_loading_count--; //no threads waiting, just reduce loading count
-		}
-
-		print_lt("END: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+		print_lt("END: " + load_task.local_path + " / queued: " + itos(thread_load_queue.size()));
 
 		for (int i = 0; i < load_task.poll_requests; i++) {
 			load_task.semaphore->post();
@@ -266,6 +254,34 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 	thread_load_mutex->unlock();
 }
 
+void ResourceLoader::_thread_load_worker(void *p_userdata) {
+	while (true) {
+		thread_load_semaphore->wait();
+
+		thread_load_mutex->lock();
+		if (thread_load_exit) {
+			thread_load_mutex->unlock();
+			break;
+		}
+
+		// Tasks may have been loaded already by a thread waiting for them, skip those.
+		ThreadLoadTask *load_task = nullptr;
+		while (!load_task && thread_load_queue.size()) {
+			ThreadLoadTask *candidate = thread_load_tasks.getptr(thread_load_queue.front()->get());
+			thread_load_queue.pop_front();
+			if (candidate && !candidate->started) {
+				candidate->started = true;
+				load_task = candidate;
+			}
+		}
+		thread_load_mutex->unlock();
+
+		if (load_task) {
+			_thread_load_function(load_task);
+		}
+	}
+}
+
 Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, const String &p_source_resource) {
 	String local_path;
 	if (p_path.is_rel_path()) {
@@ -356,17 +372,17 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 	if (load_task.resource.is_null()) { //needs  to be loaded in thread
 
 		load_task.semaphore = memnew(Semaphore);
-		if (thread_loading_count < thread_load_max) {
-			thread_loading_count++;
-			thread_load_semaphore->post(); //we have free threads, so allow one
-		} else {
-			thread_waiting_count++;
+
+		if (thread_load_workers.empty()) {
+			for (int i = 0; i < thread_load_max; i++) {
+				thread_load_workers.push_back(Thread::create(_thread_load_worker, nullptr));
+			}
 		}
 
-		print_lt("REQUEST: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+		thread_load_queue.push_back(local_path);
+		thread_load_semaphore->post();
 
-		load_task.thread = Thread::create(_thread_load_function, &thread_load_tasks[local_path]);
-		load_task.loader_id = load_task.thread->get_id();
+		print_lt("REQUEST: " + local_path + " / queued: " + itos(thread_load_queue.size()));
 	}
 
 	thread_load_mutex->unlock();
@@ -374,26 +390,33 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 	return OK;
 }
 
-float ResourceLoader::_dependency_get_progress(const String &p_path) {
-	if (thread_load_tasks.has(p_path)) {
-		ThreadLoadTask &load_task = thread_load_tasks[p_path];
-		int dep_count = load_task.sub_tasks.size();
-		if (dep_count > 0) {
-			float dep_progress = 0;
-			for (Set<String>::Element *E = load_task.sub_tasks.front(); E; E = E->next()) {
-				dep_progress += _dependency_get_progress(E->get());
-			}
-			dep_progress /= float(dep_count);
-			dep_progress *= 0.5;
-			dep_progress += load_task.progress * 0.5;
-			return dep_progress;
-		} else {
-			return load_task.progress;
-		}
+// Every resource in the dependency graph weighs the same, and shared
+// dependencies are only counted once.
+int ResourceLoader::_dependency_get_progress(const String &p_path, Set<String> &r_visited, float &r_progress) {
+	if (r_visited.has(p_path)) {
+		return 0;
+	}
+	r_visited.insert(p_path);
 
-	} else {
-		return 1.0; //assume finished loading it so it no longer exists
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(p_path);
+	if (!load_task) {
+		r_progress += 1.0; //assume finished loading it so it no longer exists
+		return 1;
+	}
+
+	r_progress += load_task->progress;
+	int count = 1;
+	for (Set<String>::Element *E = load_task->sub_tasks.front(); E; E = E->next()) {
+		count += _dependency_get_progress(E->get(), r_visited, r_progress);
 	}
+	return count;
+}
+
+float ResourceLoader::_dependency_get_progress(const String &p_path) {
+	Set<String> visited;
+	float progress = 0;
+	int count = _dependency_get_progress(p_path, visited, progress);
+	return progress / count;
 }
 
 ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path, float *r_progress) {
@@ -413,7 +436,9 @@ ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const
 	ThreadLoadStatus status;
 	status = load_task.status;
 	if (r_progress) {
-		*r_progress = _dependency_get_progress(local_path);
+		// Dependencies are only known as they are found, don't let progress go back when more show up.
+		load_task.reported_progress = MAX(load_task.reported_progress, _dependency_get_progress(local_path));
+		*r_progress = load_task.reported_progress;
 	}
 
 	thread_load_mutex->unlock();
@@ -440,39 +465,29 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 
 	ThreadLoadTask &load_task = thread_load_tasks[local_path];
 
-	//semaphore still exists, meaning its still loading, request poll
+	//semaphore still exists, meaning its still loading
 	Semaphore *semaphore = load_task.semaphore;
 	if (semaphore) {
-		load_task.poll_requests++;
+		if (!load_task.started) {
+			// No worker picked it yet, so load it here rather than waiting. Since
+			// workers do the same, a full pool of workers waiting on each other
+			// can't stall the load.
+			load_task.started = true;
 
-		{
-			// As we got a semaphore, this means we are going to have to wait
-			// until the sub-resource is done loading
-			//
-			// As this thread will become 'blocked' we should "echange" its
-			// active status with a waiting one, to ensure load continues.
-			//
-			// This ensures loading is never blocked and that is also within
-			// the maximum number of active threads.
-
-			if (thread_waiting_count > 0) {
-				thread_waiting_count--;
-				thread_loading_count++;
-				thread_load_semaphore->post();
-
-				load_task.start_next = false; //do not start next since we are doing it here
-			}
+			print_lt("GET (load): " + local_path + " / queued: " + itos(thread_load_queue.size()));
 
-			thread_suspended_count++;
+			thread_load_mutex->unlock();
+			_thread_load_function(&load_task);
+			thread_load_mutex->lock();
+		} else {
+			load_task.poll_requests++;
 
-			print_lt("GET: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
-		}
+			print_lt("GET (wait): " + local_path + " / queued: " + itos(thread_load_queue.size()));
 
-		thread_load_mutex->unlock();
-		semaphore->wait();
-		thread_load_mutex->lock();
-
-		thread_suspended_count--;
+			thread_load_mutex->unlock();
+			semaphore->wait();
+			thread_load_mutex->lock();
+		}
 
 		if (!thread_load_tasks.has(local_path)) { //may have been erased during unlock and this was always an invalid call
 			thread_load_mutex->unlock();
@@ -491,10 +506,6 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 	load_task.requests--;
 
 	if (load_task.requests == 0) {
-		if (load_task.thread) { //thread may not have been used
-			Thread::wait_to_finish(load_task.thread);
-			memdelete(load_task.thread);
-		}
 		thread_load_tasks.erase(local_path);
 	}
 
@@ -570,6 +581,7 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 		load_task.remapped_path = _path_remap(local_path, &load_task.xl_remapped);
 		load_task.type_hint = p_type_hint;
 		load_task.loader_id = Thread::get_caller_id();
+		load_task.started = true;
 
 		thread_load_tasks[local_path] = load_task;
 
@@ -1102,13 +1114,25 @@ void ResourceLoader::remove_custom_loaders() {
 void ResourceLoader::initialize() {
 	thread_load_mutex = memnew(Mutex);
 	thread_load_max = OS::get_singleton()->get_processor_count();
-	thread_loading_count = 0;
-	thread_waiting_count = 0;
-	thread_suspended_count = 0;
+	thread_load_exit = false;
 	thread_load_semaphore = memnew(Semaphore);
 }
 
 void ResourceLoader::finalize() {
+	thread_load_mutex->lock();
+	thread_load_exit = true;
+	thread_load_mutex->unlock();
+
+	for (uint32_t i = 0; i < thread_load_workers.size(); i++) {
+		thread_load_semaphore->post();
+	}
+	for (uint32_t i = 0; i < thread_load_workers.size(); i++) {
+		Thread::wait_to_finish(thread_load_workers[i]);
+		memdelete(thread_load_workers[i]);
+	}
+	thread_load_workers.clear();
+	thread_load_queue.clear();
+
 	memdelete(thread_load_mutex);
 	memdelete(thread_load_semaphore);
 }
@@ -1124,11 +1148,10 @@ bool ResourceLoader::timestamp_on_load = false;
 
 Mutex *ResourceLoader::thread_load_mutex = nullptr;
 HashMap<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
+List<String> ResourceLoader::thread_load_queue;
 Semaphore *ResourceLoader::thread_load_semaphore = nullptr;
-
-int ResourceLoader::thread_loading_count = 0;
-int ResourceLoader::thread_waiting_count = 0;
-int ResourceLoader::thread_suspended_count = 0;
+LocalVector<Thread *> ResourceLoader::thread_load_workers;
+bool ResourceLoader::thread_load_exit = false;
 int ResourceLoader::thread_load_max = 0;
 
 SelfList<Resource>::List ResourceLoader::remapped_list;
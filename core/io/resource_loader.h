@@ -31,6 +31,7 @@
 #ifndef RESOURCE_LOADER_H
 #define RESOURCE_LOADER_H
 
+#include "core/local_vector.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
 #include "core/resource.h"
@@ -106,33 +107,39 @@ private:
 	static Ref<ResourceFormatLoader> _find_custom_resource_format_loader(String path);
 
 	struct ThreadLoadTask {
-		Thread *thread = nullptr;
 		Thread::ID loader_id = 0;
 		Semaphore *semaphore = nullptr;
 		String local_path;
 		String remapped_path;
 		String type_hint;
 		float progress = 0.0;
+		float reported_progress = 0.0;
 		ThreadLoadStatus status = THREAD_LOAD_IN_PROGRESS;
 		Error error = OK;
 		RES resource;
 		bool xl_remapped = false;
 		bool use_sub_threads = false;
-		bool start_next = true;
+		bool started = false;
 		int requests = 0;
 		int poll_requests = 0;
 		Set<String> sub_tasks;
 	};
 
 	static void _thread_load_function(void *p_userdata);
+	static void _thread_load_worker(void *p_userdata);
 	static Mutex *thread_load_mutex;
 	static HashMap<String, ThreadLoadTask> thread_load_tasks;
+
+	// Requested tasks are queued for a fixed set of worker threads, started on
+	// the first request. A thread waiting for a task that was not picked yet
+	// loads it itself instead of blocking.
+	static List<String> thread_load_queue;
 	static Semaphore *thread_load_semaphore;
-	static int thread_waiting_count;
-	static int thread_loading_count;
-	static int thread_suspended_count;
+	static LocalVector<Thread *> thread_load_workers;
+	static bool thread_load_exit;
 	static int thread_load_max;
 
+	static int _dependency_get_progress(const String &p_path, Set<String> &r_visited, float &r_progress);
 	static float _dependency_get_progress(const String &p_path);
 
 public:
@@ -273,6 +273,13 @@ Error StreamPeerTCP::poll(NetSocket::PollType p_type, int timeout) {
 	return _sock->poll(p_type, timeout);
 }
 
+Error StreamPeerTCP::add_to_poll_group(NetSocket::PollGroup *p_group, NetSocket::PollType p_type, uint64_t p_id) {
+	ERR_FAIL_COND_V(!p_group, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(!is_connected_to_host(), ERR_UNCONFIGURED);
+
+	return p_group->add(_sock, p_type, p_id);
+}
+
 Error StreamPeerTCP::put_data(const uint8_t *p_data, int p_bytes) {
 	int total;
 	return write(p_data, p_bytes, total, true);
@@ -79,6 +79,8 @@ public:
 
 	// Poll functions (wait or check for writable, readable)
 	Error poll(NetSocket::PollType p_type, int timeout = 0);
+	// Registers the underlying socket, so many connections can be checked with a single wait.
+	Error add_to_poll_group(NetSocket::PollGroup *p_group, NetSocket::PollType p_type, uint64_t p_id);
 
 	// Read/Write from StreamPeer
 	Error put_data(const uint8_t *p_data, int p_bytes) override;
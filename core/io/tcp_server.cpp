@@ -91,6 +91,13 @@ bool TCP_Server::is_connection_available() const {
 	return (err == OK);
 }
 
+Error TCP_Server::add_to_poll_group(NetSocket::PollGroup *p_group, uint64_t p_id) {
+	ERR_FAIL_COND_V(!p_group, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(!_sock.is_valid() || !_sock->is_open(), ERR_UNCONFIGURED);
+
+	return p_group->add(_sock, NetSocket::POLL_TYPE_IN, p_id);
+}
+
 Ref<StreamPeerTCP> TCP_Server::take_connection() {
 	Ref<StreamPeerTCP> conn;
 	if (!is_connection_available()) {
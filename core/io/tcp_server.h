@@ -53,6 +53,9 @@ public:
 	bool is_connection_available() const;
 	Ref<StreamPeerTCP> take_connection();
 
+	// Registers the listening socket, p_group then reports p_id as readable when connections are pending.
+	Error add_to_poll_group(NetSocket::PollGroup *p_group, uint64_t p_id);
+
 	void stop(); // Stop listening
 
 	TCP_Server();
@@ -32,17 +32,77 @@
 
 #include "core/math/geometry_3d.h"
 #include "core/script_language.h"
+#include "core/thread_work_pool.h"
 #include "scene/scene_string_names.h"
 
+void AStar::SolveScratch::prepare(uint32_t p_slot_count) {
+	uint32_t old_count = open_pass.size();
+	if (old_count >= p_slot_count) {
+		return;
+	}
+
+	open_pass.resize(p_slot_count);
+	closed_pass.resize(p_slot_count);
+	g_score.resize(p_slot_count);
+	f_score.resize(p_slot_count);
+	prev_point.resize(p_slot_count);
+
+	// Passes only ever increase, so zeroed stamps never match a running query.
+	for (uint32_t i = old_count; i < p_slot_count; i++) {
+		open_pass[i] = 0;
+		closed_pass[i] = 0;
+	}
+}
+
+AStar::SolveScratch *AStar::_acquire_scratch() {
+	MutexLock lock(scratch_mutex);
+
+	if (scratches.empty()) {
+		return memnew(SolveScratch);
+	}
+
+	SolveScratch *scratch = scratches[scratches.size() - 1];
+	scratches.resize(scratches.size() - 1);
+	return scratch;
+}
+
+void AStar::_release_scratch(SolveScratch *p_scratch) {
+	MutexLock lock(scratch_mutex);
+	scratches.push_back(p_scratch);
+}
+
+void AStar::_free_scratches() {
+	MutexLock lock(scratch_mutex);
+
+	for (uint32_t i = 0; i < scratches.size(); i++) {
+		memdelete(scratches[i]);
+	}
+	scratches.clear();
+}
+
+void AStar::_add_neighbour(LocalVector<uint32_t> &r_neighbours, uint32_t p_slot) {
+	if (r_neighbours.find(p_slot) < 0) {
+		r_neighbours.push_back(p_slot);
+	}
+}
+
+void AStar::_remove_neighbour(LocalVector<uint32_t> &r_neighbours, uint32_t p_slot) {
+	int64_t idx = r_neighbours.find(p_slot);
+	if (idx >= 0) {
+		r_neighbours[idx] = r_neighbours[r_neighbours.size() - 1];
+		r_neighbours.resize(r_neighbours.size() - 1);
+	}
+}
+
 int AStar::get_available_point_id() const {
-	if (points.empty()) {
+	if (point_slots.empty()) {
 		return 1;
 	}
 
 	// calculate our new next available point id if bigger than before or next id already contained in set of points.
-	if (points.has(last_free_id)) {
+	if (point_slots.has(last_free_id)) {
 		int cur_new_id = last_free_id;
-		while (points.has(cur_new_id)) {
+		while (point_slots.has(cur_new_id)) {
 			cur_new_id++;
 		}
 		int &non_const = const_cast<int &>(last_free_id);
@@ -56,19 +116,24 @@ void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
 	ERR_FAIL_COND(p_id < 0);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	Point *found_pt;
-	bool p_exists = points.lookup(p_id, found_pt);
-
-	if (!p_exists) {
-		Point *pt = memnew(Point);
-		pt->id = p_id;
-		pt->pos = p_pos;
-		pt->weight_scale = p_weight_scale;
-		pt->prev_point = nullptr;
-		pt->open_pass = 0;
-		pt->closed_pass = 0;
-		pt->enabled = true;
-		points.set(p_id, pt);
+	Point *found_pt = _get_point(p_id);
+
+	if (!found_pt) {
+		uint32_t slot;
+		if (free_slots.size()) {
+			slot = free_slots[free_slots.size() - 1];
+			free_slots.resize(free_slots.size() - 1);
+		} else {
+			slot = points.size();
+			points.resize(slot + 1);
+		}
+
+		Point &pt = points[slot];
+		pt.id = p_id;
+		pt.pos = p_pos;
+		pt.weight_scale = p_weight_scale;
+		pt.enabled = true;
+		point_slots.set(p_id, slot);
 	} else {
 		found_pt->pos = p_pos;
 		found_pt->weight_scale = p_weight_scale;
@@ -76,81 +141,86 @@ void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
 }
 
 Vector3 AStar::get_point_position(int p_id) const {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND_V(!p_exists, Vector3());
+	const Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, Vector3());
 
 	return p->pos;
 }
 
 void AStar::set_point_position(int p_id, const Vector3 &p_pos) {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND(!p_exists);
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND(!p);
 
 	p->pos = p_pos;
 }
 
 real_t AStar::get_point_weight_scale(int p_id) const {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND_V(!p_exists, 0);
+	const Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, 0);
 
 	return p->weight_scale;
 }
 
 void AStar::set_point_weight_scale(int p_id, real_t p_weight_scale) {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND(!p_exists);
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND(!p);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
 	p->weight_scale = p_weight_scale;
 }
 
 void AStar::remove_point(int p_id) {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
+	uint32_t slot;
+	bool p_exists = point_slots.lookup(p_id, slot);
 	ERR_FAIL_COND(!p_exists);
 
-	for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
-		Segment s(p_id, (*it.key));
+	Point &p = points[slot];
+
+	for (uint32_t i = 0; i < p.neighbours.size(); i++) {
+		Point &n = points[p.neighbours[i]];
+		Segment s(p_id, n.id);
 		segments.erase(s);
 
-		(*it.value)->neighbours.remove(p->id);
-		(*it.value)->unlinked_neighbours.remove(p->id);
+		_remove_neighbour(n.neighbours, slot);
+		_remove_neighbour(n.unlinked_neighbours, slot);
 	}
 
-	for (OAHashMap<int, Point *>::Iterator it = p->unlinked_neighbours.iter(); it.valid; it = p->unlinked_neighbours.next_iter(it)) {
-		Segment s(p_id, (*it.key));
+	for (uint32_t i = 0; i < p.unlinked_neighbours.size(); i++) {
+		Point &n = points[p.unlinked_neighbours[i]];
+		Segment s(p_id, n.id);
 		segments.erase(s);
 
-		(*it.value)->neighbours.remove(p->id);
-		(*it.value)->unlinked_neighbours.remove(p->id);
+		_remove_neighbour(n.neighbours, slot);
+		_remove_neighbour(n.unlinked_neighbours, slot);
 	}
 
-	memdelete(p);
-	points.remove(p_id);
+	p.id = -1;
+	p.enabled = false;
+	p.neighbours.clear();
+	p.unlinked_neighbours.clear();
+	free_slots.push_back(slot);
+
+	point_slots.remove(p_id);
 	last_free_id = p_id;
 }
 
 void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 	ERR_FAIL_COND(p_id == p_with_id);
 
-	Point *a;
-	bool from_exists = points.lookup(p_id, a);
+	uint32_t a;
+	bool from_exists = point_slots.lookup(p_id, a);
 	ERR_FAIL_COND(!from_exists);
 
-	Point *b;
-	bool to_exists = points.lookup(p_with_id, b);
+	uint32_t b;
+	bool to_exists = point_slots.lookup(p_with_id, b);
 	ERR_FAIL_COND(!to_exists);
 
-	a->neighbours.set(b->id, b);
+	_add_neighbour(points[a].neighbours, b);
 
 	if (bidirectional) {
-		b->neighbours.set(a->id, a);
+		_add_neighbour(points[b].neighbours, a);
 	} else {
-		b->unlinked_neighbours.set(a->id, a);
+		_add_neighbour(points[b].unlinked_neighbours, a);
 	}
 
 	Segment s(p_id, p_with_id);
@@ -163,8 +233,8 @@ void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 		s.direction |= element->get().direction;
 		if (s.direction == Segment::BIDIRECTIONAL) {
 			// Both are neighbours of each other now
-			a->unlinked_neighbours.remove(b->id);
-			b->unlinked_neighbours.remove(a->id);
+			_remove_neighbour(points[a].unlinked_neighbours, b);
+			_remove_neighbour(points[b].unlinked_neighbours, a);
 		}
 		segments.erase(element);
 	}
@@ -173,12 +243,12 @@ void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 }
 
 void AStar::disconnect_points(int p_id, int p_with_id, bool bidirectional) {
-	Point *a;
-	bool a_exists = points.lookup(p_id, a);
+	uint32_t a;
+	bool a_exists = point_slots.lookup(p_id, a);
 	ERR_FAIL_COND(!a_exists);
 
-	Point *b;
-	bool b_exists = points.lookup(p_with_id, b);
+	uint32_t b;
+	bool b_exists = point_slots.lookup(p_with_id, b);
 	ERR_FAIL_COND(!b_exists);
 
 	Segment s(p_id, p_with_id);
@@ -190,18 +260,18 @@ void AStar::disconnect_points(int p_id, int p_with_id, bool bidirectional) {
 		// Erase the directions to be removed
 		s.direction = (element->get().direction & ~remove_direction);
 
-		a->neighbours.remove(b->id);
+		_remove_neighbour(points[a].neighbours, b);
 		if (bidirectional) {
-			b->neighbours.remove(a->id);
+			_remove_neighbour(points[b].neighbours, a);
 			if (element->get().direction != Segment::BIDIRECTIONAL) {
-				a->unlinked_neighbours.remove(b->id);
-				b->unlinked_neighbours.remove(a->id);
+				_remove_neighbour(points[a].unlinked_neighbours, b);
+				_remove_neighbour(points[b].unlinked_neighbours, a);
 			}
 		} else {
 			if (s.direction == Segment::NONE) {
-				b->unlinked_neighbours.remove(a->id);
+				_remove_neighbour(points[b].unlinked_neighbours, a);
 			} else {
-				a->unlinked_neighbours.set(b->id, b);
+				_add_neighbour(points[a].unlinked_neighbours, b);
 			}
 		}
 
@@ -213,13 +283,13 @@ void AStar::disconnect_points(int p_id, int p_with_id, bool bidirectional) {
 }
 
 bool AStar::has_point(int p_id) const {
-	return points.has(p_id);
+	return point_slots.has(p_id);
 }
 
 Array AStar::get_points() {
 	Array point_list;
 
-	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
+	for (OAHashMap<int, uint32_t>::Iterator it = point_slots.iter(); it.valid; it = point_slots.next_iter(it)) {
 		point_list.push_back(*(it.key));
 	}
 
@@ -227,14 +297,13 @@ Array AStar::get_points() {
 }
 
 Vector<int> AStar::get_point_connections(int p_id) {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND_V(!p_exists, Vector<int>());
+	const Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, Vector<int>());
 
 	Vector<int> point_list;
 
-	for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
-		point_list.push_back((*it.key));
+	for (uint32_t i = 0; i < p->neighbours.size(); i++) {
+		point_list.push_back(points[p->neighbours[i]].id);
 	}
 
 	return point_list;
@@ -250,24 +319,25 @@ bool AStar::are_points_connected(int p_id, int p_with_id, bool bidirectional) co
 
 void AStar::clear() {
 	last_free_id = 0;
-	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
-		memdelete(*(it.value));
-	}
 	segments.clear();
 	points.clear();
+	free_slots.clear();
+	point_slots.clear();
+	_free_scratches();
 }
 
 int AStar::get_point_count() const {
-	return points.get_num_elements();
+	return point_slots.get_num_elements();
 }
 
 int AStar::get_point_capacity() const {
-	return points.get_capacity();
+	return point_slots.get_capacity();
 }
 
 void AStar::reserve_space(int p_num_nodes) {
 	ERR_FAIL_COND_MSG(p_num_nodes <= 0, "New capacity must be greater than 0, was: " + itos(p_num_nodes) + ".");
-	ERR_FAIL_COND_MSG((uint32_t)p_num_nodes < points.get_capacity(), "New capacity must be greater than current capacity: " + itos(points.get_capacity()) + ", new was: " + itos(p_num_nodes) + ".");
+	ERR_FAIL_COND_MSG((uint32_t)p_num_nodes < point_slots.get_capacity(), "New capacity must be greater than current capacity: " + itos(point_slots.get_capacity()) + ", new was: " + itos(p_num_nodes) + ".");
+	point_slots.reserve(p_num_nodes);
 	points.reserve(p_num_nodes);
 }
 
@@ -275,21 +345,24 @@ int AStar::get_closest_point(const Vector3 &p_point, bool p_include_disabled) co
 	int closest_id = -1;
 	real_t closest_dist = 1e20;
 
-	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
-		if (!p_include_disabled && !(*it.value)->enabled) {
+	for (uint32_t i = 0; i < points.size(); i++) {
+		const Point &p = points[i];
+		if (p.id < 0) {
+			continue; // Free slot.
+		}
+		if (!p_include_disabled && !p.enabled) {
 			continue; // Disabled points should not be considered.
 		}
 
 		// Keep the closest point's ID, and in case of multiple closest IDs,
 		// the smallest one (makes it deterministic).
-		real_t d = p_point.distance_squared_to((*it.value)->pos);
-		int id = *(it.key);
+		real_t d = p_point.distance_squared_to(p.pos);
 		if (d <= closest_dist) {
-			if (d == closest_dist && id > closest_id) { // Keep lowest ID.
+			if (d == closest_dist && p.id > closest_id) { // Keep lowest ID.
 				continue;
 			}
 			closest_dist = d;
-			closest_id = id;
+			closest_id = p.id;
 		}
 	}
 
@@ -301,9 +374,8 @@ Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
 	Vector3 closest_point;
 
 	for (const Set<Segment>::Element *E = segments.front(); E; E = E->next()) {
-		Point *from_point = nullptr, *to_point = nullptr;
-		points.lookup(E->get().u, from_point);
-		points.lookup(E->get().v, to_point);
+		const Point *from_point = _get_point(E->get().u);
+		const Point *to_point = _get_point(E->get().v);
 
 		if (!(from_point->enabled && to_point->enabled)) {
 			continue;
@@ -325,61 +397,77 @@ Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
 	return closest_point;
 }
 
-bool AStar::_solve(Point *begin_point, Point *end_point) {
-	pass++;
+template <class C>
+bool AStar::_solve(C *p_costs, uint32_t p_begin, uint32_t p_end, SolveScratch &r_scratch) {
+	const Point *pts = points.ptr();
 
-	if (!end_point->enabled) {
+	if (!pts[p_end].enabled) {
 		return false;
 	}
 
+	r_scratch.prepare(points.size());
+	uint64_t pass = ++r_scratch.pass;
+
+	uint64_t *open_pass = r_scratch.open_pass.ptr();
+	uint64_t *closed_pass = r_scratch.closed_pass.ptr();
+	real_t *g_score = r_scratch.g_score.ptr();
+	real_t *f_score = r_scratch.f_score.ptr();
+	uint32_t *prev_point = r_scratch.prev_point.ptr();
+
 	bool found_route = false;
 
-	Vector<Point *> open_list;
-	SortArray<Point *, SortPoints> sorter;
+	LocalVector<uint32_t> &open_list = r_scratch.open_list;
+	open_list.clear();
+	SortArray<uint32_t, SortPoints> sorter;
+	sorter.compare.scratch = &r_scratch;
 
-	begin_point->g_score = 0;
-	begin_point->f_score = _estimate_cost(begin_point->id, end_point->id);
-	open_list.push_back(begin_point);
+	int end_id = pts[p_end].id;
+
+	g_score[p_begin] = 0;
+	f_score[p_begin] = p_costs->_estimate_cost(pts[p_begin].id, end_id);
+	open_list.push_back(p_begin);
 
 	while (!open_list.empty()) {
-		Point *p = open_list[0]; // The currently processed point
+		uint32_t p = open_list[0]; // The currently processed point
 
-		if (p == end_point) {
+		if (p == p_end) {
 			found_route = true;
 			break;
 		}
 
-		sorter.pop_heap(0, open_list.size(), open_list.ptrw()); // Remove the current point from the open list
-		open_list.remove(open_list.size() - 1);
-		p->closed_pass = pass; // Mark the point as closed
+		sorter.pop_heap(0, open_list.size(), open_list.ptr()); // Remove the current point from the open list
+		open_list.resize(open_list.size() - 1);
+		closed_pass[p] = pass; // Mark the point as closed
 
-		for (OAHashMap<int, Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
-			Point *e = *(it.value); // The neighbour point
+		const Point &point = pts[p];
+		for (uint32_t i = 0; i < point.neighbours.size(); i++) {
+			uint32_t e = point.neighbours[i]; // The neighbour point
+			const Point &neighbour = pts[e];
 
-			if (!e->enabled || e->closed_pass == pass) {
+			if (!neighbour.enabled || closed_pass[e] == pass) {
 				continue;
 			}
 
-			real_t tentative_g_score = p->g_score + _compute_cost(p->id, e->id) * e->weight_scale;
+			real_t tentative_g_score = g_score[p] + p_costs->_compute_cost(point.id, neighbour.id) * neighbour.weight_scale;
 
 			bool new_point = false;
 
-			if (e->open_pass != pass) { // The point wasn't inside the open list.
-				e->open_pass = pass;
+			if (open_pass[e] != pass) { // The point wasn't inside the open list.
+				open_pass[e] = pass;
 				open_list.push_back(e);
 				new_point = true;
-			} else if (tentative_g_score >= e->g_score) { // The new path is worse than the previous.
+			} else if (tentative_g_score >= g_score[e]) { // The new path is worse than the previous.
 				continue;
 			}
 
-			e->prev_point = p;
-			e->g_score = tentative_g_score;
-			e->f_score = e->g_score + _estimate_cost(e->id, end_point->id);
+			prev_point[e] = p;
+			g_score[e] = tentative_g_score;
+			f_score[e] = tentative_g_score + p_costs->_estimate_cost(neighbour.id, end_id);
 
 			if (new_point) { // The position of the new points is already known.
-				sorter.push_heap(0, open_list.size() - 1, 0, e, open_list.ptrw());
+				sorter.push_heap(0, open_list.size() - 1, 0, e, open_list.ptr());
 			} else {
-				sorter.push_heap(0, open_list.find(e), 0, e, open_list.ptrw());
+				sorter.push_heap(0, open_list.find(e), 0, e, open_list.ptr());
 			}
 		}
 	}
@@ -387,18 +475,69 @@ bool AStar::_solve(Point *begin_point, Point *end_point) {
 	return found_route;
 }
 
+template <class C>
+bool AStar::_find_path(C *p_costs, int p_from_id, int p_to_id, LocalVector<uint32_t> &r_slots) {
+	r_slots.clear();
+
+	uint32_t begin_point;
+	bool from_exists = point_slots.lookup(p_from_id, begin_point);
+	ERR_FAIL_COND_V(!from_exists, false);
+
+	uint32_t end_point;
+	bool to_exists = point_slots.lookup(p_to_id, end_point);
+	ERR_FAIL_COND_V(!to_exists, false);
+
+	if (begin_point == end_point) {
+		r_slots.push_back(begin_point);
+		return true;
+	}
+
+	// A cost method may run a query of its own, that one borrows another scratch.
+	SolveScratch *scratch = _acquire_scratch();
+
+	bool found_route = _solve(p_costs, begin_point, end_point, *scratch);
+	if (found_route) {
+		const uint32_t *prev_point = scratch->prev_point.ptr();
+
+		uint32_t p = end_point;
+		uint32_t pc = 1; // Begin point
+		while (p != begin_point) {
+			pc++;
+			p = prev_point[p];
+		}
+
+		r_slots.resize(pc);
+
+		p = end_point;
+		uint32_t idx = pc - 1;
+		while (p != begin_point) {
+			r_slots[idx--] = p;
+			p = prev_point[p];
+		}
+
+		r_slots[0] = p; // Assign first
+	}
+
+	_release_scratch(scratch);
+
+	return found_route;
+}
+
+bool AStar::_has_script_costs() const {
+	ScriptInstance *si = get_script_instance();
+	return si && (si->has_method(SceneStringNames::get_singleton()->_estimate_cost) || si->has_method(SceneStringNames::get_singleton()->_compute_cost));
+}
+
 real_t AStar::_estimate_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_estimate_cost)) {
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_estimate_cost, p_from_id, p_to_id);
 	}
 
-	Point *from_point;
-	bool from_exists = points.lookup(p_from_id, from_point);
-	ERR_FAIL_COND_V(!from_exists, 0);
+	const Point *from_point = _get_point(p_from_id);
+	ERR_FAIL_COND_V(!from_point, 0);
 
-	Point *to_point;
-	bool to_exists = points.lookup(p_to_id, to_point);
-	ERR_FAIL_COND_V(!to_exists, 0);
+	const Point *to_point = _get_point(p_to_id);
+	ERR_FAIL_COND_V(!to_point, 0);
 
 	return from_point->pos.distance_to(to_point->pos);
 }
@@ -408,127 +547,94 @@ real_t AStar::_compute_cost(int p_from_id, int p_to_id) {
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_compute_cost, p_from_id, p_to_id);
 	}
 
-	Point *from_point;
-	bool from_exists = points.lookup(p_from_id, from_point);
-	ERR_FAIL_COND_V(!from_exists, 0);
+	const Point *from_point = _get_point(p_from_id);
+	ERR_FAIL_COND_V(!from_point, 0);
 
-	Point *to_point;
-	bool to_exists = points.lookup(p_to_id, to_point);
-	ERR_FAIL_COND_V(!to_exists, 0);
+	const Point *to_point = _get_point(p_to_id);
+	ERR_FAIL_COND_V(!to_point, 0);
 
 	return from_point->pos.distance_to(to_point->pos);
 }
 
 Vector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
-	Point *a;
-	bool from_exists = points.lookup(p_from_id, a);
-	ERR_FAIL_COND_V(!from_exists, Vector<Vector3>());
-
-	Point *b;
-	bool to_exists = points.lookup(p_to_id, b);
-	ERR_FAIL_COND_V(!to_exists, Vector<Vector3>());
-
-	if (a == b) {
-		Vector<Vector3> ret;
-		ret.push_back(a->pos);
-		return ret;
-	}
-
-	Point *begin_point = a;
-	Point *end_point = b;
-
-	bool found_route = _solve(begin_point, end_point);
-	if (!found_route) {
+	LocalVector<uint32_t> slots;
+	if (!_find_path(this, p_from_id, p_to_id, slots)) {
 		return Vector<Vector3>();
 	}
 
-	Point *p = end_point;
-	int pc = 1; // Begin point
-	while (p != begin_point) {
-		pc++;
-		p = p->prev_point;
-	}
-
 	Vector<Vector3> path;
-	path.resize(pc);
+	path.resize(slots.size());
 
-	{
-		Vector3 *w = path.ptrw();
-
-		Point *p2 = end_point;
-		int idx = pc - 1;
-		while (p2 != begin_point) {
-			w[idx--] = p2->pos;
-			p2 = p2->prev_point;
-		}
-
-		w[0] = p2->pos; // Assign first
+	Vector3 *w = path.ptrw();
+	for (uint32_t i = 0; i < slots.size(); i++) {
+		w[i] = points[slots[i]].pos;
 	}
 
 	return path;
 }
 
 Vector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
-	Point *a;
-	bool from_exists = points.lookup(p_from_id, a);
-	ERR_FAIL_COND_V(!from_exists, Vector<int>());
+	LocalVector<uint32_t> slots;
+	if (!_find_path(this, p_from_id, p_to_id, slots)) {
+		return Vector<int>();
+	}
 
-	Point *b;
-	bool to_exists = points.lookup(p_to_id, b);
-	ERR_FAIL_COND_V(!to_exists, Vector<int>());
+	Vector<int> path;
+	path.resize(slots.size());
 
-	if (a == b) {
-		Vector<int> ret;
-		ret.push_back(a->id);
-		return ret;
+	int *w = path.ptrw();
+	for (uint32_t i = 0; i < slots.size(); i++) {
+		w[i] = points[slots[i]].id;
 	}
 
-	Point *begin_point = a;
-	Point *end_point = b;
+	return path;
+}
 
-	bool found_route = _solve(begin_point, end_point);
-	if (!found_route) {
-		return Vector<int>();
-	}
+void AStar::_id_path_batch_item(uint32_t p_index, IdPathBatch *p_batch) {
+	p_batch->paths[p_index] = get_id_path(p_batch->from_ids[p_index], p_batch->to_ids[p_index]);
+}
 
-	Point *p = end_point;
-	int pc = 1; // Begin point
-	while (p != begin_point) {
-		pc++;
-		p = p->prev_point;
-	}
+Array AStar::get_id_paths_batch(const Vector<int> &p_from_ids, const Vector<int> &p_to_ids) {
+	ERR_FAIL_COND_V_MSG(p_from_ids.size() != p_to_ids.size(), Array(), "The arrays of start and end point IDs must have the same size.");
 
-	Vector<int> path;
-	path.resize(pc);
+	uint32_t count = p_from_ids.size();
+	LocalVector<Vector<int>> paths;
+	paths.resize(count);
 
-	{
-		int *w = path.ptrw();
+	IdPathBatch batch;
+	batch.from_ids = p_from_ids.ptr();
+	batch.to_ids = p_to_ids.ptr();
+	batch.paths = paths.ptr();
 
-		p = end_point;
-		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->id;
-			p = p->prev_point;
+	// Scripted costs can't be called from several threads at once.
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (pool && count > 1 && !_has_script_costs()) {
+		pool->do_work(count, this, &AStar::_id_path_batch_item, &batch, 0);
+	} else {
+		for (uint32_t i = 0; i < count; i++) {
+			_id_path_batch_item(i, &batch);
 		}
+	}
 
-		w[0] = p->id; // Assign first
+	Array ret;
+	ret.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		ret[i] = paths[i];
 	}
 
-	return path;
+	return ret;
 }
 
 void AStar::set_point_disabled(int p_id, bool p_disabled) {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND(!p_exists);
+	Point *p = _get_point(p_id);
+	ERR_FAIL_COND(!p);
 
 	p->enabled = !p_disabled;
 }
 
 bool AStar::is_point_disabled(int p_id) const {
-	Point *p;
-	bool p_exists = points.lookup(p_id, p);
-	ERR_FAIL_COND_V(!p_exists, false);
+	const Point *p = _get_point(p_id);
+	ERR_FAIL_COND_V(!p, false);
 
 	return !p->enabled;
 }
@@ -562,6 +668,7 @@ void AStar::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_point_path", "from_id", "to_id"), &AStar::get_point_path);
 	ClassDB::bind_method(D_METHOD("get_id_path", "from_id", "to_id"), &AStar::get_id_path);
+	ClassDB::bind_method(D_METHOD("get_id_paths_batch", "from_ids", "to_ids"), &AStar::get_id_paths_batch);
 
 	BIND_VMETHOD(MethodInfo(Variant::FLOAT, "_estimate_cost", PropertyInfo(Variant::INT, "from_id"), PropertyInfo(Variant::INT, "to_id")));
 	BIND_VMETHOD(MethodInfo(Variant::FLOAT, "_compute_cost", PropertyInfo(Variant::INT, "from_id"), PropertyInfo(Variant::INT, "to_id")));
@@ -659,18 +766,21 @@ Vector2 AStar2D::get_closest_position_in_segment(const Vector2 &p_point) const {
 	return Vector2(p.x, p.y);
 }
 
+bool AStar2D::_has_script_costs() const {
+	ScriptInstance *si = get_script_instance();
+	return si && (si->has_method(SceneStringNames::get_singleton()->_estimate_cost) || si->has_method(SceneStringNames::get_singleton()->_compute_cost));
+}
+
 real_t AStar2D::_estimate_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_estimate_cost)) {
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_estimate_cost, p_from_id, p_to_id);
 	}
 
-	AStar::Point *from_point;
-	bool from_exists = astar.points.lookup(p_from_id, from_point);
-	ERR_FAIL_COND_V(!from_exists, 0);
+	const AStar::Point *from_point = astar._get_point(p_from_id);
+	ERR_FAIL_COND_V(!from_point, 0);
 
-	AStar::Point *to_point;
-	bool to_exists = astar.points.lookup(p_to_id, to_point);
-	ERR_FAIL_COND_V(!to_exists, 0);
+	const AStar::Point *to_point = astar._get_point(p_to_id);
+	ERR_FAIL_COND_V(!to_point, 0);
 
 	return from_point->pos.distance_to(to_point->pos);
 }
@@ -680,175 +790,83 @@ real_t AStar2D::_compute_cost(int p_from_id, int p_to_id) {
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_compute_cost, p_from_id, p_to_id);
 	}
 
-	AStar::Point *from_point;
-	bool from_exists = astar.points.lookup(p_from_id, from_point);
-	ERR_FAIL_COND_V(!from_exists, 0);
+	const AStar::Point *from_point = astar._get_point(p_from_id);
+	ERR_FAIL_COND_V(!from_point, 0);
 
-	AStar::Point *to_point;
-	bool to_exists = astar.points.lookup(p_to_id, to_point);
-	ERR_FAIL_COND_V(!to_exists, 0);
+	const AStar::Point *to_point = astar._get_point(p_to_id);
+	ERR_FAIL_COND_V(!to_point, 0);
 
 	return from_point->pos.distance_to(to_point->pos);
 }
 
 Vector<Vector2> AStar2D::get_point_path(int p_from_id, int p_to_id) {
-	AStar::Point *a;
-	bool from_exists = astar.points.lookup(p_from_id, a);
-	ERR_FAIL_COND_V(!from_exists, Vector<Vector2>());
-
-	AStar::Point *b;
-	bool to_exists = astar.points.lookup(p_to_id, b);
-	ERR_FAIL_COND_V(!to_exists, Vector<Vector2>());
-
-	if (a == b) {
-		Vector<Vector2> ret;
-		ret.push_back(Vector2(a->pos.x, a->pos.y));
-		return ret;
-	}
-
-	AStar::Point *begin_point = a;
-	AStar::Point *end_point = b;
-
-	bool found_route = _solve(begin_point, end_point);
-	if (!found_route) {
+	LocalVector<uint32_t> slots;
+	if (!astar._find_path(this, p_from_id, p_to_id, slots)) {
 		return Vector<Vector2>();
 	}
 
-	AStar::Point *p = end_point;
-	int pc = 1; // Begin point
-	while (p != begin_point) {
-		pc++;
-		p = p->prev_point;
-	}
-
 	Vector<Vector2> path;
-	path.resize(pc);
-
-	{
-		Vector2 *w = path.ptrw();
-
-		AStar::Point *p2 = end_point;
-		int idx = pc - 1;
-		while (p2 != begin_point) {
-			w[idx--] = Vector2(p2->pos.x, p2->pos.y);
-			p2 = p2->prev_point;
-		}
+	path.resize(slots.size());
 
-		w[0] = Vector2(p2->pos.x, p2->pos.y); // Assign first
+	Vector2 *w = path.ptrw();
+	for (uint32_t i = 0; i < slots.size(); i++) {
+		const Vector3 &pos = astar.points[slots[i]].pos;
+		w[i] = Vector2(pos.x, pos.y);
 	}
 
 	return path;
 }
 
 Vector<int> AStar2D::get_id_path(int p_from_id, int p_to_id) {
-	AStar::Point *a;
-	bool from_exists = astar.points.lookup(p_from_id, a);
-	ERR_FAIL_COND_V(!from_exists, Vector<int>());
-
-	AStar::Point *b;
-	bool to_exists = astar.points.lookup(p_to_id, b);
-	ERR_FAIL_COND_V(!to_exists, Vector<int>());
-
-	if (a == b) {
-		Vector<int> ret;
-		ret.push_back(a->id);
-		return ret;
-	}
-
-	AStar::Point *begin_point = a;
-	AStar::Point *end_point = b;
-
-	bool found_route = _solve(begin_point, end_point);
-	if (!found_route) {
+	LocalVector<uint32_t> slots;
+	if (!astar._find_path(this, p_from_id, p_to_id, slots)) {
 		return Vector<int>();
 	}
 
-	AStar::Point *p = end_point;
-	int pc = 1; // Begin point
-	while (p != begin_point) {
-		pc++;
-		p = p->prev_point;
-	}
-
 	Vector<int> path;
-	path.resize(pc);
-
-	{
-		int *w = path.ptrw();
+	path.resize(slots.size());
 
-		p = end_point;
-		int idx = pc - 1;
-		while (p != begin_point) {
-			w[idx--] = p->id;
-			p = p->prev_point;
-		}
-
-		w[0] = p->id; // Assign first
+	int *w = path.ptrw();
+	for (uint32_t i = 0; i < slots.size(); i++) {
+		w[i] = astar.points[slots[i]].id;
 	}
 
 	return path;
 }
 
-bool AStar2D::_solve(AStar::Point *begin_point, AStar::Point *end_point) {
-	astar.pass++;
-
-	if (!end_point->enabled) {
-		return false;
-	}
-
-	bool found_route = false;
+void AStar2D::_id_path_batch_item(uint32_t p_index, AStar::IdPathBatch *p_batch) {
+	p_batch->paths[p_index] = get_id_path(p_batch->from_ids[p_index], p_batch->to_ids[p_index]);
+}
 
-	Vector<AStar::Point *> open_list;
-	SortArray<AStar::Point *, AStar::SortPoints> sorter;
+Array AStar2D::get_id_paths_batch(const Vector<int> &p_from_ids, const Vector<int> &p_to_ids) {
+	ERR_FAIL_COND_V_MSG(p_from_ids.size() != p_to_ids.size(), Array(), "The arrays of start and end point IDs must have the same size.");
 
-	begin_point->g_score = 0;
-	begin_point->f_score = _estimate_cost(begin_point->id, end_point->id);
-	open_list.push_back(begin_point);
+	uint32_t count = p_from_ids.size();
+	LocalVector<Vector<int>> paths;
+	paths.resize(count);
 
-	while (!open_list.empty()) {
-		AStar::Point *p = open_list[0]; // The currently processed point
+	AStar::IdPathBatch batch;
+	batch.from_ids = p_from_ids.ptr();
+	batch.to_ids = p_to_ids.ptr();
+	batch.paths = paths.ptr();
 
-		if (p == end_point) {
-			found_route = true;
-			break;
+	// Scripted costs can't be called from several threads at once.
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (pool && count > 1 && !_has_script_costs()) {
+		pool->do_work(count, this, &AStar2D::_id_path_batch_item, &batch, 0);
+	} else {
+		for (uint32_t i = 0; i < count; i++) {
+			_id_path_batch_item(i, &batch);
 		}
+	}
 
-		sorter.pop_heap(0, open_list.size(), open_list.ptrw()); // Remove the current point from the open list
-		open_list.remove(open_list.size() - 1);
-		p->closed_pass = astar.pass; // Mark the point as closed
-
-		for (OAHashMap<int, AStar::Point *>::Iterator it = p->neighbours.iter(); it.valid; it = p->neighbours.next_iter(it)) {
-			AStar::Point *e = *(it.value); // The neighbour point
-
-			if (!e->enabled || e->closed_pass == astar.pass) {
-				continue;
-			}
-
-			real_t tentative_g_score = p->g_score + _compute_cost(p->id, e->id) * e->weight_scale;
-
-			bool new_point = false;
-
-			if (e->open_pass != astar.pass) { // The point wasn't inside the open list.
-				e->open_pass = astar.pass;
-				open_list.push_back(e);
-				new_point = true;
-			} else if (tentative_g_score >= e->g_score) { // The new path is worse than the previous.
-				continue;
-			}
-
-			e->prev_point = p;
-			e->g_score = tentative_g_score;
-			e->f_score = e->g_score + _estimate_cost(e->id, end_point->id);
-
-			if (new_point) { // The position of the new points is already known.
-				sorter.push_heap(0, open_list.size() - 1, 0, e, open_list.ptrw());
-			} else {
-				sorter.push_heap(0, open_list.find(e), 0, e, open_list.ptrw());
-			}
-		}
+	Array ret;
+	ret.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		ret[i] = paths[i];
 	}
 
-	return found_route;
+	return ret;
 }
 
 void AStar2D::_bind_methods() {
@@ -880,6 +898,7 @@ void AStar2D::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_point_path", "from_id", "to_id"), &AStar2D::get_point_path);
 	ClassDB::bind_method(D_METHOD("get_id_path", "from_id", "to_id"), &AStar2D::get_id_path);
+	ClassDB::bind_method(D_METHOD("get_id_paths_batch", "from_ids", "to_ids"), &AStar2D::get_id_paths_batch);
 
 	BIND_VMETHOD(MethodInfo(Variant::FLOAT, "_estimate_cost", PropertyInfo(Variant::INT, "from_id"), PropertyInfo(Variant::INT, "to_id")));
 	BIND_VMETHOD(MethodInfo(Variant::FLOAT, "_compute_cost", PropertyInfo(Variant::INT, "from_id"), PropertyInfo(Variant::INT, "to_id")));
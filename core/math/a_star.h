@@ -31,7 +31,9 @@
 #ifndef A_STAR_H
 #define A_STAR_H
 
+#include "core/local_vector.h"
 #include "core/oa_hash_map.h"
+#include "core/os/mutex.h"
 #include "core/reference.h"
 
 /**
@@ -44,33 +46,45 @@ class AStar : public Reference {
 	GDCLASS(AStar, Reference);
 	friend class AStar2D;
 
+	// Points live in a flat array and refer to each other by slot. Removed
+	// points leave a free slot behind, reused by the next added point.
 	struct Point {
-		Point() {}
-
-		int id;
+		int id = -1; // -1 while the slot is free.
 		Vector3 pos;
-		real_t weight_scale;
-		bool enabled;
-
-		OAHashMap<int, Point *> neighbours = 4u;
-		OAHashMap<int, Point *> unlinked_neighbours = 4u;
-
-		// Used for pathfinding.
-		Point *prev_point;
-		real_t g_score;
-		real_t f_score;
-		uint64_t open_pass;
-		uint64_t closed_pass;
+		real_t weight_scale = 1;
+		bool enabled = false;
+
+		LocalVector<uint32_t> neighbours;
+		LocalVector<uint32_t> unlinked_neighbours;
+	};
+
+	// Search state of a single query, indexed by point slot. Each running
+	// query borrows one from the graph, so queries never write to the shared
+	// points and can run at the same time as long as the graph itself is not
+	// being modified.
+	struct SolveScratch {
+		uint64_t pass = 1;
+
+		LocalVector<uint64_t> open_pass;
+		LocalVector<uint64_t> closed_pass;
+		LocalVector<real_t> g_score;
+		LocalVector<real_t> f_score;
+		LocalVector<uint32_t> prev_point;
+		LocalVector<uint32_t> open_list;
+
+		void prepare(uint32_t p_slot_count);
 	};
 
 	struct SortPoints {
-		_FORCE_INLINE_ bool operator()(const Point *A, const Point *B) const { // Returns true when the Point A is worse than Point B.
-			if (A->f_score > B->f_score) {
+		const SolveScratch *scratch = nullptr;
+
+		_FORCE_INLINE_ bool operator()(uint32_t A, uint32_t B) const { // Returns true when the Point A is worse than Point B.
+			if (scratch->f_score[A] > scratch->f_score[B]) {
 				return true;
-			} else if (A->f_score < B->f_score) {
+			} else if (scratch->f_score[A] < scratch->f_score[B]) {
 				return false;
 			} else {
-				return A->g_score < B->g_score; // If the f_costs are the same then prioritize the points that are further away from the start.
+				return scratch->g_score[A] < scratch->g_score[B]; // If the f_costs are the same then prioritize the points that are further away from the start.
 			}
 		}
 	};
@@ -108,13 +122,45 @@ class AStar : public Reference {
 		}
 	};
 
+	struct IdPathBatch {
+		const int *from_ids = nullptr;
+		const int *to_ids = nullptr;
+		Vector<int> *paths = nullptr;
+	};
+
 	int last_free_id = 0;
-	uint64_t pass = 1;
 
-	OAHashMap<int, Point *> points;
+	LocalVector<Point> points;
+	LocalVector<uint32_t> free_slots;
+	OAHashMap<int, uint32_t> point_slots; // Point id to slot.
 	Set<Segment> segments;
 
-	bool _solve(Point *begin_point, Point *end_point);
+	BinaryMutex scratch_mutex;
+	LocalVector<SolveScratch *> scratches; // Not in use by any query.
+
+	SolveScratch *_acquire_scratch();
+	void _release_scratch(SolveScratch *p_scratch);
+	void _free_scratches();
+
+	_FORCE_INLINE_ Point *_get_point(int p_id) {
+		uint32_t slot;
+		return point_slots.lookup(p_id, slot) ? &points[slot] : nullptr;
+	}
+	_FORCE_INLINE_ const Point *_get_point(int p_id) const {
+		uint32_t slot;
+		return point_slots.lookup(p_id, slot) ? &points[slot] : nullptr;
+	}
+
+	static void _add_neighbour(LocalVector<uint32_t> &r_neighbours, uint32_t p_slot);
+	static void _remove_neighbour(LocalVector<uint32_t> &r_neighbours, uint32_t p_slot);
+
+	template <class C>
+	bool _solve(C *p_costs, uint32_t p_begin, uint32_t p_end, SolveScratch &r_scratch);
+	template <class C>
+	bool _find_path(C *p_costs, int p_from_id, int p_to_id, LocalVector<uint32_t> &r_slots);
+
+	bool _has_script_costs() const;
+	void _id_path_batch_item(uint32_t p_index, IdPathBatch *p_batch);
 
 protected:
 	static void _bind_methods();
@@ -152,6 +198,7 @@ public:
 
 	Vector<Vector3> get_point_path(int p_from_id, int p_to_id);
 	Vector<int> get_id_path(int p_from_id, int p_to_id);
+	Array get_id_paths_batch(const Vector<int> &p_from_ids, const Vector<int> &p_to_ids);
 
 	AStar() {}
 	~AStar();
@@ -159,9 +206,12 @@ public:
 
 class AStar2D : public Reference {
 	GDCLASS(AStar2D, Reference);
+	friend class AStar; // Calls the cost methods while solving.
+
 	AStar astar;
 
-	bool _solve(AStar::Point *begin_point, AStar::Point *end_point);
+	bool _has_script_costs() const;
+	void _id_path_batch_item(uint32_t p_index, AStar::IdPathBatch *p_batch);
 
 protected:
 	static void _bind_methods();
@@ -199,6 +249,7 @@ public:
 
 	Vector<Vector2> get_point_path(int p_from_id, int p_to_id);
 	Vector<int> get_id_path(int p_from_id, int p_to_id);
+	Array get_id_paths_batch(const Vector<int> &p_from_ids, const Vector<int> &p_to_ids);
 
 	AStar2D() {}
 	~AStar2D() {}
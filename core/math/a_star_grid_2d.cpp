@@ -0,0 +1,980 @@
+/*************************************************************************/
+/*  a_star_grid_2d.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "a_star_grid_2d.h"
+
+#include "core/sort_array.h"
+
+// Runs of open border cells at least this long get an entrance at each end
+// instead of a single one in the middle.
+static const int ENTRANCE_SPLIT_LENGTH = 6;
+
+// Orthogonal directions first, then diagonals.
+static const int DIRECTIONS[8][2] = {
+	{ 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 },
+	{ 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 }
+};
+
+void AStarGrid2D::SearchState::prepare(uint32_t p_count) {
+	uint32_t old_count = stamp.size();
+	if (old_count >= p_count) {
+		return;
+	}
+
+	stamp.resize(p_count);
+	g_score.resize(p_count);
+	parent.resize(p_count);
+
+	for (uint32_t i = old_count; i < p_count; i++) {
+		stamp[i] = 0;
+	}
+}
+
+uint32_t AStarGrid2D::SearchState::begin() {
+	open_list.clear();
+
+	pass += 2; // Open and closed stamps of this pass.
+	if (unlikely(pass == 0)) { // Wrapped around, old stamps could match again.
+		for (uint32_t i = 0; i < stamp.size(); i++) {
+			stamp[i] = 0;
+		}
+		pass = 2;
+	}
+
+	return pass;
+}
+
+AStarGrid2D::Scratch *AStarGrid2D::_acquire_scratch() {
+	MutexLock lock(scratch_mutex);
+
+	if (scratches.empty()) {
+		return memnew(Scratch);
+	}
+
+	Scratch *scratch = scratches[scratches.size() - 1];
+	scratches.resize(scratches.size() - 1);
+	return scratch;
+}
+
+void AStarGrid2D::_release_scratch(Scratch *p_scratch) {
+	MutexLock lock(scratch_mutex);
+	scratches.push_back(p_scratch);
+}
+
+void AStarGrid2D::_free_scratches() {
+	MutexLock lock(scratch_mutex);
+
+	for (uint32_t i = 0; i < scratches.size(); i++) {
+		memdelete(scratches[i]);
+	}
+	scratches.clear();
+}
+
+real_t AStarGrid2D::_estimate_cost(uint32_t p_from, uint32_t p_to) const {
+	int dx = ABS(int(p_from % size.x) - int(p_to % size.x));
+	int dy = ABS(int(p_from / size.x) - int(p_to / size.x));
+
+	if (diagonal_enabled) {
+		return MAX(dx, dy) + (Math_SQRT2 - 1) * MIN(dx, dy); // Octile distance.
+	}
+	return dx + dy;
+}
+
+bool AStarGrid2D::_solve_region(uint32_t p_from, uint32_t p_to, const Rect2i &p_region, SearchState &r_state) const {
+	// With no destination, this visits every cell of the region reachable from
+	// p_from and leaves their distances in r_state.
+	SortArray<OpenEntry, SortOpenEntries> sorter;
+
+	r_state.prepare(size.x * size.y);
+	const uint32_t open = r_state.begin();
+	const uint32_t closed = open + 1;
+
+	uint32_t *stamp = r_state.stamp.ptr();
+	real_t *g_score = r_state.g_score.ptr();
+	uint32_t *parent = r_state.parent.ptr();
+	LocalVector<OpenEntry> &open_list = r_state.open_list;
+
+	int direction_count = diagonal_enabled ? 8 : 4;
+
+	stamp[p_from] = open;
+	g_score[p_from] = 0;
+	parent[p_from] = p_from;
+	open_list.push_back({ p_to != INVALID_CELL ? _estimate_cost(p_from, p_to) : 0, 0, p_from });
+
+	while (!open_list.empty()) {
+		uint32_t c = open_list[0].id;
+		sorter.pop_heap(0, open_list.size(), open_list.ptr());
+		open_list.resize(open_list.size() - 1);
+
+		if (stamp[c] == closed) {
+			continue; // Outdated entry, the cell was reached again with a better score.
+		}
+		stamp[c] = closed;
+
+		if (c == p_to) {
+			return true;
+		}
+
+		int x = c % size.x;
+		int y = c / size.x;
+
+		for (int i = 0; i < direction_count; i++) {
+			int dx = DIRECTIONS[i][0];
+			int dy = DIRECTIONS[i][1];
+
+			if (!_is_walkable(x + dx, y + dy, p_region)) {
+				continue;
+			}
+			if (dx != 0 && dy != 0 && (!_is_walkable(x + dx, y, p_region) || !_is_walkable(x, y + dy, p_region))) {
+				continue; // Don't cut corners.
+			}
+
+			uint32_t n = _cell_index(x + dx, y + dy);
+			if (stamp[n] == closed) {
+				continue;
+			}
+
+			real_t tentative_g_score = g_score[c] + (i < 4 ? 1 : Math_SQRT2);
+			if (stamp[n] == open && tentative_g_score >= g_score[n]) {
+				continue;
+			}
+
+			stamp[n] = open;
+			g_score[n] = tentative_g_score;
+			parent[n] = c;
+
+			real_t f_score = tentative_g_score + (p_to != INVALID_CELL ? _estimate_cost(n, p_to) : 0);
+			open_list.push_back({ f_score, tentative_g_score, n });
+			sorter.push_heap(0, open_list.size() - 1, 0, open_list[open_list.size() - 1], open_list.ptr());
+		}
+	}
+
+	return p_to == INVALID_CELL;
+}
+
+bool AStarGrid2D::_jump(int &r_x, int &r_y, int p_dx, int p_dy, uint32_t p_to) const {
+	// Walks from (r_x, r_y) in the given direction until it finds a jump point:
+	// the destination, or a cell with a neighbour that can't be reached any
+	// better without going through it.
+	const Rect2i region(Point2i(), size);
+
+	int x = r_x;
+	int y = r_y;
+
+	while (true) {
+		if (!_is_walkable(x, y, region)) {
+			return false;
+		}
+		if (_cell_index(x, y) == p_to) {
+			break;
+		}
+
+		if (p_dx != 0 && p_dy != 0) {
+			int sx = x + p_dx;
+			int sy = y;
+			if (_jump(sx, sy, p_dx, 0, p_to)) {
+				break;
+			}
+			sx = x;
+			sy = y + p_dy;
+			if (_jump(sx, sy, 0, p_dy, p_to)) {
+				break;
+			}
+		} else if (p_dx != 0) {
+			if ((_is_walkable(x, y - 1, region) && !_is_walkable(x - p_dx, y - 1, region)) || (_is_walkable(x, y + 1, region) && !_is_walkable(x - p_dx, y + 1, region))) {
+				break;
+			}
+		} else {
+			if ((_is_walkable(x - 1, y, region) && !_is_walkable(x - 1, y - p_dy, region)) || (_is_walkable(x + 1, y, region) && !_is_walkable(x + 1, y - p_dy, region))) {
+				break;
+			}
+		}
+
+		if (!_is_walkable(x + p_dx, y, region) || !_is_walkable(x, y + p_dy, region)) {
+			return false; // Blocked, or a corner that can't be cut.
+		}
+		x += p_dx;
+		y += p_dy;
+	}
+
+	r_x = x;
+	r_y = y;
+	return true;
+}
+
+bool AStarGrid2D::_solve_jps(uint32_t p_from, uint32_t p_to, SearchState &r_state) const {
+	SortArray<OpenEntry, SortOpenEntries> sorter;
+	const Rect2i region(Point2i(), size);
+
+	r_state.prepare(size.x * size.y);
+	const uint32_t open = r_state.begin();
+	const uint32_t closed = open + 1;
+
+	uint32_t *stamp = r_state.stamp.ptr();
+	real_t *g_score = r_state.g_score.ptr();
+	uint32_t *parent = r_state.parent.ptr();
+	LocalVector<OpenEntry> &open_list = r_state.open_list;
+
+	stamp[p_from] = open;
+	g_score[p_from] = 0;
+	parent[p_from] = p_from;
+	open_list.push_back({ _estimate_cost(p_from, p_to), 0, p_from });
+
+	while (!open_list.empty()) {
+		uint32_t c = open_list[0].id;
+		sorter.pop_heap(0, open_list.size(), open_list.ptr());
+		open_list.resize(open_list.size() - 1);
+
+		if (stamp[c] == closed) {
+			continue; // Outdated entry, the cell was reached again with a better score.
+		}
+		stamp[c] = closed;
+
+		if (c == p_to) {
+			return true;
+		}
+
+		int x = c % size.x;
+		int y = c / size.x;
+
+		// Directions worth exploring, pruned by the direction we came from.
+		int directions[8][2];
+		int direction_count = 0;
+
+		if (c == p_from) {
+			for (int i = 0; i < 8; i++) {
+				int dx = DIRECTIONS[i][0];
+				int dy = DIRECTIONS[i][1];
+				if (dx != 0 && dy != 0 && (!_is_walkable(x + dx, y, region) || !_is_walkable(x, y + dy, region))) {
+					continue;
+				}
+				directions[direction_count][0] = dx;
+				directions[direction_count][1] = dy;
+				direction_count++;
+			}
+		} else {
+			int px = parent[c] % size.x;
+			int py = parent[c] / size.x;
+			int dx = CLAMP(x - px, -1, 1);
+			int dy = CLAMP(y - py, -1, 1);
+
+#define ADD_DIRECTION(m_dx, m_dy)                  \
+	directions[direction_count][0] = m_dx;         \
+	directions[direction_count][1] = m_dy;         \
+	direction_count++;
+
+			if (dx != 0 && dy != 0) {
+				bool vertical = _is_walkable(x, y + dy, region);
+				bool horizontal = _is_walkable(x + dx, y, region);
+				if (vertical) {
+					ADD_DIRECTION(0, dy);
+				}
+				if (horizontal) {
+					ADD_DIRECTION(dx, 0);
+				}
+				if (vertical && horizontal) {
+					ADD_DIRECTION(dx, dy);
+				}
+			} else if (dx != 0) {
+				bool next = _is_walkable(x + dx, y, region);
+				bool down = _is_walkable(x, y + 1, region);
+				bool up = _is_walkable(x, y - 1, region);
+				if (next) {
+					ADD_DIRECTION(dx, 0);
+					if (down) {
+						ADD_DIRECTION(dx, 1);
+					}
+					if (up) {
+						ADD_DIRECTION(dx, -1);
+					}
+				}
+				if (down) {
+					ADD_DIRECTION(0, 1);
+				}
+				if (up) {
+					ADD_DIRECTION(0, -1);
+				}
+			} else {
+				bool next = _is_walkable(x, y + dy, region);
+				bool right = _is_walkable(x + 1, y, region);
+				bool left = _is_walkable(x - 1, y, region);
+				if (next) {
+					ADD_DIRECTION(0, dy);
+					if (right) {
+						ADD_DIRECTION(1, dy);
+					}
+					if (left) {
+						ADD_DIRECTION(-1, dy);
+					}
+				}
+				if (right) {
+					ADD_DIRECTION(1, 0);
+				}
+				if (left) {
+					ADD_DIRECTION(-1, 0);
+				}
+			}
+
+#undef ADD_DIRECTION
+		}
+
+		for (int i = 0; i < direction_count; i++) {
+			int jx = x + directions[i][0];
+			int jy = y + directions[i][1];
+			if (!_jump(jx, jy, directions[i][0], directions[i][1], p_to)) {
+				continue;
+			}
+
+			uint32_t n = _cell_index(jx, jy);
+			if (stamp[n] == closed) {
+				continue;
+			}
+
+			// Jump points are always on a straight or diagonal line from their parent.
+			real_t tentative_g_score = g_score[c] + _estimate_cost(c, n);
+			if (stamp[n] == open && tentative_g_score >= g_score[n]) {
+				continue;
+			}
+
+			stamp[n] = open;
+			g_score[n] = tentative_g_score;
+			parent[n] = c;
+
+			open_list.push_back({ tentative_g_score + _estimate_cost(n, p_to), tentative_g_score, n });
+			sorter.push_heap(0, open_list.size() - 1, 0, open_list[open_list.size() - 1], open_list.ptr());
+		}
+	}
+
+	return false;
+}
+
+void AStarGrid2D::_append_path(const SearchState &p_state, uint32_t p_from, uint32_t p_to, LocalVector<uint32_t> &r_cells) const {
+	// Collect the solved cells backwards, then walk them forwards one cell at
+	// a time, which also fills in the gaps between jump points.
+	LocalVector<uint32_t> points;
+	for (uint32_t c = p_to; c != p_from; c = p_state.parent[c]) {
+		points.push_back(c);
+	}
+	points.push_back(p_from);
+	points.invert();
+
+	if (r_cells.empty() || r_cells[r_cells.size() - 1] != p_from) {
+		r_cells.push_back(p_from);
+	}
+
+	for (uint32_t i = 1; i < points.size(); i++) {
+		int x = points[i - 1] % size.x;
+		int y = points[i - 1] / size.x;
+		int to_x = points[i] % size.x;
+		int to_y = points[i] / size.x;
+		int dx = CLAMP(to_x - x, -1, 1);
+		int dy = CLAMP(to_y - y, -1, 1);
+
+		while (x != to_x || y != to_y) {
+			x += dx;
+			y += dy;
+			r_cells.push_back(_cell_index(x, y));
+		}
+	}
+}
+
+void AStarGrid2D::_add_cluster_node(LocalVector<ClusterNode> &r_nodes, uint32_t p_cell, uint32_t p_mate) {
+	for (uint32_t i = 0; i < r_nodes.size(); i++) {
+		if (r_nodes[i].cell == p_cell) {
+			r_nodes[i].mates.push_back(p_mate);
+			return;
+		}
+	}
+
+	r_nodes.resize(r_nodes.size() + 1);
+	ClusterNode &node = r_nodes[r_nodes.size() - 1];
+	node.cell = p_cell;
+	node.mates.push_back(p_mate);
+}
+
+uint32_t AStarGrid2D::_get_cluster(uint32_t p_cell) const {
+	int x = p_cell % size.x;
+	int y = p_cell / size.x;
+	return (y / cluster_size) * cluster_count.x + (x / cluster_size);
+}
+
+void AStarGrid2D::_mark_dirty(int p_x, int p_y) {
+	// Cells on a cluster edge also change the entrances on that border, and
+	// with them the nodes of the cluster on the other side.
+	int cx = p_x / cluster_size;
+	int cy = p_y / cluster_size;
+	uint32_t idx = cy * cluster_count.x + cx;
+
+	Cluster &cluster = clusters[idx];
+	cluster.dirty = true;
+
+	int lx = p_x - cluster.region.position.x;
+	int ly = p_y - cluster.region.position.y;
+
+	if (lx == cluster.region.size.x - 1 && cx + 1 < cluster_count.x) {
+		cluster.east_dirty = true;
+		clusters[idx + 1].dirty = true;
+	}
+	if (lx == 0 && cx > 0) {
+		clusters[idx - 1].east_dirty = true;
+		clusters[idx - 1].dirty = true;
+	}
+	if (ly == cluster.region.size.y - 1 && cy + 1 < cluster_count.y) {
+		cluster.south_dirty = true;
+		clusters[idx + cluster_count.x].dirty = true;
+	}
+	if (ly == 0 && cy > 0) {
+		clusters[idx - cluster_count.x].south_dirty = true;
+		clusters[idx - cluster_count.x].dirty = true;
+	}
+
+	hierarchy_dirty = true;
+}
+
+void AStarGrid2D::_build_entrances(uint32_t p_cluster, bool p_east) {
+	Cluster &cluster = clusters[p_cluster];
+	LocalVector<uint32_t> &entrances = p_east ? cluster.east_entrances : cluster.south_entrances;
+
+	entrances.clear();
+	if (p_east) {
+		cluster.east_dirty = false;
+	} else {
+		cluster.south_dirty = false;
+	}
+
+	if ((p_east && int(p_cluster % cluster_count.x) + 1 >= cluster_count.x) || (!p_east && int(p_cluster / cluster_count.x) + 1 >= cluster_count.y)) {
+		return; // Edge of the grid.
+	}
+
+	// Walk the last column (or row) of the cluster, next to the first one of its neighbour.
+	const Rect2i &r = cluster.region;
+	uint32_t first = p_east ? _cell_index(r.position.x + r.size.x - 1, r.position.y) : _cell_index(r.position.x, r.position.y + r.size.y - 1);
+	uint32_t stride = p_east ? size.x : 1;
+	uint32_t across = p_east ? 1 : size.x;
+	int length = p_east ? r.size.y : r.size.x;
+
+	int run_start = -1;
+	for (int i = 0; i <= length; i++) {
+		uint32_t inside = first + i * stride;
+		bool open = i < length && !_is_solid(inside) && !_is_solid(inside + across);
+
+		if (open) {
+			if (run_start < 0) {
+				run_start = i;
+			}
+			continue;
+		}
+		if (run_start < 0) {
+			continue;
+		}
+
+		int run_end = i - 1;
+		if (run_end - run_start + 1 < ENTRANCE_SPLIT_LENGTH) {
+			uint32_t cell = first + ((run_start + run_end) / 2) * stride;
+			entrances.push_back(cell);
+			entrances.push_back(cell + across);
+		} else {
+			uint32_t cell = first + run_start * stride;
+			entrances.push_back(cell);
+			entrances.push_back(cell + across);
+			cell = first + run_end * stride;
+			entrances.push_back(cell);
+			entrances.push_back(cell + across);
+		}
+		run_start = -1;
+	}
+}
+
+void AStarGrid2D::_build_cluster(uint32_t p_cluster, SearchState &r_state) {
+	Cluster &cluster = clusters[p_cluster];
+	cluster.nodes.clear();
+
+	for (uint32_t i = 0; i < cluster.east_entrances.size(); i += 2) {
+		_add_cluster_node(cluster.nodes, cluster.east_entrances[i], cluster.east_entrances[i + 1]);
+	}
+	for (uint32_t i = 0; i < cluster.south_entrances.size(); i += 2) {
+		_add_cluster_node(cluster.nodes, cluster.south_entrances[i], cluster.south_entrances[i + 1]);
+	}
+	if (p_cluster % cluster_count.x > 0) {
+		const LocalVector<uint32_t> &west = clusters[p_cluster - 1].east_entrances;
+		for (uint32_t i = 0; i < west.size(); i += 2) {
+			_add_cluster_node(cluster.nodes, west[i + 1], west[i]);
+		}
+	}
+	if (p_cluster / cluster_count.x > 0) {
+		const LocalVector<uint32_t> &north = clusters[p_cluster - cluster_count.x].south_entrances;
+		for (uint32_t i = 0; i < north.size(); i += 2) {
+			_add_cluster_node(cluster.nodes, north[i + 1], north[i]);
+		}
+	}
+
+	// Distances between all nodes, without leaving the cluster.
+	uint32_t count = cluster.nodes.size();
+	cluster.distances.resize(count * count);
+	for (uint32_t i = 0; i < count; i++) {
+		_solve_region(cluster.nodes[i].cell, INVALID_CELL, cluster.region, r_state);
+		for (uint32_t j = 0; j < count; j++) {
+			uint32_t cell = cluster.nodes[j].cell;
+			cluster.distances[i * count + j] = r_state.is_closed(cell) ? r_state.g_score[cell] : -1;
+		}
+	}
+
+	cluster.dirty = false;
+}
+
+void AStarGrid2D::_reset_hierarchy() {
+	clusters.clear();
+	node_clusters.clear();
+	node_count = 0;
+	cluster_count = Vector2i();
+	hierarchy_dirty = false;
+
+	if (cluster_size <= 0 || size.x <= 0 || size.y <= 0) {
+		return;
+	}
+
+	cluster_count.x = (size.x + cluster_size - 1) / cluster_size;
+	cluster_count.y = (size.y + cluster_size - 1) / cluster_size;
+	clusters.resize(cluster_count.x * cluster_count.y);
+
+	for (int y = 0; y < cluster_count.y; y++) {
+		for (int x = 0; x < cluster_count.x; x++) {
+			Rect2i &region = clusters[y * cluster_count.x + x].region;
+			region.position = Point2i(x * cluster_size, y * cluster_size);
+			region.size = Size2i(MIN(cluster_size, size.x - region.position.x), MIN(cluster_size, size.y - region.position.y));
+		}
+	}
+
+	hierarchy_dirty = true; // Built on the next query.
+}
+
+bool AStarGrid2D::_solve_hierarchical(uint32_t p_from, uint32_t p_to, Scratch &r_scratch, LocalVector<uint32_t> &r_cells) {
+	SortArray<OpenEntry, SortOpenEntries> sorter;
+	SearchState &cells = r_scratch.cells;
+
+	uint32_t from_cluster = _get_cluster(p_from);
+	uint32_t to_cluster = _get_cluster(p_to);
+	const Cluster &from_c = clusters[from_cluster];
+	const Cluster &to_c = clusters[to_cluster];
+
+	// Connect the start and the destination to the nodes of their clusters.
+	LocalVector<real_t> from_costs;
+	from_costs.resize(from_c.nodes.size());
+	_solve_region(p_from, INVALID_CELL, from_c.region, cells);
+	for (uint32_t i = 0; i < from_c.nodes.size(); i++) {
+		uint32_t cell = from_c.nodes[i].cell;
+		from_costs[i] = cells.is_closed(cell) ? cells.g_score[cell] : -1;
+	}
+	real_t direct_cost = (from_cluster == to_cluster && cells.is_closed(p_to)) ? cells.g_score[p_to] : -1;
+
+	LocalVector<real_t> to_costs;
+	to_costs.resize(to_c.nodes.size());
+	_solve_region(p_to, INVALID_CELL, to_c.region, cells);
+	for (uint32_t i = 0; i < to_c.nodes.size(); i++) {
+		uint32_t cell = to_c.nodes[i].cell;
+		to_costs[i] = cells.is_closed(cell) ? cells.g_score[cell] : -1;
+	}
+
+	// Search the abstract graph, with the start and destination as two extra nodes.
+	const uint32_t start = node_count;
+	const uint32_t goal = node_count + 1;
+
+	SearchState &nodes = r_scratch.nodes;
+	nodes.prepare(node_count + 2);
+	const uint32_t open = nodes.begin();
+	const uint32_t closed = open + 1;
+
+	uint32_t *stamp = nodes.stamp.ptr();
+	real_t *g_score = nodes.g_score.ptr();
+	uint32_t *parent = nodes.parent.ptr();
+	LocalVector<OpenEntry> &open_list = nodes.open_list;
+
+#define NODE_CELL(m_node) ((m_node) == start ? p_from : ((m_node) == goal ? p_to : clusters[node_clusters[m_node]].nodes[(m_node)-clusters[node_clusters[m_node]].first_node].cell))
+
+#define RELAX(m_node, m_cost)                                                                                  \
+	{                                                                                                          \
+		uint32_t n = m_node;                                                                                   \
+		real_t tentative_g_score = g_score[c] + (m_cost);                                                      \
+		if (stamp[n] != closed && (stamp[n] != open || tentative_g_score < g_score[n])) {                      \
+			stamp[n] = open;                                                                                   \
+			g_score[n] = tentative_g_score;                                                                    \
+			parent[n] = c;                                                                                     \
+			open_list.push_back({ tentative_g_score + _estimate_cost(NODE_CELL(n), p_to), tentative_g_score, n }); \
+			sorter.push_heap(0, open_list.size() - 1, 0, open_list[open_list.size() - 1], open_list.ptr());    \
+		}                                                                                                      \
+	}
+
+	stamp[start] = open;
+	g_score[start] = 0;
+	parent[start] = start;
+	open_list.push_back({ _estimate_cost(p_from, p_to), 0, start });
+
+	bool found_route = false;
+
+	while (!open_list.empty()) {
+		uint32_t c = open_list[0].id;
+		sorter.pop_heap(0, open_list.size(), open_list.ptr());
+		open_list.resize(open_list.size() - 1);
+
+		if (stamp[c] == closed) {
+			continue;
+		}
+		stamp[c] = closed;
+
+		if (c == goal) {
+			found_route = true;
+			break;
+		}
+
+		if (c == start) {
+			for (uint32_t i = 0; i < from_c.nodes.size(); i++) {
+				if (from_costs[i] >= 0) {
+					RELAX(from_c.first_node + i, from_costs[i]);
+				}
+			}
+			if (direct_cost >= 0) {
+				RELAX(goal, direct_cost);
+			}
+			continue;
+		}
+
+		uint32_t cluster_idx = node_clusters[c];
+		const Cluster &cluster = clusters[cluster_idx];
+		uint32_t i = c - cluster.first_node;
+		uint32_t count = cluster.nodes.size();
+
+		for (uint32_t j = 0; j < count; j++) {
+			real_t distance = cluster.distances[i * count + j];
+			if (j != i && distance >= 0) {
+				RELAX(cluster.first_node + j, distance);
+			}
+		}
+
+		const ClusterNode &node = cluster.nodes[i];
+		for (uint32_t k = 0; k < node.mates.size(); k++) {
+			const Cluster &mate_cluster = clusters[_get_cluster(node.mates[k])];
+			for (uint32_t j = 0; j < mate_cluster.nodes.size(); j++) {
+				if (mate_cluster.nodes[j].cell == node.mates[k]) {
+					RELAX(mate_cluster.first_node + j, 1); // Entrances are orthogonal steps.
+					break;
+				}
+			}
+		}
+
+		if (cluster_idx == to_cluster && to_costs[i] >= 0) {
+			RELAX(goal, to_costs[i]);
+		}
+	}
+
+	if (!found_route) {
+		return false;
+	}
+
+	LocalVector<uint32_t> abstract_path;
+	for (uint32_t n = goal; n != start; n = parent[n]) {
+		abstract_path.push_back(n);
+	}
+	abstract_path.push_back(start);
+	abstract_path.invert();
+
+	// Refine every abstract step into cells.
+	for (uint32_t k = 1; k < abstract_path.size(); k++) {
+		uint32_t a = abstract_path[k - 1];
+		uint32_t b = abstract_path[k];
+		uint32_t a_cell = NODE_CELL(a);
+		uint32_t b_cell = NODE_CELL(b);
+
+		if (a != start && b != goal && node_clusters[a] != node_clusters[b]) {
+			if (r_cells.empty()) {
+				r_cells.push_back(a_cell);
+			}
+			r_cells.push_back(b_cell); // Crossing to the next cluster.
+			continue;
+		}
+
+		const Rect2i &region = a == start ? from_c.region : clusters[node_clusters[a]].region;
+		bool found = _solve_region(a_cell, b_cell, region, cells);
+		ERR_FAIL_COND_V(!found, false);
+		_append_path(cells, a_cell, b_cell, r_cells);
+	}
+
+#undef RELAX
+#undef NODE_CELL
+
+	return true;
+}
+
+bool AStarGrid2D::_find_path(const Vector2i &p_from, const Vector2i &p_to, LocalVector<uint32_t> &r_cells) {
+	ERR_FAIL_COND_V_MSG(!is_in_bounds(p_from), false, "Start cell " + String(p_from) + " is out of bounds.");
+	ERR_FAIL_COND_V_MSG(!is_in_bounds(p_to), false, "End cell " + String(p_to) + " is out of bounds.");
+
+	uint32_t from = _cell_index(p_from.x, p_from.y);
+	uint32_t to = _cell_index(p_to.x, p_to.y);
+
+	if (_is_solid(from) || _is_solid(to)) {
+		return false;
+	}
+
+	if (from == to) {
+		r_cells.push_back(from);
+		return true;
+	}
+
+	if (cluster_size > 0) {
+		update();
+	}
+
+	Scratch *scratch = _acquire_scratch();
+
+	bool found_route;
+	if (cluster_size > 0) {
+		found_route = _solve_hierarchical(from, to, *scratch, r_cells);
+	} else {
+		if (diagonal_enabled && jumping_enabled) {
+			found_route = _solve_jps(from, to, scratch->cells);
+		} else {
+			found_route = _solve_region(from, to, Rect2i(Point2i(), size), scratch->cells);
+		}
+
+		if (found_route) {
+			_append_path(scratch->cells, from, to, r_cells);
+		}
+	}
+
+	_release_scratch(scratch);
+
+	return found_route;
+}
+
+void AStarGrid2D::set_size(const Vector2i &p_size) {
+	ERR_FAIL_COND(p_size.x < 0 || p_size.y < 0);
+
+	size = p_size;
+
+	uint32_t words = (uint32_t(size.x) * uint32_t(size.y) + 63) / 64;
+	solid.resize(words);
+	for (uint32_t i = 0; i < words; i++) {
+		solid[i] = 0;
+	}
+
+	_free_scratches(); // Sized for the old grid.
+	_reset_hierarchy();
+}
+
+Vector2i AStarGrid2D::get_size() const {
+	return size;
+}
+
+void AStarGrid2D::set_cell_size(const Vector2 &p_cell_size) {
+	cell_size = p_cell_size;
+}
+
+Vector2 AStarGrid2D::get_cell_size() const {
+	return cell_size;
+}
+
+void AStarGrid2D::set_diagonal_enabled(bool p_enabled) {
+	if (diagonal_enabled == p_enabled) {
+		return;
+	}
+
+	diagonal_enabled = p_enabled;
+	_reset_hierarchy(); // Cluster distances depend on it.
+}
+
+bool AStarGrid2D::is_diagonal_enabled() const {
+	return diagonal_enabled;
+}
+
+void AStarGrid2D::set_jumping_enabled(bool p_enabled) {
+	jumping_enabled = p_enabled;
+}
+
+bool AStarGrid2D::is_jumping_enabled() const {
+	return jumping_enabled;
+}
+
+void AStarGrid2D::set_cluster_size(int p_cluster_size) {
+	ERR_FAIL_COND(p_cluster_size < 0);
+
+	if (cluster_size == p_cluster_size) {
+		return;
+	}
+
+	cluster_size = p_cluster_size;
+	_reset_hierarchy();
+}
+
+int AStarGrid2D::get_cluster_size() const {
+	return cluster_size;
+}
+
+bool AStarGrid2D::is_in_bounds(const Vector2i &p_cell) const {
+	return p_cell.x >= 0 && p_cell.y >= 0 && p_cell.x < size.x && p_cell.y < size.y;
+}
+
+void AStarGrid2D::set_cell_solid(const Vector2i &p_cell, bool p_solid) {
+	ERR_FAIL_COND_MSG(!is_in_bounds(p_cell), "Cell " + String(p_cell) + " is out of bounds.");
+
+	uint32_t cell = _cell_index(p_cell.x, p_cell.y);
+	if (_is_solid(cell) == p_solid) {
+		return;
+	}
+
+	solid[cell >> 6] ^= uint64_t(1) << (cell & 63);
+
+	if (clusters.size()) {
+		_mark_dirty(p_cell.x, p_cell.y);
+	}
+}
+
+bool AStarGrid2D::is_cell_solid(const Vector2i &p_cell) const {
+	ERR_FAIL_COND_V_MSG(!is_in_bounds(p_cell), false, "Cell " + String(p_cell) + " is out of bounds.");
+
+	return _is_solid(_cell_index(p_cell.x, p_cell.y));
+}
+
+void AStarGrid2D::fill_solid_region(const Rect2i &p_region, bool p_solid) {
+	int from_x = MAX(p_region.position.x, 0);
+	int from_y = MAX(p_region.position.y, 0);
+	int to_x = MIN(p_region.position.x + p_region.size.x, size.x);
+	int to_y = MIN(p_region.position.y + p_region.size.y, size.y);
+
+	for (int y = from_y; y < to_y; y++) {
+		for (int x = from_x; x < to_x; x++) {
+			set_cell_solid(Vector2i(x, y), p_solid);
+		}
+	}
+}
+
+void AStarGrid2D::update() {
+	// Queries update the hierarchy too, so they may race each other to get here.
+	MutexLock lock(update_mutex);
+
+	if (!hierarchy_dirty) {
+		return;
+	}
+
+	Scratch *scratch = _acquire_scratch();
+
+	// Entrances first, the nodes of a cluster come from the borders of its neighbours too.
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		if (clusters[i].east_dirty) {
+			_build_entrances(i, true);
+		}
+		if (clusters[i].south_dirty) {
+			_build_entrances(i, false);
+		}
+	}
+
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		if (clusters[i].dirty) {
+			_build_cluster(i, scratch->cells);
+		}
+	}
+
+	node_count = 0;
+	node_clusters.clear();
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		clusters[i].first_node = node_count;
+		node_count += clusters[i].nodes.size();
+		for (uint32_t j = 0; j < clusters[i].nodes.size(); j++) {
+			node_clusters.push_back(i);
+		}
+	}
+
+	_release_scratch(scratch);
+	hierarchy_dirty = false;
+}
+
+Vector<Vector2> AStarGrid2D::get_cell_path(const Vector2i &p_from, const Vector2i &p_to) {
+	LocalVector<uint32_t> cells;
+	if (!_find_path(p_from, p_to, cells)) {
+		return Vector<Vector2>();
+	}
+
+	Vector<Vector2> path;
+	path.resize(cells.size());
+
+	Vector2 *w = path.ptrw();
+	for (uint32_t i = 0; i < cells.size(); i++) {
+		w[i] = Vector2(cells[i] % size.x, cells[i] / size.x);
+	}
+
+	return path;
+}
+
+Vector<Vector2> AStarGrid2D::get_point_path(const Vector2i &p_from, const Vector2i &p_to) {
+	LocalVector<uint32_t> cells;
+	if (!_find_path(p_from, p_to, cells)) {
+		return Vector<Vector2>();
+	}
+
+	Vector<Vector2> path;
+	path.resize(cells.size());
+
+	Vector2 *w = path.ptrw();
+	for (uint32_t i = 0; i < cells.size(); i++) {
+		w[i] = Vector2(cells[i] % size.x, cells[i] / size.x) * cell_size;
+	}
+
+	return path;
+}
+
+void AStarGrid2D::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_size", "size"), &AStarGrid2D::set_size);
+	ClassDB::bind_method(D_METHOD("get_size"), &AStarGrid2D::get_size);
+	ClassDB::bind_method(D_METHOD("set_cell_size", "cell_size"), &AStarGrid2D::set_cell_size);
+	ClassDB::bind_method(D_METHOD("get_cell_size"), &AStarGrid2D::get_cell_size);
+	ClassDB::bind_method(D_METHOD("set_diagonal_enabled", "enabled"), &AStarGrid2D::set_diagonal_enabled);
+	ClassDB::bind_method(D_METHOD("is_diagonal_enabled"), &AStarGrid2D::is_diagonal_enabled);
+	ClassDB::bind_method(D_METHOD("set_jumping_enabled", "enabled"), &AStarGrid2D::set_jumping_enabled);
+	ClassDB::bind_method(D_METHOD("is_jumping_enabled"), &AStarGrid2D::is_jumping_enabled);
+	ClassDB::bind_method(D_METHOD("set_cluster_size", "cluster_size"), &AStarGrid2D::set_cluster_size);
+	ClassDB::bind_method(D_METHOD("get_cluster_size"), &AStarGrid2D::get_cluster_size);
+
+	ClassDB::bind_method(D_METHOD("is_in_bounds", "cell"), &AStarGrid2D::is_in_bounds);
+	ClassDB::bind_method(D_METHOD("set_cell_solid", "cell", "solid"), &AStarGrid2D::set_cell_solid, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("is_cell_solid", "cell"), &AStarGrid2D::is_cell_solid);
+	ClassDB::bind_method(D_METHOD("fill_solid_region", "region", "solid"), &AStarGrid2D::fill_solid_region, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("update"), &AStarGrid2D::update);
+
+	ClassDB::bind_method(D_METHOD("get_cell_path", "from_cell", "to_cell"), &AStarGrid2D::get_cell_path);
+	ClassDB::bind_method(D_METHOD("get_point_path", "from_cell", "to_cell"), &AStarGrid2D::get_point_path);
+
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2I, "size"), "set_size", "get_size");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "cell_size"), "set_cell_size", "get_cell_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "diagonal_enabled"), "set_diagonal_enabled", "is_diagonal_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "jumping_enabled"), "set_jumping_enabled", "is_jumping_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cluster_size", PROPERTY_HINT_RANGE, "0,256,1,or_greater"), "set_cluster_size", "get_cluster_size");
+}
+
+AStarGrid2D::~AStarGrid2D() {
+	_free_scratches();
+}
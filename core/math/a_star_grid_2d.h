@@ -0,0 +1,197 @@
+/*************************************************************************/
+/*  a_star_grid_2d.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef A_STAR_GRID_2D_H
+#define A_STAR_GRID_2D_H
+
+#include "core/local_vector.h"
+#include "core/math/rect2.h"
+#include "core/os/mutex.h"
+#include "core/reference.h"
+
+/**
+	A* pathfinding on a dense 2D grid of cells.
+
+	Walkability is stored as one bit per cell, and movement costs are uniform
+	(1 orthogonally, sqrt(2) diagonally, never cutting corners of solid cells).
+	Queries use jump point search when diagonals are enabled, or plain A*.
+
+	With a cluster size set, the grid is also split into square clusters whose
+	border entrances form a small abstract graph (HPA*). Queries then search
+	the abstract graph and refine it into cells, which is much faster on large
+	grids at the cost of slightly longer paths. Changing a cell only rebuilds
+	the clusters it touches, on the next query.
+
+	Every running query borrows a scratch buffer of about 12 bytes per cell
+	from the grid. Buffers are kept for later queries and freed along with
+	the grid, or when it's resized.
+*/
+
+class AStarGrid2D : public Reference {
+	GDCLASS(AStarGrid2D, Reference);
+
+	static const uint32_t INVALID_CELL = 0xFFFFFFFF;
+
+	struct OpenEntry {
+		real_t f_score;
+		real_t g_score;
+		uint32_t id;
+	};
+
+	struct SortOpenEntries {
+		_FORCE_INLINE_ bool operator()(const OpenEntry &A, const OpenEntry &B) const { // Returns true when A is worse than B.
+			if (A.f_score != B.f_score) {
+				return A.f_score > B.f_score;
+			}
+			if (A.g_score != B.g_score) {
+				return A.g_score < B.g_score; // Prefer the entries further away from the start.
+			}
+			return A.id > B.id;
+		}
+	};
+
+	// Search state, indexed by cell (or by abstract node for the HPA* search).
+	// Each running query owns one, so queries never write to the grid itself.
+	struct SearchState {
+		uint32_t pass = 0;
+		LocalVector<uint32_t> stamp; // Pass while open, pass + 1 once closed.
+		LocalVector<real_t> g_score;
+		LocalVector<uint32_t> parent;
+		LocalVector<OpenEntry> open_list;
+
+		void prepare(uint32_t p_count);
+		uint32_t begin();
+		_FORCE_INLINE_ bool is_closed(uint32_t p_index) const { return stamp[p_index] == pass + 1; }
+	};
+
+	struct Scratch {
+		SearchState cells;
+		SearchState nodes;
+	};
+
+	// A cluster border cell with a walkable neighbour across the border.
+	struct ClusterNode {
+		uint32_t cell = INVALID_CELL;
+		LocalVector<uint32_t> mates; // Cells on the other side.
+	};
+
+	struct Cluster {
+		Rect2i region;
+		bool dirty = true;
+		bool east_dirty = true;
+		bool south_dirty = true;
+
+		// Entrance cell pairs (inside, outside) on the east and south borders.
+		LocalVector<uint32_t> east_entrances;
+		LocalVector<uint32_t> south_entrances;
+
+		LocalVector<ClusterNode> nodes;
+		LocalVector<real_t> distances; // nodes.size() squared, negative when unreachable.
+		uint32_t first_node = 0; // Index of the first node in the abstract graph.
+	};
+
+	Vector2i size;
+	Vector2 cell_size = Vector2(1, 1);
+	bool diagonal_enabled = true;
+	bool jumping_enabled = true;
+	int cluster_size = 0;
+
+	LocalVector<uint64_t> solid; // One bit per cell.
+
+	Vector2i cluster_count;
+	LocalVector<Cluster> clusters;
+	uint32_t node_count = 0;
+	LocalVector<uint32_t> node_clusters; // Cluster of every abstract node.
+	bool hierarchy_dirty = false;
+
+	BinaryMutex scratch_mutex;
+	LocalVector<Scratch *> scratches; // Not in use by any query.
+	BinaryMutex update_mutex;
+
+	Scratch *_acquire_scratch();
+	void _release_scratch(Scratch *p_scratch);
+	void _free_scratches();
+
+	_FORCE_INLINE_ uint32_t _cell_index(int p_x, int p_y) const { return uint32_t(p_y) * uint32_t(size.x) + uint32_t(p_x); }
+	_FORCE_INLINE_ bool _is_solid(uint32_t p_cell) const { return (solid[p_cell >> 6] >> (p_cell & 63)) & 1; }
+	_FORCE_INLINE_ bool _is_walkable(int p_x, int p_y, const Rect2i &p_region) const {
+		return p_x >= p_region.position.x && p_y >= p_region.position.y && p_x < p_region.position.x + p_region.size.x && p_y < p_region.position.y + p_region.size.y && !_is_solid(_cell_index(p_x, p_y));
+	}
+
+	real_t _estimate_cost(uint32_t p_from, uint32_t p_to) const;
+
+	bool _solve_region(uint32_t p_from, uint32_t p_to, const Rect2i &p_region, SearchState &r_state) const;
+	bool _jump(int &r_x, int &r_y, int p_dx, int p_dy, uint32_t p_to) const;
+	bool _solve_jps(uint32_t p_from, uint32_t p_to, SearchState &r_state) const;
+	void _append_path(const SearchState &p_state, uint32_t p_from, uint32_t p_to, LocalVector<uint32_t> &r_cells) const;
+
+	static void _add_cluster_node(LocalVector<ClusterNode> &r_nodes, uint32_t p_cell, uint32_t p_mate);
+	uint32_t _get_cluster(uint32_t p_cell) const;
+	void _mark_dirty(int p_x, int p_y);
+	void _build_entrances(uint32_t p_cluster, bool p_east);
+	void _build_cluster(uint32_t p_cluster, SearchState &r_state);
+	void _reset_hierarchy();
+	bool _solve_hierarchical(uint32_t p_from, uint32_t p_to, Scratch &r_scratch, LocalVector<uint32_t> &r_cells);
+
+	bool _find_path(const Vector2i &p_from, const Vector2i &p_to, LocalVector<uint32_t> &r_cells);
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_size(const Vector2i &p_size);
+	Vector2i get_size() const;
+
+	void set_cell_size(const Vector2 &p_cell_size);
+	Vector2 get_cell_size() const;
+
+	void set_diagonal_enabled(bool p_enabled);
+	bool is_diagonal_enabled() const;
+
+	void set_jumping_enabled(bool p_enabled);
+	bool is_jumping_enabled() const;
+
+	void set_cluster_size(int p_cluster_size);
+	int get_cluster_size() const;
+
+	bool is_in_bounds(const Vector2i &p_cell) const;
+	void set_cell_solid(const Vector2i &p_cell, bool p_solid = true);
+	bool is_cell_solid(const Vector2i &p_cell) const;
+	void fill_solid_region(const Rect2i &p_region, bool p_solid = true);
+
+	void update();
+
+	Vector<Vector2> get_cell_path(const Vector2i &p_from, const Vector2i &p_to);
+	Vector<Vector2> get_point_path(const Vector2i &p_from, const Vector2i &p_to);
+
+	AStarGrid2D() {}
+	~AStarGrid2D();
+};
+
+#endif // A_STAR_GRID_2D_H
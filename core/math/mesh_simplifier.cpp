@@ -0,0 +1,667 @@
+/*************************************************************************/
+/*  mesh_simplifier.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "mesh_simplifier.h"
+
+#include "core/oa_hash_map.h"
+
+// Border and seam edges get an extra plane perpendicular to their face, so they keep their shape.
+static const real_t EDGE_WEIGHT = 10.0;
+// Smallest cosine allowed between the normals of a moving vertex and the one it merges into.
+static const real_t NORMAL_LIMIT = 0.5;
+// Smallest cosine allowed between a moved face and the shading normals of its vertices.
+static const real_t FACE_NORMAL_LIMIT = 0.2;
+// A LOD must have at most this fraction of the indices of the previous one to be kept.
+static const real_t MIN_LOD_REDUCTION = 0.9;
+
+struct MeshSimplifierPositionHasher {
+	static _FORCE_INLINE_ uint32_t hash(const Vector3 &p_position) {
+		uint32_t h = hash_djb2_one_float(p_position.x);
+		h = hash_djb2_one_float(p_position.y, h);
+		return hash_djb2_one_float(p_position.z, h);
+	}
+};
+
+void MeshSimplifier::Quadric::add(const Quadric &p_quadric) {
+	a00 += p_quadric.a00;
+	a11 += p_quadric.a11;
+	a22 += p_quadric.a22;
+	a10 += p_quadric.a10;
+	a20 += p_quadric.a20;
+	a21 += p_quadric.a21;
+	b0 += p_quadric.b0;
+	b1 += p_quadric.b1;
+	b2 += p_quadric.b2;
+	c += p_quadric.c;
+	w += p_quadric.w;
+}
+
+void MeshSimplifier::Quadric::add_plane(const Vector3 &p_normal, real_t p_d, real_t p_weight) {
+	double x = p_normal.x;
+	double y = p_normal.y;
+	double z = p_normal.z;
+	double d = p_d;
+
+	a00 += p_weight * x * x;
+	a11 += p_weight * y * y;
+	a22 += p_weight * z * z;
+	a10 += p_weight * y * x;
+	a20 += p_weight * z * x;
+	a21 += p_weight * z * y;
+	b0 += p_weight * x * d;
+	b1 += p_weight * y * d;
+	b2 += p_weight * z * d;
+	c += p_weight * d * d;
+}
+
+double MeshSimplifier::Quadric::error(const Vector3 &p_point) const {
+	if (w <= 0.0) {
+		return 0.0;
+	}
+
+	double x = p_point.x;
+	double y = p_point.y;
+	double z = p_point.z;
+
+	double r = a00 * x * x + a11 * y * y + a22 * z * z;
+	r += 2.0 * (a10 * x * y + a20 * x * z + a21 * y * z);
+	r += 2.0 * (b0 * x + b1 * y + b2 * z);
+	r += c;
+
+	return MAX(r, 0.0) / w;
+}
+
+void MeshSimplifier::_build_positions(Context &p_context) {
+	uint32_t vertex_count = p_context.vertex_count;
+
+	p_context.position.resize(vertex_count);
+	p_context.wedge.resize(vertex_count);
+
+	OAHashMap<Vector3, uint32_t, MeshSimplifierPositionHasher> first_vertex(MAX(vertex_count * 2, 64u));
+
+	for (uint32_t i = 0; i < vertex_count; i++) {
+		uint32_t *first = first_vertex.lookup_ptr(p_context.vertices[i]);
+		if (first) {
+			p_context.position[i] = *first;
+			p_context.wedge[i] = p_context.wedge[*first];
+			p_context.wedge[*first] = i;
+		} else {
+			first_vertex.insert(p_context.vertices[i], i);
+			p_context.position[i] = i;
+			p_context.wedge[i] = i;
+		}
+	}
+}
+
+void MeshSimplifier::_build_adjacency(Context &p_context) {
+	uint32_t vertex_count = p_context.vertex_count;
+	const uint32_t *indices = p_context.indices.ptr();
+	uint32_t index_count = p_context.indices.size();
+
+	LocalVector<uint32_t> &offsets = p_context.adjacency_offsets;
+	offsets.resize(vertex_count + 1);
+	memset(offsets.ptr(), 0, sizeof(uint32_t) * (vertex_count + 1));
+
+	for (uint32_t i = 0; i < index_count; i++) {
+		offsets[p_context.position[indices[i]]]++;
+	}
+
+	uint32_t total = 0;
+	for (uint32_t i = 0; i < vertex_count; i++) {
+		uint32_t count = offsets[i];
+		offsets[i] = total;
+		total += count;
+	}
+	offsets[vertex_count] = total;
+
+	p_context.adjacency.resize(total);
+	for (uint32_t i = 0; i < index_count; i++) {
+		p_context.adjacency[offsets[p_context.position[indices[i]]]++] = i / 3;
+	}
+
+	// Filling advanced every offset to the start of the next position.
+	for (uint32_t i = vertex_count; i > 0; i--) {
+		offsets[i] = offsets[i - 1];
+	}
+	offsets[0] = 0;
+}
+
+void MeshSimplifier::_build_quadrics(Context &p_context) {
+	p_context.quadrics.resize(p_context.vertex_count);
+	for (uint32_t i = 0; i < p_context.vertex_count; i++) {
+		p_context.quadrics[i] = Quadric();
+	}
+
+	uint32_t triangle_count = p_context.indices.size() / 3;
+	for (uint32_t i = 0; i < triangle_count; i++) {
+		uint32_t p[3];
+		for (int j = 0; j < 3; j++) {
+			p[j] = p_context.position[p_context.indices[i * 3 + j]];
+		}
+
+		const Vector3 &v0 = p_context.vertices[p[0]];
+		Vector3 normal = (p_context.vertices[p[1]] - v0).cross(p_context.vertices[p[2]] - v0);
+		real_t area = normal.length();
+		if (area == 0.0) {
+			continue;
+		}
+		normal /= area;
+		area *= 0.5;
+
+		Quadric quadric;
+		quadric.add_plane(normal, -normal.dot(v0), area);
+		quadric.w = area;
+
+		for (int j = 0; j < 3; j++) {
+			p_context.quadrics[p[j]].add(quadric);
+		}
+	}
+}
+
+void MeshSimplifier::_add_edge_quadric(Context &p_context, uint32_t p_triangle, uint32_t p_from, uint32_t p_to) {
+	const uint32_t *triangle = &p_context.indices[p_triangle * 3];
+	const Vector3 &v0 = p_context.vertices[p_context.position[triangle[0]]];
+	const Vector3 &v1 = p_context.vertices[p_context.position[triangle[1]]];
+	const Vector3 &v2 = p_context.vertices[p_context.position[triangle[2]]];
+
+	Vector3 face_normal = (v1 - v0).cross(v2 - v0);
+	Vector3 edge = p_context.vertices[p_to] - p_context.vertices[p_from];
+	real_t face_length = face_normal.length();
+	real_t edge_length = edge.length();
+	if (face_length == 0.0 || edge_length == 0.0) {
+		return;
+	}
+
+	// Plane containing the edge and perpendicular to the face.
+	Vector3 normal = edge.cross(face_normal / face_length) / edge_length;
+
+	Quadric quadric;
+	quadric.add_plane(normal, -normal.dot(p_context.vertices[p_from]), edge_length * edge_length * EDGE_WEIGHT);
+
+	p_context.quadrics[p_from].add(quadric);
+	p_context.quadrics[p_to].add(quadric);
+}
+
+void MeshSimplifier::_classify(Context &p_context) {
+	uint32_t vertex_count = p_context.vertex_count;
+	const uint32_t *indices = p_context.indices.ptr();
+	const uint32_t *position = p_context.position.ptr();
+	uint32_t triangle_count = p_context.indices.size() / 3;
+
+	LocalVector<uint8_t> used;
+	LocalVector<uint8_t> locked;
+	LocalVector<uint32_t> border_out;
+	LocalVector<uint32_t> border_in;
+	LocalVector<uint32_t> seams;
+	used.resize(vertex_count);
+	locked.resize(vertex_count);
+	border_out.resize(vertex_count);
+	border_in.resize(vertex_count);
+	seams.resize(vertex_count);
+	memset(used.ptr(), 0, vertex_count);
+	memset(locked.ptr(), 0, vertex_count);
+	memset(border_out.ptr(), 0, sizeof(uint32_t) * vertex_count);
+	memset(border_in.ptr(), 0, sizeof(uint32_t) * vertex_count);
+	memset(seams.ptr(), 0, sizeof(uint32_t) * vertex_count);
+
+	p_context.kind.resize(vertex_count);
+	for (int i = 0; i < 2; i++) {
+		p_context.link[i].resize(vertex_count);
+		for (uint32_t j = 0; j < vertex_count; j++) {
+			p_context.link[i][j] = INVALID_VERTEX;
+		}
+	}
+
+	for (uint32_t i = 0; i < p_context.indices.size(); i++) {
+		used[indices[i]] = 1;
+	}
+
+	for (uint32_t i = 0; i < triangle_count; i++) {
+		for (int j = 0; j < 3; j++) {
+			uint32_t a = indices[i * 3 + j];
+			uint32_t b = indices[i * 3 + (j + 1) % 3];
+			uint32_t pa = position[a];
+			uint32_t pb = position[b];
+
+			// Look for the opposite half edge, and for duplicates of this one, around pb.
+			uint32_t opposite = 0;
+			uint32_t same = 0;
+			uint32_t oa = INVALID_VERTEX;
+			uint32_t ob = INVALID_VERTEX;
+			for (uint32_t k = p_context.adjacency_offsets[pb]; k < p_context.adjacency_offsets[pb + 1]; k++) {
+				uint32_t t = p_context.adjacency[k];
+				for (int l = 0; l < 3; l++) {
+					uint32_t c0 = indices[t * 3 + l];
+					uint32_t c1 = indices[t * 3 + (l + 1) % 3];
+					if (position[c0] == pb && position[c1] == pa) {
+						opposite++;
+						ob = c0;
+						oa = c1;
+					} else if (t != i && position[c0] == pa && position[c1] == pb) {
+						same++;
+					}
+				}
+			}
+
+			if (same > 0 || opposite > 1) {
+				locked[pa] = 1;
+				locked[pb] = 1;
+			} else if (opposite == 0) {
+				border_out[pa]++;
+				border_in[pb]++;
+				p_context.link[0][pa] = pb;
+				p_context.link[1][pb] = pa;
+				_add_edge_quadric(p_context, i, pa, pb);
+			} else if (oa != a || ob != b) {
+				// Only the half edge leaving pa is counted here, pb counts the opposite one.
+				if (seams[pa] < 2) {
+					p_context.link[seams[pa]][pa] = pb;
+				}
+				seams[pa]++;
+				_add_edge_quadric(p_context, i, pa, pb);
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < vertex_count; i++) {
+		if (position[i] != i) {
+			p_context.kind[i] = KIND_LOCKED;
+			continue;
+		}
+
+		uint32_t wedges = 0;
+		uint32_t v = i;
+		do {
+			wedges += used[v];
+			v = p_context.wedge[v];
+		} while (v != i);
+
+		bool border = border_out[i] || border_in[i];
+
+		if (locked[i] || wedges == 0) {
+			p_context.kind[i] = KIND_LOCKED;
+		} else if (wedges == 1 && !border && seams[i] == 0) {
+			p_context.kind[i] = KIND_MANIFOLD;
+		} else if (wedges == 1 && border_out[i] == 1 && border_in[i] == 1 && seams[i] == 0) {
+			p_context.kind[i] = KIND_BORDER;
+		} else if (wedges == 2 && !border && seams[i] == 2) {
+			p_context.kind[i] = KIND_SEAM;
+		} else {
+			// Seam endpoints and crossings, border corners, seams meeting borders...
+			p_context.kind[i] = KIND_LOCKED;
+		}
+	}
+}
+
+bool MeshSimplifier::_can_collapse(const Context &p_context, uint32_t p_from, uint32_t p_to) {
+	switch (p_context.kind[p_from]) {
+		case KIND_MANIFOLD:
+			return true;
+		case KIND_BORDER:
+		case KIND_SEAM:
+			return p_context.link[0][p_from] == p_to || p_context.link[1][p_from] == p_to;
+		default:
+			return false;
+	}
+}
+
+void MeshSimplifier::_replace_link(Context &p_context, uint32_t p_position, uint32_t p_old, uint32_t p_new) {
+	if (p_position == INVALID_VERTEX) {
+		return;
+	}
+	if (p_context.link[0][p_position] == p_old) {
+		p_context.link[0][p_position] = p_new;
+	} else if (p_context.link[1][p_position] == p_old) {
+		p_context.link[1][p_position] = p_new;
+	}
+}
+
+bool MeshSimplifier::_map_wedges(Context &p_context, uint32_t p_from, uint32_t p_to) {
+	const uint32_t *indices = p_context.indices.ptr();
+	uint32_t *wedge_target = p_context.wedge_target.ptr();
+	bool valid = true;
+
+	// Every vertex at p_from must move to the vertex at p_to it shares a triangle with, which
+	// keeps both sides of a seam apart. Vertices with no such triangle, or with more than one
+	// candidate, mean the edge doesn't follow the seam.
+	for (uint32_t i = p_context.adjacency_offsets[p_from]; i < p_context.adjacency_offsets[p_from + 1]; i++) {
+		uint32_t t = p_context.adjacency[i];
+		uint32_t from_vertex = INVALID_VERTEX;
+		uint32_t to_vertex = INVALID_VERTEX;
+		for (int j = 0; j < 3; j++) {
+			uint32_t v = indices[t * 3 + j];
+			if (p_context.position[v] == p_from) {
+				from_vertex = v;
+			} else if (p_context.position[v] == p_to) {
+				to_vertex = v;
+			}
+		}
+
+		if (to_vertex == INVALID_VERTEX) {
+			if (wedge_target[from_vertex] == INVALID_VERTEX) {
+				wedge_target[from_vertex] = PENDING_VERTEX;
+			}
+		} else if (wedge_target[from_vertex] == INVALID_VERTEX || wedge_target[from_vertex] == PENDING_VERTEX) {
+			wedge_target[from_vertex] = to_vertex;
+		} else if (wedge_target[from_vertex] != to_vertex) {
+			valid = false;
+		}
+	}
+
+	uint32_t v = p_from;
+	do {
+		uint32_t target = wedge_target[v];
+		if (target == PENDING_VERTEX) {
+			valid = false;
+		} else if (target != INVALID_VERTEX && p_context.normals && p_context.normals[v].dot(p_context.normals[target]) < NORMAL_LIMIT) {
+			valid = false;
+		}
+		v = p_context.wedge[v];
+	} while (v != p_from);
+
+	do {
+		if (valid && wedge_target[v] != INVALID_VERTEX) {
+			p_context.vertex_remap[v] = wedge_target[v];
+		}
+		wedge_target[v] = INVALID_VERTEX;
+		v = p_context.wedge[v];
+	} while (v != p_from);
+
+	return valid;
+}
+
+bool MeshSimplifier::_has_flips(const Context &p_context, uint32_t p_from, uint32_t p_to) {
+	const Vector3 &target = p_context.vertices[p_to];
+
+	for (uint32_t i = p_context.adjacency_offsets[p_from]; i < p_context.adjacency_offsets[p_from + 1]; i++) {
+		uint32_t t = p_context.adjacency[i];
+		uint32_t p[3];
+		for (int j = 0; j < 3; j++) {
+			p[j] = p_context.position[p_context.indices[t * 3 + j]];
+		}
+		if (p[0] == p_to || p[1] == p_to || p[2] == p_to) {
+			continue; // Collapses to a degenerate triangle and gets removed.
+		}
+
+		Vector3 v[3];
+		for (int j = 0; j < 3; j++) {
+			v[j] = p_context.vertices[p[j]];
+		}
+		Vector3 normal = (v[1] - v[0]).cross(v[2] - v[0]);
+
+		for (int j = 0; j < 3; j++) {
+			if (p[j] == p_from) {
+				v[j] = target;
+			}
+		}
+		Vector3 moved_normal = (v[1] - v[0]).cross(v[2] - v[0]);
+
+		if (normal.dot(moved_normal) <= 0.0) {
+			return true;
+		}
+
+		// Small rotations add up over the passes, so also compare against the shading normals.
+		// This catches triangles turning edge-on too, which never flip exactly.
+		if (p_context.normals) {
+			Vector3 shading_normal;
+			for (int j = 0; j < 3; j++) {
+				shading_normal += p_context.normals[p_context.indices[t * 3 + j]];
+			}
+			real_t limit = FACE_NORMAL_LIMIT * shading_normal.length() * moved_normal.length();
+			if (shading_normal.dot(moved_normal) <= limit) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+uint32_t MeshSimplifier::_collapse_pass(Context &p_context, uint32_t p_target_index_count, double p_max_cost) {
+	_build_adjacency(p_context);
+
+	const uint32_t *position = p_context.position.ptr();
+	uint32_t triangle_count = p_context.indices.size() / 3;
+
+	p_context.collapses.clear();
+	for (uint32_t i = 0; i < triangle_count; i++) {
+		for (int j = 0; j < 3; j++) {
+			uint32_t pa = position[p_context.indices[i * 3 + j]];
+			uint32_t pb = position[p_context.indices[i * 3 + (j + 1) % 3]];
+
+			// Interior edges are seen twice, only keep one. Border edges are only seen once.
+			bool border = (p_context.kind[pa] == KIND_BORDER && p_context.link[0][pa] == pb) || (p_context.kind[pb] == KIND_BORDER && p_context.link[1][pb] == pa);
+			if (pa > pb && !border) {
+				continue;
+			}
+
+			Collapse collapse;
+			bool found = false;
+			if (_can_collapse(p_context, pa, pb)) {
+				collapse.from = pa;
+				collapse.to = pb;
+				collapse.cost = p_context.quadrics[pa].error(p_context.vertices[pb]);
+				found = true;
+			}
+			if (_can_collapse(p_context, pb, pa)) {
+				double cost = p_context.quadrics[pb].error(p_context.vertices[pa]);
+				if (!found || cost < collapse.cost) {
+					collapse.from = pb;
+					collapse.to = pa;
+					collapse.cost = cost;
+					found = true;
+				}
+			}
+			if (found && collapse.cost <= p_max_cost) {
+				p_context.collapses.push_back(collapse);
+			}
+		}
+	}
+
+	p_context.collapses.sort();
+
+	uint8_t *collapse_locked = p_context.collapse_locked.ptr();
+	memset(collapse_locked, 0, p_context.vertex_count);
+
+	uint32_t goal = (p_context.indices.size() - p_target_index_count) / 3;
+	uint32_t removed = 0;
+	uint32_t performed = 0;
+
+	for (uint32_t i = 0; i < p_context.collapses.size() && removed < goal; i++) {
+		const Collapse &collapse = p_context.collapses[i];
+		uint32_t from = collapse.from;
+		uint32_t to = collapse.to;
+
+		if (collapse_locked[from] || collapse_locked[to]) {
+			continue;
+		}
+		if (_has_flips(p_context, from, to) || !_map_wedges(p_context, from, to)) {
+			continue;
+		}
+
+		// Neighbour triangles are about to change, so their vertices wait for the next pass.
+		for (uint32_t j = p_context.adjacency_offsets[from]; j < p_context.adjacency_offsets[from + 1]; j++) {
+			uint32_t t = p_context.adjacency[j];
+			for (int k = 0; k < 3; k++) {
+				collapse_locked[position[p_context.indices[t * 3 + k]]] = 1;
+			}
+		}
+
+		p_context.quadrics[to].add(p_context.quadrics[from]);
+
+		if (p_context.kind[from] == KIND_BORDER || p_context.kind[from] == KIND_SEAM) {
+			uint32_t other = p_context.link[0][from] == to ? p_context.link[1][from] : p_context.link[0][from];
+			_replace_link(p_context, other, from, to);
+			_replace_link(p_context, to, from, other);
+		}
+
+		removed += p_context.kind[from] == KIND_BORDER ? 1 : 2;
+		p_context.error = MAX(p_context.error, collapse.cost);
+		performed++;
+	}
+
+	if (performed == 0) {
+		return 0;
+	}
+
+	uint32_t write = 0;
+	for (uint32_t i = 0; i < triangle_count; i++) {
+		uint32_t v0 = p_context.vertex_remap[p_context.indices[i * 3 + 0]];
+		uint32_t v1 = p_context.vertex_remap[p_context.indices[i * 3 + 1]];
+		uint32_t v2 = p_context.vertex_remap[p_context.indices[i * 3 + 2]];
+
+		if (position[v0] == position[v1] || position[v1] == position[v2] || position[v2] == position[v0]) {
+			continue;
+		}
+
+		p_context.indices[write++] = v0;
+		p_context.indices[write++] = v1;
+		p_context.indices[write++] = v2;
+	}
+	p_context.indices.resize(write);
+
+	return performed;
+}
+
+void MeshSimplifier::_simplify(Context &p_context, uint32_t p_target_index_count, double p_max_cost) {
+	while (p_context.indices.size() > p_target_index_count) {
+		if (_collapse_pass(p_context, p_target_index_count, p_max_cost) == 0) {
+			break;
+		}
+	}
+}
+
+bool MeshSimplifier::_init(Context &p_context, const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<int> &p_indices) {
+	int vertex_count = p_vertices.size();
+	ERR_FAIL_COND_V(p_indices.size() % 3 != 0, false);
+	ERR_FAIL_COND_V(p_normals.size() != 0 && p_normals.size() != vertex_count, false);
+
+	p_context.vertices = p_vertices.ptr();
+	p_context.normals = p_normals.size() ? p_normals.ptr() : nullptr;
+	p_context.vertex_count = vertex_count;
+
+	_build_positions(p_context);
+
+	// Triangles that are already degenerate would confuse the classification.
+	const int *indices = p_indices.ptr();
+	p_context.indices.reserve(p_indices.size());
+	for (int i = 0; i < p_indices.size(); i += 3) {
+		for (int j = 0; j < 3; j++) {
+			ERR_FAIL_INDEX_V(indices[i + j], vertex_count, false);
+		}
+
+		uint32_t p0 = p_context.position[indices[i + 0]];
+		uint32_t p1 = p_context.position[indices[i + 1]];
+		uint32_t p2 = p_context.position[indices[i + 2]];
+		if (p0 == p1 || p1 == p2 || p2 == p0) {
+			continue;
+		}
+
+		for (int j = 0; j < 3; j++) {
+			p_context.indices.push_back(indices[i + j]);
+		}
+	}
+
+	_build_adjacency(p_context);
+	_build_quadrics(p_context);
+	_classify(p_context);
+
+	p_context.vertex_remap.resize(vertex_count);
+	p_context.wedge_target.resize(vertex_count);
+	p_context.collapse_locked.resize(vertex_count);
+	for (int i = 0; i < vertex_count; i++) {
+		p_context.vertex_remap[i] = i;
+		p_context.wedge_target[i] = INVALID_VERTEX;
+	}
+
+	return true;
+}
+
+Vector<int> MeshSimplifier::simplify(const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<int> &p_indices, int p_target_index_count, float p_max_error, float *r_error) {
+	Context context;
+	if (!_init(context, p_vertices, p_normals, p_indices)) {
+		return Vector<int>();
+	}
+
+	_simplify(context, MAX(p_target_index_count, 0), double(p_max_error) * p_max_error);
+
+	if (r_error) {
+		*r_error = Math::sqrt(context.error);
+	}
+
+	Vector<int> ret;
+	ret.resize(context.indices.size());
+	int *w = ret.ptrw();
+	for (uint32_t i = 0; i < context.indices.size(); i++) {
+		w[i] = context.indices[i];
+	}
+
+	return ret;
+}
+
+Vector<MeshSimplifier::LOD> MeshSimplifier::generate_lods(const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<int> &p_indices, float p_max_error, float p_ratio) {
+	Vector<LOD> lods;
+	ERR_FAIL_COND_V(p_ratio <= 0.0 || p_ratio >= 1.0, lods);
+
+	Context context;
+	if (!_init(context, p_vertices, p_normals, p_indices)) {
+		return lods;
+	}
+
+	// Each LOD keeps simplifying the previous one, the quadrics carry the error of the whole chain.
+	double max_cost = double(p_max_error) * p_max_error;
+	float last_error = 0.0;
+
+	while (true) {
+		uint32_t index_count = context.indices.size();
+		uint32_t target = uint32_t(index_count * p_ratio) / 3 * 3;
+
+		_simplify(context, target, max_cost);
+
+		uint32_t new_count = context.indices.size();
+		if (new_count == 0 || new_count > index_count * MIN_LOD_REDUCTION) {
+			break;
+		}
+
+		LOD lod;
+		// Flat areas collapse with no error at all, but LODs still need distinct, positive keys.
+		lod.error = MAX(float(Math::sqrt(context.error)), last_error + CMP_EPSILON);
+		lod.indices.resize(new_count);
+		int *w = lod.indices.ptrw();
+		for (uint32_t i = 0; i < new_count; i++) {
+			w[i] = context.indices[i];
+		}
+		lods.push_back(lod);
+
+		last_error = lod.error;
+	}
+
+	return lods;
+}
@@ -0,0 +1,142 @@
+/*************************************************************************/
+/*  mesh_simplifier.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "core/local_vector.h"
+#include "core/math/vector3.h"
+#include "core/vector.h"
+
+/*
+ * Quadric error mesh simplifier, used to generate LOD index buffers.
+ *
+ * Only half edge collapses are performed (a vertex is merged into one of its
+ * neighbours), so simplified triangles keep indexing the original vertex
+ * array. Vertices split along UV seams or hard normals may only collapse
+ * along the seam, with every copy moving together, and open borders may only
+ * collapse along the border. Collapses that flip triangles or join vertices
+ * whose normals diverge are rejected.
+ */
+
+class MeshSimplifier {
+public:
+	struct LOD {
+		float error = 0.0; // Geometric deviation from the source mesh, in mesh units.
+		Vector<int> indices;
+	};
+
+private:
+	enum VertexKind : uint8_t {
+		KIND_MANIFOLD, // Interior vertex, may collapse towards any neighbour.
+		KIND_BORDER, // On an open edge, may only collapse along it.
+		KIND_SEAM, // Split in two along an attribute seam, may only collapse along it.
+		KIND_LOCKED, // Complex or non-manifold, never collapses.
+	};
+
+	enum {
+		INVALID_VERTEX = 0xFFFFFFFF,
+		PENDING_VERTEX = 0xFFFFFFFE,
+	};
+
+	struct Quadric {
+		double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+		double a10 = 0.0, a20 = 0.0, a21 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double w = 0.0; // Area of the faces, only used to normalize the error.
+
+		void add(const Quadric &p_quadric);
+		void add_plane(const Vector3 &p_normal, real_t p_d, real_t p_weight);
+		// Weighted mean squared distance of p_point to the accumulated planes.
+		double error(const Vector3 &p_point) const;
+	};
+
+	struct Collapse {
+		uint32_t from = 0; // Position being removed.
+		uint32_t to = 0;
+		double cost = 0.0;
+
+		bool operator<(const Collapse &p_collapse) const { return cost < p_collapse.cost; }
+	};
+
+	// Per position data is indexed by the first vertex that has the position.
+	struct Context {
+		const Vector3 *vertices = nullptr;
+		const Vector3 *normals = nullptr; // Optional.
+		uint32_t vertex_count = 0;
+
+		LocalVector<uint32_t> indices;
+
+		LocalVector<uint32_t> position; // Vertex to position.
+		LocalVector<uint32_t> wedge; // Circular list of the vertices sharing a position.
+		LocalVector<uint8_t> kind;
+		LocalVector<uint32_t> link[2]; // Border (out, in) or seam neighbours.
+		LocalVector<Quadric> quadrics;
+
+		// Position to triangles, rebuilt for each pass.
+		LocalVector<uint32_t> adjacency_offsets;
+		LocalVector<uint32_t> adjacency;
+
+		LocalVector<Collapse> collapses;
+		LocalVector<uint32_t> vertex_remap;
+		LocalVector<uint32_t> wedge_target;
+		LocalVector<uint8_t> collapse_locked;
+
+		double error = 0.0; // Largest squared error of the collapses performed so far.
+	};
+
+	static void _build_positions(Context &p_context);
+	static void _build_adjacency(Context &p_context);
+	static void _build_quadrics(Context &p_context);
+	static void _add_edge_quadric(Context &p_context, uint32_t p_triangle, uint32_t p_from, uint32_t p_to);
+	static void _classify(Context &p_context);
+
+	static bool _can_collapse(const Context &p_context, uint32_t p_from, uint32_t p_to);
+	static void _replace_link(Context &p_context, uint32_t p_position, uint32_t p_old, uint32_t p_new);
+	static bool _map_wedges(Context &p_context, uint32_t p_from, uint32_t p_to);
+	static bool _has_flips(const Context &p_context, uint32_t p_from, uint32_t p_to);
+	static uint32_t _collapse_pass(Context &p_context, uint32_t p_target_index_count, double p_max_cost);
+	static void _simplify(Context &p_context, uint32_t p_target_index_count, double p_max_cost);
+
+	static bool _init(Context &p_context, const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<int> &p_indices);
+
+public:
+	// Simplifies a triangle list until it has at most p_target_index_count indices, or no collapse
+	// stays below p_max_error. The reached error is written to r_error.
+	static Vector<int> simplify(const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<int> &p_indices, int p_target_index_count, float p_max_error, float *r_error = nullptr);
+
+	// Generates successive LODs, each with about p_ratio times the indices of the previous one,
+	// until the error would exceed p_max_error or simplification stops making progress.
+	// Errors are strictly increasing, so they can be used as keys of a LOD dictionary.
+	static Vector<LOD> generate_lods(const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<int> &p_indices, float p_max_error, float p_ratio = 0.5);
+};
+
+#endif // MESH_SIMPLIFIER_H
@@ -111,6 +111,7 @@ public:
 	virtual real_t get_real() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const; ///< get an array of bytes
+	virtual const uint8_t *map(uint64_t p_offset, uint64_t p_length) { return nullptr; } ///< map a read only range, valid until closed or mapped again; nullptr if not supported
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(const String &p_delim = ",") const;
@@ -33,9 +33,11 @@
 #include "core/error_macros.h"
 #include "core/os/copymem.h"
 #include "core/safe_refcount.h"
+#include "core/spin_lock.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <atomic>
 
 void *operator new(size_t p_size, const char *p_description) {
 	return Memory::alloc_static(p_size, false);
@@ -66,6 +68,289 @@ uint64_t Memory::max_usage = 0;
 
 uint64_t Memory::alloc_count = 0;
 
+/* SLAB ALLOCATOR */
+
+// Small blocks are carved from pages of a single arena, so whether a pointer
+// belongs to it is a range check, and its size class is looked up per page.
+// Each thread keeps free lists per class and only takes the class lock to
+// exchange blocks in batches.
+
+enum {
+	SLAB_PAGE_SHIFT = 16,
+	SLAB_PAGE_SIZE = 1 << SLAB_PAGE_SHIFT,
+	SLAB_MAX_SIZE = 512,
+	SLAB_CLASS_COUNT = 16,
+	SLAB_BATCH = 32, // Blocks moved at once between a thread and the global lists.
+	STATS_FLUSH_OPS = 256,
+	STATS_FLUSH_BYTES = 64 * 1024,
+};
+
+static const uint32_t slab_class_sizes[SLAB_CLASS_COUNT] = { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+static uint8_t slab_size_class[SLAB_MAX_SIZE / 16 + 1];
+
+struct SlabClass {
+	SpinLock lock;
+	void *free_list = nullptr;
+};
+
+static SlabClass slab_classes[SLAB_CLASS_COUNT];
+static uint8_t *slab_arena = nullptr;
+static size_t slab_arena_size = 0;
+static uint8_t *slab_page_class = nullptr;
+static std::atomic<size_t> slab_pages_used(0);
+static bool slab_enabled = false;
+
+static std::atomic<uint64_t> stat_allocs(0);
+static std::atomic<uint64_t> stat_slab_allocs(0);
+static std::atomic<uint64_t> stat_slab_cache_hits(0);
+
+// Plain data, so it is usable from any thread at any time, including static
+// initialization.
+struct MemoryThreadData {
+	void *free_list[SLAB_CLASS_COUNT];
+	uint32_t free_count[SLAB_CLASS_COUNT];
+	bool registered;
+	bool exited;
+
+	// Statistics are accumulated here and added to the shared counters in batches.
+	uint32_t ops;
+	int64_t alloc_count;
+	int64_t usage;
+	uint64_t allocs;
+	uint64_t slab_allocs;
+	uint64_t slab_cache_hits;
+};
+
+static thread_local MemoryThreadData thread_data;
+
+static _FORCE_INLINE_ bool _slab_owns(const void *p_ptr) {
+	return uintptr_t(p_ptr) - uintptr_t(slab_arena) < slab_arena_size;
+}
+
+static void _slab_push_global(int p_class, void *p_first, void *p_last) {
+	SlabClass &sc = slab_classes[p_class];
+	sc.lock.lock();
+	*(void **)p_last = sc.free_list;
+	sc.free_list = p_first;
+	sc.lock.unlock();
+}
+
+// Takes up to p_max blocks from the global list of a class, carving a new page if empty.
+static void *_slab_pop_global(int p_class, uint32_t p_max, uint32_t &r_count) {
+	SlabClass &sc = slab_classes[p_class];
+	sc.lock.lock();
+
+	if (!sc.free_list) {
+		size_t page = slab_pages_used.fetch_add(1);
+		if (page >= (slab_arena_size >> SLAB_PAGE_SHIFT)) {
+			sc.lock.unlock();
+			r_count = 0;
+			return nullptr; // Arena exhausted.
+		}
+		slab_page_class[page] = p_class;
+
+		uint32_t size = slab_class_sizes[p_class];
+		uint8_t *base = slab_arena + (page << SLAB_PAGE_SHIFT);
+		uint32_t blocks = SLAB_PAGE_SIZE / size;
+		for (uint32_t i = 0; i < blocks - 1; i++) {
+			*(void **)(base + i * size) = base + (i + 1) * size;
+		}
+		*(void **)(base + (blocks - 1) * size) = nullptr;
+		sc.free_list = base;
+	}
+
+	void *first = sc.free_list;
+	void *last = first;
+	uint32_t count = 1;
+	while (count < p_max && *(void **)last) {
+		last = *(void **)last;
+		count++;
+	}
+	sc.free_list = *(void **)last;
+	*(void **)last = nullptr;
+
+	sc.lock.unlock();
+
+	r_count = count;
+	return first;
+}
+
+void Memory::_add_usage(int64_t p_alloc_count, int64_t p_usage) {
+	if (p_alloc_count > 0) {
+		atomic_add(&alloc_count, uint64_t(p_alloc_count));
+	} else if (p_alloc_count < 0) {
+		atomic_sub(&alloc_count, uint64_t(-p_alloc_count));
+	}
+#ifdef DEBUG_ENABLED
+	if (p_usage > 0) {
+		atomic_exchange_if_greater(&max_usage, atomic_add(&mem_usage, uint64_t(p_usage)));
+	} else if (p_usage < 0) {
+		atomic_sub(&mem_usage, uint64_t(-p_usage));
+	}
+#endif
+}
+
+static void _thread_data_flush_stats(MemoryThreadData &t) {
+	Memory::_add_usage(t.alloc_count, t.usage);
+	stat_allocs.fetch_add(t.allocs, std::memory_order_relaxed);
+	stat_slab_allocs.fetch_add(t.slab_allocs, std::memory_order_relaxed);
+	stat_slab_cache_hits.fetch_add(t.slab_cache_hits, std::memory_order_relaxed);
+
+	t.ops = 0;
+	t.alloc_count = 0;
+	t.usage = 0;
+	t.allocs = 0;
+	t.slab_allocs = 0;
+	t.slab_cache_hits = 0;
+}
+
+// Returns the cached blocks of a thread when it exits.
+struct MemoryThreadExit {
+	bool active = false;
+
+	~MemoryThreadExit() {
+		MemoryThreadData &t = thread_data;
+		for (int i = 0; i < SLAB_CLASS_COUNT; i++) {
+			if (!t.free_list[i]) {
+				continue;
+			}
+			void *last = t.free_list[i];
+			while (*(void **)last) {
+				last = *(void **)last;
+			}
+			_slab_push_global(i, t.free_list[i], last);
+			t.free_list[i] = nullptr;
+			t.free_count[i] = 0;
+		}
+
+		_thread_data_flush_stats(t);
+		t.exited = true;
+	}
+};
+
+static thread_local MemoryThreadExit thread_exit;
+
+static _FORCE_INLINE_ MemoryThreadData &_get_thread_data() {
+	MemoryThreadData &t = thread_data;
+	if (unlikely(!t.registered)) {
+		t.registered = true;
+		thread_exit.active = true; // Registers the exit handler.
+	}
+	return t;
+}
+
+static _FORCE_INLINE_ void _count_alloc(MemoryThreadData &t, int64_t p_usage) {
+	t.allocs++;
+	t.alloc_count++;
+	t.usage += p_usage;
+	if (unlikely(t.exited || ++t.ops >= STATS_FLUSH_OPS || t.usage >= STATS_FLUSH_BYTES)) {
+		_thread_data_flush_stats(t);
+	}
+}
+
+static _FORCE_INLINE_ void _count_free(MemoryThreadData &t, int64_t p_usage) {
+	t.alloc_count--;
+	t.usage -= p_usage;
+	if (unlikely(t.exited || ++t.ops >= STATS_FLUSH_OPS || t.usage <= -STATS_FLUSH_BYTES)) {
+		_thread_data_flush_stats(t);
+	}
+}
+
+static void *_slab_alloc(MemoryThreadData &t, size_t p_size) {
+	int c = slab_size_class[(p_size + 15) >> 4];
+
+	if (unlikely(t.exited)) {
+		uint32_t count;
+		return _slab_pop_global(c, 1, count);
+	}
+
+	void *mem = t.free_list[c];
+	if (likely(mem)) {
+		t.slab_cache_hits++;
+	} else {
+		mem = _slab_pop_global(c, SLAB_BATCH, t.free_count[c]);
+		if (!mem) {
+			return nullptr;
+		}
+	}
+
+	t.free_list[c] = *(void **)mem;
+	t.free_count[c]--;
+	t.slab_allocs++;
+	return mem;
+}
+
+static void _slab_free(MemoryThreadData &t, void *p_mem) {
+	int c = slab_page_class[size_t((uint8_t *)p_mem - slab_arena) >> SLAB_PAGE_SHIFT];
+
+	if (unlikely(t.exited)) {
+		*(void **)p_mem = nullptr;
+		_slab_push_global(c, p_mem, p_mem);
+		return;
+	}
+
+	*(void **)p_mem = t.free_list[c];
+	t.free_list[c] = p_mem;
+	t.free_count[c]++;
+
+	if (t.free_count[c] > SLAB_BATCH * 2) {
+		// Give a batch back, so blocks freed by other threads than the one that allocated them are reused.
+		void *last = t.free_list[c];
+		for (int i = 1; i < SLAB_BATCH; i++) {
+			last = *(void **)last;
+		}
+		void *first = t.free_list[c];
+		t.free_list[c] = *(void **)last;
+		t.free_count[c] -= SLAB_BATCH;
+		_slab_push_global(c, first, last);
+	}
+}
+
+void Memory::set_slab_allocator_enabled(bool p_enabled, size_t p_arena_size) {
+	if (p_enabled && !slab_arena) {
+		// The arena is reserved once and never released, so blocks can be freed
+		// regardless of the current setting.
+		ERR_FAIL_COND(p_arena_size < SLAB_PAGE_SIZE);
+		size_t pages = p_arena_size >> SLAB_PAGE_SHIFT;
+		uint8_t *page_class = (uint8_t *)malloc(pages);
+		uint8_t *arena = (uint8_t *)malloc(pages << SLAB_PAGE_SHIFT);
+		if (!arena || !page_class) {
+			::free(arena);
+			::free(page_class);
+			ERR_FAIL_MSG("Can't reserve the slab allocator arena.");
+		}
+
+		int c = 0;
+		for (int i = 0; i <= SLAB_MAX_SIZE / 16; i++) {
+			while (slab_class_sizes[c] < uint32_t(i * 16)) {
+				c++;
+			}
+			slab_size_class[i] = c;
+		}
+
+		slab_page_class = page_class;
+		slab_arena_size = pages << SLAB_PAGE_SHIFT;
+		slab_arena = arena;
+	}
+
+	slab_enabled = p_enabled && slab_arena;
+}
+
+bool Memory::is_slab_allocator_enabled() {
+	return slab_enabled;
+}
+
+Memory::AllocatorStats Memory::get_allocator_stats() {
+	AllocatorStats stats;
+	stats.allocs = stat_allocs.load(std::memory_order_relaxed);
+	stats.slab_allocs = stat_slab_allocs.load(std::memory_order_relaxed);
+	stats.slab_cache_hits = stat_slab_cache_hits.load(std::memory_order_relaxed);
+	stats.slab_arena_used = MIN(slab_pages_used.load(std::memory_order_relaxed) << SLAB_PAGE_SHIFT, slab_arena_size);
+	return stats;
+}
+
+/* ALLOCATION */
+
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 #ifdef DEBUG_ENABLED
 	bool prepad = true;
@@ -73,11 +358,24 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
-	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+	MemoryThreadData &t = _get_thread_data();
+	size_t size = p_bytes + (prepad ? PAD_ALIGN : 0);
+
+	void *mem = nullptr;
+	if (slab_enabled && size <= SLAB_MAX_SIZE) {
+		mem = _slab_alloc(t, size);
+	}
+	if (!mem) {
+		mem = malloc(size);
+	}
 
 	ERR_FAIL_COND_V(!mem, nullptr);
 
-	atomic_increment(&alloc_count);
+#ifdef DEBUG_ENABLED
+	_count_alloc(t, p_bytes);
+#else
+	_count_alloc(t, 0);
+#endif
 
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
@@ -85,10 +383,6 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
 		uint8_t *s8 = (uint8_t *)mem;
 
-#ifdef DEBUG_ENABLED
-		atomic_add(&mem_usage, p_bytes);
-		atomic_exchange_if_greater(&max_usage, mem_usage);
-#endif
 		return s8 + PAD_ALIGN;
 	} else {
 		return mem;
@@ -110,21 +404,45 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 
 	if (prepad) {
 		mem -= PAD_ALIGN;
-		uint64_t *s = (uint64_t *)mem;
+	}
 
+	if (_slab_owns(mem)) {
+		// Slab blocks can't grow in place, but can shrink or grow within their size class.
+		uint32_t capacity = slab_class_sizes[slab_page_class[size_t(mem - slab_arena) >> SLAB_PAGE_SHIFT]];
+		if (p_bytes > 0 && p_bytes + (prepad ? PAD_ALIGN : 0) <= capacity) {
+			if (prepad) {
+				uint64_t *s = (uint64_t *)mem;
 #ifdef DEBUG_ENABLED
-		if (p_bytes > *s) {
-			atomic_add(&mem_usage, p_bytes - *s);
-			atomic_exchange_if_greater(&max_usage, mem_usage);
-		} else {
-			atomic_sub(&mem_usage, *s - p_bytes);
-		}
+				MemoryThreadData &t = _get_thread_data();
+				t.usage += int64_t(p_bytes) - int64_t(*s);
 #endif
+				*s = p_bytes;
+			}
+			return p_memory;
+		}
+
+		void *new_mem = nullptr;
+		if (p_bytes > 0) {
+			new_mem = alloc_static(p_bytes, p_pad_align);
+			ERR_FAIL_COND_V(!new_mem, nullptr);
+			size_t old_bytes = prepad ? *(uint64_t *)mem : capacity;
+			copymem(new_mem, p_memory, MIN(old_bytes, p_bytes));
+		}
+		free_static(p_memory, p_pad_align);
+		return new_mem;
+	}
+
+	if (prepad) {
+		uint64_t *s = (uint64_t *)mem;
 
 		if (p_bytes == 0) {
-			free(mem);
+			free_static(p_memory, p_pad_align);
 			return nullptr;
 		} else {
+#ifdef DEBUG_ENABLED
+			MemoryThreadData &t = _get_thread_data();
+			t.usage += int64_t(p_bytes) - int64_t(*s);
+#endif
 			*s = p_bytes;
 
 			mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
@@ -156,17 +474,20 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
-	atomic_decrement(&alloc_count);
+	MemoryThreadData &t = _get_thread_data();
 
 	if (prepad) {
 		mem -= PAD_ALIGN;
+	}
 
 #ifdef DEBUG_ENABLED
-		uint64_t *s = (uint64_t *)mem;
-		atomic_sub(&mem_usage, *s);
+	_count_free(t, *(uint64_t *)mem);
+#else
+	_count_free(t, 0);
 #endif
 
-		free(mem);
+	if (_slab_owns(mem)) {
+		_slab_free(t, mem);
 	} else {
 		free(mem);
 	}
@@ -178,6 +499,7 @@ uint64_t Memory::get_mem_available() {
 
 uint64_t Memory::get_mem_usage() {
 #ifdef DEBUG_ENABLED
+	_thread_data_flush_stats(_get_thread_data()); // Include this thread's pending counts.
 	return mem_usage;
 #else
 	return 0;
@@ -186,6 +508,7 @@ uint64_t Memory::get_mem_usage() {
 
 uint64_t Memory::get_mem_max_usage() {
 #ifdef DEBUG_ENABLED
+	_thread_data_flush_stats(_get_thread_data());
 	return max_usage;
 #else
 	return 0;
@@ -50,6 +50,16 @@ class Memory {
 	static uint64_t alloc_count;
 
 public:
+	struct AllocatorStats {
+		uint64_t allocs = 0;
+		uint64_t slab_allocs = 0;
+		uint64_t slab_cache_hits = 0; // Slab allocations served from the thread's own free lists.
+		uint64_t slab_arena_used = 0;
+	};
+
+	// Statistics are gathered per thread and published in batches.
+	static void _add_usage(int64_t p_alloc_count, int64_t p_usage);
+
 	static void *alloc_static(size_t p_bytes, bool p_pad_align = false);
 	static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false);
 	static void free_static(void *p_ptr, bool p_pad_align = false);
@@ -57,6 +67,11 @@ public:
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+
+	// Serves small allocations from size classes of a preallocated arena instead of malloc.
+	static void set_slab_allocator_enabled(bool p_enabled, size_t p_arena_size = 0);
+	static bool is_slab_allocator_enabled();
+	static AllocatorStats get_allocator_stats();
 };
 
 class DefaultAllocator {
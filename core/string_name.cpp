@@ -32,6 +32,9 @@
 
 #include "core/os/os.h"
 #include "core/print_string.h"
+#include "core/spin_lock.h"
+
+#include <thread>
 
 StaticCString StaticCString::create(const char *p_ptr) {
 	StaticCString scs;
@@ -39,30 +42,230 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+std::atomic<StringName::_Data *> StringName::_table[STRING_TABLE_LEN];
 
 StringName _scs_create(const char *p_chr) {
 	return (p_chr[0] ? StringName(StaticCString::create(p_chr)) : StringName());
 }
 
 bool StringName::configured = false;
-Mutex StringName::mutex;
+
+StringName::_Data *StringName::retired = nullptr;
+uint32_t StringName::retired_count = 0;
+
+enum {
+	WRITE_SHARDS = 64,
+	READER_SLOTS = 32,
+	RECLAIM_THRESHOLD = 128, // Removed entries waiting before lookups are synchronized with.
+};
+
+// Writers to buckets of different shards never contend.
+struct alignas(64) WriteShard {
+	SpinLock lock;
+};
+
+static WriteShard write_shards[WRITE_SHARDS];
+
+// Lookups announce themselves in the counter of the current epoch parity, in
+// a slot shared by a few threads. Reclaiming flips the epoch and waits for the
+// counters of the previous one to drain, after which no lookup can hold a
+// pointer to an entry removed before the flip.
+struct alignas(64) ReaderSlot {
+	std::atomic<uint32_t> count[2] = { { 0 }, { 0 } };
+};
+
+static ReaderSlot reader_slots[READER_SLOTS];
+static std::atomic<uint32_t> reader_epoch(0);
+static std::atomic<uint32_t> reader_slot_next(0);
+static thread_local int32_t reader_slot = -1;
+
+static SpinLock retire_lock;
+static std::atomic_flag reclaiming = ATOMIC_FLAG_INIT;
+
+static _FORCE_INLINE_ ReaderSlot &_get_reader_slot() {
+	if (unlikely(reader_slot < 0)) {
+		reader_slot = reader_slot_next.fetch_add(1) % READER_SLOTS;
+	}
+	return reader_slots[reader_slot];
+}
+
+static _FORCE_INLINE_ uint32_t _read_begin(ReaderSlot &p_slot) {
+	while (true) {
+		uint32_t epoch = reader_epoch.load();
+		p_slot.count[epoch & 1].fetch_add(1);
+		if (reader_epoch.load() == epoch) {
+			return epoch;
+		}
+		// A reclaim flipped the epoch meanwhile, it may not have seen this reader.
+		p_slot.count[epoch & 1].fetch_sub(1, std::memory_order_release);
+	}
+}
+
+static _FORCE_INLINE_ void _read_end(ReaderSlot &p_slot, uint32_t p_epoch) {
+	p_slot.count[p_epoch & 1].fetch_sub(1, std::memory_order_release);
+}
+
+bool StringName::_Data::matches(const char *p_name) const {
+	if (cname) {
+		return strcmp(cname, p_name) == 0;
+	}
+	return name == p_name;
+}
+
+bool StringName::_Data::matches(const CharType *p_name) const {
+	if (cname) {
+		const char *c = cname;
+		while (*c && CharType(*c) == *p_name) {
+			c++;
+			p_name++;
+		}
+		return CharType(*c) == *p_name;
+	}
+	return name == p_name;
+}
+
+bool StringName::_Data::matches(const String &p_name) const {
+	if (cname) {
+		return p_name == cname;
+	}
+	return name == p_name;
+}
+
+// Returns a new reference to an existing entry, or nullptr. Doesn't lock.
+template <class T>
+StringName::_Data *StringName::_find(uint32_t p_hash, const T &p_name) {
+	ReaderSlot &slot = _get_reader_slot();
+	uint32_t epoch = _read_begin(slot);
+
+	_Data *data = _table[p_hash & STRING_TABLE_MASK].load(std::memory_order_acquire);
+	while (data) {
+		// Compare hash first. Entries being removed have no references left and can't be revived.
+		if (data->hash == p_hash && data->matches(p_name) && data->refcount.ref()) {
+			break;
+		}
+		data = data->next.load(std::memory_order_acquire);
+	}
+
+	_read_end(slot, epoch);
+	return data;
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(uint32_t p_hash, const T &p_name, const char *p_cname) {
+	_Data *data = _find(p_hash, p_name);
+	if (data) {
+		return data;
+	}
+
+	uint32_t idx = p_hash & STRING_TABLE_MASK;
+	WriteShard &shard = write_shards[idx % WRITE_SHARDS];
+	shard.lock.lock();
+
+	// Another thread may have added it since.
+	data = _table[idx].load(std::memory_order_relaxed);
+	while (data) {
+		if (data->hash == p_hash && data->matches(p_name) && data->refcount.ref()) {
+			shard.lock.unlock();
+			return data;
+		}
+		data = data->next.load(std::memory_order_relaxed);
+	}
+
+	data = memnew(_Data);
+	if (p_cname) {
+		data->cname = p_cname;
+	} else {
+		data->name = p_name;
+	}
+	data->refcount.init();
+	data->hash = p_hash;
+	data->idx = idx;
+
+	_Data *first = _table[idx].load(std::memory_order_relaxed);
+	data->next.store(first, std::memory_order_relaxed);
+	if (first) {
+		first->prev = data;
+	}
+	// Publishes the fully constructed entry to lookups.
+	_table[idx].store(data, std::memory_order_release);
+
+	shard.lock.unlock();
+	return data;
+}
+
+void StringName::_remove(_Data *p_data) {
+	WriteShard &shard = write_shards[p_data->idx % WRITE_SHARDS];
+	shard.lock.lock();
+
+	// Lookups already past this entry still find the rest of the bucket through its next pointer.
+	_Data *next = p_data->next.load(std::memory_order_relaxed);
+	if (p_data->prev) {
+		p_data->prev->next.store(next, std::memory_order_release);
+	} else {
+		if (_table[p_data->idx].load(std::memory_order_relaxed) != p_data) {
+			ERR_PRINT("BUG!");
+		}
+		_table[p_data->idx].store(next, std::memory_order_release);
+	}
+	if (next) {
+		next->prev = p_data->prev;
+	}
+
+	shard.lock.unlock();
+
+	retire_lock.lock();
+	p_data->retired_next = retired;
+	retired = p_data;
+	retired_count++;
+	bool reclaim = retired_count >= RECLAIM_THRESHOLD;
+	retire_lock.unlock();
+
+	if (reclaim) {
+		_reclaim();
+	}
+}
+
+void StringName::_reclaim() {
+	if (reclaiming.test_and_set(std::memory_order_acquire)) {
+		return; // Another thread is reclaiming, these entries will be in the next batch.
+	}
+
+	retire_lock.lock();
+	_Data *data = retired;
+	retired = nullptr;
+	retired_count = 0;
+	retire_lock.unlock();
+
+	// All these entries are unlinked, wait for the lookups which could still be reading them.
+	uint32_t epoch = reader_epoch.fetch_add(1);
+	for (int i = 0; i < READER_SLOTS; i++) {
+		while (reader_slots[i].count[epoch & 1].load(std::memory_order_acquire)) {
+			std::this_thread::yield();
+		}
+	}
+
+	reclaiming.clear(std::memory_order_release);
+
+	while (data) {
+		_Data *next = data->retired_next;
+		memdelete(data);
+		data = next;
+	}
+}
 
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		_table[i] = nullptr;
+		_table[i].store(nullptr, std::memory_order_relaxed);
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
-	MutexLock lock(mutex);
-
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		while (_table[i]) {
-			_Data *d = _table[i];
+		_Data *d = _table[i].load(std::memory_order_relaxed);
+		while (d) {
 			lost_strings++;
 			if (OS::get_singleton()->is_stdout_verbose()) {
 				if (d->cname) {
@@ -72,34 +275,29 @@ void StringName::cleanup() {
 				}
 			}
 
-			_table[i] = _table[i]->next;
+			_Data *next = d->next.load(std::memory_order_relaxed);
 			memdelete(d);
+			d = next;
 		}
+		_table[i].store(nullptr, std::memory_order_relaxed);
 	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+
+	while (retired) {
+		_Data *next = retired->retired_next;
+		memdelete(retired);
+		retired = next;
+	}
+	retired_count = 0;
 }
 
 void StringName::unref() {
 	ERR_FAIL_COND(!configured);
 
 	if (_data && _data->refcount.unref()) {
-		MutexLock lock(mutex);
-
-		if (_data->prev) {
-			_data->prev->next = _data->next;
-		} else {
-			if (_table[_data->idx] != _data) {
-				ERR_PRINT("BUG!");
-			}
-			_table[_data->idx] = _data->next;
-		}
-
-		if (_data->next) {
-			_data->next->prev = _data->prev;
-		}
-		memdelete(_data);
+		_remove(_data);
 	}
 
 	_data = nullptr;
@@ -162,41 +360,7 @@ StringName::StringName(const char *p_name) {
 		return; //empty, ignore
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _intern(String::hash(p_name), p_name, nullptr);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -206,41 +370,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _intern(String::hash(p_static_string.ptr), p_static_string.ptr, p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name) {
@@ -252,39 +382,7 @@ StringName::StringName(const String &p_name) {
 		return;
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = p_name.hash();
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _intern(p_name.hash(), p_name, nullptr);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -295,23 +393,9 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		return StringName(_data);
+	_Data *data = _find(String::hash(p_name), p_name);
+	if (data) {
+		return StringName(data);
 	}
 
 	return StringName(); //does not exist
@@ -325,24 +409,9 @@ StringName StringName::search(const CharType *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		return StringName(_data);
+	_Data *data = _find(String::hash(p_name), p_name);
+	if (data) {
+		return StringName(data);
 	}
 
 	return StringName(); //does not exist
@@ -351,24 +420,9 @@ StringName StringName::search(const CharType *p_name) {
 StringName StringName::search(const String &p_name) {
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name()) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		return StringName(_data);
+	_Data *data = _find(p_name.hash(), p_name);
+	if (data) {
+		return StringName(data);
 	}
 
 	return StringName(); //does not exist
@@ -35,6 +35,8 @@
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
+#include <atomic>
+
 class Main;
 
 struct StaticCString {
@@ -50,20 +52,27 @@ class StringName {
 		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
 	};
 
+	// Lookups walk the buckets without locking, through the atomic next
+	// pointers. Insertions and removals lock the shard owning the bucket,
+	// and removed entries are only deleted once no lookup can still see them.
 	struct _Data {
 		SafeRefCount refcount;
 		const char *cname = nullptr;
 		String name;
 
 		String get_name() const { return cname ? String(cname) : name; }
+		bool matches(const char *p_name) const;
+		bool matches(const CharType *p_name) const;
+		bool matches(const String &p_name) const;
 		int idx = 0;
 		uint32_t hash = 0;
-		_Data *prev = nullptr;
-		_Data *next = nullptr;
+		_Data *prev = nullptr; // Only used under the shard lock.
+		std::atomic<_Data *> next = { nullptr };
+		_Data *retired_next = nullptr;
 		_Data() {}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	static std::atomic<_Data *> _table[STRING_TABLE_LEN];
 
 	_Data *_data = nullptr;
 
@@ -76,11 +85,20 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 	friend class Main;
-	static Mutex mutex;
 	static void setup();
 	static void cleanup();
 	static bool configured;
 
+	static _Data *retired;
+	static uint32_t retired_count;
+
+	template <class T>
+	static _Data *_find(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_intern(uint32_t p_hash, const T &p_name, const char *p_cname);
+	static void _remove(_Data *p_data);
+	static void _reclaim();
+
 	StringName(_Data *p_data) { _data = p_data; }
 
 public:
@@ -32,50 +32,350 @@
 
 #include "core/os/os.h"
 
+ThreadWorkPool *ThreadWorkPool::singleton = nullptr;
+thread_local ThreadWorkPool *ThreadWorkPool::current_pool = nullptr;
+thread_local int32_t ThreadWorkPool::current_thread = -1;
+
+void ThreadWorkPool::JobQueue::push_back(Group *p_group) {
+	lock.lock();
+	uint32_t capacity = ring.size();
+	if (count == capacity) {
+		// Grow and unwrap, so head goes back to zero.
+		uint32_t new_capacity = MAX(capacity * 2, 16u);
+		LocalVector<Group *> new_ring;
+		new_ring.resize(new_capacity);
+		for (uint32_t i = 0; i < count; i++) {
+			new_ring[i] = ring[(head + i) % capacity];
+		}
+		ring = new_ring;
+		head = 0;
+		capacity = new_capacity;
+	}
+	ring[(head + count) % capacity] = p_group;
+	count++;
+	lock.unlock();
+}
+
+ThreadWorkPool::Group *ThreadWorkPool::JobQueue::pop_back() {
+	Group *group = nullptr;
+	lock.lock();
+	if (count > 0) {
+		count--;
+		group = ring[(head + count) % ring.size()];
+	}
+	lock.unlock();
+	return group;
+}
+
+ThreadWorkPool::Group *ThreadWorkPool::JobQueue::pop_front() {
+	Group *group = nullptr;
+	lock.lock();
+	if (count > 0) {
+		group = ring[head];
+		head = (head + 1) % ring.size();
+		count--;
+	}
+	lock.unlock();
+	return group;
+}
+
 void ThreadWorkPool::_thread_function(ThreadData *p_thread) {
+	current_pool = p_thread->pool;
+	current_thread = p_thread->index;
+
+	while (true) {
+		p_thread->pool->work_available.wait();
+		if (p_thread->pool->exit.load()) {
+			break;
+		}
+		while (p_thread->pool->_execute_one_job()) {
+		}
+	}
+
+	current_pool = nullptr;
+	current_thread = -1;
+}
+
+ThreadWorkPool::Group *ThreadWorkPool::_alloc_group() {
+	Group *group;
+	groups_lock.lock();
+	if (free_groups.size()) {
+		group = groups[free_groups[free_groups.size() - 1]];
+		free_groups.resize(free_groups.size() - 1);
+	} else {
+		group = memnew(Group);
+		group->slot = groups.size();
+		groups.push_back(group);
+	}
+	group->used = true;
+	group->completed = false;
+	groups_lock.unlock();
+	return group;
+}
+
+void ThreadWorkPool::_free_group(Group *p_group) {
+	if (p_group->work) {
+		if ((uint8_t *)p_group->work == p_group->work_inline) {
+			p_group->work->~BaseWork();
+		} else {
+			memdelete(p_group->work);
+		}
+		p_group->work = nullptr;
+	}
+
+	groups_lock.lock();
+	p_group->used = false;
+	p_group->generation++;
+	if (p_group->generation == 0) {
+		p_group->generation = 1; // Zero would make INVALID_GROUP_ID valid again.
+	}
+	p_group->dependents.clear();
+	free_groups.push_back(p_group->slot);
+	groups_lock.unlock();
+}
+
+ThreadWorkPool::Group *ThreadWorkPool::_get_group(GroupID p_group) const {
+	// Must be called with groups_lock held.
+	uint32_t slot = p_group & 0xFFFFFFFF;
+	uint32_t generation = p_group >> 32;
+	if (slot >= groups.size()) {
+		return nullptr;
+	}
+	Group *group = groups[slot];
+	if (!group->used || group->generation != generation) {
+		return nullptr;
+	}
+	return group;
+}
+
+ThreadWorkPool::GroupID ThreadWorkPool::_add_group(Group *p_group, uint32_t p_elements, uint32_t p_batch_size, const GroupID *p_dependencies, uint32_t p_dependency_count) {
+	if (p_batch_size == 0) {
+		p_batch_size = MAX(1u, p_elements / (MAX(thread_count, 1u) * AUTO_BATCH_DIVISOR));
+	}
+
+	uint32_t batches = p_elements / p_batch_size + ((p_elements % p_batch_size) ? 1 : 0);
+
+	p_group->max_elements = p_elements;
+	p_group->batch_size = p_batch_size;
+	p_group->runner_count = CLAMP(batches, 1u, MAX(thread_count, 1u));
+	p_group->index.store(0);
+	p_group->pending_runners.store(0);
+	// The extra dependency keeps the group from being dispatched while registering.
+	p_group->pending_dependencies.store(1);
+
+	GroupID id;
+
+	groups_lock.lock();
+	id = _make_id(p_group);
+	for (uint32_t i = 0; i < p_dependency_count; i++) {
+		Group *dependency = _get_group(p_dependencies[i]);
+		if (!dependency || dependency->completed) {
+			continue; // Already done (or already waited for).
+		}
+		dependency->dependents.push_back(p_group);
+		p_group->pending_dependencies.fetch_add(1);
+	}
+	groups_lock.unlock();
+
+	if (p_group->pending_dependencies.fetch_sub(1) == 1) {
+		_dispatch_group(p_group);
+	}
+
+	return id;
+}
+
+void ThreadWorkPool::_dispatch_group(Group *p_group) {
+	p_group->pending_runners.store(p_group->runner_count);
+
+	JobQueue *queue = is_working_thread() ? &queues[current_thread] : &queues[thread_count];
+	for (uint32_t i = 0; i < p_group->runner_count; i++) {
+		queue->push_back(p_group);
+	}
+	for (uint32_t i = 0; i < MIN(p_group->runner_count, thread_count); i++) {
+		work_available.post();
+	}
+}
+
+void ThreadWorkPool::_run_batches(Group *p_group) {
 	while (true) {
-		p_thread->start.wait();
-		if (p_thread->exit.load()) {
+		uint32_t from = p_group->index.fetch_add(p_group->batch_size, std::memory_order_relaxed);
+		if (from >= p_group->max_elements) {
 			break;
 		}
-		p_thread->work->work();
-		p_thread->completed.post();
+		uint32_t to = MIN(from + p_group->batch_size, p_group->max_elements);
+		for (uint32_t i = from; i < to; i++) {
+			p_group->work->work(i);
+		}
+	}
+}
+
+void ThreadWorkPool::_retire_runner(Group *p_group) {
+	if (p_group->pending_runners.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+		return;
+	}
+
+	// Last runner out, the group is complete.
+	LocalVector<Group *> dependents;
+	groups_lock.lock();
+	p_group->completed = true;
+	dependents = p_group->dependents;
+	p_group->dependents.clear();
+	groups_lock.unlock();
+
+	for (uint32_t i = 0; i < dependents.size(); i++) {
+		if (dependents[i]->pending_dependencies.fetch_sub(1) == 1) {
+			_dispatch_group(dependents[i]);
+		}
 	}
+
+	// Nothing may touch the group after this, the waiter releases it.
+	p_group->done.post();
+}
+
+bool ThreadWorkPool::_join_group(Group *p_group) {
+	uint32_t runners = p_group->pending_runners.load();
+	while (runners > 0) {
+		if (p_group->pending_runners.compare_exchange_weak(runners, runners + 1)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ThreadWorkPool::_execute_one_job() {
+	Group *group = nullptr;
+
+	if (is_working_thread()) {
+		group = queues[current_thread].pop_back();
+	}
+	if (!group) {
+		group = queues[thread_count].pop_front();
+	}
+	if (!group) {
+		// Steal, starting from the neighbor so thieves spread out.
+		uint32_t start = is_working_thread() ? current_thread + 1 : 0;
+		for (uint32_t i = 0; i < thread_count && !group; i++) {
+			uint32_t victim = (start + i) % thread_count;
+			if (is_working_thread() && victim == uint32_t(current_thread)) {
+				continue;
+			}
+			group = queues[victim].pop_front();
+		}
+	}
+
+	if (!group) {
+		return false;
+	}
+
+	_run_batches(group);
+	_retire_runner(group);
+	return true;
+}
+
+bool ThreadWorkPool::is_group_completed(GroupID p_group) const {
+	const_cast<SpinLock &>(groups_lock).lock();
+	Group *group = _get_group(p_group);
+	bool completed = !group || group->completed;
+	const_cast<SpinLock &>(groups_lock).unlock();
+	return completed;
+}
+
+void ThreadWorkPool::wait_for_group(GroupID p_group) {
+	groups_lock.lock();
+	Group *group = _get_group(p_group);
+	groups_lock.unlock();
+
+	ERR_FAIL_COND_MSG(!group, "Invalid or already waited for group.");
+
+	bool joined = false;
+	while (!group->done.try_wait()) {
+		if (!joined && _join_group(group)) {
+			// Help with our own batches first.
+			_run_batches(group);
+			_retire_runner(group);
+			joined = true;
+			continue;
+		}
+
+		if (thread_count > 0 && !is_working_thread()) {
+			if (joined || !_execute_one_job()) {
+				// Workers will get to the rest, wake up when the group completes.
+				group->done.wait();
+				break;
+			}
+		} else if (!_execute_one_job()) {
+			// Workers must never block while waiting (the rest of the group may
+			// sit in their own queue), and without workers everything runs here.
+			std::this_thread::yield();
+		}
+	}
+
+	_free_group(group);
 }
 
 void ThreadWorkPool::init(int p_thread_count) {
-	ERR_FAIL_COND(threads != nullptr);
+	ERR_FAIL_COND(queues != nullptr);
 	if (p_thread_count < 0) {
 		p_thread_count = OS::get_singleton()->get_processor_count();
 	}
 
+	exit.store(false);
+
 	thread_count = p_thread_count;
+	queue_count = thread_count + 1;
+	queues = memnew_arr(JobQueue, queue_count);
 	threads = memnew_arr(ThreadData, thread_count);
 
 	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(false);
+		threads[i].pool = this;
+		threads[i].index = i;
 		threads[i].thread = memnew(std::thread(ThreadWorkPool::_thread_function, &threads[i]));
 	}
 }
 
 void ThreadWorkPool::finish() {
-	if (threads == nullptr) {
+	if (queues == nullptr) {
 		return;
 	}
 
+	exit.store(true);
 	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(true);
-		threads[i].start.post();
+		work_available.post();
 	}
 	for (uint32_t i = 0; i < thread_count; i++) {
 		threads[i].thread->join();
 		memdelete(threads[i].thread);
 	}
 
-	memdelete_arr(threads);
-	threads = nullptr;
+	if (threads) {
+		memdelete_arr(threads);
+		threads = nullptr;
+	}
+	thread_count = 0;
+
+	memdelete_arr(queues);
+	queues = nullptr;
+	queue_count = 0;
+
+	for (uint32_t i = 0; i < groups.size(); i++) {
+		ERR_CONTINUE_MSG(groups[i]->used, "Group was never waited for.");
+		memdelete(groups[i]);
+	}
+	groups.reset();
+	free_groups.reset();
+}
+
+ThreadWorkPool::ThreadWorkPool(bool p_make_singleton) {
+	exit.store(false);
+	if (p_make_singleton) {
+		ERR_FAIL_COND_MSG(singleton != nullptr, "A ThreadWorkPool singleton already exists.");
+		singleton = this;
+	}
 }
 
 ThreadWorkPool::~ThreadWorkPool() {
 	finish();
+	if (singleton == this) {
+		singleton = nullptr;
+	}
 }
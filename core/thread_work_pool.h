@@ -31,19 +31,37 @@
 #ifndef THREAD_WORK_POOL_H
 #define THREAD_WORK_POOL_H
 
+#include "core/local_vector.h"
 #include "core/os/memory.h"
 #include "core/os/semaphore.h"
+#include "core/spin_lock.h"
 
 #include <atomic>
 #include <thread>
 
+/*
+ * Work stealing job pool.
+ *
+ * Work is submitted as groups: a method called once for every element index
+ * in [0, p_elements). Elements are handed out in batches of p_batch_size from
+ * an atomic cursor by a handful of runner jobs. Runners are queued on the
+ * submitting worker's own deque (or on a shared injection queue when the
+ * submitter is not a worker), and idle workers steal from the other end.
+ *
+ * Groups may depend on other groups; they are only dispatched once all their
+ * dependencies are completed. Every group must be waited on exactly once with
+ * wait_for_group(), from a single thread, which also releases it. The waiting
+ * thread helps processing the group instead of idling.
+ */
+
 class ThreadWorkPool {
-	std::atomic<uint32_t> index;
+public:
+	typedef uint64_t GroupID;
+	static const GroupID INVALID_GROUP_ID = 0;
 
+private:
 	struct BaseWork {
-		std::atomic<uint32_t> *index;
-		uint32_t max_elements;
-		virtual void work() = 0;
+		virtual void work(uint32_t p_index) = 0;
 		virtual ~BaseWork() = default;
 	};
 
@@ -52,59 +70,135 @@ class ThreadWorkPool {
 		C *instance;
 		M method;
 		U userdata;
-		virtual void work() {
-			while (true) {
-				uint32_t work_index = index->fetch_add(1, std::memory_order_relaxed);
-				if (work_index >= max_elements) {
-					break;
-				}
-				(instance->*method)(work_index, userdata);
-			}
+		virtual void work(uint32_t p_index) {
+			(instance->*method)(p_index, userdata);
 		}
 	};
 
+	enum {
+		WORK_INLINE_SIZE = 64, // Large enough for an instance, a method pointer and a small userdata.
+		AUTO_BATCH_DIVISOR = 4, // Automatic batches aim for this many batches per thread.
+	};
+
+	struct Group {
+		uint32_t slot = 0;
+		uint32_t generation = 1;
+		bool used = false;
+		bool completed = false; // Protected by groups_lock.
+
+		BaseWork *work = nullptr;
+		alignas(16) uint8_t work_inline[WORK_INLINE_SIZE];
+
+		uint32_t max_elements = 0;
+		uint32_t batch_size = 1;
+		uint32_t runner_count = 0;
+		std::atomic<uint32_t> index;
+		std::atomic<uint32_t> pending_runners;
+		std::atomic<uint32_t> pending_dependencies;
+		LocalVector<Group *> dependents; // Protected by groups_lock.
+		Semaphore done;
+	};
+
+	// Double ended job queue, the owner thread pushes and pops from the back,
+	// thieves take from the front.
+	struct JobQueue {
+		SpinLock lock;
+		LocalVector<Group *> ring;
+		uint32_t head = 0;
+		uint32_t count = 0;
+
+		void push_back(Group *p_group);
+		Group *pop_back();
+		Group *pop_front();
+	};
+
 	struct ThreadData {
-		std::thread *thread;
-		Semaphore start;
-		Semaphore completed;
-		std::atomic<bool> exit;
-		BaseWork *work;
+		std::thread *thread = nullptr;
+		ThreadWorkPool *pool = nullptr;
+		uint32_t index = 0;
 	};
 
 	ThreadData *threads = nullptr;
 	uint32_t thread_count = 0;
 
+	// One queue per worker, plus the injection queue used by external threads.
+	JobQueue *queues = nullptr;
+	uint32_t queue_count = 0;
+
+	Semaphore work_available;
+	std::atomic<bool> exit;
+
+	SpinLock groups_lock;
+	LocalVector<Group *> groups;
+	LocalVector<uint32_t> free_groups;
+
+	static ThreadWorkPool *singleton;
+
+	static thread_local ThreadWorkPool *current_pool;
+	static thread_local int32_t current_thread;
+
 	static void _thread_function(ThreadData *p_thread);
 
+	Group *_alloc_group();
+	void _free_group(Group *p_group);
+	Group *_get_group(GroupID p_group) const;
+	_FORCE_INLINE_ GroupID _make_id(const Group *p_group) const { return (uint64_t(p_group->generation) << 32) | uint64_t(p_group->slot); }
+
+	GroupID _add_group(Group *p_group, uint32_t p_elements, uint32_t p_batch_size, const GroupID *p_dependencies, uint32_t p_dependency_count);
+	void _dispatch_group(Group *p_group);
+	void _run_batches(Group *p_group);
+	void _retire_runner(Group *p_group);
+	bool _join_group(Group *p_group);
+	bool _execute_one_job();
+
 public:
+	static ThreadWorkPool *get_singleton() { return singleton; }
+
+	// Queues p_method to be called for every index in [0, p_elements) and returns immediately.
+	// A p_batch_size of 0 picks a batch size based on the element and thread counts.
 	template <class C, class M, class U>
-	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-		ERR_FAIL_COND(!threads); //never initialized
+	GroupID add_group_task(C *p_instance, M p_method, U p_userdata, uint32_t p_elements, uint32_t p_batch_size = 1, const GroupID *p_dependencies = nullptr, uint32_t p_dependency_count = 0) {
+		ERR_FAIL_COND_V(!queues, INVALID_GROUP_ID); //never initialized
 
-		index.store(0);
+		Group *group = _alloc_group();
 
-		Work<C, M, U> *w = memnew((Work<C, M, U>));
+		typedef Work<C, M, U> WorkType;
+		WorkType *w;
+		if (sizeof(WorkType) <= WORK_INLINE_SIZE) {
+			w = memnew_placement(group->work_inline, WorkType);
+		} else {
+			w = memnew(WorkType);
+		}
 		w->instance = p_instance;
-		w->userdata = p_userdata;
 		w->method = p_method;
-		w->index = &index;
-		w->max_elements = p_elements;
+		w->userdata = p_userdata;
+		group->work = w;
 
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].work = w;
-			threads[i].start.post();
-		}
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].completed.wait();
-			threads[i].work = nullptr;
-		}
+		return _add_group(group, p_elements, p_batch_size, p_dependencies, p_dependency_count);
+	}
 
-		memdelete(w);
+	template <class C, class M, class U>
+	GroupID add_task(C *p_instance, M p_method, U p_userdata, const GroupID *p_dependencies = nullptr, uint32_t p_dependency_count = 0) {
+		return add_group_task(p_instance, p_method, p_userdata, 1, 1, p_dependencies, p_dependency_count);
 	}
 
+	bool is_group_completed(GroupID p_group) const;
+	void wait_for_group(GroupID p_group);
+
+	// Blocking helper, equivalent to waiting on add_group_task().
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata, uint32_t p_batch_size = 1) {
+		wait_for_group(add_group_task(p_instance, p_method, p_userdata, p_elements, p_batch_size));
+	}
+
+	uint32_t get_thread_count() const { return thread_count; }
+	bool is_working_thread() const { return current_pool == this && current_thread >= 0; }
+
 	void init(int p_thread_count = -1);
 	void finish();
+
+	ThreadWorkPool(bool p_make_singleton = false);
 	~ThreadWorkPool();
 };
 
-#endif // THREAD_POOL_H
+#endif // THREAD_WORK_POOL_H
@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  variant_internal.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef VARIANT_INTERNAL_H
+#define VARIANT_INTERNAL_H
+
+#include "core/variant.h"
+
+// Direct access to the storage of a Variant, for hot paths (like the script
+// VMs) that already checked the type and want to skip the conversion and
+// assignment operators. None of these check the type, it's up to the caller.
+
+class VariantInternal {
+public:
+	_FORCE_INLINE_ static bool *get_bool(Variant *v) { return &v->_data._bool; }
+	_FORCE_INLINE_ static const bool *get_bool(const Variant *v) { return &v->_data._bool; }
+	_FORCE_INLINE_ static int64_t *get_int(Variant *v) { return &v->_data._int; }
+	_FORCE_INLINE_ static const int64_t *get_int(const Variant *v) { return &v->_data._int; }
+	_FORCE_INLINE_ static double *get_float(Variant *v) { return &v->_data._float; }
+	_FORCE_INLINE_ static const double *get_float(const Variant *v) { return &v->_data._float; }
+	_FORCE_INLINE_ static Vector2 *get_vector2(Variant *v) { return reinterpret_cast<Vector2 *>(v->_data._mem); }
+	_FORCE_INLINE_ static const Vector2 *get_vector2(const Variant *v) { return reinterpret_cast<const Vector2 *>(v->_data._mem); }
+	_FORCE_INLINE_ static Vector3 *get_vector3(Variant *v) { return reinterpret_cast<Vector3 *>(v->_data._mem); }
+	_FORCE_INLINE_ static const Vector3 *get_vector3(const Variant *v) { return reinterpret_cast<const Vector3 *>(v->_data._mem); }
+
+	// Changes the type of a Variant to one stored inline without a constructor
+	// (BOOL, INT, FLOAT, VECTOR2, VECTOR3), releasing the previous contents.
+	// The value is left undefined and must be written right after.
+	_FORCE_INLINE_ static void set_trivial_type(Variant *v, Variant::Type p_type) {
+		if (v->type != p_type) {
+			v->clear();
+			v->type = p_type;
+		}
+	}
+
+	_FORCE_INLINE_ static void set_bool(Variant *v, bool p_value) {
+		set_trivial_type(v, Variant::BOOL);
+		v->_data._bool = p_value;
+	}
+	_FORCE_INLINE_ static void set_int(Variant *v, int64_t p_value) {
+		set_trivial_type(v, Variant::INT);
+		v->_data._int = p_value;
+	}
+	_FORCE_INLINE_ static void set_float(Variant *v, double p_value) {
+		set_trivial_type(v, Variant::FLOAT);
+		v->_data._float = p_value;
+	}
+	_FORCE_INLINE_ static void set_vector2(Variant *v, const Vector2 &p_value) {
+		set_trivial_type(v, Variant::VECTOR2);
+		*reinterpret_cast<Vector2 *>(v->_data._mem) = p_value;
+	}
+	_FORCE_INLINE_ static void set_vector3(Variant *v, const Vector3 &p_value) {
+		set_trivial_type(v, Variant::VECTOR3);
+		*reinterpret_cast<Vector3 *>(v->_data._mem) = p_value;
+	}
+};
+
+// Typed access for templated code, specialized for the types above.
+template <class T>
+struct VariantInternalAccessor;
+
+#define MAKE_VARIANT_INTERNAL_ACCESSOR(m_type, m_variant_type, m_name)                                                   \
+	template <>                                                                                                          \
+	struct VariantInternalAccessor<m_type> {                                                                             \
+		static const Variant::Type type = Variant::m_variant_type;                                                       \
+		_FORCE_INLINE_ static const m_type &get(const Variant *v) { return *VariantInternal::get_##m_name(v); }          \
+		_FORCE_INLINE_ static void set(Variant *v, const m_type &p_value) { VariantInternal::set_##m_name(v, p_value); } \
+	};
+
+MAKE_VARIANT_INTERNAL_ACCESSOR(bool, BOOL, bool)
+MAKE_VARIANT_INTERNAL_ACCESSOR(int64_t, INT, int)
+MAKE_VARIANT_INTERNAL_ACCESSOR(double, FLOAT, float)
+MAKE_VARIANT_INTERNAL_ACCESSOR(Vector2, VECTOR2, vector2)
+MAKE_VARIANT_INTERNAL_ACCESSOR(Vector3, VECTOR3, vector3)
+
+#undef MAKE_VARIANT_INTERNAL_ACCESSOR
+
+#endif // VARIANT_INTERNAL_H
@@ -41,6 +41,7 @@
 #include <errno.h>
 
 #if defined(UNIX_ENABLED)
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -71,6 +72,7 @@ void FileAccessUnix::check_errors() const {
 }
 
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
+	_unmap();
 	if (f) {
 		fclose(f);
 	}
@@ -153,6 +155,7 @@ void FileAccessUnix::close() {
 		return;
 	}
 
+	_unmap();
 	fclose(f);
 	f = nullptr;
 
@@ -246,6 +249,48 @@ int FileAccessUnix::get_buffer(uint8_t *p_dst, int p_length) const {
 	return read;
 };
 
+const uint8_t *FileAccessUnix::map(uint64_t p_offset, uint64_t p_length) {
+#if defined(UNIX_ENABLED)
+	ERR_FAIL_COND_V_MSG(!f, nullptr, "File must be opened before use.");
+	if (flags != READ || p_length == 0) {
+		return nullptr;
+	}
+	ERR_FAIL_COND_V(p_offset + p_length > get_len(), nullptr);
+
+	_unmap();
+
+	// The offset must be a multiple of the page size.
+	uint64_t page_size = sysconf(_SC_PAGESIZE);
+	uint64_t page_offset = p_offset & ~(page_size - 1);
+	size_t len = p_length + (p_offset - page_offset);
+
+	void *ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fileno(f), page_offset);
+	if (ptr == MAP_FAILED) {
+		return nullptr;
+	}
+#ifdef MADV_WILLNEED
+	// Mapped files are usually read front to back right away, start reading ahead.
+	madvise(ptr, len, MADV_WILLNEED);
+#endif
+
+	mapped = (uint8_t *)ptr;
+	mapped_len = len;
+	return mapped + (p_offset - page_offset);
+#else
+	return nullptr;
+#endif
+}
+
+void FileAccessUnix::_unmap() {
+#if defined(UNIX_ENABLED)
+	if (mapped) {
+		munmap(mapped, mapped_len);
+		mapped = nullptr;
+		mapped_len = 0;
+	}
+#endif
+}
+
 Error FileAccessUnix::get_error() const {
 	return last_error;
 }
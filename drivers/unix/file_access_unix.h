@@ -49,6 +49,10 @@ class FileAccessUnix : public FileAccess {
 	String path;
 	String path_src;
 
+	uint8_t *mapped = nullptr;
+	size_t mapped_len = 0;
+	void _unmap();
+
 	static FileAccess *create_libc();
 
 public:
@@ -71,6 +75,8 @@ public:
 	virtual uint8_t get_8() const; ///< get a byte
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
 
+	virtual const uint8_t *map(uint64_t p_offset, uint64_t p_length);
+
 	virtual Error get_error() const; ///< get last error
 
 	virtual void flush();
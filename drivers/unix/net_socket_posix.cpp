@@ -30,6 +30,8 @@
 
 #include "net_socket_posix.h"
 
+#include "core/hash_map.h"
+
 #ifndef UNIX_SOCKET_UNAVAILABLE
 #if defined(UNIX_ENABLED)
 
@@ -56,6 +58,11 @@
 
 #include <netinet/tcp.h>
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define POLL_GROUP_EPOLL
+#endif
+
 // BSD calls this flag IPV6_JOIN_GROUP
 #if !defined(IPV6_ADD_MEMBERSHIP) && defined(IPV6_JOIN_GROUP)
 #define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
@@ -145,16 +152,250 @@ void NetSocketPosix::_set_ip_port(struct sockaddr_storage *p_addr, IP_Address &r
 	};
 }
 
+#if !defined(WINDOWS_ENABLED)
+// Uses epoll on Linux, a single poll() over all the sockets elsewhere.
+// Windows uses the generic NetSocket fallback.
+class NetSocketPosixPollGroup : public NetSocket::PollGroup {
+	struct Entry {
+		Ref<NetSocket> sock; // Keeps the fd valid (or closed) until removed.
+		NetSocket::PollType type = NetSocket::POLL_TYPE_IN;
+	};
+
+	HashMap<uint64_t, Entry> entries;
+
+	static _FORCE_INLINE_ SOCKET_TYPE _get_fd(const Ref<NetSocket> &p_sock) {
+		// Sockets always come from NetSocketPosix::_create_func, see NetSocket::PollGroup.
+		return static_cast<const NetSocketPosix *>(p_sock.ptr())->_sock;
+	}
+
+#ifdef POLL_GROUP_EPOLL
+	int epfd = -1;
+	LocalVector<struct epoll_event> ready;
+
+	static _FORCE_INLINE_ uint32_t _get_events(NetSocket::PollType p_type) {
+		switch (p_type) {
+			case NetSocket::POLL_TYPE_IN:
+				return EPOLLIN;
+			case NetSocket::POLL_TYPE_OUT:
+				return EPOLLOUT;
+			case NetSocket::POLL_TYPE_IN_OUT:
+				return EPOLLIN | EPOLLOUT;
+		}
+		return EPOLLIN;
+	}
+
+	Error _ctl(int p_op, SOCKET_TYPE p_fd, NetSocket::PollType p_type, uint64_t p_id) {
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = _get_events(p_type);
+		ev.data.u64 = p_id;
+		if (epoll_ctl(epfd, p_op, p_fd, &ev) != 0) {
+			print_verbose("Unable to update epoll set: " + itos(errno));
+			return FAILED;
+		}
+		return OK;
+	}
+#else
+	LocalVector<struct pollfd> fds;
+	LocalVector<uint64_t> fd_ids;
+	bool dirty = false;
+
+	static _FORCE_INLINE_ short _get_events(NetSocket::PollType p_type) {
+		switch (p_type) {
+			case NetSocket::POLL_TYPE_IN:
+				return POLLIN;
+			case NetSocket::POLL_TYPE_OUT:
+				return POLLOUT;
+			case NetSocket::POLL_TYPE_IN_OUT:
+				return POLLIN | POLLOUT;
+		}
+		return POLLIN;
+	}
+
+	void _rebuild() {
+		fds.clear();
+		fd_ids.clear();
+		const uint64_t *k = nullptr;
+		while ((k = entries.next(k))) {
+			const Entry &e = entries[*k];
+			SOCKET_TYPE fd = _get_fd(e.sock);
+			if (fd == SOCK_EMPTY) {
+				continue;
+			}
+			struct pollfd pfd;
+			pfd.fd = fd;
+			pfd.events = _get_events(e.type);
+			pfd.revents = 0;
+			fds.push_back(pfd);
+			fd_ids.push_back(*k);
+		}
+		dirty = false;
+	}
+#endif
+
+public:
+	virtual Error add(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, uint64_t p_id) {
+		ERR_FAIL_COND_V(p_sock.is_null() || !p_sock->is_open(), ERR_INVALID_PARAMETER);
+		ERR_FAIL_COND_V(entries.has(p_id), ERR_ALREADY_EXISTS);
+#ifdef POLL_GROUP_EPOLL
+		ERR_FAIL_COND_V(epfd == -1, ERR_UNCONFIGURED);
+		Error err = _ctl(EPOLL_CTL_ADD, _get_fd(p_sock), p_type, p_id);
+		if (err != OK) {
+			return err;
+		}
+#else
+		dirty = true;
+#endif
+		Entry e;
+		e.sock = p_sock;
+		e.type = p_type;
+		entries[p_id] = e;
+		return OK;
+	}
+
+	virtual Error modify(uint64_t p_id, NetSocket::PollType p_type) {
+		Entry *e = entries.getptr(p_id);
+		ERR_FAIL_COND_V(!e, ERR_DOES_NOT_EXIST);
+		if (e->type == p_type) {
+			return OK;
+		}
+		e->type = p_type;
+#ifdef POLL_GROUP_EPOLL
+		SOCKET_TYPE fd = _get_fd(e->sock);
+		if (fd != SOCK_EMPTY) {
+			return _ctl(EPOLL_CTL_MOD, fd, p_type, p_id);
+		}
+#else
+		dirty = true;
+#endif
+		return OK;
+	}
+
+	virtual void remove(uint64_t p_id) {
+		Entry *e = entries.getptr(p_id);
+		ERR_FAIL_COND(!e);
+#ifdef POLL_GROUP_EPOLL
+		// A closed socket was already dropped by the kernel, and its fd might
+		// have been reused by another registered socket.
+		SOCKET_TYPE fd = _get_fd(e->sock);
+		if (fd != SOCK_EMPTY) {
+			struct epoll_event ev; // Kernels before 2.6.9 require a non null event.
+			epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev);
+		}
+#else
+		dirty = true;
+#endif
+		entries.erase(p_id);
+	}
+
+	virtual bool has(uint64_t p_id) const {
+		return entries.has(p_id);
+	}
+
+	virtual int get_socket_count() const {
+		return entries.size();
+	}
+
+	virtual Error wait(LocalVector<Event> &r_events, int p_timeout) {
+		r_events.clear();
+		if (entries.size() == 0) {
+			return ERR_BUSY;
+		}
+#ifdef POLL_GROUP_EPOLL
+		ERR_FAIL_COND_V(epfd == -1, ERR_UNCONFIGURED);
+		ready.resize(entries.size());
+		int ret = epoll_wait(epfd, ready.ptr(), ready.size(), p_timeout);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				return ERR_BUSY;
+			}
+			print_verbose("Error when waiting on epoll set: " + itos(errno));
+			return FAILED;
+		}
+		for (int i = 0; i < ret; i++) {
+			const struct epoll_event &ev = ready[i];
+			Event e;
+			e.id = ev.data.u64;
+			e.readable = ev.events & EPOLLIN;
+			e.writable = ev.events & EPOLLOUT;
+			e.error = ev.events & (EPOLLERR | EPOLLHUP);
+			r_events.push_back(e);
+		}
+#else
+		if (dirty) {
+			_rebuild();
+		}
+		if (fds.size() == 0) {
+			return ERR_BUSY;
+		}
+		int ret = ::poll(fds.ptr(), fds.size(), p_timeout);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				return ERR_BUSY;
+			}
+			print_verbose("Error when polling sockets: " + itos(errno));
+			return FAILED;
+		}
+		for (uint32_t i = 0; i < fds.size() && ret > 0; i++) {
+			struct pollfd &pfd = fds[i];
+			if (!pfd.revents) {
+				continue;
+			}
+			Event e;
+			e.id = fd_ids[i];
+			e.readable = pfd.revents & POLLIN;
+			e.writable = pfd.revents & POLLOUT;
+			e.error = pfd.revents & (POLLERR | POLLHUP | POLLNVAL);
+			if (pfd.revents & POLLNVAL) {
+				dirty = true; // Closed while registered.
+			}
+			pfd.revents = 0;
+			r_events.push_back(e);
+			ret--;
+		}
+#endif
+		return r_events.size() ? OK : ERR_BUSY;
+	}
+
+	NetSocketPosixPollGroup() {
+#ifdef POLL_GROUP_EPOLL
+		epfd = epoll_create1(EPOLL_CLOEXEC);
+		if (epfd == -1) {
+			ERR_PRINT("Unable to create epoll instance: " + itos(errno));
+		}
+#endif
+	}
+
+	~NetSocketPosixPollGroup() {
+#ifdef POLL_GROUP_EPOLL
+		if (epfd != -1) {
+			::close(epfd);
+		}
+#endif
+	}
+};
+#endif
+
 NetSocket *NetSocketPosix::_create_func() {
 	return memnew(NetSocketPosix);
 }
 
+NetSocket::PollGroup *NetSocketPosix::_create_poll_group_func() {
+#if defined(WINDOWS_ENABLED)
+	return nullptr;
+#else
+	return memnew(NetSocketPosixPollGroup);
+#endif
+}
+
 void NetSocketPosix::make_default() {
 #if defined(WINDOWS_ENABLED)
 	if (_create == nullptr) {
 		WSADATA data;
 		WSAStartup(MAKEWORD(2, 2), &data);
 	}
+#else
+	_create_poll_group = _create_poll_group_func;
 #endif
 	_create = _create_func;
 }
@@ -166,6 +407,7 @@ void NetSocketPosix::cleanup() {
 	}
 	_create = nullptr;
 #endif
+	_create_poll_group = nullptr;
 }
 
 NetSocketPosix::NetSocketPosix() :
@@ -45,6 +45,8 @@
 #endif
 
 class NetSocketPosix : public NetSocket {
+	friend class NetSocketPosixPollGroup;
+
 private:
 	SOCKET_TYPE _sock; // NOLINT - the default value is defined in the .cpp
 	IP::Type _ip_type = IP::TYPE_NONE;
@@ -64,6 +66,7 @@ private:
 
 protected:
 	static NetSocket *_create_func();
+	static PollGroup *_create_poll_group_func();
 
 	bool _can_use_ip(const IP_Address &p_ip, const bool p_for_bind) const;
 
@@ -31,6 +31,8 @@
 #include "resource_importer_scene.h"
 
 #include "core/io/resource_saver.h"
+#include "core/math/mesh_simplifier.h"
+#include "core/thread_work_pool.h"
 #include "editor/editor_node.h"
 #include "scene/3d/collision_shape_3d.h"
 #include "scene/3d/mesh_instance_3d.h"
@@ -929,6 +931,89 @@ void ResourceImporterScene::_find_meshes(Node *p_node, Map<Ref<ArrayMesh>, Trans
 	}
 }
 
+void ResourceImporterScene::_generate_surface_lods(uint32_t p_index, LODSurface *p_surfaces) {
+	LODSurface &surface = p_surfaces[p_index];
+	if (!surface.simplify) {
+		return;
+	}
+
+	Vector<Vector3> vertices = surface.arrays[Mesh::ARRAY_VERTEX];
+	Vector<Vector3> normals = surface.arrays[Mesh::ARRAY_NORMAL];
+	Vector<int> indices = surface.arrays[Mesh::ARRAY_INDEX];
+
+	AABB aabb;
+	for (int i = 0; i < vertices.size(); i++) {
+		if (i == 0) {
+			aabb.position = vertices[i];
+		} else {
+			aabb.expand_to(vertices[i]);
+		}
+	}
+
+	// Past a quarter of the mesh size, the LOD would be too coarse to be worth keeping.
+	float max_error = aabb.get_longest_axis_size() * 0.25;
+
+	Vector<MeshSimplifier::LOD> lods = MeshSimplifier::generate_lods(vertices, normals, indices, max_error);
+	for (int i = 0; i < lods.size(); i++) {
+		surface.lods[lods[i].error] = lods[i].indices;
+	}
+}
+
+void ResourceImporterScene::_generate_lods(const Map<Ref<ArrayMesh>, Transform> &p_meshes) {
+	LocalVector<LODSurface> surfaces;
+
+	for (const Map<Ref<ArrayMesh>, Transform>::Element *E = p_meshes.front(); E; E = E->next()) {
+		Ref<ArrayMesh> mesh = E->key();
+		for (int i = 0; i < mesh->get_surface_count(); i++) {
+			LODSurface surface;
+			surface.mesh = mesh;
+			surface.primitive = mesh->surface_get_primitive_type(i);
+			surface.format = mesh->surface_get_format(i);
+			surface.arrays = mesh->surface_get_arrays(i);
+			surface.blend_shape_arrays = mesh->surface_get_blend_shape_arrays(i);
+			surface.material = mesh->surface_get_material(i);
+			surface.name = mesh->surface_get_name(i);
+			surface.simplify = surface.primitive == Mesh::PRIMITIVE_TRIANGLES && (surface.format & Mesh::ARRAY_FORMAT_INDEX);
+			surfaces.push_back(surface);
+		}
+	}
+
+	// Surfaces are independent, and simplifying is by far the slowest part.
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (pool && surfaces.size() > 1) {
+		pool->do_work(surfaces.size(), this, &ResourceImporterScene::_generate_surface_lods, surfaces.ptr());
+	} else {
+		for (uint32_t i = 0; i < surfaces.size(); i++) {
+			_generate_surface_lods(i, surfaces.ptr());
+		}
+	}
+
+	// Meshes are rebuilt as a whole, so surfaces keep their order.
+	uint32_t first = 0;
+	while (first < surfaces.size()) {
+		Ref<ArrayMesh> mesh = surfaces[first].mesh;
+		uint32_t count = mesh->get_surface_count();
+
+		bool has_lods = false;
+		for (uint32_t i = first; i < first + count; i++) {
+			has_lods = has_lods || !surfaces[i].lods.empty();
+		}
+
+		if (has_lods) {
+			mesh->clear_surfaces();
+			for (uint32_t i = first; i < first + count; i++) {
+				const LODSurface &surface = surfaces[i];
+				int idx = mesh->get_surface_count();
+				mesh->add_surface_from_arrays(surface.primitive, surface.arrays, surface.blend_shape_arrays, surface.lods, surface.format);
+				mesh->surface_set_material(idx, surface.material);
+				mesh->surface_set_name(idx, surface.name);
+			}
+		}
+
+		first += count;
+	}
+}
+
 void ResourceImporterScene::_make_external_resources(Node *p_node, const String &p_base_path, bool p_make_animations, bool p_animations_as_text, bool p_keep_animations, bool p_make_materials, bool p_materials_as_text, bool p_keep_materials, bool p_make_meshes, bool p_meshes_as_text, Map<Ref<Animation>, Ref<Animation>> &p_animations, Map<Ref<Material>, Ref<Material>> &p_materials, Map<Ref<ArrayMesh>, Ref<ArrayMesh>> &p_meshes) {
 	List<PropertyInfo> pi;
 
@@ -1122,6 +1207,7 @@ void ResourceImporterScene::get_import_options(List<ImportOption> *r_options, in
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "materials/keep_on_reimport"), materials_out));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/compress"), true));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/ensure_tangents"), true));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/generate_lods"), false));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/storage", PROPERTY_HINT_ENUM, "Built-In,Files (.mesh),Files (.tres)"), meshes_out ? 1 : 0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/light_baking", PROPERTY_HINT_ENUM, "Disabled,Enable,Gen Lightmaps", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::FLOAT, "meshes/lightmap_texel_size", PROPERTY_HINT_RANGE, "0.001,100,0.001"), 0.1));
@@ -1375,7 +1461,7 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 		}
 	}
 
-	if (light_bake_mode == 2 /* || generate LOD */) {
+	if (light_bake_mode == 2) {
 		Map<Ref<ArrayMesh>, Transform> meshes;
 		_find_meshes(scene, meshes);
 
@@ -1485,6 +1571,15 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 		}
 	}
 
+	// After unwrapping, which rebuilds the surfaces without their LODs.
+	if (bool(p_options["meshes/generate_lods"])) {
+		progress.step(TTR("Generating LODs..."), 1);
+
+		Map<Ref<ArrayMesh>, Transform> meshes;
+		_find_meshes(scene, meshes);
+		_generate_lods(meshes);
+	}
+
 	if (external_animations || external_materials || external_meshes) {
 		Map<Ref<Animation>, Ref<Animation>> anim_map;
 		Map<Ref<Material>, Ref<Material>> mat_map;
@@ -118,7 +118,21 @@ class ResourceImporterScene : public ResourceImporter {
 		LIGHT_BAKE_LIGHTMAPS
 	};
 
+	struct LODSurface {
+		Ref<ArrayMesh> mesh;
+		Mesh::PrimitiveType primitive = Mesh::PRIMITIVE_TRIANGLES;
+		uint32_t format = 0;
+		Array arrays;
+		Array blend_shape_arrays;
+		Ref<Material> material;
+		String name;
+		bool simplify = false;
+		Dictionary lods;
+	};
+
 	void _replace_owner(Node *p_node, Node *p_scene, Node *p_new_owner);
+	void _generate_surface_lods(uint32_t p_index, LODSurface *p_surfaces);
+	void _generate_lods(const Map<Ref<ArrayMesh>, Transform> &p_meshes);
 
 public:
 	static ResourceImporterScene *get_singleton() { return singleton; }
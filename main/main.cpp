@@ -46,6 +46,7 @@
 #include "core/os/os.h"
 #include "core/project_settings.h"
 #include "core/register_core_types.h"
+#include "core/thread_work_pool.h"
 #include "core/translation.h"
 #include "core/version.h"
 #include "core/version_hash.gen.h"
@@ -62,6 +63,7 @@
 #include "scene/main/window.h"
 #include "scene/register_scene_types.h"
 #include "scene/resources/packed_scene.h"
+#include "servers/audio/audio_driver_dummy.h"
 #include "servers/audio_server.h"
 #include "servers/camera_server.h"
 #include "servers/display_server.h"
@@ -106,6 +108,7 @@ static ZipArchive *zip_packed_data = nullptr;
 #endif
 static FileAccessNetworkClient *file_access_network_client = nullptr;
 static MessageQueue *message_queue = nullptr;
+static ThreadWorkPool *thread_work_pool = nullptr;
 
 // Initialized in setup2()
 static AudioServer *audio_server = nullptr;
@@ -124,6 +127,8 @@ static bool _start_success = false;
 
 static int display_driver_idx = -1;
 static int audio_driver_idx = -1;
+static bool audio_offline = false;
+static String audio_output_file;
 
 // Engine config/tools
 
@@ -292,6 +297,8 @@ void Main::print_help(const char *p_binary) {
 		OS::get_singleton()->print("'%s'", AudioDriverManager::get_driver(i)->get_name());
 	}
 	OS::get_singleton()->print("].\n");
+	OS::get_singleton()->print("  --audio-offline                  Mix audio as the main loop advances instead of in real time, using the dummy driver.\n");
+	OS::get_singleton()->print("  --audio-output <file>            Write the audio mix to a WAV file (implies --audio-offline).\n");
 
 	OS::get_singleton()->print("  --display-driver <driver>        Display driver (and rendering driver) [");
 	for (int i = 0; i < DisplayServer::get_create_function_count(); i++) {
@@ -407,9 +414,7 @@ int Main::test_entrypoint(int argc, char *argv[], bool &tests_need_run) {
 		if (strncmp(argv[x], "--test", 6) == 0) {
 			tests_need_run = true;
 			OS::get_singleton()->initialize();
-			StringName::setup();
-			int status = test_main(argc, argv);
-			StringName::cleanup();
+			int status = test_main(argc, argv); // Sets up the core types, StringName included.
 			// TODO: fix OS::singleton cleanup
 			return status;
 		}
@@ -564,6 +569,21 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 
 			quiet_stdout = true;
 
+		} else if (I->get() == "--audio-offline") { // render audio faster than realtime
+
+			audio_offline = true;
+
+		} else if (I->get() == "--audio-output") { // render audio to a file
+
+			if (I->next()) {
+				audio_offline = true;
+				audio_output_file = I->next()->get();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing audio output file argument, aborting.\n");
+				goto error;
+			}
+
 		} else if (I->get() == "--audio-driver") { // audio driver
 
 			if (I->next()) {
@@ -997,6 +1017,18 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	// Initialize user data dir.
 	OS::get_singleton()->ensure_user_data_dir();
 
+	GLOBAL_DEF_RST("memory/allocator/use_slab_allocator", false);
+	GLOBAL_DEF_RST("memory/allocator/slab_arena_size_mb", 128);
+	ProjectSettings::get_singleton()->set_custom_property_info("memory/allocator/slab_arena_size_mb",
+			PropertyInfo(Variant::INT,
+					"memory/allocator/slab_arena_size_mb",
+					PROPERTY_HINT_RANGE,
+					"1,4096,1,or_greater"));
+	if (GLOBAL_GET("memory/allocator/use_slab_allocator")) {
+		int arena_size_mb = GLOBAL_GET("memory/allocator/slab_arena_size_mb");
+		Memory::set_slab_allocator_enabled(true, size_t(MAX(arena_size_mb, 1)) << 20);
+	}
+
 	GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc",
 			PropertyInfo(Variant::INT,
@@ -1250,6 +1282,10 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 		display_driver_idx = 0;
 	}
 
+	if (audio_offline) {
+		audio_driver = "Dummy";
+	}
+
 	if (audio_driver == "") { // specified in project.godot
 		audio_driver = GLOBAL_DEF_RST_NOVAL("audio/driver", AudioDriverManager::get_driver(0)->get_name());
 	}
@@ -1327,6 +1363,15 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 
 	message_queue = memnew(MessageQueue);
 
+	GLOBAL_DEF("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads",
+			PropertyInfo(Variant::INT,
+					"threading/worker_pool/max_threads",
+					PROPERTY_HINT_RANGE,
+					"-1,256,1,or_greater")); // -1 means one thread per processor
+	thread_work_pool = memnew(ThreadWorkPool(true));
+	thread_work_pool->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+
 	if (p_second_phase) {
 		return setup2();
 	}
@@ -1448,6 +1493,11 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 
 	/* Initialize Audio Driver */
 
+	if (audio_offline) {
+		AudioDriverDummy::get_dummy_singleton()->set_use_threads(false);
+		AudioDriverDummy::get_dummy_singleton()->set_output_file(audio_output_file);
+	}
+
 	AudioDriverManager::initialize(audio_driver_idx);
 
 	print_line(" "); //add a blank line for readability
@@ -2392,6 +2442,9 @@ bool Main::iteration() {
 	}
 
 	AudioServer::get_singleton()->update();
+	if (audio_offline) {
+		AudioDriverDummy::get_dummy_singleton()->advance(step);
+	}
 
 	if (EngineDebugger::is_active()) {
 		EngineDebugger::get_singleton()->iteration(frame_time, idle_process_ticks, physics_process_ticks, frame_slice);
@@ -2554,6 +2607,10 @@ void Main::cleanup() {
 	message_queue->flush();
 	memdelete(message_queue);
 
+	if (thread_work_pool) {
+		memdelete(thread_work_pool);
+	}
+
 	unregister_core_driver_types();
 	unregister_core_types();
 
@@ -77,6 +77,8 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(MEMORY_SLAB_HIT_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_SLAB_THREAD_CACHE_HIT_RATE);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -121,6 +123,8 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"memory/slab_hit_rate",
+		"memory/slab_thread_cache_hit_rate",
 
 	};
 
@@ -183,6 +187,14 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case MEMORY_SLAB_HIT_RATE: {
+			Memory::AllocatorStats stats = Memory::get_allocator_stats();
+			return stats.allocs ? 100.0 * stats.slab_allocs / stats.allocs : 0;
+		}
+		case MEMORY_SLAB_THREAD_CACHE_HIT_RATE: {
+			Memory::AllocatorStats stats = Memory::get_allocator_stats();
+			return stats.slab_allocs ? 100.0 * stats.slab_cache_hits / stats.slab_allocs : 0;
+		}
 
 		default: {
 		}
@@ -223,6 +235,8 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
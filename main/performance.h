@@ -92,6 +92,8 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		MEMORY_SLAB_HIT_RATE,
+		MEMORY_SLAB_THREAD_CACHE_HIT_RATE,
 		MONITOR_MAX
 	};
 
@@ -0,0 +1,112 @@
+/*************************************************************************/
+/*  test_animation.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_ANIMATION_H
+#define TEST_ANIMATION_H
+
+#include "core/math/random_pcg.h"
+#include "scene/resources/animation.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAnimation {
+
+enum {
+	KEY_COUNT = 200,
+};
+
+// A value track with keys at irregular times, the first one after 0.
+static Ref<Animation> make_animation(Vector<float> &r_key_times) {
+	Ref<Animation> animation;
+	animation.instance();
+	animation->add_track(Animation::TYPE_VALUE);
+	animation->track_set_path(0, NodePath("Node:position"));
+
+	RandomPCG rng(KEY_COUNT);
+	float time = 0.0;
+	r_key_times.clear();
+	for (int i = 0; i < KEY_COUNT; i++) {
+		time += rng.random(0.01f, 0.5f);
+		animation->track_insert_key(0, time, rng.random(-10.0f, 10.0f));
+		r_key_times.push_back(time);
+	}
+	animation->set_length(time + 0.5);
+	return animation;
+}
+
+// Seeks to every time of p_times in order, with a key cursor carried from one
+// seek to the next. Returns how many seeks found another key than a plain
+// binary search, or another value than interpolating without a cursor.
+static int count_cursor_mismatches(Ref<Animation> p_animation, const Vector<float> &p_times) {
+	int cursor = 0;
+	int mismatches = 0;
+	for (int i = 0; i < p_times.size(); i++) {
+		Variant value = p_animation->value_track_interpolate(0, p_times[i], &cursor);
+		mismatches += cursor != p_animation->track_find_key(0, p_times[i]);
+		mismatches += value != p_animation->value_track_interpolate(0, p_times[i]);
+	}
+	return mismatches;
+}
+
+TEST_CASE("[Animation] Seeking with a key cursor finds the same keys as searching") {
+	Vector<float> key_times;
+	Ref<Animation> animation = make_animation(key_times);
+	const float length = animation->get_length();
+
+	// Small steps, landing exactly on every key once, as when playing.
+	Vector<float> forward;
+	forward.push_back(0.0);
+	for (int i = 0; i < key_times.size(); i++) {
+		float previous = i == 0 ? 0.0 : key_times[i - 1];
+		forward.push_back(previous + (key_times[i] - previous) * 0.25);
+		forward.push_back(previous + (key_times[i] - previous) * 0.75);
+		forward.push_back(key_times[i]);
+	}
+	forward.push_back(length);
+	CHECK(count_cursor_mismatches(animation, forward) == 0);
+
+	Vector<float> backward;
+	for (int i = forward.size() - 1; i >= 0; i--) {
+		backward.push_back(forward[i]);
+	}
+	CHECK(count_cursor_mismatches(animation, backward) == 0);
+
+	// Jumps, half of them exactly on a key, far from the cursor.
+	RandomPCG rng(1);
+	Vector<float> random;
+	for (int i = 0; i < 1000; i++) {
+		random.push_back(i % 2 ? key_times[rng.rand() % key_times.size()] : rng.random(0.0f, length));
+	}
+	CHECK(count_cursor_mismatches(animation, random) == 0);
+}
+
+} // namespace TestAnimation
+
+#endif // TEST_ANIMATION_H
@@ -0,0 +1,248 @@
+/*************************************************************************/
+/*  test_animation_threads.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_ANIMATION_THREADS_H
+#define TEST_ANIMATION_THREADS_H
+
+#ifndef _3D_DISABLED
+
+#include "core/math/random_pcg.h"
+#include "core/message_queue.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/thread_work_pool.h"
+#include "scene/3d/skeleton_3d.h"
+#include "scene/animation/animation_blend_tree.h"
+#include "scene/animation/animation_player.h"
+#include "scene/animation/animation_tree.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAnimationThreads {
+
+enum {
+	CHARACTER_COUNT = 8,
+	BONE_COUNT = 16,
+	KEY_COUNT = 10,
+	FRAMES = 10,
+};
+
+struct CrowdSize {
+	int characters = CHARACTER_COUNT;
+	int bones = BONE_COUNT;
+	int keys = KEY_COUNT;
+	int frames = FRAMES;
+};
+
+static Ref<Animation> make_animation(uint32_t p_seed, const CrowdSize &p_size) {
+	Ref<Animation> animation;
+	animation.instance();
+	animation->set_length(1.0);
+	animation->set_loop(true);
+
+	RandomPCG rng(p_seed);
+
+	for (int i = 0; i < p_size.bones; i++) {
+		int track = animation->add_track(Animation::TYPE_TRANSFORM);
+		animation->track_set_path(track, NodePath(vformat(".:bone%d", i)));
+
+		for (int k = 0; k < p_size.keys; k++) {
+			Vector3 loc(rng.random(-0.1f, 0.1f), rng.random(-0.1f, 0.1f), rng.random(-0.1f, 0.1f));
+			Quat rot(Vector3(0, 1, 0), rng.random(-1.0f, 1.0f));
+			animation->transform_track_insert_key(track, float(k) / p_size.keys, loc, rot, Vector3(1, 1, 1));
+		}
+	}
+
+	return animation;
+}
+
+// Animates a crowd of skeletons the way SceneTree does: every node gets its
+// process notification, then the message queue is flushed. The nodes are
+// never added to a tree (it needs a rendering server), so delta is always 0
+// and time moves by seeking instead. Optionally returns every bone pose of
+// every frame. Returns the time spent processing, in microseconds.
+static uint64_t animate_crowd(const CrowdSize &p_size, bool p_use_tree, bool p_threaded, Vector<Transform> *r_poses = nullptr) {
+	AnimationPlayer::set_threaded_processing(p_threaded);
+	AnimationTree::set_threaded_processing(p_threaded);
+
+	Ref<Animation> walk = make_animation(1, p_size);
+	Ref<Animation> run = make_animation(2, p_size);
+
+	Ref<AnimationNodeBlendTree> blend_tree;
+	blend_tree.instance();
+	Ref<AnimationNodeAnimation> walk_node;
+	walk_node.instance();
+	walk_node->set_animation("walk");
+	Ref<AnimationNodeAnimation> run_node;
+	run_node.instance();
+	run_node->set_animation("run");
+	blend_tree->add_node("walk", walk_node);
+	blend_tree->add_node("run", run_node);
+	blend_tree->add_node("blend", memnew(AnimationNodeBlend2));
+	blend_tree->add_node("seek", memnew(AnimationNodeTimeSeek));
+	blend_tree->connect_node("blend", 0, "walk");
+	blend_tree->connect_node("blend", 1, "run");
+	blend_tree->connect_node("seek", 0, "blend");
+	blend_tree->connect_node("output", 0, "seek");
+
+	Vector<Skeleton3D *> skeletons;
+	Vector<AnimationPlayer *> players;
+	Vector<AnimationTree *> trees;
+
+	for (int c = 0; c < p_size.characters; c++) {
+		Skeleton3D *skeleton = memnew(Skeleton3D);
+		for (int i = 0; i < p_size.bones; i++) {
+			skeleton->add_bone(vformat("bone%d", i));
+			skeleton->set_bone_parent(i, i - 1);
+		}
+		skeletons.push_back(skeleton);
+
+		AnimationPlayer *player = memnew(AnimationPlayer);
+		player->set_name("AnimationPlayer");
+		player->set_root(NodePath(".."));
+		player->add_animation("walk", walk);
+		player->add_animation("run", run);
+		skeleton->add_child(player);
+		players.push_back(player);
+
+		if (p_use_tree) {
+			AnimationTree *tree = memnew(AnimationTree);
+			skeleton->add_child(tree);
+			tree->set_animation_player(NodePath("../AnimationPlayer"));
+			tree->set_tree_root(blend_tree);
+			tree->set_active(true);
+			trees.push_back(tree);
+		} else {
+			// Keep the player cross fading between both animations.
+			player->set_default_blend_time(1000.0);
+			player->play("walk");
+			player->play("run");
+		}
+	}
+
+	uint64_t elapsed = 0;
+	for (int f = 0; f < p_size.frames; f++) {
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int c = 0; c < p_size.characters; c++) {
+			float time = (f * p_size.characters + c) * 0.037;
+			if (p_use_tree) {
+				trees[c]->set("parameters/blend/blend_amount", float(c) / CHARACTER_COUNT);
+				trees[c]->set("parameters/seek/seek_position", time);
+				trees[c]->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+			} else {
+				players[c]->seek(time);
+				players[c]->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+			}
+		}
+
+		MessageQueue::get_singleton()->flush();
+		elapsed += OS::get_singleton()->get_ticks_usec() - begin;
+
+		if (r_poses) {
+			for (int c = 0; c < p_size.characters; c++) {
+				for (int i = 0; i < p_size.bones; i++) {
+					r_poses->push_back(skeletons[c]->get_bone_pose(i));
+				}
+			}
+		}
+	}
+
+	for (int c = 0; c < p_size.characters; c++) {
+		memdelete(skeletons[c]);
+	}
+
+	AnimationPlayer::set_threaded_processing(false);
+	AnimationTree::set_threaded_processing(false);
+
+	return elapsed;
+}
+
+static void check_threaded_matches_serial(bool p_use_tree) {
+	MessageQueue message_queue;
+
+	Vector<Transform> serial;
+	animate_crowd(CrowdSize(), p_use_tree, false, &serial);
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	Vector<Transform> threaded;
+	animate_crowd(CrowdSize(), p_use_tree, true, &threaded);
+	pool.finish();
+
+	REQUIRE(serial.size() == CHARACTER_COUNT * BONE_COUNT * FRAMES);
+	REQUIRE(serial.size() == threaded.size());
+
+	bool animated = false;
+	for (int i = 0; i < serial.size(); i++) {
+		CHECK_MESSAGE(serial[i] == threaded[i], "Every bone must get the same pose.");
+		animated = animated || serial[i] != Transform();
+	}
+	CHECK_MESSAGE(animated, "Bones must actually be posed by the animations.");
+}
+
+TEST_CASE("[Animation] Threaded AnimationPlayer processing poses bones like serial processing") {
+	check_threaded_matches_serial(false);
+}
+
+TEST_CASE("[Animation] Threaded AnimationTree processing poses bones like serial processing") {
+	check_threaded_matches_serial(true);
+}
+
+TEST_CASE("[Animation][Benchmark] Threaded processing of a crowd" * doctest::skip()) {
+	MessageQueue message_queue;
+	ThreadWorkPool pool(true);
+	pool.init(OS::get_singleton()->get_processor_count());
+
+	CrowdSize size;
+	size.bones = 64;
+	size.keys = 30;
+	size.frames = 120;
+	print_line(vformat("Characters have %d bones, animations have %d keys per bone.", size.bones, size.keys));
+
+	const int counts[] = { 16, 64, 256, 1024 };
+	for (int t = 0; t < 2; t++) {
+		bool use_tree = t == 1;
+		for (int i = 0; i < 4; i++) {
+			size.characters = counts[i];
+			float serial = animate_crowd(size, use_tree, false) / 1000.0 / size.frames;
+			float threaded = animate_crowd(size, use_tree, true) / 1000.0 / size.frames;
+			print_line(vformat("%s, %d characters: serial %.3f msec/frame, threaded %.3f msec/frame (%.2fx)",
+					use_tree ? "AnimationTree" : "AnimationPlayer", counts[i], serial, threaded, serial / threaded));
+		}
+	}
+
+	pool.finish();
+}
+
+} // namespace TestAnimationThreads
+
+#endif // _3D_DISABLED
+
+#endif // TEST_ANIMATION_THREADS_H
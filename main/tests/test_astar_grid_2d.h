@@ -0,0 +1,493 @@
+/*************************************************************************/
+/*  test_astar_grid_2d.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_ASTAR_GRID_2D_H
+#define TEST_ASTAR_GRID_2D_H
+
+#include "core/local_vector.h"
+#include "core/math/a_star.h"
+#include "core/math/a_star_grid_2d.h"
+#include "core/math/random_pcg.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/thread_work_pool.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAStarGrid2D {
+
+// Walls and corridors of different lengths, with an unreachable cell at (14, 1).
+static const char *MAZE[] = {
+	"..............#.",
+	"..####.......#.#",
+	"..#.........#.#.",
+	"..#..######.#...",
+	"..#.......#.....",
+	"..#####...#.###.",
+	"......#...#...#.",
+	".####.#.###.#.#.",
+	"......#.....#...",
+	"............#...",
+};
+
+// Rooms of 4x4 cells, their west and north sides walled off but for a single
+// door. With clusters of the same size, doors are the only entrances and the
+// rooms are convex, so HPA* paths are as short as the plain A* ones.
+static const char *ROOMS[] = {
+	"....#...#...",
+	"........#...",
+	"....#.......",
+	"....#...#...",
+	"##.###.###.#",
+	"....#.......",
+	"........#...",
+	"....#...#...",
+	"#.###.#####.",
+	"....#.......",
+	"........#...",
+	"....#...#...",
+};
+
+static const int ROOM_SIZE = 4;
+
+static Ref<AStarGrid2D> make_grid(const char **p_rows, int p_height, bool p_diagonal, int p_cluster_size) {
+	Ref<AStarGrid2D> grid;
+	grid.instance();
+
+	int width = strlen(p_rows[0]);
+	grid->set_size(Vector2i(width, p_height));
+	grid->set_diagonal_enabled(p_diagonal);
+	grid->set_cluster_size(p_cluster_size);
+
+	for (int y = 0; y < p_height; y++) {
+		for (int x = 0; x < width; x++) {
+			grid->set_cell_solid(Vector2i(x, y), p_rows[y][x] == '#');
+		}
+	}
+
+	return grid;
+}
+
+static bool is_walkable(const Ref<AStarGrid2D> &p_grid, int p_x, int p_y) {
+	return p_grid->is_in_bounds(Vector2i(p_x, p_y)) && !p_grid->is_cell_solid(Vector2i(p_x, p_y));
+}
+
+// Dijkstra over every cell, negative when p_to can't be reached.
+static real_t optimal_cost(const Ref<AStarGrid2D> &p_grid, const Vector2i &p_from, const Vector2i &p_to) {
+	const Vector2i size = p_grid->get_size();
+	const int direction_count = p_grid->is_diagonal_enabled() ? 8 : 4;
+	const int directions[8][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+	LocalVector<real_t> cost;
+	LocalVector<bool> done;
+	cost.resize(size.x * size.y);
+	done.resize(size.x * size.y);
+	for (int i = 0; i < size.x * size.y; i++) {
+		cost[i] = -1;
+		done[i] = false;
+	}
+	cost[p_from.y * size.x + p_from.x] = 0;
+
+	while (true) {
+		int c = -1;
+		for (int i = 0; i < size.x * size.y; i++) {
+			if (!done[i] && cost[i] >= 0 && (c < 0 || cost[i] < cost[c])) {
+				c = i;
+			}
+		}
+		if (c < 0) {
+			return -1;
+		}
+		if (c == p_to.y * size.x + p_to.x) {
+			return cost[c];
+		}
+		done[c] = true;
+
+		int x = c % size.x;
+		int y = c / size.x;
+		for (int i = 0; i < direction_count; i++) {
+			int dx = directions[i][0];
+			int dy = directions[i][1];
+			if (!is_walkable(p_grid, x + dx, y + dy) || !is_walkable(p_grid, x + dx, y) || !is_walkable(p_grid, x, y + dy)) {
+				continue;
+			}
+			int n = (y + dy) * size.x + x + dx;
+			real_t n_cost = cost[c] + (i < 4 ? 1 : Math_SQRT2);
+			if (!done[n] && (cost[n] < 0 || n_cost < cost[n])) {
+				cost[n] = n_cost;
+			}
+		}
+	}
+}
+
+// Cost of a path, negative when it jumps, crosses solid cells or cuts corners.
+static real_t path_cost(const Ref<AStarGrid2D> &p_grid, const Vector<Vector2> &p_path) {
+	real_t cost = 0;
+	for (int i = 1; i < p_path.size(); i++) {
+		int x = p_path[i - 1].x;
+		int y = p_path[i - 1].y;
+		int dx = int(p_path[i].x) - x;
+		int dy = int(p_path[i].y) - y;
+
+		if (ABS(dx) > 1 || ABS(dy) > 1 || (dx == 0 && dy == 0)) {
+			return -1;
+		}
+		if (dx != 0 && dy != 0 && !p_grid->is_diagonal_enabled()) {
+			return -1;
+		}
+		if (!is_walkable(p_grid, x + dx, y + dy) || !is_walkable(p_grid, x + dx, y) || !is_walkable(p_grid, x, y + dy)) {
+			return -1;
+		}
+
+		cost += (dx != 0 && dy != 0) ? Math_SQRT2 : 1;
+	}
+	return cost;
+}
+
+static void check_paths(Ref<AStarGrid2D> p_grid, const Vector2i p_queries[][2], int p_count, bool p_optimal) {
+	for (int i = 0; i < p_count; i++) {
+		const Vector2i &from = p_queries[i][0];
+		const Vector2i &to = p_queries[i][1];
+		real_t optimal = optimal_cost(p_grid, from, to);
+		Vector<Vector2> path = p_grid->get_cell_path(from, to);
+
+		if (optimal < 0) {
+			CHECK_MESSAGE(path.empty(), "Unreachable cells should have no path.");
+			continue;
+		}
+
+		REQUIRE_MESSAGE(path.size() > 0, "Reachable cells should have a path.");
+		CHECK(path[0] == Vector2(from));
+		CHECK(path[path.size() - 1] == Vector2(to));
+
+		real_t cost = path_cost(p_grid, path);
+		CHECK_MESSAGE(cost >= 0, "Paths should only take single steps between walkable cells, without cutting corners.");
+		if (p_optimal) {
+			CHECK_MESSAGE(Math::abs(cost - optimal) < 0.001, "Paths should be as short as possible.");
+		} else {
+			CHECK_MESSAGE(cost > optimal - 0.001, "Paths can't be shorter than the shortest one.");
+		}
+	}
+}
+
+static bool same_path(const Vector<Vector2> &p_a, const Vector<Vector2> &p_b) {
+	if (p_a.size() != p_b.size()) {
+		return false;
+	}
+	for (int i = 0; i < p_a.size(); i++) {
+		if (p_a[i] != p_b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[AStarGrid2D] Shortest paths") {
+	const Vector2i queries[][2] = {
+		{ Vector2i(0, 0), Vector2i(15, 9) },
+		{ Vector2i(3, 2), Vector2i(13, 6) },
+		{ Vector2i(7, 4), Vector2i(0, 9) },
+		{ Vector2i(15, 2), Vector2i(3, 6) },
+		{ Vector2i(11, 8), Vector2i(8, 6) },
+		{ Vector2i(5, 0), Vector2i(5, 8) },
+		{ Vector2i(4, 4), Vector2i(4, 4) },
+		{ Vector2i(0, 0), Vector2i(14, 1) },
+	};
+	const int count = sizeof(queries) / sizeof(queries[0]);
+	const int height = sizeof(MAZE) / sizeof(MAZE[0]);
+
+	SUBCASE("Jump point search") {
+		check_paths(make_grid(MAZE, height, true, 0), queries, count, true);
+	}
+
+	SUBCASE("A* with diagonals") {
+		Ref<AStarGrid2D> grid = make_grid(MAZE, height, true, 0);
+		grid->set_jumping_enabled(false);
+		check_paths(grid, queries, count, true);
+	}
+
+	SUBCASE("A* without diagonals") {
+		check_paths(make_grid(MAZE, height, false, 0), queries, count, true);
+	}
+
+	SUBCASE("HPA*") {
+		// Clusters cut through the corridors here, paths only have to be valid.
+		check_paths(make_grid(MAZE, height, true, 4), queries, count, false);
+		check_paths(make_grid(MAZE, height, false, 4), queries, count, false);
+	}
+
+	SUBCASE("Solid ends") {
+		Ref<AStarGrid2D> grid = make_grid(MAZE, height, true, 0);
+		CHECK(grid->get_cell_path(Vector2i(0, 0), Vector2i(2, 1)).empty());
+		CHECK(grid->get_cell_path(Vector2i(2, 1), Vector2i(0, 0)).empty());
+	}
+}
+
+TEST_CASE("[AStarGrid2D] Hierarchical paths after changing cluster borders") {
+	const Vector2i queries[][2] = {
+		{ Vector2i(0, 0), Vector2i(11, 11) },
+		{ Vector2i(11, 0), Vector2i(0, 11) },
+		{ Vector2i(6, 6), Vector2i(1, 2) },
+		{ Vector2i(10, 10), Vector2i(2, 6) },
+		{ Vector2i(0, 5), Vector2i(11, 5) },
+		{ Vector2i(3, 3), Vector2i(0, 0) },
+	};
+	const int count = sizeof(queries) / sizeof(queries[0]);
+	const int height = sizeof(ROOMS) / sizeof(ROOMS[0]);
+
+	// The hierarchies are kept across the changes, and only rebuilt where needed.
+	Ref<AStarGrid2D> grids[] = {
+		make_grid(ROOMS, height, true, ROOM_SIZE),
+		make_grid(ROOMS, height, false, ROOM_SIZE),
+		make_grid(ROOMS, height, true, 0),
+		make_grid(ROOMS, height, false, 0),
+	};
+	const int grid_count = sizeof(grids) / sizeof(grids[0]);
+
+	for (int i = 0; i < grid_count; i++) {
+		check_paths(grids[i], queries, count, true);
+	}
+
+	// Close the east door of the middle room, on the west border of its neighbour.
+	for (int i = 0; i < grid_count; i++) {
+		grids[i]->set_cell_solid(Vector2i(8, 5));
+		check_paths(grids[i], queries, count, true);
+	}
+
+	// Open a second door between the two rooms at the top left.
+	for (int i = 0; i < grid_count; i++) {
+		grids[i]->set_cell_solid(Vector2i(4, 3), false);
+		check_paths(grids[i], queries, count, true);
+	}
+
+	// Wall off the top left room.
+	for (int i = 0; i < grid_count; i++) {
+		grids[i]->set_cell_solid(Vector2i(4, 1));
+		grids[i]->set_cell_solid(Vector2i(4, 3));
+		grids[i]->set_cell_solid(Vector2i(2, 4));
+		check_paths(grids[i], queries, count, true);
+		CHECK(grids[i]->get_cell_path(Vector2i(0, 0), Vector2i(11, 11)).empty());
+		CHECK(grids[i]->get_cell_path(Vector2i(3, 3), Vector2i(0, 0)).size() > 0);
+	}
+
+	// And open it again, through the south door.
+	for (int i = 0; i < grid_count; i++) {
+		grids[i]->set_cell_solid(Vector2i(2, 4), false);
+		check_paths(grids[i], queries, count, true);
+	}
+}
+
+struct Queries {
+	Ref<AStarGrid2D> grid;
+	LocalVector<Vector2i> from;
+	LocalVector<Vector2i> to;
+	LocalVector<Vector<Vector2>> paths;
+
+	void query(uint32_t p_index, void *p_userdata) {
+		paths[p_index] = grid->get_cell_path(from[p_index], to[p_index]);
+	}
+};
+
+TEST_CASE("[AStarGrid2D] Concurrent queries") {
+	const int height = sizeof(ROOMS) / sizeof(ROOMS[0]);
+
+	Queries queries;
+	queries.grid = make_grid(ROOMS, height, true, ROOM_SIZE);
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < height; x++) {
+			if (queries.grid->is_cell_solid(Vector2i(x, y))) {
+				continue;
+			}
+			queries.from.push_back(Vector2i(x, y));
+			queries.to.push_back(Vector2i(height - 1 - y, x));
+		}
+	}
+	queries.paths.resize(queries.from.size());
+
+	// The first queries rebuild the changed clusters, however many run at once.
+	queries.grid->get_cell_path(Vector2i(0, 0), Vector2i(11, 11));
+	queries.grid->set_cell_solid(Vector2i(8, 5));
+	queries.grid->set_cell_solid(Vector2i(4, 3), false);
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	pool.do_work(queries.from.size(), &queries, &Queries::query, (void *)nullptr);
+	pool.finish();
+
+	int same = 0;
+	for (uint32_t i = 0; i < queries.from.size(); i++) {
+		if (same_path(queries.paths[i], queries.grid->get_cell_path(queries.from[i], queries.to[i]))) {
+			same++;
+		}
+	}
+	CHECK_MESSAGE(same == int(queries.from.size()), "Concurrent queries should find the same paths as serial ones.");
+}
+
+// Memory use and query time of AStarGrid2D (plain A*, jump point search and
+// HPA*) against an AStar2D graph built from the same grid. Grids have random
+// walls covering about a fifth of the cells.
+TEST_CASE("[AStarGrid2D][Benchmark] Against AStar2D" * doctest::skip()) {
+	enum {
+		QUERIES = 100,
+		CLUSTER_SIZE = 16,
+		CHANGED_CELLS = 50,
+	};
+
+	const int sizes[] = { 128, 256, 512 };
+	for (int s = 0; s < 3; s++) {
+		const int size = sizes[s];
+		RandomPCG rng(size);
+
+		uint64_t memory = Memory::get_mem_usage();
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+		Ref<AStarGrid2D> grid;
+		grid.instance();
+		grid->set_size(Vector2i(size, size));
+		for (int i = 0; i < size * size / 40; i++) {
+			Vector2i from(rng.rand() % size, rng.rand() % size);
+			bool horizontal = rng.rand() % 2;
+			grid->fill_solid_region(Rect2i(from, horizontal ? Size2i(8, 1) : Size2i(1, 8)));
+		}
+
+		uint64_t grid_time = OS::get_singleton()->get_ticks_usec() - begin;
+		uint64_t grid_memory = Memory::get_mem_usage() - memory;
+
+		// Same walkable cells and moves, as a generic graph.
+		memory = Memory::get_mem_usage();
+		begin = OS::get_singleton()->get_ticks_usec();
+
+		Ref<AStar2D> graph;
+		graph.instance();
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				if (!grid->is_cell_solid(Vector2i(x, y))) {
+					graph->add_point(y * size + x, Vector2(x, y));
+				}
+			}
+		}
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				int id = y * size + x;
+				if (!graph->has_point(id)) {
+					continue;
+				}
+				bool right = x + 1 < size && graph->has_point(id + 1);
+				bool down = y + 1 < size && graph->has_point(id + size);
+				if (right) {
+					graph->connect_points(id, id + 1);
+				}
+				if (down) {
+					graph->connect_points(id, id + size);
+				}
+				if (right && down && graph->has_point(id + size + 1)) {
+					graph->connect_points(id, id + size + 1);
+				}
+				if (x > 0 && down && graph->has_point(id - 1) && graph->has_point(id + size - 1)) {
+					graph->connect_points(id, id + size - 1);
+				}
+			}
+		}
+
+		uint64_t graph_time = OS::get_singleton()->get_ticks_usec() - begin;
+		uint64_t graph_memory = Memory::get_mem_usage() - memory;
+
+		Vector<Vector2i> points;
+		while (points.size() < QUERIES * 2) {
+			Vector2i cell(rng.rand() % size, rng.rand() % size);
+			if (!grid->is_cell_solid(cell)) {
+				points.push_back(cell);
+			}
+		}
+
+		real_t graph_cost = 0;
+		begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < QUERIES; i++) {
+			int from = points[i * 2].y * size + points[i * 2].x;
+			int to = points[i * 2 + 1].y * size + points[i * 2 + 1].x;
+			graph_cost += path_cost(grid, graph->get_point_path(from, to));
+		}
+		uint64_t graph_query_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+		// Queries borrow a scratch buffer from the grid, which keeps it for the next ones.
+		memory = Memory::get_mem_usage();
+		grid->get_cell_path(points[0], points[1]);
+		uint64_t scratch_memory = Memory::get_mem_usage() - memory;
+
+		real_t costs[3] = {};
+		uint64_t times[3];
+		for (int mode = 0; mode < 3; mode++) {
+			grid->set_jumping_enabled(mode == 1);
+			grid->set_cluster_size(mode == 2 ? CLUSTER_SIZE : 0);
+			grid->update();
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < QUERIES; i++) {
+				costs[mode] += path_cost(grid, grid->get_cell_path(points[i * 2], points[i * 2 + 1]));
+			}
+			times[mode] = OS::get_singleton()->get_ticks_usec() - begin;
+		}
+
+		// Hierarchy memory and rebuild times, full and after a few changed cells.
+		grid->set_cluster_size(0);
+		memory = Memory::get_mem_usage();
+		grid->set_cluster_size(CLUSTER_SIZE);
+		begin = OS::get_singleton()->get_ticks_usec();
+		grid->update();
+		uint64_t build_time = OS::get_singleton()->get_ticks_usec() - begin;
+		uint64_t hierarchy_memory = Memory::get_mem_usage() - memory;
+
+		for (int i = 0; i < CHANGED_CELLS; i++) {
+			Vector2i cell(rng.rand() % size, rng.rand() % size);
+			grid->set_cell_solid(cell, !grid->is_cell_solid(cell));
+		}
+		begin = OS::get_singleton()->get_ticks_usec();
+		grid->update();
+		uint64_t update_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+		print_line(vformat("%dx%d grid:", size, size));
+		print_line(vformat("    AStar2D: %d KiB, built in %.1f msec, %.3f msec/path.", graph_memory / 1024, graph_time / 1000.0, graph_query_time / 1000.0 / QUERIES));
+		print_line(vformat("    AStarGrid2D: %d KiB, built in %.1f msec, %d KiB more of scratch per concurrent query.", grid_memory / 1024, grid_time / 1000.0, scratch_memory / 1024));
+		print_line(vformat("        A*: %.3f msec/path.", times[0] / 1000.0 / QUERIES));
+		print_line(vformat("        Jump point search: %.3f msec/path.", times[1] / 1000.0 / QUERIES));
+		print_line(vformat("        HPA*: %.3f msec/path, %.1f%% longer paths.", times[2] / 1000.0 / QUERIES, (costs[2] / MAX(costs[0], (real_t)CMP_EPSILON) - 1.0) * 100.0));
+		print_line(vformat("        HPA* hierarchy: %d KiB, built in %.1f msec, %.2f msec to update %d changed cells.", hierarchy_memory / 1024, build_time / 1000.0, update_time / 1000.0, CHANGED_CELLS));
+
+		// Both searches are exact over the same moves.
+		CHECK(costs[0] == doctest::Approx(graph_cost).epsilon(0.0001));
+		CHECK(costs[1] == doctest::Approx(graph_cost).epsilon(0.0001));
+	}
+}
+
+} // namespace TestAStarGrid2D
+
+#endif // TEST_ASTAR_GRID_2D_H
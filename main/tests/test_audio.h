@@ -0,0 +1,595 @@
+/*************************************************************************/
+/*  test_audio.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_AUDIO_H
+#define TEST_AUDIO_H
+
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
+#include "scene/resources/audio_stream_sample.h"
+#include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_simd.h"
+#include "servers/audio/effects/audio_effect_amplify.h"
+#include "servers/audio/effects/audio_effect_delay.h"
+#include "servers/audio/effects/audio_effect_distortion.h"
+#include "servers/audio_server.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAudio {
+
+enum {
+	MIX_RATE = 44100,
+	VOICE_CAPACITY = 4,
+};
+
+// Mixes on the calling thread, when the test asks for it.
+class OfflineAudioDriver : public AudioDriver {
+public:
+	virtual const char *get_name() const override { return "Offline"; }
+	virtual Error init() override { return OK; }
+	virtual void start() override {}
+	virtual int get_mix_rate() const override { return MIX_RATE; }
+	virtual SpeakerMode get_speaker_mode() const override { return SPEAKER_MODE_STEREO; }
+	virtual void lock() override {}
+	virtual void unlock() override {}
+	virtual void finish() override {}
+
+	// Mixes one block and returns the loudest sample in it. The block is
+	// appended to r_samples, when given.
+	int32_t mix(Vector<int32_t> *r_samples = nullptr) {
+		int block_size = AudioServer::get_singleton()->thread_get_mix_buffer_size();
+		Vector<int32_t> buffer;
+		buffer.resize(block_size * 2);
+		audio_server_process(block_size, buffer.ptrw(), false);
+		if (r_samples) {
+			r_samples->append_array(buffer);
+		}
+
+		int32_t peak = 0;
+		for (int i = 0; i < buffer.size(); i++) {
+			peak = MAX(peak, ABS(buffer[i]));
+		}
+		return peak;
+	}
+};
+
+class AudioEnvironment {
+	AudioDriver *previous_driver = nullptr;
+
+public:
+	OfflineAudioDriver driver;
+	AudioServer *server = nullptr;
+	Ref<AudioStreamSample> sample;
+
+	explicit AudioEnvironment(int p_voice_capacity = VOICE_CAPACITY) {
+		previous_driver = AudioDriver::get_singleton();
+		driver.set_singleton();
+
+		ProjectSettings::get_singleton()->set_setting("audio/voices/max_voices", p_voice_capacity);
+		server = memnew(AudioServer);
+		server->init();
+
+		// A constant, looped signal, so every block has the same level.
+		Vector<uint8_t> data;
+		data.resize(MIX_RATE * sizeof(int16_t));
+		int16_t *w = (int16_t *)data.ptrw();
+		for (int i = 0; i < MIX_RATE; i++) {
+			w[i] = 8192;
+		}
+
+		sample.instance();
+		sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+		sample->set_mix_rate(MIX_RATE);
+		sample->set_loop_mode(AudioStreamSample::LOOP_FORWARD);
+		sample->set_loop_end(MIX_RATE);
+		sample->set_data(data);
+	}
+
+	~AudioEnvironment() {
+		sample.unref();
+		server->finish();
+		memdelete(server);
+		ProjectSettings::get_singleton()->set_setting("audio/voices/max_voices", Variant());
+
+		if (previous_driver) {
+			previous_driver->set_singleton();
+		}
+	}
+
+	AudioServer::VoiceID play(int p_priority = 0) {
+		return server->voice_play(sample->instance_playback(), 0.0, p_priority);
+	}
+
+	// Makes p_voice heard on the master bus from p_outputs listeners, at
+	// p_volume from each of them.
+	void update(AudioServer::VoiceID p_voice, float p_volume, int p_outputs = 1) {
+		AudioServer::VoiceParams params;
+		params.output_count = p_outputs;
+		for (int i = 0; i < p_outputs; i++) {
+			AudioServer::VoiceOutput &output = params.outputs[i];
+			output.listener = i + 1;
+			output.bus_index = 0;
+			for (int k = 0; k < 4; k++) {
+				output.vol[k] = AudioFrame(p_volume, p_volume);
+			}
+		}
+		server->voice_update(p_voice, params);
+	}
+};
+
+TEST_CASE("[Audio] Playing voices are mixed into the output") {
+	AudioEnvironment env;
+
+	CHECK(env.driver.mix() == 0);
+
+	AudioServer::VoiceID voice = env.play();
+	REQUIRE(env.server->voice_is_playing(voice));
+	env.update(voice, 0.5);
+	env.driver.mix();
+	CHECK_MESSAGE(env.driver.mix() > 0, "A playing voice must be heard.");
+
+	env.server->voice_stop(voice);
+	CHECK_FALSE(env.server->voice_is_playing(voice));
+	env.driver.mix();
+	CHECK_MESSAGE(env.driver.mix() == 0, "A stopped voice must not be heard.");
+}
+
+TEST_CASE("[Audio] Voices are heard from every listener output") {
+	int32_t peaks[2];
+	const int output_counts[2] = { 1, AudioServer::VOICE_MAX_OUTPUTS };
+
+	for (int i = 0; i < 2; i++) {
+		AudioEnvironment env;
+		AudioServer::VoiceID voice = env.play();
+		env.update(voice, 0.05, output_counts[i]);
+		env.driver.mix();
+		peaks[i] = env.driver.mix();
+	}
+
+	REQUIRE(peaks[0] > 0);
+	CHECK_MESSAGE(Math::is_equal_approx(float(peaks[1]) / peaks[0], float(AudioServer::VOICE_MAX_OUTPUTS), 0.01f),
+			"Every output must add the voice once.");
+}
+
+TEST_CASE("[Audio] A full voice pool steals the least important voice") {
+	AudioEnvironment env;
+	REQUIRE(env.server->get_voice_capacity() == VOICE_CAPACITY);
+
+	const float volumes[VOICE_CAPACITY] = { 0.8, 0.1, 0.5, 0.9 };
+	AudioServer::VoiceID voices[VOICE_CAPACITY];
+	for (int i = 0; i < VOICE_CAPACITY; i++) {
+		voices[i] = env.play();
+		env.update(voices[i], volumes[i]);
+	}
+	env.driver.mix();
+
+	// Same priority, so the quietest one goes.
+	AudioServer::VoiceID voice = env.play();
+	CHECK(env.server->voice_is_playing(voice));
+	CHECK_FALSE(env.server->voice_is_playing(voices[1]));
+	CHECK(env.server->voice_is_playing(voices[0]));
+	CHECK(env.server->voice_is_playing(voices[2]));
+	CHECK(env.server->voice_is_playing(voices[3]));
+
+	// A lower priority goes before a quieter voice.
+	env.server->voice_stop(voice);
+	voices[1] = env.play(1);
+	env.update(voices[1], 0.01);
+	env.driver.mix();
+	voice = env.play(1);
+	CHECK(env.server->voice_is_playing(voice));
+	CHECK(env.server->voice_is_playing(voices[1]));
+	CHECK_FALSE(env.server->voice_is_playing(voices[2]));
+
+	// Higher priority voices are never stolen.
+	CHECK_FALSE(env.server->voice_is_playing(env.play(-1)));
+}
+
+TEST_CASE("[Audio] SIMD kernels match the scalar code") {
+	enum {
+		MAX_FRAMES = 1027,
+	};
+
+	RandomPCG rng(1);
+	AudioFrame src[MAX_FRAMES + 1];
+	AudioFrame dst[MAX_FRAMES + 1];
+	AudioFrame expected[MAX_FRAMES + 1];
+	int32_t samples[MAX_FRAMES * 3];
+
+	// Odd sizes finish on the scalar loop, offset buffers aren't aligned.
+	const int sizes[] = { 1, 2, 3, 64, 257, MAX_FRAMES };
+	for (int n = 0; n < 6; n++) {
+		const int frames = sizes[n];
+		for (int offset = 0; offset < 2; offset++) {
+			AudioFrame *s = src + offset;
+			AudioFrame *d = dst + offset;
+			for (int i = 0; i < frames; i++) {
+				s[i] = AudioFrame(rng.random(-1.5f, 1.5f), rng.random(-1.5f, 1.5f));
+				d[i] = AudioFrame(rng.random(-1.5f, 1.5f), rng.random(-1.5f, 1.5f));
+			}
+
+			// mix()
+			for (int i = 0; i < frames; i++) {
+				expected[i] = d[i] + s[i];
+			}
+			AudioSIMD::mix(d, s, frames);
+			int mismatches = 0;
+			for (int i = 0; i < frames; i++) {
+				mismatches += !Math::is_equal_approx(d[i].l, expected[i].l, 1e-6f) || !Math::is_equal_approx(d[i].r, expected[i].r, 1e-6f);
+			}
+			CHECK_MESSAGE(mismatches == 0, "mix() must add the source frames.");
+
+			// mix_ramp()
+			AudioFrame vol(0.25, 0.75);
+			AudioFrame vol_inc(0.5 / frames, -0.5 / frames);
+			AudioFrame v = vol;
+			for (int i = 0; i < frames; i++) {
+				expected[i] = d[i] + s[i] * v;
+				v += vol_inc;
+			}
+			AudioSIMD::mix_ramp(d, s, vol, vol_inc, frames);
+			mismatches = 0;
+			for (int i = 0; i < frames; i++) {
+				mismatches += !Math::is_equal_approx(d[i].l, expected[i].l, 1e-4f) || !Math::is_equal_approx(d[i].r, expected[i].r, 1e-4f);
+			}
+			CHECK_MESSAGE(mismatches == 0, "mix_ramp() must ramp the volume from frame to frame.");
+
+			// scale_peak()
+			AudioFrame expected_peak(0, 0);
+			for (int i = 0; i < frames; i++) {
+				expected[i] = d[i] * 0.5f;
+				expected_peak.l = MAX(expected_peak.l, ABS(expected[i].l));
+				expected_peak.r = MAX(expected_peak.r, ABS(expected[i].r));
+			}
+			AudioFrame peak = AudioSIMD::scale_peak(d, 0.5, frames);
+			mismatches = 0;
+			for (int i = 0; i < frames; i++) {
+				mismatches += !Math::is_equal_approx(d[i].l, expected[i].l, 1e-6f) || !Math::is_equal_approx(d[i].r, expected[i].r, 1e-6f);
+			}
+			CHECK_MESSAGE(mismatches == 0, "scale_peak() must scale every frame.");
+			CHECK(peak.l == doctest::Approx(expected_peak.l));
+			CHECK(peak.r == doctest::Approx(expected_peak.r));
+
+			// to_int32(), both packed and with the channels of other speakers in between.
+			for (int stride = 2; stride <= 3; stride++) {
+				for (int i = 0; i < frames * stride; i++) {
+					samples[i] = 0x5A5A5A5A;
+				}
+				AudioSIMD::to_int32(s, samples, stride, frames);
+				mismatches = 0;
+				int untouched = 0;
+				for (int i = 0; i < frames; i++) {
+					const float channels[2] = { s[i].l, s[i].r };
+					for (int c = 0; c < 2; c++) {
+						int32_t e = int32_t(CLAMP(channels[c], -1.0f, 1.0f) * ((1 << 20) - 1)) * (1 << AudioSIMD::INT32_SCALE_BITS);
+						// One step of difference is allowed, in case the float to int rounding differs.
+						mismatches += ABS(int64_t(samples[i * stride + c]) - e) > (1 << AudioSIMD::INT32_SCALE_BITS);
+					}
+					for (int c = 2; c < stride; c++) {
+						untouched += samples[i * stride + c] == 0x5A5A5A5A;
+					}
+				}
+				CHECK_MESSAGE(mismatches == 0, "to_int32() must clamp and scale every sample.");
+				CHECK_MESSAGE(untouched == frames * (stride - 2), "to_int32() must only write two samples per frame.");
+			}
+		}
+	}
+}
+
+// Mixes a few blocks through a graph of buses with effects and sends:
+// Left and Right send to Mid, Mid and Side send to Master. Left, Right and
+// Side are on the same level, so they're mixed in parallel when threads
+// are used.
+static Vector<int32_t> mix_bus_graph(bool p_use_threads) {
+	enum {
+		BLOCKS = 8,
+	};
+
+	ProjectSettings::get_singleton()->set_setting("audio/buses/use_threads", p_use_threads);
+	Vector<int32_t> samples;
+	{
+		AudioEnvironment env;
+		AudioServer *server = env.server;
+		server->set_bus_count(5);
+		server->set_bus_name(1, "Mid");
+		server->set_bus_name(2, "Left");
+		server->set_bus_name(3, "Right");
+		server->set_bus_name(4, "Side");
+		server->set_bus_send(1, "Master");
+		server->set_bus_send(2, "Mid");
+		server->set_bus_send(3, "Mid");
+		server->set_bus_send(4, "Master");
+		server->set_bus_volume_db(3, -3.0);
+
+		Ref<AudioEffectDistortion> distortion;
+		distortion.instance();
+		distortion->set_mode(AudioEffectDistortion::MODE_OVERDRIVE);
+		distortion->set_drive(0.6);
+		server->add_bus_effect(2, distortion);
+
+		Ref<AudioEffectDelay> delay;
+		delay.instance();
+		delay->set_tap1_delay_ms(20);
+		delay->set_feedback_active(true);
+		delay->set_feedback_delay_ms(30);
+		server->add_bus_effect(3, delay);
+
+		Ref<AudioEffectAmplify> amplify;
+		amplify.instance();
+		amplify->set_volume_db(-6.0);
+		server->add_bus_effect(4, amplify);
+
+		Ref<AudioEffectDelay> mid_delay;
+		mid_delay.instance();
+		mid_delay->set_tap2_delay_ms(45);
+		server->add_bus_effect(1, amplify);
+		server->add_bus_effect(1, mid_delay);
+
+		const float volumes[3] = { 0.3, 0.2, 0.4 };
+		for (int b = 2; b <= 4; b++) {
+			AudioServer::VoiceParams params;
+			params.output_count = 1;
+			AudioServer::VoiceOutput &output = params.outputs[0];
+			output.listener = 1;
+			output.bus_index = b;
+			for (int k = 0; k < 4; k++) {
+				output.vol[k] = AudioFrame(volumes[b - 2], 1.0 - volumes[b - 2]);
+			}
+			server->voice_update(env.play(), params);
+		}
+
+		for (int i = 0; i < BLOCKS; i++) {
+			env.driver.mix(&samples);
+		}
+	}
+	ProjectSettings::get_singleton()->set_setting("audio/buses/use_threads", Variant());
+
+	return samples;
+}
+
+TEST_CASE("[Audio] Buses are mixed the same in parallel and serially") {
+	Vector<int32_t> serial = mix_bus_graph(false);
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	Vector<int32_t> parallel = mix_bus_graph(true);
+	pool.finish();
+
+	REQUIRE(serial.size() > 0);
+	REQUIRE(serial.size() == parallel.size());
+
+	int32_t peak = 0;
+	int mismatches = 0;
+	for (int i = 0; i < serial.size(); i++) {
+		peak = MAX(peak, ABS(serial[i]));
+		mismatches += serial[i] != parallel[i];
+	}
+	CHECK_MESSAGE(peak > 0, "The voices must be heard through the buses.");
+	CHECK_MESSAGE(mismatches == 0, "Every sample must be the same.");
+}
+
+static String read_chunk_id(FileAccess *p_file) {
+	char id[5] = {};
+	p_file->get_buffer((uint8_t *)id, 4);
+	return String(id);
+}
+
+static void capture_print(void *p_lines, const String &p_string, bool p_error) {
+	((Vector<String> *)p_lines)->push_back(p_string);
+}
+
+TEST_CASE("[Audio] The dummy driver renders offline to a WAV file") {
+	enum {
+		OFFLINE_MIX_RATE = 32000,
+		LATENCY = 32, // Msec, exactly 1024 frames at that rate.
+		BUFFER_FRAMES = 1024,
+		STEPS = 60,
+	};
+
+	const String path = OS::get_singleton()->get_cache_path().plus_file("godot_test_audio_offline.wav");
+	ProjectSettings::get_singleton()->set_setting("audio/mix_rate", OFFLINE_MIX_RATE);
+	ProjectSettings::get_singleton()->set_setting("audio/output_latency", LATENCY);
+
+	AudioDriver *previous_driver = AudioDriver::get_singleton();
+	AudioDriverDummy *driver = AudioDriverDummy::get_dummy_singleton();
+	REQUIRE(driver);
+	driver->set_use_threads(false);
+	driver->set_output_file(path);
+	driver->set_singleton();
+	REQUIRE(driver->init() == OK);
+
+	AudioServer *server = memnew(AudioServer);
+	server->init();
+	CHECK_MESSAGE(server->is_mix_cost_tracking(), "Offline mixing tracks what every bus costs.");
+
+	server->set_bus_count(3);
+	server->set_bus_name(1, "Music");
+	server->set_bus_name(2, "Effects");
+	Ref<AudioEffectAmplify> amplify;
+	amplify.instance();
+	server->add_bus_effect(2, amplify);
+
+	Vector<uint8_t> data;
+	data.resize(OFFLINE_MIX_RATE * sizeof(int16_t));
+	int16_t *w = (int16_t *)data.ptrw();
+	for (int i = 0; i < OFFLINE_MIX_RATE; i++) {
+		w[i] = 8192;
+	}
+	Ref<AudioStreamSample> sample;
+	sample.instance();
+	sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+	sample->set_mix_rate(OFFLINE_MIX_RATE);
+	sample->set_loop_mode(AudioStreamSample::LOOP_FORWARD);
+	sample->set_loop_end(OFFLINE_MIX_RATE);
+	sample->set_data(data);
+
+	for (int b = 1; b < 3; b++) {
+		AudioServer::VoiceParams params;
+		params.output_count = 1;
+		params.outputs[0].listener = 1;
+		params.outputs[0].bus_index = b;
+		for (int k = 0; k < 4; k++) {
+			params.outputs[0].vol[k] = AudioFrame(0.25, 0.25);
+		}
+		server->voice_update(server->voice_play(sample->instance_playback()), params);
+	}
+
+	// One second in frame steps, only whole buffers are mixed.
+	for (int i = 0; i < STEPS; i++) {
+		driver->advance(1.0 / STEPS);
+	}
+	const uint32_t frames = OFFLINE_MIX_RATE / BUFFER_FRAMES * BUFFER_FRAMES;
+
+	Vector<String> lines;
+	PrintHandlerList handler;
+	handler.printfunc = capture_print;
+	handler.userdata = &lines;
+	add_print_handler(&handler);
+	driver->finish();
+	remove_print_handler(&handler);
+
+	driver->set_use_threads(true);
+	driver->set_output_file(String());
+	sample.unref();
+	amplify.unref();
+	server->finish();
+	memdelete(server);
+	if (previous_driver) {
+		previous_driver->set_singleton();
+	}
+	ProjectSettings::get_singleton()->set_setting("audio/mix_rate", Variant());
+	ProjectSettings::get_singleton()->set_setting("audio/output_latency", Variant());
+
+	FileAccess *f = FileAccess::open(path, FileAccess::READ);
+	REQUIRE(f);
+	const uint32_t data_size = frames * 2 * sizeof(int16_t);
+	CHECK(f->get_len() == 44 + data_size);
+	CHECK(read_chunk_id(f) == "RIFF");
+	CHECK(f->get_32() == 36 + data_size);
+	CHECK(read_chunk_id(f) == "WAVE");
+	CHECK(read_chunk_id(f) == "fmt ");
+	CHECK(f->get_32() == 16);
+	CHECK_MESSAGE(f->get_16() == 1, "PCM format.");
+	CHECK(f->get_16() == 2);
+	CHECK(f->get_32() == OFFLINE_MIX_RATE);
+	CHECK(f->get_32() == OFFLINE_MIX_RATE * 2 * sizeof(int16_t));
+	CHECK(f->get_16() == 2 * sizeof(int16_t));
+	CHECK(f->get_16() == 16);
+	CHECK(read_chunk_id(f) == "data");
+	CHECK(f->get_32() == data_size);
+
+	int heard = 0;
+	for (uint32_t i = 0; i < frames * 2; i++) {
+		heard += f->get_16() != 0;
+	}
+	CHECK_MESSAGE(heard > 0, "The voices must be written to the file.");
+	CHECK(f->get_position() == f->get_len());
+	memdelete(f);
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(path);
+
+	const char *expected_lines[] = { "Audio: rendered 0.99 s", "  Voices: ", "  Bus \"Master\": ", "  Bus \"Music\": ", "  Bus \"Effects\": ", "    AudioEffectAmplify: " };
+	for (int i = 0; i < 6; i++) {
+		int found = 0;
+		for (int j = 0; j < lines.size(); j++) {
+			found += lines[j].begins_with(expected_lines[i]);
+		}
+		INFO(expected_lines[i]);
+		CHECK_MESSAGE(found == 1, "The mix cost report must have every bus and effect once.");
+	}
+}
+
+TEST_CASE("[Audio][Benchmark] Voice pool mixing" * doctest::skip()) {
+	enum {
+		WARMUP_BLOCKS = 4,
+		BLOCKS = 64,
+	};
+
+	const int counts[] = { 32, 128, 256, 512 };
+	for (int c = 0; c < 4; c++) {
+		AudioEnvironment env(256);
+		// Half the mix rate, so every voice is resampled.
+		env.sample->set_mix_rate(MIX_RATE / 2);
+		RandomPCG rng(counts[c]);
+
+		LocalVector<AudioServer::VoiceID> voices;
+		for (int i = 0; i < counts[c]; i++) {
+			voices.push_back(env.server->voice_play(env.sample->instance_playback(), rng.randf()));
+		}
+
+		uint64_t elapsed = 0;
+		for (int b = 0; b < WARMUP_BLOCKS + BLOCKS; b++) {
+			// Positions change every block, as when the game runs faster than the mix.
+			for (uint32_t i = 0; i < voices.size(); i++) {
+				AudioServer::VoiceParams params;
+				params.output_count = 1;
+				AudioServer::VoiceOutput &output = params.outputs[0];
+				output.listener = 1;
+				output.bus_index = 0;
+				output.filter_gain = rng.random(0.1f, 1.0f);
+				output.pitch_scale = rng.random(0.9f, 1.1f);
+				for (int k = 0; k < 4; k++) {
+					float pan = rng.randf();
+					output.vol[k] = AudioFrame(1.0 - pan, pan) * rng.random(0.01f, 0.2f);
+				}
+				env.server->voice_update(voices[i], params);
+			}
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			env.driver.mix();
+			if (b >= WARMUP_BLOCKS) {
+				elapsed += OS::get_singleton()->get_ticks_usec() - begin;
+			}
+		}
+
+		int mixed = 0;
+		for (uint32_t i = 0; i < voices.size(); i++) {
+			mixed += env.server->voice_is_playing(voices[i]);
+			env.server->voice_stop(voices[i]);
+		}
+
+		int block_size = env.server->thread_get_mix_buffer_size();
+		float msec = elapsed / 1000.0 / BLOCKS;
+		float block_msec = 1000.0 * block_size / MIX_RATE;
+		print_line(vformat("%d voices (%d mixed, the rest stolen): %.3f msec per %d frame block, %.1f%% of its duration.",
+				counts[c], mixed, msec, block_size, 100.0 * msec / block_msec));
+	}
+}
+
+} // namespace TestAudio
+
+#endif // TEST_AUDIO_H
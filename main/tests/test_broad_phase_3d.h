@@ -0,0 +1,252 @@
+/*************************************************************************/
+/*  test_broad_phase_3d.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_BROAD_PHASE_3D_H
+#define TEST_BROAD_PHASE_3D_H
+
+#include "core/math/random_pcg.h"
+#include "core/set.h"
+#include "servers/physics_3d/area_3d_sw.h"
+#include "servers/physics_3d/broad_phase_3d_bvh.h"
+#include "servers/physics_3d/broad_phase_octree.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestBroadPhase3D {
+
+// Keeps the pairs reported by a broadphase. Objects are created with their
+// index as subindex, so pairs can be compared between broadphases.
+struct PairRecorder {
+	Set<uint64_t> pairs;
+	int errors = 0;
+
+	static uint64_t key(int p_a, int p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32 | uint64_t(p_b)) : (uint64_t(p_b) << 32 | uint64_t(p_a));
+	}
+
+	static void *pair(CollisionObject3DSW *p_A, int p_subindex_A, CollisionObject3DSW *p_B, int p_subindex_B, void *p_self) {
+		PairRecorder *self = (PairRecorder *)p_self;
+		uint64_t k = key(p_subindex_A, p_subindex_B);
+		if (self->pairs.has(k)) {
+			self->errors++; // Paired twice.
+		}
+		self->pairs.insert(k);
+		return self;
+	}
+
+	static void unpair(CollisionObject3DSW *p_A, int p_subindex_A, CollisionObject3DSW *p_B, int p_subindex_B, void *p_data, void *p_self) {
+		PairRecorder *self = (PairRecorder *)p_self;
+		if (!self->pairs.erase(key(p_subindex_A, p_subindex_B))) {
+			self->errors++; // Not paired.
+		}
+	}
+};
+
+static bool same_pairs(const Set<uint64_t> &p_a, const Set<uint64_t> &p_b) {
+	if (p_a.size() != p_b.size()) {
+		return false;
+	}
+	for (const Set<uint64_t>::Element *E = p_a.front(), *F = p_b.front(); E; E = E->next(), F = F->next()) {
+		if (E->get() != F->get()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Runs the same objects through the octree and the dynamic BVH side by side.
+struct Scene {
+	enum {
+		OBJECT_COUNT = 400,
+	};
+
+	BroadPhase3DSW *broad_phases[2];
+	PairRecorder recorders[2];
+
+	RandomPCG rng = RandomPCG(1234);
+	const float extent = 20.0;
+
+	Vector<Area3DSW *> owners;
+	Vector<BroadPhase3DSW::ID> ids[2];
+	Vector<AABB> aabbs;
+	Vector<bool> statics;
+	Vector<bool> alive;
+
+	Vector3 random_position() {
+		return Vector3(rng.random(0.0f, extent), rng.random(0.0f, extent), rng.random(0.0f, extent));
+	}
+
+	void create(int p_index) {
+		alive.write[p_index] = true;
+		for (int b = 0; b < 2; b++) {
+			ids[b].write[p_index] = broad_phases[b]->create(owners[p_index], p_index);
+			broad_phases[b]->set_static(ids[b][p_index], statics[p_index]);
+			broad_phases[b]->move(ids[b][p_index], aabbs[p_index]);
+		}
+	}
+
+	void remove(int p_index) {
+		alive.write[p_index] = false;
+		for (int b = 0; b < 2; b++) {
+			broad_phases[b]->remove(ids[b][p_index]);
+		}
+	}
+
+	void move(int p_index, const Vector3 &p_position) {
+		aabbs.write[p_index].position = p_position;
+		for (int b = 0; b < 2; b++) {
+			broad_phases[b]->move(ids[b][p_index], aabbs[p_index]);
+		}
+	}
+
+	void set_static(int p_index, bool p_static) {
+		statics.write[p_index] = p_static;
+		for (int b = 0; b < 2; b++) {
+			broad_phases[b]->set_static(ids[b][p_index], p_static);
+		}
+	}
+
+	// Checks both broadphases against testing every pair of objects.
+	void check_pairs() {
+		Set<uint64_t> expected;
+		for (int i = 0; i < OBJECT_COUNT; i++) {
+			for (int j = i + 1; j < OBJECT_COUNT; j++) {
+				if (alive[i] && alive[j] && !(statics[i] && statics[j]) && aabbs[i].intersects(aabbs[j])) {
+					expected.insert(PairRecorder::key(i, j));
+				}
+			}
+		}
+
+		for (int b = 0; b < 2; b++) {
+			broad_phases[b]->update();
+		}
+
+		CHECK(recorders[0].errors == 0);
+		CHECK(recorders[1].errors == 0);
+		CHECK_MESSAGE(same_pairs(recorders[0].pairs, expected), "Octree pairs must match the intersecting objects.");
+		CHECK_MESSAGE(same_pairs(recorders[1].pairs, expected), "Dynamic BVH pairs must match the intersecting objects.");
+	}
+
+	Scene() {
+		broad_phases[0] = BroadPhaseOctree::_create();
+		broad_phases[1] = BroadPhase3DBVH::_create();
+		for (int b = 0; b < 2; b++) {
+			broad_phases[b]->set_pair_callback(PairRecorder::pair, &recorders[b]);
+			broad_phases[b]->set_unpair_callback(PairRecorder::unpair, &recorders[b]);
+			ids[b].resize(OBJECT_COUNT);
+		}
+
+		owners.resize(OBJECT_COUNT);
+		aabbs.resize(OBJECT_COUNT);
+		statics.resize(OBJECT_COUNT);
+		alive.resize(OBJECT_COUNT);
+
+		for (int i = 0; i < OBJECT_COUNT; i++) {
+			owners.write[i] = memnew(Area3DSW);
+			aabbs.write[i] = AABB(random_position(), Vector3(1, 1, 1) * rng.random(0.5f, 2.0f));
+			statics.write[i] = i % 3 == 0;
+			create(i);
+		}
+	}
+
+	~Scene() {
+		for (int i = 0; i < OBJECT_COUNT; i++) {
+			if (alive[i]) {
+				remove(i);
+			}
+			memdelete(owners[i]);
+		}
+		for (int b = 0; b < 2; b++) {
+			memdelete(broad_phases[b]);
+		}
+	}
+};
+
+TEST_CASE("[BroadPhase3D] Pairs after creation") {
+	Scene scene;
+	scene.check_pairs();
+	CHECK(scene.recorders[1].pairs.size() > 0);
+}
+
+TEST_CASE("[BroadPhase3D] Pairs after moves") {
+	Scene scene;
+	scene.check_pairs();
+
+	for (int f = 0; f < 20; f++) {
+		for (int i = 0; i < Scene::OBJECT_COUNT; i++) {
+			if (scene.statics[i]) {
+				continue;
+			}
+			// Mostly small moves that stay inside the BVH margin, with the occasional teleport.
+			if (scene.rng.rand() % 10 == 0) {
+				scene.move(i, scene.random_position());
+			} else {
+				scene.move(i, scene.aabbs[i].position + Vector3(scene.rng.random(-0.2f, 0.2f), scene.rng.random(-0.2f, 0.2f), scene.rng.random(-0.2f, 0.2f)));
+			}
+		}
+		scene.check_pairs();
+	}
+}
+
+TEST_CASE("[BroadPhase3D] Pairs after static changes") {
+	Scene scene;
+	scene.check_pairs();
+
+	for (int i = 0; i < Scene::OBJECT_COUNT; i += 5) {
+		scene.set_static(i, !scene.statics[i]);
+	}
+	scene.check_pairs();
+}
+
+TEST_CASE("[BroadPhase3D] Pairs after removals") {
+	Scene scene;
+	scene.check_pairs();
+
+	for (int i = 0; i < Scene::OBJECT_COUNT; i += 3) {
+		scene.remove(i);
+	}
+	scene.check_pairs();
+
+	// Reuses the freed IDs.
+	for (int i = 0; i < Scene::OBJECT_COUNT; i += 3) {
+		scene.create(i);
+	}
+	scene.check_pairs();
+
+	for (int i = 0; i < Scene::OBJECT_COUNT; i++) {
+		scene.remove(i);
+	}
+	CHECK(scene.recorders[0].pairs.empty());
+	CHECK(scene.recorders[1].pairs.empty());
+}
+
+} // namespace TestBroadPhase3D
+
+#endif // TEST_BROAD_PHASE_3D_H
@@ -0,0 +1,271 @@
+/*************************************************************************/
+/*  test_command_queue.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_COMMAND_QUEUE_H
+#define TEST_COMMAND_QUEUE_H
+
+#include "core/command_queue_mt.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+#include <thread>
+
+namespace TestCommandQueue {
+
+struct Receiver {
+	uint32_t last[4] = {};
+	uint64_t count = 0;
+	bool out_of_order = false;
+	bool exit = false;
+
+	void add(int p_producer, uint32_t p_sequence) {
+		if (p_sequence != last[p_producer] + 1) {
+			out_of_order = true;
+		}
+		last[p_producer] = p_sequence;
+		count++;
+	}
+
+	int twice(int p_value) {
+		return p_value * 2;
+	}
+
+	void quit() {
+		exit = true;
+	}
+};
+
+void flush_until_exit(CommandQueueMT *p_queue, Receiver *p_receiver) {
+	while (!p_receiver->exit) {
+		p_queue->wait_and_flush();
+	}
+	p_queue->flush_all();
+}
+
+TEST_CASE("[CommandQueueMT] Commands are flushed in order") {
+	CommandQueueMT queue(false);
+	Receiver receiver;
+	uint64_t initial_memory = queue.get_memory_size();
+
+	// More than the initial memory, so the queue has to grow.
+	const uint32_t count = 100000;
+	for (uint32_t i = 1; i <= count; i++) {
+		queue.push(&receiver, &Receiver::add, 0, i);
+	}
+	queue.flush_all();
+
+	CHECK(receiver.count == count);
+	CHECK_FALSE(receiver.out_of_order);
+	CHECK(queue.get_push_count() == count);
+	CHECK(queue.get_flush_count() == count);
+	CHECK(queue.get_memory_size() > initial_memory);
+}
+
+TEST_CASE("[CommandQueueMT] Several producers and a flushing thread") {
+	CommandQueueMT queue(true);
+	Receiver receiver;
+	std::thread flusher(flush_until_exit, &queue, &receiver);
+
+	const uint32_t count = 50000;
+	std::thread producers[3];
+	bool returned_ok[3] = {};
+	for (int p = 0; p < 3; p++) {
+		producers[p] = std::thread([&queue, &receiver, &returned_ok, p, count]() {
+			for (uint32_t i = 1; i <= count; i++) {
+				queue.push(&receiver, &Receiver::add, p, i);
+			}
+			int ret = 0;
+			queue.push_and_ret(&receiver, &Receiver::twice, p + 1, &ret);
+			returned_ok[p] = ret == (p + 1) * 2;
+		});
+	}
+	for (int p = 0; p < 3; p++) {
+		producers[p].join();
+	}
+	queue.push(&receiver, &Receiver::quit);
+	flusher.join();
+
+	CHECK(receiver.count == count * 3);
+	CHECK_FALSE_MESSAGE(receiver.out_of_order, "Commands from a single producer must keep their order.");
+	CHECK(returned_ok[0]);
+	CHECK(returned_ok[1]);
+	CHECK(returned_ok[2]);
+}
+
+TEST_CASE("[CommandQueueMT] Producers wait for memory to be recycled") {
+	CommandQueueMT queue(true);
+	Receiver receiver;
+
+	// Far more than the 16 MiB budget, pushed before the flusher starts, so every
+	// producer ends up waiting for segments while the others keep pushing.
+	const uint32_t count = 400000;
+	std::thread producers[3];
+	for (int p = 0; p < 3; p++) {
+		producers[p] = std::thread([&queue, &receiver, p, count]() {
+			for (uint32_t i = 1; i <= count; i++) {
+				queue.push(&receiver, &Receiver::add, p, i);
+			}
+		});
+	}
+	OS::get_singleton()->delay_usec(100000);
+	std::thread flusher(flush_until_exit, &queue, &receiver);
+	for (int p = 0; p < 3; p++) {
+		producers[p].join();
+	}
+	queue.push(&receiver, &Receiver::quit);
+	flusher.join();
+
+	CHECK(receiver.count == count * 3);
+	CHECK_FALSE(receiver.out_of_order);
+	CHECK(queue.get_stall_count() > 0);
+	CHECK(queue.get_memory_size() <= 16384 * 1024);
+}
+
+// The previous queue design: a fixed ring guarded by a mutex, with the
+// semaphore posted for every command. Kept here as a baseline.
+class LegacyCommandQueue {
+	enum {
+		RING_SIZE = 16384,
+	};
+
+	struct Command {
+		Receiver *receiver;
+		int producer;
+		uint32_t sequence;
+	};
+
+	Command ring[RING_SIZE];
+	uint32_t read_pos = 0;
+	uint32_t write_pos = 0;
+	Mutex mutex;
+	Semaphore sync;
+
+public:
+	void push(Receiver *p_receiver, int p_producer, uint32_t p_sequence) {
+		mutex.lock();
+		while ((write_pos + 1) % RING_SIZE == read_pos) {
+			mutex.unlock();
+			OS::get_singleton()->delay_usec(1000);
+			mutex.lock();
+		}
+		Command &cmd = ring[write_pos];
+		cmd.receiver = p_receiver;
+		cmd.producer = p_producer;
+		cmd.sequence = p_sequence;
+		write_pos = (write_pos + 1) % RING_SIZE;
+		mutex.unlock();
+		sync.post();
+	}
+
+	void wait_and_flush_one() {
+		sync.wait();
+		mutex.lock();
+		if (read_pos == write_pos) {
+			mutex.unlock();
+			return;
+		}
+		Command cmd = ring[read_pos];
+		mutex.unlock();
+		if (cmd.producer < 0) {
+			cmd.receiver->quit();
+		} else {
+			cmd.receiver->add(cmd.producer, cmd.sequence);
+		}
+		mutex.lock();
+		read_pos = (read_pos + 1) % RING_SIZE;
+		mutex.unlock();
+	}
+};
+
+void legacy_flush_until_exit(LegacyCommandQueue *p_queue, Receiver *p_receiver) {
+	while (!p_receiver->exit) {
+		p_queue->wait_and_flush_one();
+	}
+}
+
+TEST_CASE("[CommandQueueMT][Benchmark] Throughput" * doctest::skip()) {
+	const uint32_t count = 1000000;
+	const int producer_counts[] = { 1, 3 };
+
+	for (int k = 0; k < 2; k++) {
+		int producer_count = producer_counts[k];
+
+		Receiver legacy_receiver;
+		LegacyCommandQueue *legacy = memnew(LegacyCommandQueue);
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		std::thread legacy_flusher(legacy_flush_until_exit, legacy, &legacy_receiver);
+		std::thread legacy_producers[3];
+		for (int p = 0; p < producer_count; p++) {
+			legacy_producers[p] = std::thread([legacy, &legacy_receiver, p, count]() {
+				for (uint32_t i = 1; i <= count; i++) {
+					legacy->push(&legacy_receiver, p, i);
+				}
+			});
+		}
+		for (int p = 0; p < producer_count; p++) {
+			legacy_producers[p].join();
+		}
+		legacy->push(&legacy_receiver, -1, 0);
+		legacy_flusher.join();
+		uint64_t legacy_usec = OS::get_singleton()->get_ticks_usec() - begin;
+		memdelete(legacy);
+
+		Receiver receiver;
+		CommandQueueMT queue(true);
+		begin = OS::get_singleton()->get_ticks_usec();
+		std::thread flusher(flush_until_exit, &queue, &receiver);
+		std::thread producers[3];
+		for (int p = 0; p < producer_count; p++) {
+			producers[p] = std::thread([&queue, &receiver, p, count]() {
+				for (uint32_t i = 1; i <= count; i++) {
+					queue.push(&receiver, &Receiver::add, p, i);
+				}
+			});
+		}
+		for (int p = 0; p < producer_count; p++) {
+			producers[p].join();
+		}
+		queue.push(&receiver, &Receiver::quit);
+		flusher.join();
+		uint64_t queue_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		CHECK(receiver.count == legacy_receiver.count);
+
+		OS::get_singleton()->print("%d producers, %d commands each: mutex queue %.1f Mcmd/s, command ring %.1f Mcmd/s (%d stalls, %.2f msec stalled, %d KiB)\n",
+				producer_count, count, double(count * producer_count) / legacy_usec, double(count * producer_count) / queue_usec,
+				int(queue.get_stall_count()), queue.get_stall_usec() / 1000.0, int(queue.get_memory_size() / 1024));
+	}
+}
+
+} // namespace TestCommandQueue
+
+#endif // TEST_COMMAND_QUEUE_H
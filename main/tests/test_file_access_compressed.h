@@ -0,0 +1,207 @@
+/*************************************************************************/
+/*  test_file_access_compressed.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_FILE_ACCESS_COMPRESSED_H
+#define TEST_FILE_ACCESS_COMPRESSED_H
+
+#include "core/io/file_access_compressed.h"
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+#include "core/thread_work_pool.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestFileAccessCompressed {
+
+enum {
+	BLOCK_SIZE = 4096,
+	FILE_SIZE = 300 * BLOCK_SIZE + 123, // Several prefetch groups, and a partial last block.
+};
+
+// Writes FILE_SIZE compressible bytes to a compressed file and keeps them to
+// compare reads against.
+class CompressedFile {
+public:
+	String path;
+	Vector<uint8_t> data;
+	FileAccessCompressed *fa = nullptr;
+
+	CompressedFile() {
+		path = OS::get_singleton()->get_cache_path().plus_file("godot_test_file_access_compressed.bin");
+
+		RandomPCG rng(FILE_SIZE);
+		data.resize(FILE_SIZE);
+		uint8_t *w = data.ptrw();
+		for (int i = 0; i < FILE_SIZE; i++) {
+			w[i] = rng.rand() % 16;
+		}
+
+		FileAccessCompressed writer;
+		writer.configure("GCPF", Compression::MODE_ZSTD, BLOCK_SIZE);
+		if (writer._open(path, FileAccess::WRITE) == OK) {
+			writer.store_buffer(data.ptr(), data.size());
+			writer.close();
+		}
+	}
+
+	// Opens the file for reading, after the thread pool is set up, since it
+	// decides whether blocks are read ahead.
+	bool open() {
+		fa = memnew(FileAccessCompressed);
+		fa->configure("GCPF", Compression::MODE_ZSTD, BLOCK_SIZE);
+		return fa->_open(path, FileAccess::READ) == OK;
+	}
+
+	// Reads p_length bytes at the current position and compares them with
+	// what was written there.
+	bool read_matches(int p_length) {
+		int from = fa->get_position();
+		Vector<uint8_t> read;
+		read.resize(p_length);
+		if (fa->get_buffer(read.ptrw(), p_length) != MIN(p_length, FILE_SIZE - from)) {
+			return false;
+		}
+		for (int i = from; i < MIN(from + p_length, int(FILE_SIZE)); i++) {
+			if (read[i - from] != data[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	~CompressedFile() {
+		if (fa) {
+			memdelete(fa);
+		}
+		DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		da->remove(path);
+	}
+};
+
+static void check_sequential_reads() {
+	CompressedFile file;
+	REQUIRE(file.open());
+	CHECK(file.fa->get_len() == FILE_SIZE);
+
+	// Odd sizes, so reads keep straddling block boundaries.
+	const int sizes[] = { 1, 7, 100, BLOCK_SIZE - 1, BLOCK_SIZE + 1, 3 * BLOCK_SIZE };
+	bool matches = true;
+	for (int i = 0; matches && file.fa->get_position() < FILE_SIZE - 3 * BLOCK_SIZE; i++) {
+		matches = file.read_matches(sizes[i % 6]);
+	}
+	CHECK_MESSAGE(matches, "Every read must return the bytes written there.");
+	CHECK_FALSE(file.fa->eof_reached());
+
+	CHECK(file.read_matches(FILE_SIZE));
+	CHECK(file.fa->eof_reached());
+}
+
+static void check_seeks() {
+	CompressedFile file;
+	REQUIRE(file.open());
+
+	RandomPCG rng(1);
+	bool matches = true;
+	for (int i = 0; matches && i < 200; i++) {
+		// Mostly short jumps around the read position, so cached and
+		// prefetched blocks get reused, with some far ones.
+		int position = int(file.fa->get_position()) + int(rng.rand() % (8 * BLOCK_SIZE)) - 2 * BLOCK_SIZE;
+		if (i % 10 == 0) {
+			position = rng.rand() % FILE_SIZE;
+		}
+		position = CLAMP(position, 0, FILE_SIZE - 1);
+		file.fa->seek(position);
+		CHECK(file.fa->get_position() == uint64_t(position));
+		CHECK(file.fa->get_8() == file.data[position]);
+		matches = file.read_matches(1 + rng.rand() % (2 * BLOCK_SIZE));
+	}
+	CHECK_MESSAGE(matches, "Every read after a seek must return the bytes written there.");
+
+	file.fa->seek_end(-10);
+	CHECK(file.read_matches(10));
+	CHECK(file.fa->get_8() == 0);
+	CHECK(file.fa->eof_reached());
+
+	file.fa->seek(0);
+	CHECK_FALSE(file.fa->eof_reached());
+	CHECK(file.read_matches(FILE_SIZE));
+}
+
+static void check_large_reads() {
+	CompressedFile file;
+	REQUIRE(file.open());
+
+	// Whole blocks, some of them already decompressed by the read before.
+	CHECK(file.read_matches(10));
+	CHECK(file.read_matches(64 * BLOCK_SIZE));
+
+	// Starting at a block boundary, then from the middle of a block.
+	file.fa->seek(100 * BLOCK_SIZE);
+	CHECK(file.read_matches(50 * BLOCK_SIZE));
+	file.fa->seek(20 * BLOCK_SIZE + 1000);
+	CHECK(file.read_matches(200 * BLOCK_SIZE));
+
+	// Everything at once, past the end.
+	file.fa->seek(0);
+	CHECK(file.read_matches(FILE_SIZE + BLOCK_SIZE));
+	CHECK(file.fa->eof_reached());
+}
+
+TEST_CASE("[FileAccessCompressed] get_buffer() reads across blocks") {
+	check_sequential_reads();
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	check_sequential_reads();
+	pool.finish();
+}
+
+TEST_CASE("[FileAccessCompressed] Seeking across blocks") {
+	check_seeks();
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	check_seeks();
+	pool.finish();
+}
+
+TEST_CASE("[FileAccessCompressed] Large reads decompress whole blocks in parallel") {
+	check_large_reads();
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	check_large_reads();
+	pool.finish();
+}
+
+} // namespace TestFileAccessCompressed
+
+#endif // TEST_FILE_ACCESS_COMPRESSED_H
@@ -0,0 +1,401 @@
+/*************************************************************************/
+/*  test_gdscript_vm.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_GDSCRIPT_VM_H
+#define TEST_GDSCRIPT_VM_H
+
+#include "core/script_language.h"
+
+#include "modules/modules_enabled.gen.h"
+#ifdef MODULE_GDSCRIPT_ENABLED
+
+#include "modules/gdscript/gdscript.h"
+#include "modules/gdscript/gdscript_cache.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestGDScriptVM {
+
+// Each function has an untyped and a typed version with the same body, the
+// typed one lets the compiler emit the specialized opcodes.
+static const char *test_code = R"(
+class Intercepted extends RandomNumberGenerator:
+	var seed_sets = 0
+
+	func _set(property, value):
+		if property == "seed":
+			seed_sets += 1
+			return true
+		return false
+
+static func int_math(n):
+	var acc = 0
+	var i = 0
+	while i < n:
+		acc = (acc + i * 3 - (i >> 2)) & 0xFFFFFF
+		i += 1
+	return acc
+
+static func int_math_typed(n: int) -> int:
+	var acc: int = 0
+	var i: int = 0
+	while i < n:
+		acc = (acc + i * 3 - (i >> 2)) & 0xFFFFFF
+		i += 1
+	return acc
+
+static func float_math(n):
+	var x = 0.0
+	var i = 0
+	while i < n:
+		x = x * 0.5 + i / 3.0
+		i += 1
+	return x
+
+static func float_math_typed(n: int) -> float:
+	var x: float = 0.0
+	var i: int = 0
+	while i < n:
+		x = x * 0.5 + i / 3.0
+		i += 1
+	return x
+
+static func vector2_math(n):
+	var v = Vector2()
+	var d = Vector2(0.5, 0.25)
+	var i = 0
+	while i < n:
+		v = v * 0.9 + d
+		v.x += v.y * 0.01
+		i += 1
+	return v
+
+static func vector2_math_typed(n: int) -> Vector2:
+	var v: Vector2 = Vector2()
+	var d: Vector2 = Vector2(0.5, 0.25)
+	var i: int = 0
+	while i < n:
+		v = v * 0.9 + d
+		v.x += v.y * 0.01
+		i += 1
+	return v
+
+static func vector3_math(n):
+	var v = Vector3()
+	var d = Vector3(0.5, 0.25, 0.125)
+	var i = 0
+	while i < n:
+		v = v * 0.9 + d
+		v.z -= v.x * 0.01
+		i += 1
+	return v
+
+static func vector3_math_typed(n: int) -> Vector3:
+	var v: Vector3 = Vector3()
+	var d: Vector3 = Vector3(0.5, 0.25, 0.125)
+	var i: int = 0
+	while i < n:
+		v = v * 0.9 + d
+		v.z -= v.x * 0.01
+		i += 1
+	return v
+
+static func native_calls(n):
+	var rng = RandomNumberGenerator.new()
+	var acc = 0
+	var i = 0
+	while i < n:
+		rng.set_seed(i & 255)
+		acc += rng.get_seed()
+		i += 1
+	return acc
+
+static func native_calls_typed(n: int) -> int:
+	var rng: RandomNumberGenerator = RandomNumberGenerator.new()
+	var acc: int = 0
+	var i: int = 0
+	while i < n:
+		rng.set_seed(i & 255)
+		acc += rng.get_seed()
+		i += 1
+	return acc
+
+static func member_access(n):
+	var rng = RandomNumberGenerator.new()
+	var acc = 0
+	var i = 0
+	while i < n:
+		rng.seed = i & 255
+		acc += rng.seed
+		i += 1
+	return acc
+
+static func member_access_typed(n: int) -> int:
+	var rng: RandomNumberGenerator = RandomNumberGenerator.new()
+	var acc: int = 0
+	var i: int = 0
+	while i < n:
+		rng.seed = i & 255
+		acc += rng.seed
+		i += 1
+	return acc
+
+static func member_access_scripted_typed(n: int) -> int:
+	var scripted: Intercepted = Intercepted.new()
+	var rng: RandomNumberGenerator = scripted
+	var i: int = 0
+	while i < n:
+		rng.seed = i
+		i += 1
+	return scripted.seed_sets
+)";
+
+// Every function reads its operands from one kind of address, see
+// GDScriptFunction::Address.
+static const char *address_code = R"(
+class Counter:
+	var count = 0
+
+const STEP = 3
+
+var total = 1
+var names = ["a"]
+
+func stack_values(a, b):
+	var c = a * b
+	var d = c - a
+	return [a, b, c, d, (a + b) * (c + d)]
+
+func members(n):
+	var i = 0
+	while i < n:
+		total += i
+		names.append(str(i))
+		i += 1
+	return [total, names.size(), names[n]]
+
+func class_constants():
+	var counter = Counter.new()
+	counter.count = STEP
+	return [counter.count, counter is Counter, STEP * 2]
+
+static func list(a, b, c, d):
+	return [a, b, c, d]
+
+static func class_calls(n):
+	return list(n, n + 1, n + 2, n + 3)
+
+func local_constants():
+	const LOCAL = 7
+	return list("text", 1.5, 42, LOCAL)
+
+func globals():
+	var rng = RandomNumberGenerator.new()
+	rng.seed = 5
+	return [rng.seed, OK, ERR_BUG, TYPE_VECTOR3, PI]
+
+func no_value():
+	return
+
+func nils():
+	var unset
+	return [null, unset, no_value()]
+
+func self_values():
+	var me = self
+	self.total = 10
+	return [me == self, self.total, me.get_instance_id() == get_instance_id()]
+)";
+
+// The parts of register_gdscript_types() needed to compile and run a script.
+class ScriptEnvironment {
+	GDScriptLanguage *language;
+	GDScriptCache *cache;
+
+public:
+	Ref<GDScript> script;
+	Error compile_error;
+
+	explicit ScriptEnvironment(const char *p_code = test_code) {
+		language = memnew(GDScriptLanguage);
+		ScriptServer::register_language(language);
+		language->init();
+		cache = memnew(GDScriptCache);
+
+		script.instance();
+		script->set_source_code(p_code);
+		compile_error = script->reload();
+	}
+
+	~ScriptEnvironment() {
+		script.unref();
+
+		memdelete(cache);
+		ScriptServer::unregister_language(language);
+		language->finish();
+		memdelete(language);
+	}
+
+	Variant call(const StringName &p_function, int p_arg) {
+		Variant arg = p_arg;
+		const Variant *args[1] = { &arg };
+		Callable::CallError ce;
+		// GDScript::call() is protected, go through Object.
+		Variant ret = static_cast<Object *>(script.ptr())->call(p_function, args, 1, ce);
+		CHECK_MESSAGE(ce.error == Callable::CallError::CALL_OK, "The script function should be callable.");
+		return ret;
+	}
+};
+
+TEST_CASE("[GDScript] Typed opcodes give the same results as untyped code") {
+	ScriptEnvironment env;
+	REQUIRE_MESSAGE(env.compile_error == OK, "The test script should compile.");
+
+	const char *functions[] = { "int_math", "float_math", "vector2_math", "vector3_math", "native_calls", "member_access", nullptr };
+	for (int i = 0; functions[i]; i++) {
+		Variant untyped_result = env.call(functions[i], 1000);
+		Variant typed_result = env.call(String(functions[i]) + "_typed", 1000);
+		CHECK(untyped_result.get_type() != Variant::NIL);
+		CHECK(typed_result == untyped_result);
+	}
+}
+
+TEST_CASE("[GDScript] Typed property access calls the native setter and getter") {
+	ScriptEnvironment env;
+	REQUIRE_MESSAGE(env.compile_error == OK, "The test script should compile.");
+
+	int64_t expected = 0;
+	for (int i = 0; i < 1000; i++) {
+		expected += i & 255;
+	}
+	CHECK(int64_t(env.call("member_access_typed", 1000)) == expected);
+}
+
+TEST_CASE("[GDScript] Typed property access goes through the script of scripted objects") {
+	ScriptEnvironment env;
+	REQUIRE_MESSAGE(env.compile_error == OK, "The test script should compile.");
+
+	CHECK_MESSAGE(int(env.call("member_access_scripted_typed", 10)) == 10,
+			"_set() of the script should intercept every assignment.");
+}
+
+static Array call_array(Object *p_object, const StringName &p_function, const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant()) {
+	Variant ret = p_object->call(p_function, p_arg1, p_arg2);
+	CHECK_MESSAGE(ret.get_type() == Variant::ARRAY, "The script function should return an array.");
+	return ret;
+}
+
+TEST_CASE("[GDScript] Operands are read from every kind of address") {
+	ScriptEnvironment env(address_code);
+	REQUIRE_MESSAGE(env.compile_error == OK, "The test script should compile.");
+
+	Callable::CallError ce;
+	Variant instance = static_cast<Object *>(env.script.ptr())->call("new", nullptr, 0, ce);
+	REQUIRE(ce.error == Callable::CallError::CALL_OK);
+	Object *object = instance;
+	REQUIRE(object);
+
+	SUBCASE("Stack") {
+		Array values = call_array(object, "stack_values", 3, 4);
+		REQUIRE(values.size() == 5);
+		CHECK(int(values[0]) == 3);
+		CHECK(int(values[1]) == 4);
+		CHECK(int(values[2]) == 12);
+		CHECK(int(values[3]) == 9);
+		CHECK(int(values[4]) == 147);
+	}
+
+	SUBCASE("Member") {
+		Array values = call_array(object, "members", 4);
+		REQUIRE(values.size() == 3);
+		CHECK(int(values[0]) == 7);
+		CHECK(int(values[1]) == 5);
+		CHECK(String(values[2]) == "3");
+		CHECK(int(object->get("total")) == 7);
+	}
+
+	SUBCASE("Class") {
+		// Without an instance, only the class can be the base of the inner call.
+		Array values = call_array(env.script.ptr(), "class_calls", 5);
+		REQUIRE(values.size() == 4);
+		for (int i = 0; i < values.size(); i++) {
+			CHECK(int(values[i]) == 5 + i);
+		}
+	}
+
+	SUBCASE("Class constant") {
+		Array values = call_array(object, "class_constants");
+		REQUIRE(values.size() == 3);
+		CHECK(int(values[0]) == 3);
+		CHECK(bool(values[1]));
+		CHECK(int(values[2]) == 6);
+	}
+
+	SUBCASE("Local constant") {
+		Array values = call_array(object, "local_constants");
+		REQUIRE(values.size() == 4);
+		CHECK(String(values[0]) == "text");
+		CHECK(double(values[1]) == 1.5);
+		CHECK(int(values[2]) == 42);
+		CHECK(int(values[3]) == 7);
+	}
+
+	SUBCASE("Global") {
+		Array values = call_array(object, "globals");
+		REQUIRE(values.size() == 5);
+		CHECK(int(values[0]) == 5);
+		CHECK(int(values[1]) == OK);
+		CHECK(int(values[2]) == ERR_BUG);
+		CHECK(int(values[3]) == Variant::VECTOR3);
+		CHECK(double(values[4]) == Math_PI);
+	}
+
+	SUBCASE("Nil") {
+		CHECK(object->call("no_value").get_type() == Variant::NIL);
+		Array values = call_array(object, "nils");
+		REQUIRE(values.size() == 3);
+		for (int i = 0; i < values.size(); i++) {
+			CHECK(values[i].get_type() == Variant::NIL);
+		}
+	}
+
+	SUBCASE("Self") {
+		Array values = call_array(object, "self_values");
+		REQUIRE(values.size() == 3);
+		CHECK(bool(values[0]));
+		CHECK(int(values[1]) == 10);
+		CHECK(bool(values[2]));
+	}
+}
+
+} // namespace TestGDScriptVM
+
+#endif // MODULE_GDSCRIPT_ENABLED
+
+#endif // TEST_GDSCRIPT_VM_H
@@ -30,23 +30,48 @@
 
 #include "test_main.h"
 
+#include "core/class_db.h"
+#include "core/engine.h"
 #include "core/list.h"
+#include "core/project_settings.h"
+#include "core/register_core_types.h"
+#include "scene/main/node.h"
+#include "scene/scene_string_names.h"
 
 #ifdef DEBUG_ENABLED
 
+#include "test_animation.h"
+#include "test_animation_threads.h"
 #include "test_astar.h"
+#include "test_astar_grid_2d.h"
+#include "test_audio.h"
 #include "test_basis.h"
+#include "test_broad_phase_3d.h"
 #include "test_class_db.h"
+#include "test_command_queue.h"
+#include "test_file_access_compressed.h"
 #include "test_gdscript.h"
+#include "test_gdscript_vm.h"
 #include "test_gui.h"
 #include "test_math.h"
+#include "test_memory.h"
+#include "test_mesh_simplifier.h"
+#include "test_multiplayer.h"
+#include "test_navigation.h"
+#include "test_net_poll.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics_2d.h"
+#include "test_physics_2d_islands.h"
 #include "test_physics_3d.h"
+#include "test_physics_3d_islands.h"
 #include "test_render.h"
+#include "test_rendering_server_scene.h"
+#include "test_resource_loader.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_string_name.h"
+#include "test_thread_work_pool.h"
 #include "test_validate_testing.h"
 
 #include "thirdparty/doctest/doctest.h"
@@ -69,7 +94,6 @@ const char **tests_get_names() {
 		"gd_compiler",
 		"gd_bytecode",
 		"ordered_hash_map",
-		"astar",
 		nullptr
 	};
 
@@ -107,7 +131,25 @@ int test_main(int argc, char *argv[]) {
 	test_context.setOption("abort-after", 5);
 	test_context.setOption("no-breaks", true);
 	delete[] args;
-	return test_context.run();
+
+	// Some tests instance servers, resources and nodes, which expect the same
+	// core environment Main::setup() provides.
+	Engine *engine = memnew(Engine);
+	ClassDB::init();
+	register_core_types();
+	ProjectSettings *globals = memnew(ProjectSettings);
+	register_core_settings();
+	SceneStringNames::create();
+	Node::init_node_hrcr();
+
+	int status = test_context.run();
+
+	SceneStringNames::free();
+	memdelete(globals);
+	memdelete(engine);
+	unregister_core_types();
+
+	return status;
 }
 
 #else
@@ -0,0 +1,236 @@
+/*************************************************************************/
+/*  test_memory.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MEMORY_H
+#define TEST_MEMORY_H
+
+#include "core/list.h"
+#include "core/map.h"
+#include "core/thread_work_pool.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestMemory {
+
+enum {
+	ARENA_SIZE = 16 << 20,
+	ALLOCATIONS = 1024,
+};
+
+static void fill(uint8_t *p_mem, size_t p_size, uint8_t p_value) {
+	for (size_t i = 0; i < p_size; i++) {
+		p_mem[i] = p_value;
+	}
+}
+
+static bool filled_with(const uint8_t *p_mem, size_t p_size, uint8_t p_value) {
+	for (size_t i = 0; i < p_size; i++) {
+		if (p_mem[i] != p_value) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Enables the slab allocator for a test, then restores the previous setting.
+// The arena stays reserved either way.
+class SlabAllocator {
+	bool was_enabled;
+
+public:
+	SlabAllocator(bool p_enabled = true) {
+		was_enabled = Memory::is_slab_allocator_enabled();
+		Memory::set_slab_allocator_enabled(p_enabled, ARENA_SIZE);
+	}
+
+	~SlabAllocator() {
+		Memory::set_slab_allocator_enabled(was_enabled);
+	}
+};
+
+// Counters are published in batches, reading the memory usage flushes them
+// for the calling thread.
+static Memory::AllocatorStats get_stats() {
+	Memory::get_mem_usage();
+	return Memory::get_allocator_stats();
+}
+
+TEST_CASE("[Memory] Small allocations are served by the slab allocator") {
+	SlabAllocator slab;
+	REQUIRE(Memory::is_slab_allocator_enabled());
+
+	Memory::AllocatorStats before = get_stats();
+
+	uint8_t *blocks[ALLOCATIONS];
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		size_t size = 1 + i % 480;
+		blocks[i] = (uint8_t *)memalloc(size);
+		fill(blocks[i], size, i & 0xFF);
+	}
+
+	bool intact = true;
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		intact = intact && filled_with(blocks[i], 1 + i % 480, i & 0xFF);
+	}
+	CHECK_MESSAGE(intact, "Blocks must not overlap.");
+
+	Memory::AllocatorStats after = get_stats();
+	CHECK(after.slab_allocs - before.slab_allocs >= ALLOCATIONS);
+	CHECK(after.slab_arena_used > 0);
+
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		memfree(blocks[i]);
+	}
+
+	// Freed blocks are reused, from the thread's own lists.
+	before = get_stats();
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		memfree(memalloc(64));
+	}
+	after = get_stats();
+	CHECK(after.slab_cache_hits - before.slab_cache_hits >= ALLOCATIONS - 1);
+}
+
+TEST_CASE("[Memory] Reallocating slab blocks keeps their contents") {
+	SlabAllocator slab;
+
+	uint8_t *mem = (uint8_t *)memalloc(20);
+	fill(mem, 20, 0xAB);
+
+	// Within the size class, then to a larger class, then past the slab sizes.
+	const size_t sizes[] = { 24, 200, 4000, 100 };
+	size_t size = 20;
+	for (int i = 0; i < 4; i++) {
+		mem = (uint8_t *)memrealloc(mem, sizes[i]);
+		REQUIRE(mem);
+		CHECK(filled_with(mem, MIN(size, sizes[i]), 0xAB));
+		if (sizes[i] > size) {
+			fill(mem + size, sizes[i] - size, 0xAB);
+		}
+		size = sizes[i];
+	}
+	memfree(mem);
+}
+
+TEST_CASE("[Memory] Slab blocks can be freed after the slab allocator is disabled") {
+	void *blocks[ALLOCATIONS];
+	{
+		SlabAllocator slab;
+		for (int i = 0; i < ALLOCATIONS; i++) {
+			blocks[i] = memalloc(32);
+		}
+	}
+
+	SlabAllocator slab(false);
+	REQUIRE_FALSE(Memory::is_slab_allocator_enabled());
+
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		memfree(blocks[i]);
+	}
+
+	Memory::AllocatorStats before = get_stats();
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		memfree(memalloc(32));
+	}
+	CHECK(get_stats().slab_allocs == before.slab_allocs);
+}
+
+struct Churn {
+	uint64_t sums[4] = {};
+
+	// Builds and tears down containers, the typical small allocations of the
+	// engine, with nodes freed by other threads than the ones allocating them
+	// once they reach the shared lists.
+	void churn(uint32_t p_index, void *p_userdata) {
+		for (int r = 0; r < 16; r++) {
+			List<int> list;
+			Map<int, int> map;
+			for (int i = 0; i < ALLOCATIONS; i++) {
+				list.push_back(i);
+				map[(i * 7919 + p_index) % ALLOCATIONS] = i;
+			}
+			for (Map<int, int>::Element *E = map.front(); E; E = E->next()) {
+				sums[p_index] += E->get();
+			}
+			while (list.size()) {
+				sums[p_index] += list.front()->get();
+				list.pop_front();
+			}
+		}
+	}
+};
+
+TEST_CASE("[Memory] Slab allocator is thread safe") {
+	SlabAllocator slab;
+
+	ThreadWorkPool pool;
+	pool.init(4);
+	Churn churn;
+	pool.do_work(4, &churn, &Churn::churn, (void *)nullptr);
+	pool.finish();
+
+	uint64_t expected = 16 * uint64_t(ALLOCATIONS) * (ALLOCATIONS - 1);
+	for (int i = 0; i < 4; i++) {
+		CHECK(churn.sums[i] == expected);
+	}
+}
+
+#ifdef DEBUG_ENABLED
+struct LargeAllocations {
+	void *blocks[4] = {};
+
+	void allocate(uint32_t p_index, void *p_userdata) {
+		blocks[p_index] = memalloc(1 << 20);
+	}
+};
+
+TEST_CASE("[Memory] Memory usage counts allocations from every thread") {
+	uint64_t before = Memory::get_mem_usage();
+
+	// Large enough to be published right away, rather than batched.
+	ThreadWorkPool pool;
+	pool.init(4);
+	LargeAllocations allocations;
+	pool.do_work(4, &allocations, &LargeAllocations::allocate, (void *)nullptr);
+	pool.finish();
+
+	CHECK(Memory::get_mem_usage() >= before + (4 << 20));
+	CHECK(Memory::get_mem_max_usage() >= before + (4 << 20));
+
+	for (int i = 0; i < 4; i++) {
+		memfree(allocations.blocks[i]);
+	}
+	CHECK(Memory::get_mem_usage() < before + (1 << 20));
+}
+#endif
+
+} // namespace TestMemory
+
+#endif // TEST_MEMORY_H
@@ -0,0 +1,226 @@
+/*************************************************************************/
+/*  test_mesh_simplifier.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESH_SIMPLIFIER_H
+#define TEST_MESH_SIMPLIFIER_H
+
+#include "core/math/mesh_simplifier.h"
+#include "core/math/vector2.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestMeshSimplifier {
+
+struct TestMesh {
+	Vector<Vector3> vertices;
+	Vector<Vector3> normals;
+	Vector<Vector2> uvs;
+	Vector<int> indices;
+};
+
+// UV sphere, the vertices of the first and last meridians are split along the seam.
+static TestMesh make_sphere(int p_segments, int p_rings) {
+	TestMesh mesh;
+	for (int i = 0; i <= p_rings; i++) {
+		for (int j = 0; j <= p_segments; j++) {
+			real_t theta = Math_PI * i / p_rings;
+			real_t phi = Math_TAU * (j % p_segments) / p_segments;
+			Vector3 v(Math::sin(theta) * Math::cos(phi), Math::cos(theta), Math::sin(theta) * Math::sin(phi));
+			if (i == 0 || i == p_rings) {
+				v = Vector3(0, i == 0 ? 1 : -1, 0);
+			}
+			mesh.vertices.push_back(v);
+			mesh.normals.push_back(v);
+			mesh.uvs.push_back(Vector2(real_t(j) / p_segments, real_t(i) / p_rings));
+		}
+	}
+
+	for (int i = 0; i < p_rings; i++) {
+		for (int j = 0; j < p_segments; j++) {
+			int a = i * (p_segments + 1) + j;
+			int b = a + 1;
+			int c = a + p_segments + 1;
+			int d = c + 1;
+			if (i != 0) {
+				mesh.indices.push_back(a);
+				mesh.indices.push_back(b);
+				mesh.indices.push_back(c);
+			}
+			if (i != p_rings - 1) {
+				mesh.indices.push_back(b);
+				mesh.indices.push_back(d);
+				mesh.indices.push_back(c);
+			}
+		}
+	}
+
+	return mesh;
+}
+
+// Subdivided cube with hard edges, every face has its own vertices.
+static TestMesh make_cube(int p_subdivisions) {
+	TestMesh mesh;
+	for (int i = 0; i < 6; i++) {
+		int axis = i / 2;
+		Vector3 normal;
+		normal[axis] = (i % 2) ? 1 : -1;
+		Vector3 u;
+		u[(axis + 1) % 3] = 1;
+		Vector3 v = normal.cross(u);
+
+		int base = mesh.vertices.size();
+		for (int y = 0; y <= p_subdivisions; y++) {
+			for (int x = 0; x <= p_subdivisions; x++) {
+				Vector2 uv = Vector2(x, y) / p_subdivisions;
+				mesh.vertices.push_back(normal + u * (uv.x * 2.0 - 1.0) + v * (uv.y * 2.0 - 1.0));
+				mesh.normals.push_back(normal);
+				mesh.uvs.push_back(uv);
+			}
+		}
+
+		for (int y = 0; y < p_subdivisions; y++) {
+			for (int x = 0; x < p_subdivisions; x++) {
+				int a = base + y * (p_subdivisions + 1) + x;
+				int b = a + 1;
+				int c = a + p_subdivisions + 1;
+				int d = c + 1;
+				mesh.indices.push_back(a);
+				mesh.indices.push_back(b);
+				mesh.indices.push_back(d);
+				mesh.indices.push_back(a);
+				mesh.indices.push_back(d);
+				mesh.indices.push_back(c);
+			}
+		}
+	}
+
+	return mesh;
+}
+
+// Triangles with an edge longer than p_max_uv_distance in UV space, which
+// only happens when they join vertices from both sides of a seam.
+static int count_seam_crossings(const TestMesh &p_mesh, const Vector<int> &p_indices, real_t p_max_uv_distance) {
+	int count = 0;
+	for (int i = 0; i < p_indices.size(); i += 3) {
+		for (int j = 0; j < 3; j++) {
+			int a = p_indices[i + j];
+			int b = p_indices[i + (j + 1) % 3];
+			if (p_mesh.uvs[a].distance_to(p_mesh.uvs[b]) > p_max_uv_distance) {
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+// Triangles facing away from the normals of their vertices.
+static int count_flipped(const TestMesh &p_mesh, const Vector<int> &p_indices) {
+	int count = 0;
+	for (int i = 0; i < p_indices.size(); i += 3) {
+		const Vector3 &v0 = p_mesh.vertices[p_indices[i]];
+		Vector3 face_normal = (p_mesh.vertices[p_indices[i + 1]] - v0).cross(p_mesh.vertices[p_indices[i + 2]] - v0);
+		Vector3 vertex_normal = p_mesh.normals[p_indices[i]] + p_mesh.normals[p_indices[i + 1]] + p_mesh.normals[p_indices[i + 2]];
+		if (face_normal.dot(vertex_normal) <= 0) {
+			count++;
+		}
+	}
+	return count;
+}
+
+static void check_lods(const TestMesh &p_mesh, const Vector<MeshSimplifier::LOD> &p_lods, real_t p_max_uv_distance, float p_max_error) {
+	int index_count = p_mesh.indices.size();
+	float error = 0;
+
+	for (int i = 0; i < p_lods.size(); i++) {
+		const Vector<int> &indices = p_lods[i].indices;
+
+		REQUIRE(indices.size() > 0);
+		CHECK(indices.size() % 3 == 0);
+		CHECK_MESSAGE(indices.size() < index_count, "Every LOD should have fewer triangles than the previous one.");
+		CHECK_MESSAGE(p_lods[i].error > error, "LOD errors should be strictly increasing.");
+		CHECK(p_lods[i].error <= p_max_error);
+
+		bool in_range = true;
+		for (int j = 0; j < indices.size(); j++) {
+			in_range = in_range && indices[j] >= 0 && indices[j] < p_mesh.vertices.size();
+		}
+		REQUIRE(in_range);
+
+		CHECK_MESSAGE(count_seam_crossings(p_mesh, indices, p_max_uv_distance) == 0, "LODs shouldn't connect the two sides of a seam.");
+		CHECK_MESSAGE(count_flipped(p_mesh, indices) == 0, "LODs shouldn't flip triangles away from their normals.");
+
+		index_count = indices.size();
+		error = p_lods[i].error;
+	}
+}
+
+TEST_CASE("[MeshSimplifier] Sphere LODs") {
+	TestMesh sphere = make_sphere(64, 32);
+	REQUIRE(count_seam_crossings(sphere, sphere.indices, 0.5) == 0);
+	REQUIRE(count_flipped(sphere, sphere.indices) == 0);
+
+	Vector<MeshSimplifier::LOD> lods = MeshSimplifier::generate_lods(sphere.vertices, sphere.normals, sphere.indices, 0.2);
+	CHECK(lods.size() >= 3);
+	check_lods(sphere, lods, 0.5, 0.2);
+}
+
+TEST_CASE("[MeshSimplifier] Hard edged cube LODs") {
+	TestMesh cube = make_cube(16);
+	Vector<MeshSimplifier::LOD> lods = MeshSimplifier::generate_lods(cube.vertices, cube.normals, cube.indices, 0.2);
+	REQUIRE(lods.size() > 0);
+	check_lods(cube, lods, 1.5, 0.2);
+
+	// Faces are flat, so each one ends up as two triangles with no error.
+	CHECK(lods[lods.size() - 1].indices.size() == 6 * 2 * 3);
+	CHECK(lods[lods.size() - 1].error < 0.001);
+}
+
+TEST_CASE("[MeshSimplifier] Simplify to a target") {
+	TestMesh sphere = make_sphere(32, 16);
+
+	float error = -1;
+	Vector<int> indices = MeshSimplifier::simplify(sphere.vertices, sphere.normals, sphere.indices, sphere.indices.size() / 4, 1.0, &error);
+	CHECK(indices.size() > 0);
+	CHECK(indices.size() <= sphere.indices.size() / 4);
+	CHECK(error >= 0);
+	CHECK(error <= 1.0);
+	CHECK(count_seam_crossings(sphere, indices, 0.5) == 0);
+	CHECK(count_flipped(sphere, indices) == 0);
+
+	// A tight error bound stops early, above the target.
+	Vector<int> tight = MeshSimplifier::simplify(sphere.vertices, sphere.normals, sphere.indices, 3, 0.001, &error);
+	CHECK(tight.size() > 3);
+	CHECK(error <= 0.001);
+}
+
+} // namespace TestMeshSimplifier
+
+#endif // TEST_MESH_SIMPLIFIER_H
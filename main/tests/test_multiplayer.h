@@ -0,0 +1,313 @@
+/*************************************************************************/
+/*  test_multiplayer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_MULTIPLAYER_H
+#define TEST_MULTIPLAYER_H
+
+#include "core/io/marshalls.h"
+#include "core/io/multiplayer_api.h"
+#include "scene/3d/node_3d.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestMultiplayer {
+
+enum {
+	SERVER_ID = 1,
+	CLIENT_ID = 2,
+	PATH_ID = 1,
+
+	// Value encodings in replication packets, as MultiplayerAPI writes them.
+	VALUE_VARIANT = 0,
+	VALUE_ABSOLUTE,
+	VALUE_DELTA,
+	VALUE_TYPE_SHIFT = 2,
+};
+
+// Hands the packets given to receive() to the MultiplayerAPI, and keeps the ones it sends.
+class TestPeer : public NetworkedMultiplayerPeer {
+	struct Packet {
+		int from = 0;
+		Vector<uint8_t> data;
+	};
+
+	List<Packet> incoming;
+	Packet current;
+
+public:
+	Vector<Vector<uint8_t>> sent;
+
+	void receive(int p_from, const Vector<uint8_t> &p_data) {
+		Packet packet;
+		packet.from = p_from;
+		packet.data = p_data;
+		incoming.push_back(packet);
+	}
+
+	virtual int get_available_packet_count() const override { return incoming.size(); }
+	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) override {
+		ERR_FAIL_COND_V(incoming.empty(), ERR_UNAVAILABLE);
+		current = incoming.front()->get();
+		incoming.pop_front();
+		*r_buffer = current.data.ptr();
+		r_buffer_size = current.data.size();
+		return OK;
+	}
+	virtual Error put_packet(const uint8_t *p_buffer, int p_buffer_size) override {
+		Vector<uint8_t> packet;
+		packet.resize(p_buffer_size);
+		copymem(packet.ptrw(), p_buffer, p_buffer_size);
+		sent.push_back(packet);
+		return OK;
+	}
+	virtual int get_max_packet_size() const override { return 1 << 16; }
+
+	virtual void set_transfer_mode(TransferMode p_mode) override {}
+	virtual TransferMode get_transfer_mode() const override { return TRANSFER_MODE_UNRELIABLE; }
+	virtual void set_target_peer(int p_peer_id) override {}
+	virtual int get_packet_peer() const override { return incoming.empty() ? 0 : incoming.front()->get().from; }
+	virtual bool is_server() const override { return false; }
+	virtual void poll() override {}
+	virtual int get_unique_id() const override { return CLIENT_ID; }
+	virtual void set_refuse_new_connections(bool p_enable) override {}
+	virtual bool is_refusing_new_connections() const override { return false; }
+	virtual ConnectionStatus get_connection_status() const override { return CONNECTION_CONNECTED; }
+};
+
+// Writes a replication packet the way a server with replication batching
+// does. Floats are quantized with the default step of 1/1024.
+class ReplicationPacket {
+	void _put_varuint(uint32_t p_value) {
+		while (p_value >= 0x80) {
+			data.push_back(uint8_t(p_value) | 0x80);
+			p_value >>= 7;
+		}
+		data.push_back(p_value);
+	}
+
+	void _put_vector3(const Vector3 &p_value) {
+		for (int i = 0; i < 3; i++) {
+			int32_t q = int32_t(Math::round(p_value[i] * 1024));
+			_put_varuint((uint32_t(q) << 1) ^ uint32_t(q >> 31)); // Zigzag encoded.
+		}
+	}
+
+public:
+	Vector<uint8_t> data;
+
+	void put_absolute(uint16_t p_property, const Vector3 &p_value) {
+		_put_varuint(PATH_ID);
+		_put_varuint(p_property);
+		data.push_back(VALUE_ABSOLUTE | (Variant::VECTOR3 << VALUE_TYPE_SHIFT));
+		_put_vector3(p_value);
+	}
+
+	// The delta is added to the value received p_base_offset packets earlier.
+	void put_delta(uint16_t p_property, uint8_t p_base_offset, const Vector3 &p_delta) {
+		_put_varuint(PATH_ID);
+		_put_varuint(p_property);
+		data.push_back(VALUE_DELTA | (Variant::VECTOR3 << VALUE_TYPE_SHIFT));
+		data.push_back(p_base_offset);
+		_put_vector3(p_delta);
+	}
+
+	void put_bool(uint16_t p_property, bool p_value) {
+		_put_varuint(PATH_ID);
+		_put_varuint(p_property);
+		data.push_back(VALUE_VARIANT | (Variant::BOOL << VALUE_TYPE_SHIFT));
+		data.push_back((p_value ? 0x80 : 0) | Variant::BOOL); // Encoded by the MultiplayerAPI variant compression.
+	}
+
+	explicit ReplicationPacket(uint16_t p_seq) {
+		data.resize(3);
+		data.write[0] = MultiplayerAPI::NETWORK_COMMAND_REPLICATION;
+		encode_uint16(p_seq, data.ptrw() + 1);
+	}
+};
+
+struct Ack {
+	uint16_t seq = 0;
+	uint32_t mask = 0;
+};
+
+// A client receiving the replicated properties of one player node. Nodes
+// aren't in a SceneTree, receiving only needs paths relative to the root.
+struct Client {
+	Ref<MultiplayerAPI> api;
+	Ref<TestPeer> peer;
+	Node *root = nullptr;
+	Node3D *player = nullptr;
+	uint16_t translation_id = 0;
+	uint16_t visible_id = 0;
+
+	void receive(const ReplicationPacket &p_packet) {
+		peer->receive(SERVER_ID, p_packet.data);
+	}
+
+	// Polls, and returns the acknowledgements sent since the last call.
+	Vector<Ack> poll() {
+		api->poll();
+
+		Vector<Ack> acks;
+		for (int i = 0; i < peer->sent.size(); i++) {
+			const Vector<uint8_t> &packet = peer->sent[i];
+			if (packet[0] == MultiplayerAPI::NETWORK_COMMAND_REPLICATION_ACK) {
+				REQUIRE(packet.size() == 7);
+				Ack ack;
+				ack.seq = decode_uint16(packet.ptr() + 1);
+				ack.mask = decode_uint32(packet.ptr() + 3);
+				acks.push_back(ack);
+			}
+		}
+		peer->sent.clear();
+		return acks;
+	}
+
+	Client() {
+		root = memnew(Node);
+		root->set_name("Client");
+		player = memnew(Node3D);
+		player->set_name("Player");
+		translation_id = player->rset_config("translation", MultiplayerAPI::RPC_MODE_REMOTE);
+		visible_id = player->rset_config("visible", MultiplayerAPI::RPC_MODE_REMOTE);
+		root->add_child(player);
+
+		peer.instance();
+		api.instance();
+		api->set_root_node(root);
+		api->set_network_peer(peer);
+
+		// Values always refer to the player by path ID, which the server sends first.
+		CharString md5 = player->get_rpc_md5().utf8();
+		CharString path = String("Player").utf8();
+		Vector<uint8_t> simplify;
+		simplify.resize(1 + 33 + 4 + path.length() + 1);
+		simplify.write[0] = MultiplayerAPI::NETWORK_COMMAND_SIMPLIFY_PATH;
+		copymem(simplify.ptrw() + 1, md5.get_data(), 33);
+		encode_uint32(PATH_ID, simplify.ptrw() + 34);
+		copymem(simplify.ptrw() + 38, path.get_data(), path.length() + 1);
+		peer->receive(SERVER_ID, simplify);
+		poll();
+	}
+
+	~Client() {
+		api->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		memdelete(root);
+	}
+};
+
+TEST_CASE("[Multiplayer] Replicated values are applied and acknowledged") {
+	Client client;
+
+	ReplicationPacket packet(0);
+	packet.put_absolute(client.translation_id, Vector3(1.5, -2.25, 3));
+	packet.put_bool(client.visible_id, false);
+	client.receive(packet);
+	Vector<Ack> acks = client.poll();
+
+	CHECK(client.player->get_translation() == Vector3(1.5, -2.25, 3));
+	CHECK_FALSE(client.player->is_visible());
+	REQUIRE(acks.size() == 1);
+	CHECK(acks[0].seq == 0);
+	CHECK(acks[0].mask == 0);
+
+	CHECK_MESSAGE(client.poll().empty(), "Packets must only be acknowledged once.");
+}
+
+TEST_CASE("[Multiplayer] Deltas refer to values from before dropped packets") {
+	Client client;
+
+	ReplicationPacket first(0);
+	first.put_absolute(client.translation_id, Vector3(1, 1, 1));
+	client.receive(first);
+	client.poll();
+
+	// The second packet is lost, the server sends its delta against the first one.
+	ReplicationPacket lost(1);
+	lost.put_absolute(client.translation_id, Vector3(2, 2, 2));
+	ReplicationPacket third(2);
+	third.put_delta(client.translation_id, 2, Vector3(0.5, 0, -0.5));
+	client.receive(third);
+	Vector<Ack> acks = client.poll();
+
+	CHECK(client.player->get_translation() == Vector3(1.5, 1, 0.5));
+	REQUIRE(acks.size() == 1);
+	CHECK(acks[0].seq == 2);
+	CHECK_MESSAGE(acks[0].mask == 0b10, "Only the first packet was received before the last one.");
+
+	// Arriving late, the second packet is acknowledged but must not replace the newer value.
+	client.receive(lost);
+	acks = client.poll();
+
+	CHECK(client.player->get_translation() == Vector3(1.5, 1, 0.5));
+	REQUIRE(acks.size() == 1);
+	CHECK(acks[0].seq == 2);
+	CHECK(acks[0].mask == 0b11);
+}
+
+TEST_CASE("[Multiplayer] Acknowledgements follow the sequence across its wrap around") {
+	Client client;
+
+	ReplicationPacket packets[4] = { ReplicationPacket(65534), ReplicationPacket(65535), ReplicationPacket(0), ReplicationPacket(1) };
+	packets[0].put_absolute(client.translation_id, Vector3(10, 0, 0));
+	packets[1].put_delta(client.translation_id, 1, Vector3(1, 0, 0));
+	packets[2].put_delta(client.translation_id, 2, Vector3(0, 2, 0)); // Against 65534.
+	packets[3].put_delta(client.translation_id, 1, Vector3(0, 0, 3)); // Against 0.
+	for (int i = 0; i < 4; i++) {
+		client.receive(packets[i]);
+	}
+	Vector<Ack> acks = client.poll();
+
+	CHECK(client.player->get_translation() == Vector3(10, 2, 3));
+	REQUIRE(acks.size() == 1);
+	CHECK(acks[0].seq == 1);
+	CHECK(acks[0].mask == 0b111);
+}
+
+TEST_CASE("[Multiplayer] Deltas against an unknown state are rejected") {
+	Client client;
+
+	ReplicationPacket first(0);
+	first.put_absolute(client.translation_id, Vector3(1, 1, 1));
+	client.receive(first);
+	client.poll();
+
+	// Refers to packet 2, which never arrived.
+	ReplicationPacket bogus(5);
+	bogus.put_delta(client.translation_id, 3, Vector3(1, 1, 1));
+	client.receive(bogus);
+	Vector<Ack> acks = client.poll();
+
+	CHECK_MESSAGE(client.player->get_translation() == Vector3(1, 1, 1), "The value must be left as it was.");
+	CHECK_MESSAGE(acks.empty(), "The server must not believe the packet arrived, so it sends the value in full again.");
+}
+
+} // namespace TestMultiplayer
+
+#endif // TEST_MULTIPLAYER_H
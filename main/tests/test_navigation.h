@@ -0,0 +1,586 @@
+/*************************************************************************/
+/*  test_navigation.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_NAVIGATION_H
+#define TEST_NAVIGATION_H
+
+#include "modules/modules_enabled.gen.h"
+#ifdef MODULE_GDNAVIGATION_ENABLED
+
+#include "core/callable_method_pointer.h"
+#include "core/math/face3.h"
+#include "core/math/geometry_3d.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/thread_work_pool.h"
+#include "modules/gdnavigation/gd_navigation_server.h"
+#include "modules/gdnavigation/nav_map.h"
+#include "modules/gdnavigation/nav_region.h"
+#include "scene/resources/navigation_mesh.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+#include <algorithm>
+
+namespace TestNavigation {
+
+enum {
+	SIZE = 32,
+	QUERIES = 200,
+};
+
+// A rolling terrain of SIZE x SIZE cells split in two triangles each, with a
+// few walls and square holes. All the cells stay connected.
+static Ref<NavigationMesh> create_navmesh() {
+	Vector<Vector3> vertices;
+	for (int z = 0; z <= SIZE; z++) {
+		for (int x = 0; x <= SIZE; x++) {
+			vertices.push_back(Vector3(x, Math::sin(x * 0.3) * Math::cos(z * 0.2) * 2.0, z));
+		}
+	}
+
+	Ref<NavigationMesh> navmesh;
+	navmesh.instance();
+	navmesh->set_vertices(vertices);
+	for (int z = 0; z < SIZE; z++) {
+		for (int x = 0; x < SIZE; x++) {
+			bool wall = (x == 10 && z < 24) || (x == 21 && z > 8) || (z == 16 && x > 24);
+			bool hole = x >= 4 && x < 8 && z >= 4 && z < 8;
+			if (wall || hole) {
+				continue;
+			}
+			int a = z * (SIZE + 1) + x;
+			int b = a + 1;
+			int c = a + SIZE + 1;
+			int d = c + 1;
+			Vector<int> poly;
+			poly.push_back(a);
+			poly.push_back(d);
+			poly.push_back(b);
+			navmesh->add_polygon(poly);
+			poly.write[0] = a;
+			poly.write[1] = c;
+			poly.write[2] = d;
+			navmesh->add_polygon(poly);
+		}
+	}
+	return navmesh;
+}
+
+// Nearest polygon search, testing every triangle of the map.
+static const gd::Polygon *linear_closest_polygon(const gd::MapSnapshot *p_snapshot, const Vector3 &p_point, Vector3 &r_point, Vector3 &r_normal) {
+	const gd::Polygon *closest_poly = nullptr;
+	real_t closest_point_d = 1e20;
+	for (size_t i = 0; i < p_snapshot->polygons.size(); i++) {
+		const gd::Polygon &p = p_snapshot->polygons[i];
+		for (size_t point_id = 2; point_id < p.points.size(); point_id++) {
+			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
+			const Vector3 inters = f.get_closest_point_to(p_point);
+			const real_t d = inters.distance_to(p_point);
+			if (d < closest_point_d) {
+				closest_poly = &p;
+				closest_point_d = d;
+				r_point = inters;
+				r_normal = f.get_plane().normal;
+			}
+		}
+	}
+	return closest_poly;
+}
+
+// The path search as it was before the open list became a heap: the open
+// list is scanned for the cheapest polygon and visited polygons are found
+// with std::find. Returns the unoptimized path, through the polygon entries.
+static Vector<Vector3> linear_path(const gd::MapSnapshot *p_snapshot, const Vector3 &p_origin, const Vector3 &p_destination) {
+	Vector3 begin_point;
+	Vector3 end_point;
+	Vector3 normal;
+	const gd::Polygon *begin_poly = linear_closest_polygon(p_snapshot, p_origin, begin_point, normal);
+	const gd::Polygon *end_poly = linear_closest_polygon(p_snapshot, p_destination, end_point, normal);
+	if (!begin_poly || !end_poly) {
+		return Vector<Vector3>();
+	}
+
+	Vector<Vector3> path;
+	if (begin_poly == end_poly) {
+		path.push_back(begin_point);
+		path.push_back(end_point);
+		return path;
+	}
+
+	std::vector<gd::NavigationPoly> navigation_polys;
+	List<uint32_t> open_list;
+	navigation_polys.push_back(gd::NavigationPoly(begin_poly));
+	navigation_polys[0].entry = begin_point;
+	open_list.push_back(0);
+	int least_cost_id = 0;
+
+	while (navigation_polys[least_cost_id].poly != end_poly) {
+		for (size_t i = 0; i < navigation_polys[least_cost_id].poly->edges.size(); i++) {
+			gd::NavigationPoly *least_cost_poly = &navigation_polys[least_cost_id];
+			const gd::Edge &edge = least_cost_poly->poly->edges[i];
+			if (!edge.other_polygon) {
+				continue;
+			}
+
+			Vector3 edge_line[2] = {
+				least_cost_poly->poly->points[i].pos,
+				least_cost_poly->poly->points[(i + 1) % least_cost_poly->poly->points.size()].pos
+			};
+			const Vector3 new_entry = Geometry3D::get_closest_point_to_segment(least_cost_poly->entry, edge_line);
+			const float new_distance = least_cost_poly->entry.distance_to(new_entry) + least_cost_poly->traveled_distance;
+
+			std::vector<gd::NavigationPoly>::iterator it = std::find(navigation_polys.begin(), navigation_polys.end(), gd::NavigationPoly(edge.other_polygon));
+			if (it != navigation_polys.end()) {
+				if (it->traveled_distance > new_distance) {
+					it->prev_navigation_poly_id = least_cost_id;
+					it->back_navigation_edge = edge.other_edge;
+					it->traveled_distance = new_distance;
+					it->entry = new_entry;
+				}
+			} else {
+				gd::NavigationPoly np(edge.other_polygon);
+				np.self_id = navigation_polys.size();
+				np.prev_navigation_poly_id = least_cost_id;
+				np.back_navigation_edge = edge.other_edge;
+				np.traveled_distance = new_distance;
+				np.entry = new_entry;
+				navigation_polys.push_back(np);
+				open_list.push_back(np.self_id);
+			}
+		}
+
+		open_list.erase(least_cost_id);
+		if (open_list.empty()) {
+			return Vector<Vector3>(); // The map is connected, this doesn't happen.
+		}
+
+		float least_cost = 1e30;
+		for (List<uint32_t>::Element *E = open_list.front(); E; E = E->next()) {
+			const gd::NavigationPoly &np = navigation_polys[E->get()];
+			float cost = np.traveled_distance + np.entry.distance_to(end_point);
+			if (cost < least_cost) {
+				least_cost_id = np.self_id;
+				least_cost = cost;
+			}
+		}
+	}
+
+	path.push_back(end_point);
+	for (int np_id = least_cost_id; np_id != -1; np_id = navigation_polys[np_id].prev_navigation_poly_id) {
+		path.push_back(navigation_polys[np_id].entry);
+	}
+	path.invert();
+	return path;
+}
+
+struct NavigationMap {
+	NavMap map;
+	NavRegion region;
+
+	NavigationMap() {
+		region.set_mesh(create_navmesh());
+		region.set_map(&map);
+		map.add_region(&region);
+		map.sync();
+	}
+
+	~NavigationMap() {
+		map.remove_region(&region);
+	}
+};
+
+static bool same_path(const Vector<Vector3> &p_a, const Vector<Vector3> &p_b) {
+	if (p_a.size() != p_b.size()) {
+		return false;
+	}
+	for (int i = 0; i < p_a.size(); i++) {
+		if (p_a[i] != p_b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static Vector<Vector3> random_points(int p_count) {
+	RandomPCG rng(SIZE);
+	Vector<Vector3> points;
+	for (int i = 0; i < p_count; i++) {
+		// Some points are off the map, or above and below it.
+		Vector3 point(rng.randf() * (SIZE + 8) - 4, rng.randf() * 8 - 4, rng.randf() * (SIZE + 8) - 4);
+		if (i % 4 == 0) {
+			// Above a vertex, the polygons around it are tied.
+			point.x = Math::round(point.x);
+			point.z = Math::round(point.z);
+		}
+		points.push_back(point);
+	}
+	return points;
+}
+
+TEST_CASE("[Navigation] Closest points match a search over every polygon") {
+	NavigationMap nav;
+	gd::MapSnapshot *snapshot = nav.map.acquire_snapshot();
+	REQUIRE(snapshot->polygons.size() > 0);
+
+	Vector<Vector3> points = random_points(QUERIES);
+	int same_point = 0;
+	int same_normal = 0;
+	for (int i = 0; i < points.size(); i++) {
+		Vector3 point;
+		Vector3 normal;
+		REQUIRE(linear_closest_polygon(snapshot, points[i], point, normal));
+		same_point += nav.map.get_closest_point(points[i]) == point;
+		same_normal += nav.map.get_closest_point_normal(points[i]) == normal;
+	}
+	CHECK(same_point == QUERIES);
+	CHECK(same_normal == QUERIES);
+
+	NavMap::release_snapshot(snapshot);
+}
+
+TEST_CASE("[Navigation] Paths match the search with a linear open list") {
+	NavigationMap nav;
+	gd::MapSnapshot *snapshot = nav.map.acquire_snapshot();
+
+	Vector<Vector3> points = random_points(QUERIES * 2);
+	int found = 0;
+	int same = 0;
+	int same_ends = 0;
+	for (int i = 0; i < QUERIES; i++) {
+		Vector<Vector3> expected = linear_path(snapshot, points[i * 2], points[i * 2 + 1]);
+		found += expected.size() > 0;
+		same += same_path(nav.map.get_path(points[i * 2], points[i * 2 + 1], false), expected);
+
+		// String pulling only removes the points in between.
+		Vector<Vector3> optimized = nav.map.get_path(points[i * 2], points[i * 2 + 1], true);
+		same_ends += optimized.size() >= 2 && expected.size() >= 2 && optimized[0] == expected[0] && optimized[optimized.size() - 1] == expected[expected.size() - 1];
+	}
+	CHECK(found == QUERIES);
+	CHECK(same == QUERIES);
+	CHECK(same_ends == QUERIES);
+
+	NavMap::release_snapshot(snapshot);
+}
+
+struct SnapshotPaths {
+	const gd::MapSnapshot *snapshot = nullptr;
+	Vector<Vector3> points;
+	Vector<Vector3> paths[QUERIES];
+
+	void solve(uint32_t p_index, void *p_userdata) {
+		paths[p_index] = NavMap::get_snapshot_path(snapshot, points[p_index * 2], points[p_index * 2 + 1], true);
+	}
+};
+
+TEST_CASE("[Navigation] Paths solved on other threads match the serial ones") {
+	NavigationMap nav;
+
+	SnapshotPaths paths;
+	paths.snapshot = nav.map.acquire_snapshot();
+	paths.points = random_points(QUERIES * 2);
+
+	ThreadWorkPool pool;
+	pool.init(4);
+	pool.do_work(QUERIES, &paths, &SnapshotPaths::solve, (void *)nullptr);
+	pool.finish();
+
+	int same = 0;
+	for (int i = 0; i < QUERIES; i++) {
+		same += same_path(nav.map.get_path(paths.points[i * 2], paths.points[i * 2 + 1], true), paths.paths[i]);
+	}
+	CHECK(same == QUERIES);
+
+	NavMap::release_snapshot((gd::MapSnapshot *)paths.snapshot);
+}
+
+// The test map in a navigation server, which owns the batched queries.
+struct NavigationServerMap {
+	GdNavigationServer server;
+	RID map;
+	RID region;
+	Vector<Vector3> origins;
+	Vector<Vector3> destinations;
+
+	NavigationServerMap() {
+		map = server.map_create();
+		server.map_set_active(map, true);
+		region = server.region_create();
+		server.region_set_map(region, map);
+		server.region_set_navmesh(region, create_navmesh());
+		server.process(0.0);
+
+		Vector<Vector3> points = random_points(QUERIES * 2);
+		for (int i = 0; i < QUERIES; i++) {
+			origins.push_back(points[i * 2]);
+			destinations.push_back(points[i * 2 + 1]);
+		}
+	}
+
+	~NavigationServerMap() {
+		server.free(region);
+		server.free(map);
+		server.process(0.0);
+	}
+
+	bool wait_for(RID p_query) const {
+		for (int i = 0; i < 10000 && !server.path_query_is_done(p_query); i++) {
+			OS::get_singleton()->delay_usec(1000);
+		}
+		return server.path_query_is_done(p_query);
+	}
+
+	int count_same_paths(const Array &p_paths) const {
+		int same = 0;
+		for (int i = 0; i < MIN(p_paths.size(), QUERIES); i++) {
+			same += same_path(p_paths[i], server.map_get_path(map, origins[i], destinations[i], true));
+		}
+		return same;
+	}
+};
+
+class PathsReceiver : public Object {
+public:
+	int calls = 0;
+	Array paths;
+
+	void receive(const Array &p_paths) {
+		calls++;
+		paths = p_paths;
+	}
+};
+
+TEST_CASE("[Navigation] Batched path queries") {
+	ThreadWorkPool pool(true);
+	pool.init(4);
+
+	NavigationServerMap nav;
+	PathsReceiver receiver;
+
+	SUBCASE("Polling") {
+		RID query = nav.server.map_query_paths(nav.map, nav.origins, nav.destinations, true);
+		REQUIRE(query.is_valid());
+		CHECK(nav.wait_for(query));
+
+		Array paths = nav.server.path_query_get_paths(query);
+		CHECK(paths.size() == QUERIES);
+		CHECK(nav.count_same_paths(paths) == QUERIES);
+		CHECK_MESSAGE(nav.server.path_query_get_paths(query).size() == QUERIES, "Paths can be fetched again until the query is freed.");
+
+		nav.server.free(query);
+		nav.server.process(0.0);
+	}
+
+	SUBCASE("Getting the paths waits for them") {
+		RID query = nav.server.map_query_paths(nav.map, nav.origins, nav.destinations, true);
+		Array paths = nav.server.path_query_get_paths(query);
+		CHECK(nav.server.path_query_is_done(query));
+		CHECK(nav.count_same_paths(paths) == QUERIES);
+
+		nav.server.free(query);
+		nav.server.process(0.0);
+	}
+
+	SUBCASE("A single query is solved right away") {
+		Vector<Vector3> origins;
+		Vector<Vector3> destinations;
+		origins.push_back(nav.origins[0]);
+		destinations.push_back(nav.destinations[0]);
+
+		RID query = nav.server.map_query_paths(nav.map, origins, destinations, true);
+		CHECK(nav.server.path_query_is_done(query));
+		CHECK(nav.count_same_paths(nav.server.path_query_get_paths(query)) == 1);
+
+		nav.server.free(query);
+		nav.server.process(0.0);
+	}
+
+	SUBCASE("Callbacks are called from process() and free the query") {
+		RID query = nav.server.map_query_paths(nav.map, nav.origins, nav.destinations, true, callable_mp(&receiver, &PathsReceiver::receive));
+		REQUIRE(query.is_valid());
+		CHECK(nav.wait_for(query));
+		CHECK_MESSAGE(receiver.calls == 0, "Callbacks should wait for process().");
+
+		nav.server.process(0.0);
+		CHECK(receiver.calls == 1);
+		CHECK(receiver.paths.size() == QUERIES);
+		CHECK(nav.count_same_paths(receiver.paths) == QUERIES);
+
+		// The query was freed after its callback.
+		CHECK(nav.server.path_query_get_paths(query).empty());
+
+		nav.server.process(0.0);
+		CHECK_MESSAGE(receiver.calls == 1, "Callbacks should only be called once.");
+	}
+
+	SUBCASE("Freeing a pending query") {
+		RID with_callback = nav.server.map_query_paths(nav.map, nav.origins, nav.destinations, true, callable_mp(&receiver, &PathsReceiver::receive));
+		RID without_callback = nav.server.map_query_paths(nav.map, nav.origins, nav.destinations, true);
+		nav.server.free(with_callback);
+		nav.server.free(without_callback);
+
+		// Frees are deferred to process(), which waits for the workers.
+		nav.server.process(0.0);
+		nav.server.process(0.0);
+		CHECK_MESSAGE(receiver.calls == 0, "Freed queries should never call back.");
+	}
+
+	SUBCASE("Origins without destinations") {
+		Vector<Vector3> destinations = nav.destinations;
+		destinations.resize(QUERIES - 1);
+		CHECK_FALSE(nav.server.map_query_paths(nav.map, nav.origins, destinations, true).is_valid());
+	}
+
+	pool.finish();
+}
+
+// Rolling terrain of p_size x p_size cells, with random square holes as obstacles.
+static Ref<NavigationMesh> create_benchmark_navmesh(int p_size, RandomPCG &p_rng) {
+	Vector<Vector3> vertices;
+	for (int z = 0; z <= p_size; z++) {
+		for (int x = 0; x <= p_size; x++) {
+			vertices.push_back(Vector3(x, Math::sin(x * 0.05) * Math::cos(z * 0.07) * 4.0, z));
+		}
+	}
+
+	// Obstacles cover about a sixth of the cells.
+	Vector<bool> blocked;
+	blocked.resize(p_size * p_size);
+	for (int i = 0; i < blocked.size(); i++) {
+		blocked.write[i] = false;
+	}
+	for (int i = 0; i < p_size * p_size / 150; i++) {
+		int ox = p_rng.rand() % p_size;
+		int oz = p_rng.rand() % p_size;
+		for (int z = oz; z < MIN(oz + 5, p_size); z++) {
+			for (int x = ox; x < MIN(ox + 5, p_size); x++) {
+				blocked.write[z * p_size + x] = true;
+			}
+		}
+	}
+
+	Ref<NavigationMesh> navmesh;
+	navmesh.instance();
+	navmesh->set_vertices(vertices);
+	for (int z = 0; z < p_size; z++) {
+		for (int x = 0; x < p_size; x++) {
+			if (blocked[z * p_size + x]) {
+				continue;
+			}
+			int a = z * (p_size + 1) + x;
+			int b = a + 1;
+			int c = a + p_size + 1;
+			int d = c + 1;
+			Vector<int> poly;
+			poly.push_back(a);
+			poly.push_back(d);
+			poly.push_back(b);
+			navmesh->add_polygon(poly);
+			poly.write[0] = a;
+			poly.write[1] = c;
+			poly.write[2] = d;
+			navmesh->add_polygon(poly);
+		}
+	}
+	return navmesh;
+}
+
+// Path and closest point queries on navigation meshes of increasing size.
+// Paths are solved one by one, then again as a single batch on the worker threads.
+TEST_CASE("[Navigation][Benchmark] Path queries" * doctest::skip()) {
+	ThreadWorkPool pool(true);
+	pool.init(OS::get_singleton()->get_processor_count());
+
+	GdNavigationServer server;
+	const int sizes[] = { 70, 160, 320 }; // About 10k, 50k and 200k polygons.
+
+	for (int s = 0; s < 3; s++) {
+		const int size = sizes[s];
+		RandomPCG rng(size);
+
+		Ref<NavigationMesh> navmesh = create_benchmark_navmesh(size, rng);
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		RID map = server.map_create();
+		server.map_set_active(map, true);
+		RID region = server.region_create();
+		server.region_set_map(region, map);
+		server.region_set_navmesh(region, navmesh);
+		server.process(0.0);
+		uint64_t sync_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+		Vector<Vector3> points;
+		for (int i = 0; i < QUERIES * 2; i++) {
+			points.push_back(Vector3(rng.randf() * size, 0.0, rng.randf() * size));
+		}
+
+		int found = 0;
+		begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < QUERIES; i++) {
+			found += server.map_get_path(map, points[i * 2], points[i * 2 + 1], true).size() > 0;
+		}
+		uint64_t path_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+		// Same paths, solved in parallel.
+		Vector<Vector3> origins;
+		Vector<Vector3> destinations;
+		for (int i = 0; i < QUERIES; i++) {
+			origins.push_back(points[i * 2]);
+			destinations.push_back(points[i * 2 + 1]);
+		}
+		begin = OS::get_singleton()->get_ticks_usec();
+		RID query = server.map_query_paths(map, origins, destinations, true);
+		Array paths = server.path_query_get_paths(query);
+		uint64_t batch_time = OS::get_singleton()->get_ticks_usec() - begin;
+		server.free(query);
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < QUERIES * 2; i++) {
+			server.map_get_closest_point(map, points[i]);
+		}
+		uint64_t closest_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+		print_line(vformat("%d polygons: sync %.1f msec, %.3f msec/path (%d found), %.2f usec/closest point.", navmesh->get_polygon_count(), sync_time / 1000.0, path_time / 1000.0 / QUERIES, found, double(closest_time) / (QUERIES * 2)));
+		print_line(vformat("    Batched: %.3f msec/path, %.1fx faster.", batch_time / 1000.0 / QUERIES, double(path_time) / MAX(batch_time, (uint64_t)1)));
+
+		server.free(region);
+		server.free(map);
+		server.process(0.0);
+	}
+
+	pool.finish();
+}
+
+} // namespace TestNavigation
+
+#endif // MODULE_GDNAVIGATION_ENABLED
+
+#endif // TEST_NAVIGATION_H
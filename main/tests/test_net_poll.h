@@ -0,0 +1,323 @@
+/*************************************************************************/
+/*  test_net_poll.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_NET_POLL_H
+#define TEST_NET_POLL_H
+
+#include "core/io/tcp_server.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestNetPoll {
+
+enum {
+	PORT = 28372,
+	TIMEOUT = 1000, // Msec, loopback traffic is ready long before.
+};
+
+// Both ends of a loopback TCP connection.
+struct SocketPair {
+	Ref<TCP_Server> server;
+	Ref<StreamPeerTCP> client;
+	Ref<StreamPeerTCP> peer; // Server side.
+
+	bool listen() {
+		server.instance();
+		return server->listen(PORT, IP_Address("127.0.0.1")) == OK;
+	}
+
+	bool connect() {
+		client.instance();
+		client->connect_to_host(IP_Address("127.0.0.1"), PORT);
+		uint64_t deadline = OS::get_singleton()->get_ticks_msec() + TIMEOUT;
+		while (OS::get_singleton()->get_ticks_msec() < deadline) {
+			if (peer.is_null() && server->is_connection_available()) {
+				peer = server->take_connection();
+			}
+			if (peer.is_valid() && client->get_status() == StreamPeerTCP::STATUS_CONNECTED) {
+				return true;
+			}
+			OS::get_singleton()->delay_usec(1000);
+		}
+		return false;
+	}
+
+	~SocketPair() {
+		client.unref();
+		peer.unref();
+		if (server.is_valid()) {
+			server->stop();
+		}
+	}
+};
+
+TEST_CASE("[NetPoll] Connected sockets are reported when readable") {
+	SocketPair pair;
+	REQUIRE(pair.listen());
+	REQUIRE(pair.connect());
+
+	NetSocket::PollGroup *group = NetSocket::create_poll_group();
+	LocalVector<NetSocket::PollGroup::Event> events;
+	CHECK(pair.peer->add_to_poll_group(group, NetSocket::POLL_TYPE_IN, 7) == OK);
+	CHECK(group->has(7));
+	CHECK(group->get_socket_count() == 1);
+
+	CHECK_MESSAGE(group->wait(events, 0) == ERR_BUSY, "Nothing was sent yet.");
+	CHECK(events.size() == 0);
+
+	uint8_t data[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+	REQUIRE(pair.client->put_data(data, sizeof(data)) == OK);
+
+	REQUIRE(group->wait(events, TIMEOUT) == OK);
+	REQUIRE(events.size() == 1);
+	CHECK(events[0].id == 7);
+	CHECK(events[0].readable);
+	CHECK(!events[0].writable);
+	CHECK(!events[0].error);
+
+	uint8_t received[16] = {};
+	REQUIRE(pair.peer->get_data(received, sizeof(received)) == OK);
+	CHECK(received[0] == 1);
+	CHECK(received[15] == 16);
+
+	CHECK_MESSAGE(group->wait(events, 0) == ERR_BUSY, "Everything was read.");
+	CHECK(events.size() == 0);
+
+	group->remove(7);
+	memdelete(group);
+}
+
+TEST_CASE("[NetPoll] Listening sockets are reported when connections are pending") {
+	SocketPair pair;
+	REQUIRE(pair.listen());
+
+	NetSocket::PollGroup *group = NetSocket::create_poll_group();
+	LocalVector<NetSocket::PollGroup::Event> events;
+	CHECK(pair.server->add_to_poll_group(group, 3) == OK);
+	CHECK(group->wait(events, 0) == ERR_BUSY);
+
+	pair.client.instance();
+	pair.client->connect_to_host(IP_Address("127.0.0.1"), PORT);
+
+	REQUIRE(group->wait(events, TIMEOUT) == OK);
+	REQUIRE(events.size() == 1);
+	CHECK(events[0].id == 3);
+	CHECK(events[0].readable);
+	CHECK(pair.server->is_connection_available());
+
+	pair.peer = pair.server->take_connection();
+	CHECK(pair.peer.is_valid());
+	CHECK_MESSAGE(group->wait(events, 0) == ERR_BUSY, "The connection was accepted.");
+
+	group->remove(3);
+	memdelete(group);
+}
+
+TEST_CASE("[NetPoll] Registered sockets can be modified and removed") {
+	SocketPair pair;
+	REQUIRE(pair.listen());
+	REQUIRE(pair.connect());
+
+	NetSocket::PollGroup *group = NetSocket::create_poll_group();
+	LocalVector<NetSocket::PollGroup::Event> events;
+	CHECK(pair.peer->add_to_poll_group(group, NetSocket::POLL_TYPE_IN, 1) == OK);
+	CHECK(group->wait(events, 0) == ERR_BUSY);
+
+	// An idle connection can always be written to.
+	CHECK(group->modify(1, NetSocket::POLL_TYPE_OUT) == OK);
+	REQUIRE(group->wait(events, TIMEOUT) == OK);
+	REQUIRE(events.size() == 1);
+	CHECK(events[0].id == 1);
+	CHECK(events[0].writable);
+	CHECK(!events[0].readable);
+
+	group->remove(1);
+	CHECK(!group->has(1));
+	CHECK(group->get_socket_count() == 0);
+	CHECK(group->wait(events, 0) == ERR_BUSY);
+	CHECK(events.size() == 0);
+
+	memdelete(group);
+}
+
+TEST_CASE("[NetPoll] Closing the remote end reports the socket") {
+	SocketPair pair;
+	REQUIRE(pair.listen());
+	REQUIRE(pair.connect());
+
+	NetSocket::PollGroup *group = NetSocket::create_poll_group();
+	LocalVector<NetSocket::PollGroup::Event> events;
+	CHECK(pair.peer->add_to_poll_group(group, NetSocket::POLL_TYPE_IN, 5) == OK);
+
+	pair.client->disconnect_from_host();
+
+	// The next read reports the hang up.
+	REQUIRE(group->wait(events, TIMEOUT) == OK);
+	REQUIRE(events.size() == 1);
+	CHECK(events[0].id == 5);
+	CHECK((events[0].readable || events[0].error));
+
+	group->remove(5);
+	memdelete(group);
+}
+
+// Many loopback TCP connections, of which only a few receive data every
+// frame, as on a busy WebSocket server. The server side is checked once per
+// connection with NetSocket::poll(), then with a single PollGroup wait.
+struct PollBenchmark {
+	enum {
+		CONNECTIONS = 400, // Both ends are in this process, keep under the usual 1024 fd limit.
+		ACTIVE_PER_FRAME = 4,
+		FRAMES = 2000,
+		PACKET_SIZE = 64,
+		BENCHMARK_PORT = 28371,
+	};
+
+	Ref<TCP_Server> server;
+	Vector<Ref<StreamPeerTCP>> clients;
+	Vector<Ref<StreamPeerTCP>> peers; // Server side.
+	uint8_t buffer[4096];
+
+	bool connect() {
+		memset(buffer, 0, sizeof(buffer));
+		server.instance();
+		if (server->listen(BENCHMARK_PORT, IP_Address("127.0.0.1")) != OK) {
+			return false;
+		}
+
+		// One at a time, the server only keeps a few pending connections.
+		uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 10000;
+		for (int i = 0; i < CONNECTIONS; i++) {
+			Ref<StreamPeerTCP> client;
+			client.instance();
+			client->connect_to_host(IP_Address("127.0.0.1"), BENCHMARK_PORT);
+			clients.push_back(client);
+
+			while (peers.size() == i && OS::get_singleton()->get_ticks_msec() < deadline) {
+				if (server->is_connection_available()) {
+					peers.push_back(server->take_connection());
+				} else {
+					OS::get_singleton()->delay_usec(100);
+				}
+			}
+		}
+
+		int connected = 0;
+		while (connected < CONNECTIONS && OS::get_singleton()->get_ticks_msec() < deadline) {
+			connected = 0;
+			for (int i = 0; i < CONNECTIONS; i++) {
+				connected += clients.write[i]->get_status() == StreamPeerTCP::STATUS_CONNECTED;
+			}
+			OS::get_singleton()->delay_usec(1000);
+		}
+		return peers.size() == CONNECTIONS && connected == CONNECTIONS;
+	}
+
+	int64_t read(Ref<StreamPeerTCP> p_peer) {
+		int64_t total = 0;
+		int read = 0;
+		while (p_peer->get_partial_data(buffer, sizeof(buffer), read) == OK && read > 0) {
+			total += read;
+		}
+		return total;
+	}
+
+	// Returns the bytes received by the server side.
+	int64_t run(bool p_group) {
+		NetSocket::PollGroup *group = nullptr;
+		LocalVector<NetSocket::PollGroup::Event> events;
+		if (p_group) {
+			group = NetSocket::create_poll_group();
+			for (int i = 0; i < CONNECTIONS; i++) {
+				peers.write[i]->add_to_poll_group(group, NetSocket::POLL_TYPE_IN, i);
+			}
+		}
+
+		RandomPCG rng(CONNECTIONS);
+		int64_t received = 0;
+		uint64_t elapsed = 0;
+		for (int f = 0; f < FRAMES + 10; f++) {
+			// Let the last frames deliver whatever is still in flight.
+			if (f < FRAMES) {
+				for (int i = 0; i < ACTIVE_PER_FRAME; i++) {
+					int sent = 0;
+					clients.write[rng.rand() % CONNECTIONS]->put_partial_data(buffer, PACKET_SIZE, sent);
+				}
+			}
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			if (group) {
+				group->wait(events, 0);
+				for (uint32_t i = 0; i < events.size(); i++) {
+					received += read(peers.write[events[i].id]);
+				}
+			} else {
+				for (int i = 0; i < CONNECTIONS; i++) {
+					if (peers.write[i]->poll(NetSocket::POLL_TYPE_IN, 0) == OK) {
+						received += read(peers.write[i]);
+					}
+				}
+			}
+			elapsed += OS::get_singleton()->get_ticks_usec() - begin;
+		}
+
+		if (group) {
+			memdelete(group);
+		}
+
+		print_line(vformat("%s: %.2f usec/frame.", p_group ? "Poll group" : "Per socket poll", double(elapsed) / (FRAMES + 10)));
+		return received;
+	}
+
+	~PollBenchmark() {
+		clients.clear();
+		peers.clear();
+		if (server.is_valid()) {
+			server->stop();
+		}
+	}
+};
+
+TEST_CASE("[NetPoll][Benchmark] Per socket polling against a poll group" * doctest::skip()) {
+	PollBenchmark benchmark;
+	REQUIRE_MESSAGE(benchmark.connect(), "Every loopback connection must be established.");
+	print_line(vformat("%d connections, %d active per frame.", PollBenchmark::CONNECTIONS, PollBenchmark::ACTIVE_PER_FRAME));
+
+	const int64_t expected = int64_t(PollBenchmark::FRAMES) * PollBenchmark::ACTIVE_PER_FRAME * PollBenchmark::PACKET_SIZE;
+	CHECK(benchmark.run(false) == expected);
+	CHECK(benchmark.run(true) == expected);
+}
+
+} // namespace TestNetPoll
+
+#endif // TEST_NET_POLL_H
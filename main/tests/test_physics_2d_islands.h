@@ -0,0 +1,171 @@
+/*************************************************************************/
+/*  test_physics_2d_islands.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PHYSICS_2D_ISLANDS_H
+#define TEST_PHYSICS_2D_ISLANDS_H
+
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
+#include "servers/physics_2d/physics_server_2d_sw.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestPhysics2DIslands {
+
+enum {
+	BOX_COUNT = 16,
+	STEPS = 60,
+};
+
+struct Contact {
+	int collider = -1; // Index of the box, RIDs differ between runs.
+	Vector2 position;
+
+	bool operator==(const Contact &p_other) const { return collider == p_other.collider && position == p_other.position; }
+};
+
+struct Result {
+	Vector<Transform2D> transforms;
+	Vector<Contact> floor_contacts;
+	int island_count = 0;
+};
+
+// Steps boxes spread over a shared static floor, so every box forms its own
+// island, while all of them report contacts to the floor.
+static Result simulate() {
+	PhysicsServer2DSW *ps = memnew(PhysicsServer2DSW);
+	ps->init();
+
+	RID box_shape = ps->rectangle_shape_create();
+	ps->shape_set_data(box_shape, Vector2(8, 8));
+	RID floor_shape = ps->rectangle_shape_create();
+	ps->shape_set_data(floor_shape, Vector2(1000, 10));
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+	// Set by World2D from the project settings otherwise.
+	ps->area_set_param(space, PhysicsServer2D::AREA_PARAM_GRAVITY, 98);
+	ps->area_set_param(space, PhysicsServer2D::AREA_PARAM_GRAVITY_VECTOR, Vector2(0, 1));
+
+	RID floor = ps->body_create();
+	ps->body_set_mode(floor, PhysicsServer2D::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, PhysicsServer2D::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(0, 10)));
+	// Static bodies never clear their contacts, so leave room for every contact of the run.
+	ps->body_set_max_contacts_reported(floor, BOX_COUNT * STEPS * 4);
+
+	Vector<RID> boxes;
+	for (int i = 0; i < BOX_COUNT; i++) {
+		RID body = ps->body_create();
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, box_shape);
+		ps->body_set_state(body, PhysicsServer2D::BODY_STATE_TRANSFORM, Transform2D(i * 0.05, Vector2(i * 40 - 300, -8.5)));
+		boxes.push_back(body);
+	}
+
+	Result result;
+	for (int i = 0; i < STEPS; i++) {
+		ps->step(1.0 / 60.0);
+		ps->flush_queries();
+		result.island_count = MAX(result.island_count, ps->get_process_info(PhysicsServer2D::INFO_ISLAND_COUNT));
+	}
+
+	for (int i = 0; i < boxes.size(); i++) {
+		result.transforms.push_back(ps->body_get_state(boxes[i], PhysicsServer2D::BODY_STATE_TRANSFORM));
+	}
+
+	PhysicsDirectBodyState2D *state = ps->body_get_direct_state(floor);
+	for (int i = 0; i < state->get_contact_count(); i++) {
+		Contact contact;
+		contact.collider = boxes.find(state->get_contact_collider(i));
+		contact.position = state->get_contact_local_position(i);
+		result.floor_contacts.push_back(contact);
+	}
+
+	for (int i = 0; i < boxes.size(); i++) {
+		ps->free(boxes[i]);
+	}
+	ps->free(floor);
+	ps->free(space);
+	ps->free(box_shape);
+	ps->free(floor_shape);
+
+	ps->finish();
+	memdelete(ps);
+
+	return result;
+}
+
+TEST_CASE("[Physics2D] Solving islands in parallel gives the same result as serially") {
+	ProjectSettings::get_singleton()->set_setting("physics/2d/parallel_islands", false);
+	Result serial = simulate();
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	ProjectSettings::get_singleton()->set_setting("physics/2d/parallel_islands", true);
+	Result parallel = simulate();
+	pool.finish();
+
+	CHECK(serial.island_count == BOX_COUNT);
+	CHECK(parallel.island_count == BOX_COUNT);
+
+	REQUIRE(serial.transforms.size() == parallel.transforms.size());
+	for (int i = 0; i < serial.transforms.size(); i++) {
+		// Islands don't share dynamic bodies, so the result must be exact.
+		CHECK_MESSAGE(serial.transforms[i] == parallel.transforms[i], "Every box must end up with the same transform.");
+	}
+}
+
+TEST_CASE("[Physics2D] Contacts reported from several islands don't depend on scheduling") {
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	ProjectSettings::get_singleton()->set_setting("physics/2d/parallel_islands", true);
+	Result first = simulate();
+	Result second = simulate();
+	ProjectSettings::get_singleton()->set_setting("physics/2d/parallel_islands", false);
+	Result serial = simulate();
+	pool.finish();
+	ProjectSettings::get_singleton()->set_setting("physics/2d/parallel_islands", true);
+
+	// Every box touches the floor.
+	CHECK(first.floor_contacts.size() >= BOX_COUNT);
+
+	REQUIRE(first.floor_contacts.size() == second.floor_contacts.size());
+	REQUIRE(first.floor_contacts.size() == serial.floor_contacts.size());
+	for (int i = 0; i < first.floor_contacts.size(); i++) {
+		CHECK(first.floor_contacts[i] == second.floor_contacts[i]);
+		CHECK(first.floor_contacts[i] == serial.floor_contacts[i]);
+	}
+}
+
+} // namespace TestPhysics2DIslands
+
+#endif // TEST_PHYSICS_2D_ISLANDS_H
@@ -0,0 +1,186 @@
+/*************************************************************************/
+/*  test_physics_3d_islands.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PHYSICS_3D_ISLANDS_H
+#define TEST_PHYSICS_3D_ISLANDS_H
+
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestPhysics3DIslands {
+
+enum {
+	STACK_COUNT = 16,
+	STACK_HEIGHT = 4,
+};
+
+struct Contact {
+	int collider = -1; // Index of the ball, RIDs differ between runs.
+	Vector3 position;
+
+	bool operator==(const Contact &p_other) const { return collider == p_other.collider && position == p_other.position; }
+};
+
+// Steps separate stacks of balls on a shared static floor, so every stack
+// forms its own island. Each ball is moved sideways by p_offset from the one
+// below it, which makes the stacks topple. Returns the final transform of
+// every ball, and optionally every contact the floor reported.
+static Vector<Transform> simulate(int p_steps, real_t p_offset, int *r_island_count = nullptr, Vector<Contact> *r_floor_contacts = nullptr) {
+	PhysicsServer3DSW *ps = memnew(PhysicsServer3DSW);
+	ps->init();
+
+	RID ball_shape = ps->shape_create(PhysicsServer3D::SHAPE_SPHERE);
+	ps->shape_set_data(ball_shape, 0.5);
+	RID floor_shape = ps->shape_create(PhysicsServer3D::SHAPE_PLANE);
+	ps->shape_set_data(floor_shape, Plane(Vector3(0, 1, 0), 0));
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID floor = ps->body_create(PhysicsServer3D::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+	if (r_floor_contacts) {
+		// Static bodies never clear their contacts, so leave room for every contact of the run.
+		ps->body_set_max_contacts_reported(floor, STACK_COUNT * p_steps * 4);
+	}
+
+	Vector<RID> balls;
+	for (int i = 0; i < STACK_COUNT; i++) {
+		Vector3 base((i % 4) * 10.0, 0.5, (i / 4) * 10.0);
+		for (int j = 0; j < STACK_HEIGHT; j++) {
+			RID body = ps->body_create(PhysicsServer3D::BODY_MODE_RIGID);
+			ps->body_set_space(body, space);
+			ps->body_add_shape(body, ball_shape);
+			ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform(Basis(), base + Vector3(j * p_offset, j, (j % 2) * p_offset)));
+			balls.push_back(body);
+		}
+	}
+
+	int island_count = 0;
+	for (int i = 0; i < p_steps; i++) {
+		ps->step(1.0 / 60.0);
+		ps->flush_queries();
+		island_count = MAX(island_count, ps->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT));
+	}
+	if (r_island_count) {
+		*r_island_count = island_count;
+	}
+
+	if (r_floor_contacts) {
+		PhysicsDirectBodyState3D *state = ps->body_get_direct_state(floor);
+		for (int i = 0; i < state->get_contact_count(); i++) {
+			Contact contact;
+			contact.collider = balls.find(state->get_contact_collider(i));
+			contact.position = state->get_contact_local_position(i);
+			r_floor_contacts->push_back(contact);
+		}
+	}
+
+	Vector<Transform> transforms;
+	for (int i = 0; i < balls.size(); i++) {
+		transforms.push_back(ps->body_get_state(balls[i], PhysicsServer3D::BODY_STATE_TRANSFORM));
+		ps->free(balls[i]);
+	}
+	ps->free(floor);
+	ps->free(space);
+	ps->free(ball_shape);
+	ps->free(floor_shape);
+
+	ps->finish();
+	memdelete(ps);
+
+	return transforms;
+}
+
+TEST_CASE("[Physics3D] Every resting stack is a separate island") {
+	int island_count = 0;
+	Vector<Transform> transforms = simulate(30, 0.0, &island_count);
+
+	CHECK(island_count == STACK_COUNT);
+	for (int i = 0; i < transforms.size(); i++) {
+		// Balls stay on top of each other instead of falling through.
+		CHECK(transforms[i].origin.y > (i % STACK_HEIGHT) + 0.45);
+	}
+}
+
+TEST_CASE("[Physics3D] Solving islands in parallel gives the same result as serially") {
+	// Toppling stacks keep every island busy. Once balls separate and touch
+	// again the contact order depends on where pairs get allocated, even when
+	// solving serially, so only the first second is compared.
+	ProjectSettings::get_singleton()->set_setting("physics/3d/parallel_islands", false);
+	Vector<Transform> serial = simulate(60, 0.02);
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	ProjectSettings::get_singleton()->set_setting("physics/3d/parallel_islands", true);
+	Vector<Transform> parallel = simulate(60, 0.02);
+	pool.finish();
+
+	REQUIRE(serial.size() == parallel.size());
+	for (int i = 0; i < serial.size(); i++) {
+		// Islands don't share bodies or constraints, so the result must be exact.
+		CHECK_MESSAGE(serial[i] == parallel[i], "Every ball must end up with the same transform.");
+	}
+}
+
+TEST_CASE("[Physics3D] Contacts reported from several islands don't depend on scheduling") {
+	// The static floor touches every island, which report their contacts to
+	// it from whichever thread sets them up.
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	ProjectSettings::get_singleton()->set_setting("physics/3d/parallel_islands", true);
+	Vector<Contact> first;
+	simulate(60, 0.0, nullptr, &first);
+	Vector<Contact> second;
+	simulate(60, 0.0, nullptr, &second);
+	ProjectSettings::get_singleton()->set_setting("physics/3d/parallel_islands", false);
+	Vector<Contact> serial;
+	simulate(60, 0.0, nullptr, &serial);
+	pool.finish();
+	ProjectSettings::get_singleton()->set_setting("physics/3d/parallel_islands", true);
+
+	// The bottom ball of every stack touches the floor.
+	CHECK(first.size() >= STACK_COUNT);
+
+	REQUIRE(first.size() == second.size());
+	REQUIRE(first.size() == serial.size());
+	for (int i = 0; i < first.size(); i++) {
+		CHECK(first[i] == second[i]);
+		CHECK(first[i] == serial[i]);
+	}
+}
+
+} // namespace TestPhysics3DIslands
+
+#endif // TEST_PHYSICS_3D_ISLANDS_H
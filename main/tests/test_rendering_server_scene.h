@@ -0,0 +1,287 @@
+/*************************************************************************/
+/*  test_rendering_server_scene.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RENDERING_SERVER_SCENE_H
+#define TEST_RENDERING_SERVER_SCENE_H
+
+#include "core/math/camera_matrix.h"
+#include "core/math/geometry_3d.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/thread_work_pool.h"
+#include "servers/rendering/rendering_server_scene.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestRenderingServerScene {
+
+typedef RenderingServerScene::Instance Instance;
+
+// Instances with random bounds, registered for culling the way
+// _update_instance_aabb() does, without the storage behind them.
+struct CullScene {
+	RenderingServerScene rss;
+	RenderingServerScene::Scenario scenario;
+	LocalVector<Instance *> instances;
+	RandomPCG rng;
+	real_t world_size;
+
+	CullScene(int p_count, real_t p_world_size, uint64_t p_seed) :
+			rng(p_seed),
+			world_size(p_world_size) {
+		for (int i = 0; i < p_count; i++) {
+			Instance *instance = memnew(Instance);
+			instance->scenario = &scenario;
+			// Some lights, which geometry culling must leave out.
+			instance->base_type = i % 8 == 7 ? RS::INSTANCE_LIGHT : RS::INSTANCE_MESH;
+			instance->transformed_aabb = random_aabb();
+			instance->octree_id = scenario.octree.create(instance, instance->transformed_aabb, 0, false, 1 << instance->base_type, 0);
+			rss._instance_update_cull_bounds(instance);
+			instances.push_back(instance);
+		}
+	}
+
+	AABB random_aabb() {
+		Vector3 size(rng.random(0.5f, 4.0f), rng.random(0.5f, 4.0f), rng.random(0.5f, 4.0f));
+		Vector3 position(rng.random(0.0f, world_size), rng.random(0.0f, world_size), rng.random(0.0f, world_size));
+		return AABB(position - size * 0.5, size);
+	}
+
+	void move(Instance *p_instance) {
+		p_instance->transformed_aabb = random_aabb();
+		scenario.octree.move(p_instance->octree_id, p_instance->transformed_aabb);
+		rss._instance_update_cull_bounds(p_instance);
+	}
+
+	void remove(uint32_t p_index) {
+		Instance *instance = instances[p_index];
+		rss._instance_remove_cull_bounds(instance);
+		scenario.octree.erase(instance->octree_id);
+		memdelete(instance);
+		instances.remove(p_index);
+	}
+
+	~CullScene() {
+		while (instances.size()) {
+			remove(instances.size() - 1);
+		}
+	}
+};
+
+static Vector<Instance *> sorted(const LocalVector<Instance *> &p_instances) {
+	Vector<Instance *> result;
+	result.resize(p_instances.size());
+	for (uint32_t i = 0; i < p_instances.size(); i++) {
+		result.write[i] = p_instances[i];
+	}
+	result.sort();
+	return result;
+}
+
+// Returns how many instances are missing from p_result or shouldn't be in it.
+static int count_mismatches(const LocalVector<Instance *> &p_result, const LocalVector<Instance *> &p_expected) {
+	Vector<Instance *> result = sorted(p_result);
+	Vector<Instance *> expected = sorted(p_expected);
+
+	int mismatches = 0;
+	int i = 0;
+	int j = 0;
+	while (i < result.size() || j < expected.size()) {
+		if (j == expected.size() || (i < result.size() && result[i] < expected[j])) {
+			mismatches++;
+			i++;
+		} else if (i == result.size() || expected[j] < result[i]) {
+			mismatches++;
+			j++;
+		} else {
+			i++;
+			j++;
+		}
+	}
+	return mismatches;
+}
+
+static void reference_cull_convex(const CullScene &p_scene, const Vector<Plane> &p_planes, uint32_t p_type_mask, LocalVector<Instance *> &r_result) {
+	r_result.clear();
+	Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(p_planes.ptr(), p_planes.size());
+	for (uint32_t i = 0; i < p_scene.instances.size(); i++) {
+		Instance *instance = p_scene.instances[i];
+		if (((1 << instance->base_type) & p_type_mask) && instance->transformed_aabb.intersects_convex_shape(p_planes.ptr(), p_planes.size(), points.ptr(), points.size())) {
+			r_result.push_back(instance);
+		}
+	}
+}
+
+static void reference_cull_aabb(const CullScene &p_scene, const AABB &p_aabb, uint32_t p_type_mask, LocalVector<Instance *> &r_result) {
+	r_result.clear();
+	for (uint32_t i = 0; i < p_scene.instances.size(); i++) {
+		Instance *instance = p_scene.instances[i];
+		if (((1 << instance->base_type) & p_type_mask) && instance->transformed_aabb.intersects_inclusive(p_aabb)) {
+			r_result.push_back(instance);
+		}
+	}
+}
+
+// Frustum of a camera looking at a random point of the scene, from inside it.
+static Vector<Plane> random_frustum(RandomPCG &p_rng, real_t p_world_size, real_t p_z_far) {
+	Vector3 eye(p_rng.random(0.0f, p_world_size), p_rng.random(0.0f, p_world_size), p_rng.random(0.0f, p_world_size));
+	Vector3 target(p_rng.random(0.0f, p_world_size), p_rng.random(0.0f, p_world_size), p_rng.random(0.0f, p_world_size));
+	Transform transform;
+	transform.origin = eye;
+	transform = transform.looking_at(target, ABS((target - eye).normalized().y) > 0.99 ? Vector3(1, 0, 0) : Vector3(0, 1, 0));
+
+	CameraMatrix projection;
+	projection.set_perspective(p_rng.random(30.0f, 110.0f), p_rng.random(0.5f, 2.0f), 0.05, p_z_far);
+	return projection.get_projection_planes(transform);
+}
+
+// Checks a few frustums and boxes against the reference, returns the mismatches.
+static int check_culling(CullScene &p_scene, RandomPCG &p_rng) {
+	LocalVector<Instance *> result;
+	LocalVector<Instance *> expected;
+	int mismatches = 0;
+
+	for (int i = 0; i < 16; i++) {
+		Vector<Plane> planes = random_frustum(p_rng, p_scene.world_size, p_rng.random(5.0f, p_scene.world_size));
+		uint32_t mask = i % 2 ? RS::INSTANCE_GEOMETRY_MASK : 0xFFFFFFFF;
+		p_scene.rss._cull_convex(&p_scene.scenario, planes, mask, result);
+		reference_cull_convex(p_scene, planes, mask, expected);
+		mismatches += count_mismatches(result, expected);
+		p_scene.rss._cull_convex_octree(&p_scene.scenario, planes, mask, result);
+		mismatches += count_mismatches(result, expected);
+
+		AABB aabb = p_scene.random_aabb().grow(p_rng.random(0.0f, p_scene.world_size * 0.3f));
+		p_scene.rss._cull_aabb(&p_scene.scenario, aabb, mask, result);
+		reference_cull_aabb(p_scene, aabb, mask, expected);
+		mismatches += count_mismatches(result, expected);
+	}
+	return mismatches;
+}
+
+TEST_CASE("[RenderingServerScene] Culling matches testing every instance") {
+	// Several chunks, the last one partially filled.
+	CullScene scene(RenderingServerScene::CULL_CHUNK_SIZE * 4 + 321, 100, 1);
+	RandomPCG rng(2);
+
+	CHECK_MESSAGE(check_culling(scene, rng) == 0, "Serial culling must find the same instances.");
+
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	CHECK_MESSAGE(check_culling(scene, rng) == 0, "Parallel culling must find the same instances.");
+
+	// Moved and removed instances must be culled where they are now.
+	for (int i = 0; i < 500; i++) {
+		scene.move(scene.instances[rng.rand() % scene.instances.size()]);
+		scene.remove(rng.rand() % scene.instances.size());
+	}
+	CHECK_MESSAGE(check_culling(scene, rng) == 0, "Culling must follow moved and removed instances.");
+	pool.finish();
+
+	CHECK_MESSAGE(check_culling(scene, rng) == 0, "Serial culling must follow moved and removed instances.");
+}
+
+TEST_CASE("[RenderingServerScene] Culling results are merged in instance order") {
+	CullScene scene(RenderingServerScene::CULL_CHUNK_SIZE * 3, 50, 3);
+
+	AABB everything(Vector3(-10, -10, -10), Vector3(70, 70, 70));
+	LocalVector<Instance *> result;
+	ThreadWorkPool pool(true);
+	pool.init(4);
+	scene.rss._cull_aabb(&scene.scenario, everything, 0xFFFFFFFF, result);
+	pool.finish();
+
+	REQUIRE(result.size() == scene.instances.size());
+	int out_of_order = 0;
+	for (uint32_t i = 0; i < result.size(); i++) {
+		out_of_order += result[i] != scene.scenario.instance_cull_list[i];
+	}
+	CHECK_MESSAGE(out_of_order == 0, "Results must not depend on which job finished first.");
+}
+
+// Times the chunked scan and the octree on p_frustums, which must find the same instances.
+static void time_culling(CullScene &p_scene, const Vector<Vector<Plane>> &p_frustums, const char *p_what) {
+	LocalVector<Instance *> result;
+	uint64_t usec[2];
+	int found[2] = { 0, 0 };
+	for (int method = 0; method < 2; method++) {
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < p_frustums.size(); i++) {
+			if (method == 0) {
+				p_scene.rss._cull_convex(&p_scene.scenario, p_frustums[i], RS::INSTANCE_GEOMETRY_MASK, result);
+			} else {
+				p_scene.rss._cull_convex_octree(&p_scene.scenario, p_frustums[i], RS::INSTANCE_GEOMETRY_MASK, result);
+			}
+			found[method] += result.size();
+		}
+		usec[method] = OS::get_singleton()->get_ticks_usec() - begin;
+	}
+
+	CHECK(found[0] == found[1]);
+	print_line(vformat("%d instances, %d %s: %.2f msec scanning chunks, %.2f msec with the octree.", p_scene.instances.size(), p_frustums.size(), p_what, usec[0] / 1000.0, usec[1] / 1000.0));
+}
+
+TEST_CASE("[RenderingServerScene][Benchmark] Chunked culling against the octree" * doctest::skip()) {
+	enum {
+		LIGHTS = 256,
+		CAMERAS = 16,
+	};
+
+	ThreadWorkPool pool(true);
+	pool.init();
+
+	const int counts[] = { 4096, 32768, 131072 };
+	for (int c = 0; c < 3; c++) {
+		// The density of instances stays the same as the scene grows.
+		real_t world_size = 20 * Math::pow(real_t(counts[c]), real_t(1.0 / 3.0));
+		CullScene scene(counts[c], world_size, counts[c]);
+		RandomPCG rng(c);
+
+		// Faces of omni lights.
+		Vector<Vector<Plane>> frustums;
+		for (int i = 0; i < LIGHTS * 6; i++) {
+			frustums.push_back(random_frustum(rng, world_size, rng.random(5.0f, 20.0f)));
+		}
+		time_culling(scene, frustums, "light faces");
+
+		// Camera and directional shadow volumes, which span the scene.
+		frustums.clear();
+		for (int i = 0; i < CAMERAS; i++) {
+			frustums.push_back(random_frustum(rng, world_size, world_size));
+		}
+		time_culling(scene, frustums, "camera frustums");
+	}
+
+	pool.finish();
+}
+
+} // namespace TestRenderingServerScene
+
+#endif // TEST_RENDERING_SERVER_SCENE_H
@@ -0,0 +1,295 @@
+/*************************************************************************/
+/*  test_resource_loader.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RESOURCE_LOADER_H
+#define TEST_RESOURCE_LOADER_H
+
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/print_string.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestResourceLoader {
+
+enum {
+	DEPTH = 2,
+	WIDTH = 4,
+	NODE_COUNT = 1 + WIDTH + WIDTH * WIDTH,
+	THREAD_COUNT = 8,
+};
+
+// A tree of binary resources, each node referencing p_width children as
+// external resources plus one resource shared by its whole level. Leaves and
+// shared resources carry p_payload random bytes.
+class ResourceTree {
+	Ref<Resource> _make_resource(RandomPCG &p_rng, int p_payload) {
+		Ref<Resource> resource;
+		resource.instance();
+		if (p_payload > 0) {
+			Vector<uint8_t> data;
+			data.resize(p_payload);
+			uint8_t *w = data.ptrw();
+			for (int i = 0; i < p_payload; i++) {
+				w[i] = p_rng.rand() & 0xFF;
+			}
+			resource->set_meta("data", data);
+		}
+		return resource;
+	}
+
+public:
+	String dir;
+	int file_count = 0;
+
+	String node_path(int p_level, int p_index) const {
+		return dir.plus_file(vformat("node_%d_%d.res", p_level, p_index));
+	}
+
+	explicit ResourceTree(int p_depth = DEPTH, int p_width = WIDTH, int p_payload = 0) {
+		dir = OS::get_singleton()->get_cache_path().plus_file("godot_test_resource_loader");
+		DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		da->make_dir_recursive(dir);
+
+		RandomPCG rng(p_depth * p_width);
+
+		// Built bottom up, so children already have a path when their parents are saved.
+		Vector<RES> below;
+		int count = 1;
+		for (int i = 0; i < p_depth; i++) {
+			count *= p_width;
+		}
+		for (int level = p_depth; level >= 0; level--) {
+			Ref<Resource> shared = _make_resource(rng, p_payload);
+			ResourceSaver::save(dir.plus_file(vformat("shared_%d.res", level)), shared, ResourceSaver::FLAG_CHANGE_PATH);
+			file_count++;
+
+			Vector<RES> current;
+			for (int i = 0; i < count; i++) {
+				Ref<Resource> node = _make_resource(rng, level == p_depth ? p_payload : 0);
+				if (level < p_depth) {
+					Array children;
+					for (int j = 0; j < p_width; j++) {
+						children.push_back(below[i * p_width + j]);
+					}
+					node->set_meta("children", children);
+				}
+				node->set_meta("shared", shared);
+				ResourceSaver::save(node_path(level, i), node, ResourceSaver::FLAG_CHANGE_PATH);
+				file_count++;
+				current.push_back(node);
+			}
+
+			below = current;
+			count /= p_width;
+		}
+	}
+
+	~ResourceTree() {
+		DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		if (da->change_dir(dir) == OK) {
+			da->erase_contents_recursive();
+			da->change_dir("..");
+			da->remove(dir);
+		}
+	}
+};
+
+static int count_nodes(const RES &p_node) {
+	if (p_node.is_null()) {
+		return 0;
+	}
+	int count = 1;
+	if (p_node->has_meta("children")) {
+		Array children = p_node->get_meta("children");
+		for (int i = 0; i < children.size(); i++) {
+			count += count_nodes(children[i]);
+		}
+	}
+	return count;
+}
+
+struct ThreadedRequest {
+	String path;
+	Error request_error = FAILED;
+	Error get_error = FAILED;
+	RES resource;
+
+	static void request(void *p_userdata) {
+		ThreadedRequest *r = (ThreadedRequest *)p_userdata;
+		r->request_error = ResourceLoader::load_threaded_request(r->path, "", true);
+		r->resource = ResourceLoader::load_threaded_get(r->path, &r->get_error);
+	}
+};
+
+TEST_CASE("[ResourceLoader] Threaded requests load the whole dependency tree") {
+	ResourceTree tree;
+	String path = tree.node_path(0, 0);
+
+	REQUIRE(ResourceLoader::load_threaded_request(path, "", true) == OK);
+
+	// Polling as a loading screen would, progress never goes back.
+	float last_progress = 0;
+	while (true) {
+		float progress = 0;
+		ResourceLoader::ThreadLoadStatus status = ResourceLoader::load_threaded_get_status(path, &progress);
+		if (status != ResourceLoader::THREAD_LOAD_IN_PROGRESS) {
+			CHECK(status == ResourceLoader::THREAD_LOAD_LOADED);
+			break;
+		}
+		CHECK(progress >= last_progress);
+		last_progress = progress;
+		OS::get_singleton()->delay_usec(100);
+	}
+
+	Error err = FAILED;
+	RES root = ResourceLoader::load_threaded_get(path, &err);
+	CHECK(err == OK);
+	CHECK(count_nodes(root) == NODE_COUNT);
+	CHECK_MESSAGE(ResourceLoader::load_threaded_get_status(path) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE,
+			"The request must be gone once its result was taken.");
+}
+
+TEST_CASE("[ResourceLoader] Concurrent threaded requests of the same path get the same resource") {
+	ResourceTree tree;
+
+	ThreadedRequest requests[THREAD_COUNT];
+	Thread *threads[THREAD_COUNT];
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		requests[i].path = tree.node_path(0, 0);
+		threads[i] = Thread::create(ThreadedRequest::request, &requests[i]);
+	}
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		CHECK(requests[i].request_error == OK);
+		CHECK(requests[i].get_error == OK);
+		CHECK_MESSAGE(requests[i].resource == requests[0].resource, "Every request must share a single load.");
+	}
+	CHECK(count_nodes(requests[0].resource) == NODE_COUNT);
+	CHECK(ResourceLoader::load_threaded_get_status(tree.node_path(0, 0)) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE);
+}
+
+TEST_CASE("[ResourceLoader] Failed threaded requests report an error") {
+	ResourceTree tree;
+	String missing = tree.dir.plus_file("missing.res");
+
+	Error err = OK;
+	CHECK(ResourceLoader::load_threaded_get(missing, &err).is_null());
+	CHECK_MESSAGE(err == ERR_INVALID_PARAMETER, "Getting a path that was never requested must fail.");
+
+	REQUIRE(ResourceLoader::load_threaded_request(missing) == OK);
+	err = OK;
+	CHECK(ResourceLoader::load_threaded_get(missing, &err).is_null());
+	CHECK(err != OK);
+	CHECK(ResourceLoader::load_threaded_get_status(missing) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE);
+}
+
+TEST_CASE("[ResourceLoader] Truncated binary resources fail to load") {
+	ResourceTree tree;
+	String path = tree.dir.plus_file("array.res");
+	String truncated_path = tree.dir.plus_file("truncated.res");
+
+	// Large enough for the file to be mapped and read through FileAccessMemory.
+	Vector<uint8_t> bytes;
+	bytes.resize(1 << 16);
+	for (int i = 0; i < bytes.size(); i++) {
+		bytes.write[i] = i & 0xFF;
+	}
+	Ref<Resource> resource;
+	resource.instance();
+	resource->set_meta("bytes", bytes);
+	REQUIRE(ResourceSaver::save(path, resource) == OK);
+
+	Error err = FAILED;
+	RES loaded = ResourceLoader::load(path, "", true, &err);
+	REQUIRE(err == OK);
+	REQUIRE(loaded.is_valid());
+	CHECK(Vector<uint8_t>(loaded->get_meta("bytes")).size() == bytes.size());
+
+	Vector<uint8_t> data = FileAccess::get_file_as_array(path);
+	REQUIRE(data.size() > bytes.size());
+
+	// Cut inside the header, inside the array and at its last byte, before the end magic.
+	const int cuts[] = { 16, data.size() / 4, data.size() / 2, data.size() - 5 };
+	for (int i = 0; i < 4; i++) {
+		FileAccessRef f = FileAccess::open(truncated_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_buffer(data.ptr(), cuts[i]);
+		f->close();
+
+		err = OK;
+		loaded = ResourceLoader::load(truncated_path, "", true, &err);
+		CHECK_MESSAGE(loaded.is_null(), "A truncated resource must not load.");
+		CHECK(err != OK);
+	}
+}
+
+TEST_CASE("[ResourceLoader][Benchmark] Deep and wide dependency tree" * doctest::skip()) {
+	enum {
+		BENCHMARK_DEPTH = 4,
+		BENCHMARK_WIDTH = 6,
+		LEAF_SIZE = 16 * 1024,
+	};
+
+	ResourceTree tree(BENCHMARK_DEPTH, BENCHMARK_WIDTH, LEAF_SIZE);
+	String path = tree.node_path(0, 0);
+	print_line(vformat("Dependency tree: depth %d, width %d, %d files, %d loader threads.", BENCHMARK_DEPTH, BENCHMARK_WIDTH, tree.file_count, OS::get_singleton()->get_processor_count()));
+
+	// Files were just written, so both loads read from a warm cache.
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	RES root = ResourceLoader::load(path, "", true);
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Serial load: %.1f msec, %d nodes.", elapsed / 1000.0, count_nodes(root)));
+	root.unref();
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	REQUIRE(ResourceLoader::load_threaded_request(path, "", true) == OK);
+	int polls = 0;
+	while (ResourceLoader::load_threaded_get_status(path) == ResourceLoader::THREAD_LOAD_IN_PROGRESS) {
+		polls++;
+		OS::get_singleton()->delay_usec(1000);
+	}
+	root = ResourceLoader::load_threaded_get(path);
+	elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("Threaded load: %.1f msec, %d nodes, %d progress polls.", elapsed / 1000.0, count_nodes(root), polls));
+}
+
+} // namespace TestResourceLoader
+
+#endif // TEST_RESOURCE_LOADER_H
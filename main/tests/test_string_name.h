@@ -0,0 +1,165 @@
+/*************************************************************************/
+/*  test_string_name.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_STRING_NAME_H
+#define TEST_STRING_NAME_H
+
+#include "core/string_name.h"
+#include "core/thread_work_pool.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestStringName {
+
+enum {
+	THREADS = 4,
+	NAMES = 256,
+	ROUNDS = 64,
+};
+
+static String contended_name(int p_index) {
+	return "contended_" + itos(p_index);
+}
+
+struct Interning {
+	StringName names[THREADS][NAMES];
+
+	// Every thread interns the same names, so they race on adding each one.
+	void intern(uint32_t p_index, void *p_userdata) {
+		for (int i = 0; i < NAMES; i++) {
+			names[p_index][i] = StringName(contended_name(i));
+		}
+	}
+
+	void release(uint32_t p_index, void *p_userdata) {
+		for (int i = 0; i < NAMES; i++) {
+			names[p_index][i] = StringName();
+		}
+	}
+};
+
+struct Churn {
+	uint32_t mismatches[THREADS] = {};
+
+	// Interns and releases the same names over and over, so entries are
+	// removed by one thread while others look them up or add them again.
+	void churn(uint32_t p_index, void *p_userdata) {
+		const StringName *shared = (const StringName *)p_userdata;
+		for (int r = 0; r < ROUNDS; r++) {
+			for (int i = 0; i < NAMES; i++) {
+				StringName name = StringName(contended_name(i));
+				if (String(name) != contended_name(i)) {
+					mismatches[p_index]++;
+				}
+				// Names held elsewhere must always resolve to the same entry.
+				if (i % 2 == 0 && name.data_unique_pointer() != shared[i / 2].data_unique_pointer()) {
+					mismatches[p_index]++;
+				}
+			}
+		}
+	}
+};
+
+TEST_CASE("[StringName] Threads interning the same names share one entry") {
+	for (int i = 0; i < NAMES; i++) {
+		REQUIRE_MESSAGE(!StringName::search(contended_name(i)), "The names used by this test must not be interned yet.");
+	}
+
+	ThreadWorkPool pool;
+	pool.init(THREADS);
+	Interning interning;
+	pool.do_work(THREADS, &interning, &Interning::intern, (void *)nullptr);
+
+	int shared = 0;
+	for (int i = 0; i < NAMES; i++) {
+		StringName name = StringName(contended_name(i));
+		int same = 0;
+		for (int t = 0; t < THREADS; t++) {
+			same += interning.names[t][i].data_unique_pointer() == name.data_unique_pointer();
+		}
+		shared += same == THREADS;
+	}
+	CHECK(shared == NAMES);
+
+	pool.do_work(THREADS, &interning, &Interning::release, (void *)nullptr);
+	pool.finish();
+
+	// Once the last reference is gone the entry must be removed, not leaked.
+	int removed = 0;
+	for (int i = 0; i < NAMES; i++) {
+		removed += !StringName::search(contended_name(i));
+	}
+	CHECK(removed == NAMES);
+}
+
+TEST_CASE("[StringName] Concurrent interning and releasing keeps reference counts exact") {
+	StringName shared[NAMES / 2];
+	for (int i = 0; i < NAMES / 2; i++) {
+		shared[i] = StringName(contended_name(i * 2));
+	}
+
+	ThreadWorkPool pool;
+	pool.init(THREADS);
+	Churn churn;
+	pool.do_work(THREADS, &churn, &Churn::churn, (void *)shared);
+	pool.finish();
+
+	for (int t = 0; t < THREADS; t++) {
+		CHECK(churn.mismatches[t] == 0);
+	}
+
+	// Names held by this thread survived the churn, the others were freed.
+	int kept = 0;
+	int removed = 0;
+	for (int i = 0; i < NAMES; i++) {
+		StringName found = StringName::search(contended_name(i));
+		if (i % 2 == 0) {
+			kept += found.data_unique_pointer() == shared[i / 2].data_unique_pointer() && String(found) == contended_name(i);
+		} else {
+			removed += !found;
+		}
+	}
+	CHECK(kept == NAMES / 2);
+	CHECK(removed == NAMES / 2);
+
+	// Dropping the last references must bring the counts back to zero.
+	for (int i = 0; i < NAMES / 2; i++) {
+		shared[i] = StringName();
+	}
+	removed = 0;
+	for (int i = 0; i < NAMES; i++) {
+		removed += !StringName::search(contended_name(i));
+	}
+	CHECK(removed == NAMES);
+}
+
+} // namespace TestStringName
+
+#endif // TEST_STRING_NAME_H
@@ -0,0 +1,249 @@
+/*************************************************************************/
+/*  test_thread_work_pool.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_THREAD_WORK_POOL_H
+#define TEST_THREAD_WORK_POOL_H
+
+#include "core/os/os.h"
+#include "core/thread_work_pool.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestThreadWorkPool {
+
+struct Counter {
+	LocalVector<std::atomic<uint32_t>> hits;
+	std::atomic<uint32_t> order;
+	uint32_t first_order = 0;
+	uint32_t second_order = 0;
+	ThreadWorkPool *pool = nullptr;
+
+	void count(uint32_t p_index, int p_amount) {
+		hits[p_index].fetch_add(p_amount);
+	}
+
+	void first(uint32_t p_index, int) {
+		OS::get_singleton()->delay_usec(2000);
+		first_order = order.fetch_add(1);
+	}
+
+	void second(uint32_t p_index, int) {
+		second_order = order.fetch_add(1);
+	}
+
+	void nested(uint32_t p_index, int) {
+		pool->do_work(64, this, &Counter::count, 1);
+	}
+
+	void noop(uint32_t p_index, int) {
+	}
+
+	void reset(uint32_t p_size) {
+		hits.resize(p_size);
+		for (uint32_t i = 0; i < p_size; i++) {
+			hits[i].store(0);
+		}
+		order.store(0);
+	}
+
+	bool all_equal(uint32_t p_value) const {
+		for (uint32_t i = 0; i < hits.size(); i++) {
+			if (hits[i].load() != p_value) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+TEST_CASE("[ThreadWorkPool] Every element is processed once") {
+	for (int threads = 0; threads <= 4; threads += 2) {
+		ThreadWorkPool pool;
+		pool.init(threads);
+		Counter counter;
+		counter.reset(10000);
+
+		pool.do_work(10000, &counter, &Counter::count, 1);
+		pool.do_work(10000, &counter, &Counter::count, 1, 7);
+		pool.do_work(10000, &counter, &Counter::count, 1, 0);
+
+		CHECK_MESSAGE(counter.all_equal(3), "Every element should be visited once per group.");
+		pool.finish();
+	}
+}
+
+TEST_CASE("[ThreadWorkPool] Non blocking submission") {
+	ThreadWorkPool pool;
+	pool.init(2);
+	Counter counter;
+	counter.reset(1000);
+
+	ThreadWorkPool::GroupID a = pool.add_group_task(&counter, &Counter::count, 1, 1000, 16);
+	ThreadWorkPool::GroupID b = pool.add_group_task(&counter, &Counter::count, 2, 1000, 16);
+	pool.wait_for_group(b);
+	pool.wait_for_group(a);
+
+	CHECK(counter.all_equal(3));
+	CHECK_MESSAGE(pool.is_group_completed(a), "Released groups should be reported as completed.");
+}
+
+TEST_CASE("[ThreadWorkPool] Dependencies") {
+	ThreadWorkPool pool;
+	pool.init(2);
+	Counter counter;
+
+	for (int i = 0; i < 10; i++) {
+		counter.reset(0);
+		ThreadWorkPool::GroupID a = pool.add_task(&counter, &Counter::first, 0);
+		ThreadWorkPool::GroupID b = pool.add_task(&counter, &Counter::second, 0, &a, 1);
+		pool.wait_for_group(b);
+		pool.wait_for_group(a);
+
+		CHECK_MESSAGE(counter.first_order < counter.second_order, "A group must not start before its dependencies are done.");
+	}
+}
+
+TEST_CASE("[ThreadWorkPool] Nested submission from workers") {
+	ThreadWorkPool pool;
+	pool.init(2);
+	Counter counter;
+	counter.pool = &pool;
+	counter.reset(64);
+
+	pool.do_work(32, &counter, &Counter::nested, 0);
+
+	CHECK(counter.all_equal(32));
+}
+
+// The previous pool design: every thread is woken through its own semaphore
+// and they all pull from a single atomic index. Kept here as a baseline.
+class LegacyWorkPool {
+	struct ThreadData {
+		std::thread *thread = nullptr;
+		Semaphore start;
+		Semaphore completed;
+		std::atomic<bool> exit;
+		LegacyWorkPool *pool = nullptr;
+	};
+
+	ThreadData *threads = nullptr;
+	uint32_t thread_count = 0;
+	std::atomic<uint32_t> index;
+	uint32_t max_elements = 0;
+	Counter *counter = nullptr;
+
+	static void _thread_function(ThreadData *p_thread) {
+		while (true) {
+			p_thread->start.wait();
+			if (p_thread->exit.load()) {
+				break;
+			}
+			LegacyWorkPool *pool = p_thread->pool;
+			while (true) {
+				uint32_t work_index = pool->index.fetch_add(1, std::memory_order_relaxed);
+				if (work_index >= pool->max_elements) {
+					break;
+				}
+				pool->counter->noop(work_index, 0);
+			}
+			p_thread->completed.post();
+		}
+	}
+
+public:
+	void do_work(uint32_t p_elements, Counter *p_counter) {
+		index.store(0);
+		max_elements = p_elements;
+		counter = p_counter;
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].start.post();
+		}
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].completed.wait();
+		}
+	}
+
+	void init(uint32_t p_thread_count) {
+		thread_count = p_thread_count;
+		threads = memnew_arr(ThreadData, thread_count);
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].exit.store(false);
+			threads[i].pool = this;
+			threads[i].thread = memnew(std::thread(LegacyWorkPool::_thread_function, &threads[i]));
+		}
+	}
+
+	~LegacyWorkPool() {
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].exit.store(true);
+			threads[i].start.post();
+		}
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].thread->join();
+			memdelete(threads[i].thread);
+		}
+		memdelete_arr(threads);
+	}
+};
+
+TEST_CASE("[ThreadWorkPool][Benchmark] Dispatch overhead" * doctest::skip()) {
+	const uint32_t thread_count = MAX(1, OS::get_singleton()->get_processor_count());
+	const int iterations = 5000;
+	const uint32_t element_counts[] = { 1, 64, 4096 };
+
+	ThreadWorkPool pool;
+	pool.init(thread_count);
+	LegacyWorkPool legacy;
+	legacy.init(thread_count);
+	Counter counter;
+
+	for (uint32_t e = 0; e < sizeof(element_counts) / sizeof(element_counts[0]); e++) {
+		uint32_t elements = element_counts[e];
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < iterations; i++) {
+			legacy.do_work(elements, &counter);
+		}
+		uint64_t legacy_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < iterations; i++) {
+			pool.do_work(elements, &counter, &Counter::noop, 0, 0);
+		}
+		uint64_t pool_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+		OS::get_singleton()->print("%d threads, %d elements: legacy %.2f usec/dispatch, work stealing %.2f usec/dispatch\n",
+				thread_count, elements, double(legacy_usec) / iterations, double(pool_usec) / iterations);
+	}
+}
+
+} // namespace TestThreadWorkPool
+
+#endif // TEST_THREAD_WORK_POOL_H
@@ -113,12 +113,38 @@
 	}                                                                           \
 	void GdNavigationServer::MERGE(_cmd_, F_NAME)(T_0 D_0, T_1 D_1, T_2 D_2, T_3 D_3)
 
+void NavPathQuery::solve(uint32_t p_index, void *p_userdata) {
+	paths[p_index] = NavMap::get_snapshot_path(snapshot, origins[p_index], destinations[p_index], optimize);
+}
+
+bool NavPathQuery::is_done() const {
+	return group == ThreadWorkPool::INVALID_GROUP_ID || ThreadWorkPool::get_singleton()->is_group_completed(group);
+}
+
+void NavPathQuery::finish() {
+	if (group != ThreadWorkPool::INVALID_GROUP_ID) {
+		ThreadWorkPool::get_singleton()->wait_for_group(group);
+		group = ThreadWorkPool::INVALID_GROUP_ID;
+	}
+	if (snapshot) {
+		NavMap::release_snapshot(snapshot);
+		snapshot = nullptr;
+	}
+}
+
 GdNavigationServer::GdNavigationServer() :
 		NavigationServer3D() {
 }
 
 GdNavigationServer::~GdNavigationServer() {
 	flush_queries();
+
+	for (uint32_t i = 0; i < callback_queries.size(); i++) {
+		NavPathQuery *query = path_query_owner.getornull(callback_queries[i]);
+		query->finish();
+		path_query_owner.free(callback_queries[i]);
+		memdelete(query);
+	}
 }
 
 void GdNavigationServer::add_command(SetCommand *command) const {
@@ -235,6 +261,65 @@ RID GdNavigationServer::map_get_closest_point_owner(RID p_map, const Vector3 &p_
 	return map->get_closest_point_owner(p_point);
 }
 
+RID GdNavigationServer::map_query_paths(RID p_map, const Vector<Vector3> &p_origins, const Vector<Vector3> &p_destinations, bool p_optimize, const Callable &p_callback) const {
+	auto mut_this = const_cast<GdNavigationServer *>(this);
+	MutexLock lock(mut_this->operations_mutex);
+
+	const NavMap *map = map_owner.getornull(p_map);
+	ERR_FAIL_COND_V(map == nullptr, RID());
+	ERR_FAIL_COND_V_MSG(p_origins.size() != p_destinations.size(), RID(), "Each origin needs a destination.");
+
+	NavPathQuery *query = memnew(NavPathQuery);
+	query->snapshot = map->acquire_snapshot();
+	query->origins = p_origins;
+	query->destinations = p_destinations;
+	query->optimize = p_optimize;
+	query->paths.resize(p_origins.size());
+	query->callback = p_callback;
+
+	RID rid = path_query_owner.make_rid(query);
+
+	if (ThreadWorkPool::get_singleton() && p_origins.size() > 1) {
+		query->group = ThreadWorkPool::get_singleton()->add_group_task(query, &NavPathQuery::solve, nullptr, p_origins.size());
+	} else {
+		for (int i = 0; i < p_origins.size(); i++) {
+			query->solve(i, nullptr);
+		}
+	}
+
+	if (!query->callback.is_null()) {
+		mut_this->callback_queries.push_back(rid);
+	}
+	return rid;
+}
+
+bool GdNavigationServer::path_query_is_done(RID p_query) const {
+	auto mut_this = const_cast<GdNavigationServer *>(this);
+	MutexLock lock(mut_this->operations_mutex);
+
+	const NavPathQuery *query = path_query_owner.getornull(p_query);
+	ERR_FAIL_COND_V(query == nullptr, false);
+
+	return query->is_done();
+}
+
+Array GdNavigationServer::path_query_get_paths(RID p_query) const {
+	auto mut_this = const_cast<GdNavigationServer *>(this);
+	MutexLock lock(mut_this->operations_mutex);
+
+	NavPathQuery *query = path_query_owner.getornull(p_query);
+	ERR_FAIL_COND_V(query == nullptr, Array());
+
+	query->finish();
+
+	Array paths;
+	paths.resize(query->paths.size());
+	for (uint32_t i = 0; i < query->paths.size(); i++) {
+		paths[i] = query->paths[i];
+	}
+	return paths;
+}
+
 RID GdNavigationServer::region_create() const {
 	auto mut_this = const_cast<GdNavigationServer *>(this);
 	MutexLock lock(mut_this->operations_mutex);
@@ -457,6 +542,15 @@ COMMAND_1(free, RID, p_object) {
 		agent_owner.free(p_object);
 		memdelete(agent);
 
+	} else if (path_query_owner.owns(p_object)) {
+		NavPathQuery *query = path_query_owner.getornull(p_object);
+
+		query->finish();
+		callback_queries.erase(p_object);
+
+		path_query_owner.free(p_object);
+		memdelete(query);
+
 	} else {
 		ERR_FAIL_COND("Invalid ID.");
 	}
@@ -480,8 +574,47 @@ void GdNavigationServer::flush_queries() {
 	commands.clear();
 }
 
+void GdNavigationServer::dispatch_path_queries() {
+	LocalVector<NavPathQuery *> done;
+	{
+		MutexLock lock(operations_mutex);
+		for (uint32_t i = 0; i < callback_queries.size(); i++) {
+			NavPathQuery *query = path_query_owner.getornull(callback_queries[i]);
+			if (!query->is_done()) {
+				continue;
+			}
+			query->finish();
+			done.push_back(query);
+			path_query_owner.free(callback_queries[i]);
+			callback_queries[i] = callback_queries[callback_queries.size() - 1];
+			callback_queries.resize(callback_queries.size() - 1);
+			i--;
+		}
+	}
+
+	// Called without holding the lock, so the callbacks can queue new queries.
+	for (uint32_t i = 0; i < done.size(); i++) {
+		NavPathQuery *query = done[i];
+		if (query->callback.get_object()) {
+			Array paths;
+			paths.resize(query->paths.size());
+			for (uint32_t j = 0; j < query->paths.size(); j++) {
+				paths[j] = query->paths[j];
+			}
+
+			Variant paths_var = paths;
+			const Variant *vp[1] = { &paths_var };
+			Variant ret;
+			Callable::CallError ce;
+			query->callback.call(vp, 1, ret, ce);
+		}
+		memdelete(query);
+	}
+}
+
 void GdNavigationServer::process(real_t p_delta_time) {
 	flush_queries();
+	dispatch_path_queries();
 
 	if (!active) {
 		return;
@@ -31,8 +31,10 @@
 #ifndef GD_NAVIGATION_SERVER_H
 #define GD_NAVIGATION_SERVER_H
 
+#include "core/local_vector.h"
 #include "core/rid.h"
 #include "core/rid_owner.h"
+#include "core/thread_work_pool.h"
 #include "servers/navigation_server_3d.h"
 
 #include "nav_map.h"
@@ -67,6 +69,23 @@ struct SetCommand {
 	virtual void exec(GdNavigationServer *server) = 0;
 };
 
+/// A batch of path queries, solved on the `ThreadWorkPool`.
+struct NavPathQuery {
+	gd::MapSnapshot *snapshot = nullptr;
+	Vector<Vector3> origins;
+	Vector<Vector3> destinations;
+	bool optimize = true;
+	LocalVector<Vector<Vector3>> paths;
+	ThreadWorkPool::GroupID group = ThreadWorkPool::INVALID_GROUP_ID;
+
+	Callable callback;
+
+	void solve(uint32_t p_index, void *p_userdata);
+	bool is_done() const;
+	/// Waits for the workers and releases the snapshot.
+	void finish();
+};
+
 class GdNavigationServer : public NavigationServer3D {
 	Mutex commands_mutex;
 	/// Mutex used to make any operation threadsafe.
@@ -77,6 +96,10 @@ class GdNavigationServer : public NavigationServer3D {
 	mutable RID_PtrOwner<NavMap> map_owner;
 	mutable RID_PtrOwner<NavRegion> region_owner;
 	mutable RID_PtrOwner<RvoAgent> agent_owner;
+	mutable RID_PtrOwner<NavPathQuery> path_query_owner;
+
+	/// The path queries with a callback, waiting to be dispatched.
+	LocalVector<RID> callback_queries;
 
 	bool active = true;
 	Vector<NavMap *> active_maps;
@@ -107,6 +130,10 @@ public:
 	virtual Vector3 map_get_closest_point_normal(RID p_map, const Vector3 &p_point) const;
 	virtual RID map_get_closest_point_owner(RID p_map, const Vector3 &p_point) const;
 
+	virtual RID map_query_paths(RID p_map, const Vector<Vector3> &p_origins, const Vector<Vector3> &p_destinations, bool p_optimize, const Callable &p_callback = Callable()) const;
+	virtual bool path_query_is_done(RID p_query) const;
+	virtual Array path_query_get_paths(RID p_query) const;
+
 	virtual RID region_create() const;
 	COMMAND_2(region_set_map, RID, p_region, RID, p_map);
 	COMMAND_2(region_set_transform, RID, p_region, Transform, p_transform);
@@ -132,6 +159,7 @@ public:
 	virtual void set_active(bool p_active) const;
 
 	void flush_queries();
+	void dispatch_path_queries();
 	virtual void process(real_t p_delta_time);
 };
 
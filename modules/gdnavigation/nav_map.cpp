@@ -42,6 +42,14 @@
 
 #define USE_ENTRY_POINT
 
+NavMap::NavMap() {
+	snapshot = memnew(gd::MapSnapshot);
+}
+
+NavMap::~NavMap() {
+	release_snapshot(snapshot);
+}
+
 void NavMap::set_up(Vector3 p_up) {
 	up = p_up;
 	regenerate_polygons = true;
@@ -70,39 +78,155 @@ gd::PointKey NavMap::get_point_key(const Vector3 &p_pos) const {
 	return p;
 }
 
-Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p_optimize) const {
-	const gd::Polygon *begin_poly = nullptr;
-	const gd::Polygon *end_poly = nullptr;
-	Vector3 begin_point;
-	Vector3 end_point;
-	float begin_d = 1e20;
-	float end_d = 1e20;
+namespace {
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+struct OpenEntry {
+	float cost;
+	uint32_t id;
+
+	// Ties go to the oldest entry, as the linear open list scan used to do.
+	bool operator<(const OpenEntry &p_other) const {
+		return cost == p_other.cost ? id < p_other.id : cost < p_other.cost;
+	}
+};
+
+/// Per thread `get_path` state, reused by the following queries.
+struct PathScratch {
+	std::vector<gd::NavigationPoly> navigation_polys;
+	/// The open list, a binary min heap on the cost.
+	std::vector<OpenEntry> open_heap;
+	/// The `navigation_polys` id of each map polygon, valid when its
+	/// `poly_pass` is the current `pass`.
+	std::vector<int> poly_nav_ids;
+	std::vector<uint32_t> poly_pass;
+	uint32_t pass = 0;
+
+	void begin(size_t p_polygon_count) {
+		if (poly_pass.size() < p_polygon_count) {
+			poly_nav_ids.resize(p_polygon_count);
+			poly_pass.resize(p_polygon_count, 0);
+		}
+		next_pass();
+	}
 
-		// For each point cast a face and check the distance between the origin/destination
-		for (size_t point_id = 2; point_id < p.points.size(); point_id++) {
-			Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			Vector3 spoint = f.get_closest_point_to(p_origin);
-			float dpoint = spoint.distance_to(p_origin);
-			if (dpoint < begin_d) {
-				begin_d = dpoint;
-				begin_poly = &p;
-				begin_point = spoint;
+	void next_pass() {
+		navigation_polys.clear();
+		open_heap.clear();
+		pass++;
+		if (pass == 0) {
+			std::fill(poly_pass.begin(), poly_pass.end(), 0);
+			pass = 1;
+		}
+	}
+
+	int get_nav_id(const gd::Polygon *p_poly) const {
+		return poly_pass[p_poly->id] == pass ? poly_nav_ids[p_poly->id] : -1;
+	}
+
+	uint32_t add(const gd::Polygon *p_poly) {
+		uint32_t id = navigation_polys.size();
+		navigation_polys.push_back(gd::NavigationPoly(p_poly));
+		navigation_polys[id].self_id = id;
+		poly_nav_ids[p_poly->id] = id;
+		poly_pass[p_poly->id] = pass;
+		return id;
+	}
+
+	void _heap_set(int p_pos, const OpenEntry &p_entry) {
+		open_heap[p_pos] = p_entry;
+		navigation_polys[p_entry.id].heap_index = p_pos;
+	}
+
+	void _sift_up(int p_pos) {
+		OpenEntry entry = open_heap[p_pos];
+		while (p_pos > 0) {
+			int parent = (p_pos - 1) / 2;
+			if (!(entry < open_heap[parent])) {
+				break;
 			}
+			_heap_set(p_pos, open_heap[parent]);
+			p_pos = parent;
+		}
+		_heap_set(p_pos, entry);
+	}
 
-			spoint = f.get_closest_point_to(p_destination);
-			dpoint = spoint.distance_to(p_destination);
-			if (dpoint < end_d) {
-				end_d = dpoint;
-				end_poly = &p;
-				end_point = spoint;
+	void _sift_down(int p_pos) {
+		OpenEntry entry = open_heap[p_pos];
+		const int size = open_heap.size();
+		while (true) {
+			int child = p_pos * 2 + 1;
+			if (child >= size) {
+				break;
 			}
+			if (child + 1 < size && open_heap[child + 1] < open_heap[child]) {
+				child++;
+			}
+			if (!(open_heap[child] < entry)) {
+				break;
+			}
+			_heap_set(p_pos, open_heap[child]);
+			p_pos = child;
 		}
+		_heap_set(p_pos, entry);
 	}
 
+	void open(uint32_t p_id, float p_cost) {
+		OpenEntry entry;
+		entry.cost = p_cost;
+		entry.id = p_id;
+		open_heap.push_back(entry);
+		_sift_up(open_heap.size() - 1);
+	}
+
+	// A shorter route can still enter the polygon further from the end, so
+	// the cost can move both ways.
+	void update(uint32_t p_id, float p_cost) {
+		int pos = navigation_polys[p_id].heap_index;
+		open_heap[pos].cost = p_cost;
+		_sift_up(pos);
+		_sift_down(navigation_polys[p_id].heap_index);
+	}
+
+	uint32_t pop() {
+		uint32_t id = open_heap[0].id;
+		navigation_polys[id].heap_index = -1;
+		OpenEntry last = open_heap.back();
+		open_heap.pop_back();
+		if (!open_heap.empty()) {
+			open_heap[0] = last;
+			_sift_down(0);
+		}
+		return id;
+	}
+};
+
+thread_local PathScratch path_scratch;
+
+real_t aabb_distance_squared(const AABB &p_aabb, const Vector3 &p_point) {
+	const Vector3 end = p_aabb.position + p_aabb.size;
+	const Vector3 clamped(
+			CLAMP(p_point.x, p_aabb.position.x, end.x),
+			CLAMP(p_point.y, p_aabb.position.y, end.y),
+			CLAMP(p_point.z, p_aabb.position.z, end.z));
+	return clamped.distance_squared_to(p_point);
+}
+
+} // namespace
+
+Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p_optimize) const {
+	return get_snapshot_path(snapshot, p_origin, p_destination, p_optimize);
+}
+
+Vector<Vector3> NavMap::get_snapshot_path(const gd::MapSnapshot *p_snapshot, Vector3 p_origin, Vector3 p_destination, bool p_optimize) {
+	const Vector3 &up = p_snapshot->up;
+
+	// Find the initial poly and the end poly on this map.
+	Vector3 begin_point;
+	Vector3 end_point;
+	const gd::Polygon *begin_poly = _get_closest_polygon(p_snapshot, p_origin, &begin_point);
+	const gd::Polygon *end_poly = _get_closest_polygon(p_snapshot, p_destination, &end_point);
+	float end_d = 1e20;
+
 	if (!begin_poly || !end_poly) {
 		// No path
 		return Vector<Vector3>();
@@ -116,23 +240,15 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 		return path;
 	}
 
-	std::vector<gd::NavigationPoly> navigation_polys;
-	navigation_polys.reserve(polygons.size() * 0.75);
+	PathScratch &scratch = path_scratch;
+	scratch.begin(p_snapshot->polygons.size());
+	std::vector<gd::NavigationPoly> &navigation_polys = scratch.navigation_polys;
 
 	// The elements indices in the `navigation_polys`.
-	int least_cost_id(-1);
-	List<uint32_t> open_list;
+	int least_cost_id = scratch.add(begin_poly);
 	bool found_route = false;
 
-	navigation_polys.push_back(gd::NavigationPoly(begin_poly));
-	{
-		least_cost_id = 0;
-		gd::NavigationPoly *least_cost_poly = &navigation_polys[least_cost_id];
-		least_cost_poly->self_id = least_cost_id;
-		least_cost_poly->entry = begin_point;
-	}
-
-	open_list.push_back(0);
+	navigation_polys[least_cost_id].entry = begin_point;
 
 	const gd::Polygon *reachable_end = nullptr;
 	float reachable_d = 1e30;
@@ -161,43 +277,44 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 				const float new_distance = least_cost_poly->poly->center.distance_to(edge.other_polygon->center) + least_cost_poly->traveled_distance;
 #endif
 
-				auto it = std::find(
-						navigation_polys.begin(),
-						navigation_polys.end(),
-						gd::NavigationPoly(edge.other_polygon));
-
-				if (it != navigation_polys.end()) {
+				const int nav_id = scratch.get_nav_id(edge.other_polygon);
+				if (nav_id != -1) {
+					gd::NavigationPoly *np = &navigation_polys[nav_id];
 					// Oh this was visited already, can we win the cost?
-					if (it->traveled_distance > new_distance) {
-						it->prev_navigation_poly_id = least_cost_id;
-						it->back_navigation_edge = edge.other_edge;
-						it->traveled_distance = new_distance;
+					if (np->traveled_distance > new_distance) {
+						np->prev_navigation_poly_id = least_cost_id;
+						np->back_navigation_edge = edge.other_edge;
+						np->traveled_distance = new_distance;
+#ifdef USE_ENTRY_POINT
+						np->entry = new_entry;
+#endif
+						if (np->heap_index != -1) {
 #ifdef USE_ENTRY_POINT
-						it->entry = new_entry;
+							scratch.update(nav_id, new_distance + np->entry.distance_to(end_point));
+#else
+							scratch.update(nav_id, new_distance + np->poly->center.distance_to(end_point));
 #endif
+						}
 					}
 				} else {
 					// Add to open neighbours
+					const uint32_t new_id = scratch.add(edge.other_polygon);
+					gd::NavigationPoly *np = &navigation_polys[new_id];
 
-					navigation_polys.push_back(gd::NavigationPoly(edge.other_polygon));
-					gd::NavigationPoly *np = &navigation_polys[navigation_polys.size() - 1];
-
-					np->self_id = navigation_polys.size() - 1;
 					np->prev_navigation_poly_id = least_cost_id;
 					np->back_navigation_edge = edge.other_edge;
 					np->traveled_distance = new_distance;
 #ifdef USE_ENTRY_POINT
 					np->entry = new_entry;
+					scratch.open(new_id, new_distance + np->entry.distance_to(end_point));
+#else
+					scratch.open(new_id, new_distance + np->poly->center.distance_to(end_point));
 #endif
-					open_list.push_back(navigation_polys.size() - 1);
 				}
 			}
 		}
 
-		// Removes the least cost polygon from the open list so we can advance.
-		open_list.erase(least_cost_id);
-
-		if (open_list.size() == 0) {
+		if (scratch.open_heap.empty()) {
 			// When the open list is empty at this point the End Polygon is not reachable
 			// so use the further reachable polygon
 			ERR_BREAK_MSG(is_reachable == false, "It's not expect to not find the most reachable polygons");
@@ -222,10 +339,9 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 
 			// Reset open and navigation_polys
 			gd::NavigationPoly np = navigation_polys[0];
-			navigation_polys.clear();
-			navigation_polys.push_back(np);
-			open_list.clear();
-			open_list.push_back(0);
+			scratch.next_pass();
+			least_cost_id = scratch.add(np.poly);
+			navigation_polys[least_cost_id].entry = np.entry;
 
 			reachable_end = nullptr;
 
@@ -233,22 +349,7 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 		}
 
 		// Now take the new least_cost_poly from the open list.
-		least_cost_id = -1;
-		float least_cost = 1e30;
-
-		for (auto element = open_list.front(); element != nullptr; element = element->next()) {
-			gd::NavigationPoly *np = &navigation_polys[element->get()];
-			float cost = np->traveled_distance;
-#ifdef USE_ENTRY_POINT
-			cost += np->entry.distance_to(end_point);
-#else
-			cost += np->poly->center.distance_to(end_point);
-#endif
-			if (cost < least_cost) {
-				least_cost_id = np->self_id;
-				least_cost = cost;
-			}
-		}
+		least_cost_id = scratch.pop();
 
 		// Stores the further reachable end polygon, in case our goal is not reachable.
 		if (is_reachable) {
@@ -259,8 +360,6 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 			}
 		}
 
-		ERR_BREAK(least_cost_id == -1);
-
 		// Check if we reached the end
 		if (navigation_polys[least_cost_id].poly == end_poly) {
 			// Yep, done!!
@@ -312,7 +411,7 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 						left_poly = p;
 						portal_left = left;
 					} else {
-						clip_path(navigation_polys, path, apex_poly, portal_right, right_poly);
+						clip_path(up, navigation_polys, path, apex_poly, portal_right, right_poly);
 
 						apex_point = portal_right;
 						p = right_poly;
@@ -331,7 +430,7 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 						right_poly = p;
 						portal_right = right;
 					} else {
-						clip_path(navigation_polys, path, apex_poly, portal_left, left_poly);
+						clip_path(up, navigation_polys, path, apex_poly, portal_left, left_poly);
 
 						apex_point = portal_left;
 						p = left_poly;
@@ -384,6 +483,7 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 }
 
 Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) const {
+	const std::vector<gd::Polygon> &polygons = snapshot->polygons;
 	bool use_collision = p_use_collision;
 	Vector3 closest_point;
 	real_t closest_point_d = 1e20;
@@ -434,82 +534,127 @@ Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector
 }
 
 Vector3 NavMap::get_closest_point(const Vector3 &p_point) const {
-	// TODO this is really not optimal, please redesign the API to directly return all this data
-
 	Vector3 closest_point;
-	real_t closest_point_d = 1e20;
-
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
-
-		// For each point cast a face and check the distance to the point
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			const Vector3 inters = f.get_closest_point_to(p_point);
-			const real_t d = inters.distance_to(p_point);
-			if (d < closest_point_d) {
-				closest_point = inters;
-				closest_point_d = d;
-			}
-		}
-	}
-
+	_get_closest_polygon(snapshot, p_point, &closest_point);
 	return closest_point;
 }
 
 Vector3 NavMap::get_closest_point_normal(const Vector3 &p_point) const {
-	// TODO this is really not optimal, please redesign the API to directly return all this data
-
 	Vector3 closest_point;
 	Vector3 closest_point_normal;
+	_get_closest_polygon(snapshot, p_point, &closest_point, &closest_point_normal);
+	return closest_point_normal;
+}
+
+RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
+	Vector3 closest_point;
+	const gd::Polygon *closest_poly = _get_closest_polygon(snapshot, p_point, &closest_point);
+	return closest_poly ? closest_poly->owner->get_self() : RID();
+}
+
+const gd::Polygon *NavMap::_get_closest_polygon(const gd::MapSnapshot *p_snapshot, const Vector3 &p_point, Vector3 *r_point, Vector3 *r_normal) {
+	const std::vector<gd::Polygon> &polygons = p_snapshot->polygons;
+	const std::vector<gd::PolygonBVH> &polygons_bvh = p_snapshot->polygons_bvh;
+	const gd::Polygon *closest_poly = nullptr;
 	real_t closest_point_d = 1e20;
+	real_t closest_point_d_squared = 1e40;
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+	if (p_snapshot->polygons_bvh_root == -1) {
+		return nullptr;
+	}
 
-		// For each point cast a face and check the distance to the point
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			const Vector3 inters = f.get_closest_point_to(p_point);
-			const real_t d = inters.distance_to(p_point);
-			if (d < closest_point_d) {
-				closest_point = inters;
-				closest_point_normal = f.get_plane().normal;
-				closest_point_d = d;
+	// Depth first, nearest child first, skipping the nodes further than the closest point found so far.
+	const int STACK_SIZE = 64;
+	int stack[STACK_SIZE];
+	int stack_size = 1;
+	stack[0] = p_snapshot->polygons_bvh_root;
+
+	while (stack_size) {
+		const gd::PolygonBVH &node = polygons_bvh[stack[--stack_size]];
+		// Rounding can put a box slightly further than a polygon inside it, keep a
+		// margin so polygons tied with the closest one are still checked.
+		if (aabb_distance_squared(node.aabb, p_point) > closest_point_d_squared * 1.0001 + CMP_EPSILON2) {
+			continue;
+		}
+
+		if (node.polygon != -1) {
+			const gd::Polygon &p = polygons[node.polygon];
+
+			// For each point cast a face and check the distance to the point
+			for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
+				const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
+				const Vector3 inters = f.get_closest_point_to(p_point);
+				const real_t d = inters.distance_to(p_point);
+				// Ties go to the first polygon, as with a linear search.
+				if (d < closest_point_d || (d == closest_point_d && p.id < closest_poly->id)) {
+					*r_point = inters;
+					if (r_normal) {
+						*r_normal = f.get_plane().normal;
+					}
+					closest_poly = &p;
+					closest_point_d = d;
+					closest_point_d_squared = inters.distance_squared_to(p_point);
+				}
 			}
+			continue;
+		}
+
+		ERR_FAIL_COND_V_MSG(stack_size + 2 > STACK_SIZE, closest_poly, "Navigation map polygons BVH is too deep.");
+		const real_t left_d = aabb_distance_squared(polygons_bvh[node.left].aabb, p_point);
+		const real_t right_d = aabb_distance_squared(polygons_bvh[node.right].aabb, p_point);
+		if (left_d < right_d) {
+			stack[stack_size++] = node.right;
+			stack[stack_size++] = node.left;
+		} else {
+			stack[stack_size++] = node.left;
+			stack[stack_size++] = node.right;
 		}
 	}
 
-	return closest_point_normal;
+	return closest_poly;
 }
 
-RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
-	// TODO this is really not optimal, please redesign the API to directly return all this data
-
-	Vector3 closest_point;
-	RID closest_point_owner;
-	real_t closest_point_d = 1e20;
+int NavMap::_build_polygons_bvh(gd::MapSnapshot *p_snapshot, std::vector<uint32_t> &p_ids, std::vector<AABB> &p_aabbs, int p_from, int p_size) {
+	std::vector<gd::PolygonBVH> &polygons_bvh = p_snapshot->polygons_bvh;
+	if (p_size == 0) {
+		return -1;
+	}
 
-	// Find the initial poly and the end poly on this map.
-	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+	gd::PolygonBVH node;
+	if (p_size == 1) {
+		node.aabb = p_aabbs[p_ids[p_from]];
+		node.polygon = p_ids[p_from];
+		polygons_bvh.push_back(node);
+		return polygons_bvh.size() - 1;
+	}
 
-		// For each point cast a face and check the distance to the point
-		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
-			const Face3 f(p.points[point_id - 2].pos, p.points[point_id - 1].pos, p.points[point_id].pos);
-			const Vector3 inters = f.get_closest_point_to(p_point);
-			const real_t d = inters.distance_to(p_point);
-			if (d < closest_point_d) {
-				closest_point = inters;
-				closest_point_owner = p.owner->get_self();
-				closest_point_d = d;
-			}
-		}
+	node.aabb = p_aabbs[p_ids[p_from]];
+	for (int i = 1; i < p_size; i++) {
+		node.aabb.merge_with(p_aabbs[p_ids[p_from + i]]);
 	}
 
-	return closest_point_owner;
+	// Median split on the longest axis.
+	const int axis = node.aabb.get_longest_axis_index();
+	std::nth_element(p_ids.begin() + p_from, p_ids.begin() + p_from + p_size / 2, p_ids.begin() + p_from + p_size,
+			[&p_aabbs, axis](uint32_t p_a, uint32_t p_b) {
+				return p_aabbs[p_a].position[axis] + p_aabbs[p_a].size[axis] * 0.5 < p_aabbs[p_b].position[axis] + p_aabbs[p_b].size[axis] * 0.5;
+			});
+
+	node.left = _build_polygons_bvh(p_snapshot, p_ids, p_aabbs, p_from, p_size / 2);
+	node.right = _build_polygons_bvh(p_snapshot, p_ids, p_aabbs, p_from + p_size / 2, p_size - p_size / 2);
+	polygons_bvh.push_back(node);
+	return polygons_bvh.size() - 1;
+}
+
+gd::MapSnapshot *NavMap::acquire_snapshot() const {
+	snapshot->refcount.ref();
+	return snapshot;
+}
+
+void NavMap::release_snapshot(gd::MapSnapshot *p_snapshot) {
+	if (p_snapshot->refcount.unref()) {
+		memdelete(p_snapshot);
+	}
 }
 
 void NavMap::add_region(NavRegion *p_region) {
@@ -575,6 +720,11 @@ void NavMap::sync() {
 	}
 
 	if (regenerate_links) {
+		// Build a new snapshot, the previous one may still be used by queries in flight.
+		gd::MapSnapshot *new_snapshot = memnew(gd::MapSnapshot);
+		new_snapshot->up = up;
+		std::vector<gd::Polygon> &polygons = new_snapshot->polygons;
+
 		// Copy all region polygons in the map.
 		int count = 0;
 		for (size_t r(0); r < regions.size(); r++) {
@@ -593,6 +743,23 @@ void NavMap::sync() {
 			count += regions[r]->get_polygons().size();
 		}
 
+		// Index the polygons, so the closest ones are found without checking all of them.
+		std::vector<uint32_t> bvh_ids(polygons.size());
+		std::vector<AABB> bvh_aabbs(polygons.size());
+		for (size_t poly_id(0); poly_id < polygons.size(); poly_id++) {
+			gd::Polygon &poly(polygons[poly_id]);
+			poly.id = poly_id;
+			bvh_ids[poly_id] = poly_id;
+			if (poly.points.size()) {
+				bvh_aabbs[poly_id].position = poly.points[0].pos;
+				for (size_t p(1); p < poly.points.size(); p++) {
+					bvh_aabbs[poly_id].expand_to(poly.points[p].pos);
+				}
+			}
+		}
+		new_snapshot->polygons_bvh.reserve(polygons.size() * 2);
+		new_snapshot->polygons_bvh_root = _build_polygons_bvh(new_snapshot, bvh_ids, bvh_aabbs, 0, polygons.size());
+
 		// Connects the `Edges` of all the `Polygons` of all `Regions` each other.
 		Map<gd::EdgeKey, gd::Connection> connections;
 
@@ -704,6 +871,10 @@ void NavMap::sync() {
 				}
 			}
 		}
+
+		// Publish the new snapshot.
+		release_snapshot(snapshot);
+		snapshot = new_snapshot;
 	}
 
 	if (regenerate_links) {
@@ -746,14 +917,14 @@ void NavMap::dispatch_callbacks() {
 	}
 }
 
-void NavMap::clip_path(const std::vector<gd::NavigationPoly> &p_navigation_polys, Vector<Vector3> &path, const gd::NavigationPoly *from_poly, const Vector3 &p_to_point, const gd::NavigationPoly *p_to_poly) const {
+void NavMap::clip_path(const Vector3 &p_up, const std::vector<gd::NavigationPoly> &p_navigation_polys, Vector<Vector3> &path, const gd::NavigationPoly *from_poly, const Vector3 &p_to_point, const gd::NavigationPoly *p_to_poly) {
 	Vector3 from = path[path.size() - 1];
 
 	if (from.distance_to(p_to_point) < CMP_EPSILON) {
 		return;
 	}
 	Plane cut_plane;
-	cut_plane.normal = (from - p_to_point).cross(up);
+	cut_plane.normal = (from - p_to_point).cross(p_up);
 	if (cut_plane.normal == Vector3()) {
 		return;
 	}
@@ -61,8 +61,8 @@ class NavMap : public NavRid {
 
 	std::vector<NavRegion *> regions;
 
-	/// Map polygons
-	std::vector<gd::Polygon> polygons;
+	/// Map polygons and their index, replaced each time the links are regenerated.
+	gd::MapSnapshot *snapshot = nullptr;
 
 	/// Rvo world
 	RVO::KdTree rvo;
@@ -83,7 +83,8 @@ class NavMap : public NavRid {
 	uint32_t map_update_id = 0;
 
 public:
-	NavMap() {}
+	NavMap();
+	~NavMap();
 
 	void set_up(Vector3 p_up);
 	Vector3 get_up() const {
@@ -103,6 +104,8 @@ public:
 	gd::PointKey get_point_key(const Vector3 &p_pos) const;
 
 	Vector<Vector3> get_path(Vector3 p_origin, Vector3 p_destination, bool p_optimize) const;
+	/// Thread safe, solves the path on a snapshot of the map.
+	static Vector<Vector3> get_snapshot_path(const gd::MapSnapshot *p_snapshot, Vector3 p_origin, Vector3 p_destination, bool p_optimize);
 	Vector3 get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) const;
 	Vector3 get_closest_point(const Vector3 &p_point) const;
 	Vector3 get_closest_point_normal(const Vector3 &p_point) const;
@@ -128,13 +131,21 @@ public:
 		return map_update_id;
 	}
 
+	/// Returns the current snapshot, which stays valid until released.
+	gd::MapSnapshot *acquire_snapshot() const;
+	static void release_snapshot(gd::MapSnapshot *p_snapshot);
+
 	void sync();
 	void step(real_t p_deltatime);
 	void dispatch_callbacks();
 
 private:
+	static int _build_polygons_bvh(gd::MapSnapshot *p_snapshot, std::vector<uint32_t> &p_ids, std::vector<AABB> &p_aabbs, int p_from, int p_size);
+	/// Returns the polygon nearest to `p_point`, and the closest point and face normal on it.
+	static const gd::Polygon *_get_closest_polygon(const gd::MapSnapshot *p_snapshot, const Vector3 &p_point, Vector3 *r_point, Vector3 *r_normal = nullptr);
+
 	void compute_single_step(uint32_t index, RvoAgent **agent);
-	void clip_path(const std::vector<gd::NavigationPoly> &p_navigation_polys, Vector<Vector3> &path, const gd::NavigationPoly *from_poly, const Vector3 &p_to_point, const gd::NavigationPoly *p_to_poly) const;
+	static void clip_path(const Vector3 &p_up, const std::vector<gd::NavigationPoly> &p_navigation_polys, Vector<Vector3> &path, const gd::NavigationPoly *from_poly, const Vector3 &p_to_point, const gd::NavigationPoly *p_to_poly);
 };
 
 #endif // RVO_SPACE_H
@@ -31,7 +31,9 @@
 #ifndef NAV_UTILS_H
 #define NAV_UTILS_H
 
+#include "core/math/aabb.h"
 #include "core/math/vector3.h"
+#include "core/safe_refcount.h"
 
 #include <vector>
 
@@ -104,6 +106,19 @@ struct Polygon {
 
 	/// The center of this `Polygon`
 	Vector3 center;
+
+	/// The index of this `Polygon` in the map.
+	uint32_t id = 0;
+};
+
+/// Node of the bounding volume hierarchy over the map polygons.
+struct PolygonBVH {
+	AABB aabb;
+	/// The children nodes, -1 in leaves.
+	int left = -1;
+	int right = -1;
+	/// The polygon id in leaves, -1 otherwise.
+	int polygon = -1;
 };
 
 struct Connection {
@@ -127,6 +142,8 @@ struct NavigationPoly {
 	Vector3 entry;
 	/// The distance to the destination.
 	float traveled_distance = 0.0;
+	/// The position in the open list heap, -1 when not in the open list.
+	int heap_index = -1;
 
 	NavigationPoly(const Polygon *p_poly) :
 			poly(p_poly) {}
@@ -140,6 +157,26 @@ struct NavigationPoly {
 	}
 };
 
+/// The map navigation data, rebuilt by `NavMap::sync` and never modified
+/// afterwards, so queries can keep using it from other threads.
+struct MapSnapshot {
+	SafeRefCount refcount;
+
+	/// Map Up
+	Vector3 up = Vector3(0, 1, 0);
+
+	/// Map polygons
+	std::vector<Polygon> polygons;
+
+	/// Bounding volume hierarchy over `polygons`.
+	std::vector<PolygonBVH> polygons_bvh;
+	int polygons_bvh_root = -1;
+
+	MapSnapshot() {
+		refcount.init();
+	}
+};
+
 struct FreeEdge {
 	bool is_free;
 	Polygon *poly;
@@ -1565,6 +1565,9 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 }
 
 void GDScriptLanguage::finish() {
+	// The name lookup tables hold StringNames, free them before StringName is cleaned up.
+	GDScriptParser::cleanup();
+	GDScriptAnalyzer::cleanup();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -112,6 +112,8 @@ public:
 	Error resolve_body();
 	Error analyze();
 
+	static void cleanup();
+
 	GDScriptAnalyzer(GDScriptParser *p_parser);
 };
 
@@ -30,6 +30,7 @@
 
 #include "gdscript_compiler.h"
 
+#include "core/core_string_names.h"
 #include "gdscript.h"
 #include "gdscript_cache.h"
 
@@ -81,7 +82,7 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 		return false;
 	}
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, on->operand, on->operand)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
@@ -103,7 +104,8 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 		return false;
 	}
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	codegen.last_operator_pos = codegen.opcodes.size();
+	codegen.opcodes.push_back(_get_operator_opcode(op, p_left_operand, p_right_operand)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
@@ -190,6 +192,195 @@ GDScriptDataType GDScriptCompiler::_gdtype_from_datatype(const GDScriptParser::D
 	return result;
 }
 
+Variant::Type GDScriptCompiler::_get_hard_builtin_type(const GDScriptParser::ExpressionNode *p_expression) const {
+	GDScriptParser::DataType datatype = p_expression->get_datatype();
+	if (!datatype.is_set() || !datatype.is_hard_type() || datatype.kind != GDScriptParser::DataType::BUILTIN) {
+		return Variant::VARIANT_MAX;
+	}
+	return datatype.builtin_type;
+}
+
+// Picks a typed operator opcode when the operand types are known. The VM still
+// checks the types at runtime and uses the generic path if they don't match.
+GDScriptFunction::Opcode GDScriptCompiler::_get_operator_opcode(Variant::Operator p_op, const GDScriptParser::ExpressionNode *p_left_operand, const GDScriptParser::ExpressionNode *p_right_operand) const {
+	switch (p_op) {
+		case Variant::OP_AND:
+		case Variant::OP_OR:
+		case Variant::OP_XOR:
+		case Variant::OP_NOT:
+		case Variant::OP_IN:
+		case Variant::OP_STRING_CONCAT: {
+			return GDScriptFunction::OPCODE_OPERATOR;
+		} break;
+		default: {
+		}
+	}
+
+	Variant::Type a = _get_hard_builtin_type(p_left_operand);
+	Variant::Type b = _get_hard_builtin_type(p_right_operand);
+	bool b_is_number = b == Variant::INT || b == Variant::FLOAT;
+
+	switch (a) {
+		case Variant::INT: {
+			if (b == Variant::INT) {
+				return GDScriptFunction::OPCODE_OPERATOR_INT;
+			} else if (b == Variant::FLOAT) {
+				return GDScriptFunction::OPCODE_OPERATOR_FLOAT;
+			}
+		} break;
+		case Variant::FLOAT: {
+			if (b_is_number) {
+				return GDScriptFunction::OPCODE_OPERATOR_FLOAT;
+			}
+		} break;
+		case Variant::VECTOR2: {
+			if (b == Variant::VECTOR2 || b_is_number) {
+				return GDScriptFunction::OPCODE_OPERATOR_VECTOR2;
+			}
+		} break;
+		case Variant::VECTOR3: {
+			if (b == Variant::VECTOR3 || b_is_number) {
+				return GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+			}
+		} break;
+		default: {
+		}
+	}
+
+	return GDScriptFunction::OPCODE_OPERATOR;
+}
+
+// Returns the axis for x, y or z on a base known to be a Vector2 or Vector3, -1 otherwise.
+int GDScriptCompiler::_get_vector_component_axis(const GDScriptParser::ExpressionNode *p_base, const StringName &p_name) const {
+	Variant::Type type = _get_hard_builtin_type(p_base);
+	if (type != Variant::VECTOR2 && type != Variant::VECTOR3) {
+		return -1;
+	}
+
+	if (p_name == CoreStringNames::get_singleton()->x) {
+		return Vector3::AXIS_X;
+	} else if (p_name == CoreStringNames::get_singleton()->y) {
+		return Vector3::AXIS_Y;
+	} else if (type == Variant::VECTOR3 && p_name == CoreStringNames::get_singleton()->z) {
+		return Vector3::AXIS_Z;
+	}
+	return -1;
+}
+
+// Resolves a method call on a base with a native static type to its method bind,
+// so the VM can call it directly instead of looking it up by name every time.
+// Returns -1 if the call has to go through Object::call().
+int GDScriptCompiler::_get_method_bind_pos(CodeGen &codegen, const GDScriptParser::ExpressionNode *p_base, const StringName &p_method) {
+	GDScriptParser::DataType base_type = p_base->get_datatype();
+	if (!base_type.is_set() || !base_type.is_hard_type() || base_type.is_meta_type || base_type.kind != GDScriptParser::DataType::NATIVE) {
+		return -1;
+	}
+
+	if (p_method == CoreStringNames::get_singleton()->_free) {
+		return -1; // Handled by Object::call().
+	}
+
+	const ClassDB::ClassInfo *class_info = ClassDB::classes.getptr(base_type.native_type);
+	if (!class_info || !class_info->class_ptr) {
+		return -1;
+	}
+
+	MethodBind *method = ClassDB::get_method(base_type.native_type, p_method);
+	if (!method) {
+		return -1;
+	}
+
+	// A derived class may bind a method with the same name, which Object::call() would pick instead.
+	List<StringName> inheriters;
+	ClassDB::get_inheriters_from_class(base_type.native_type, &inheriters);
+	for (List<StringName>::Element *E = inheriters.front(); E; E = E->next()) {
+		if (ClassDB::has_method(E->get(), p_method, true)) {
+			return -1;
+		}
+	}
+
+	return codegen.get_method_bind_pos(method, class_info->class_ptr);
+}
+
+// Resolves a property on a base with a native static type to the method bind of
+// its setter or getter, so the VM can call it directly instead of going through
+// Object::set() and Object::get(). Returns -1 if it has to be looked up by name.
+int GDScriptCompiler::_get_property_method_bind_pos(CodeGen &codegen, const GDScriptParser::ExpressionNode *p_base, const StringName &p_property, bool p_setter) {
+	GDScriptParser::DataType base_type = p_base->get_datatype();
+	if (!base_type.is_set() || !base_type.is_hard_type() || base_type.is_meta_type || base_type.kind != GDScriptParser::DataType::NATIVE) {
+		return -1;
+	}
+
+	const ClassDB::ClassInfo *class_info = ClassDB::classes.getptr(base_type.native_type);
+	if (!class_info || !class_info->class_ptr) {
+		return -1;
+	}
+
+	// Same lookup as ClassDB::get_property(), where constants, methods and signals of a
+	// class hide properties of its base classes.
+	const ClassDB::PropertySetGet *psg = nullptr;
+	for (const ClassDB::ClassInfo *check = class_info; check; check = check->inherits_ptr) {
+		psg = check->property_setget.getptr(p_property);
+		if (psg) {
+			break;
+		}
+		if (check->constant_map.has(p_property) || check->method_map.has(p_property) || check->signal_map.has(p_property)) {
+			return -1;
+		}
+	}
+
+	if (!psg || psg->index >= 0) {
+		return -1; // Indexed properties pass the index to the setter and getter.
+	}
+
+	MethodBind *method = p_setter ? psg->_setptr : psg->_getptr;
+	if (!method) {
+		return -1;
+	}
+
+	// Derived classes are looked up first, they must not have anything with the same name.
+	List<StringName> inheriters;
+	ClassDB::get_inheriters_from_class(base_type.native_type, &inheriters);
+	for (List<StringName>::Element *E = inheriters.front(); E; E = E->next()) {
+		const ClassDB::ClassInfo *inheriter = ClassDB::classes.getptr(E->get());
+		if (inheriter->property_setget.has(p_property) || inheriter->constant_map.has(p_property) || inheriter->method_map.has(p_property) || inheriter->signal_map.has(p_property)) {
+			return -1;
+		}
+	}
+
+	return codegen.get_method_bind_pos(method, class_info->class_ptr);
+}
+
+// Called right before emitting an OPCODE_JUMP_IF_NOT on p_condition_address. If
+// the condition was just computed by a typed comparison, that instruction is
+// switched to one that also takes the jump, saving a dispatch. The jump itself
+// is still emitted, the VM runs it when falling back to the generic operator.
+void GDScriptCompiler::_fuse_operator_jump_if_not(CodeGen &codegen, int p_condition_address) {
+	int pos = codegen.last_operator_pos;
+	if (pos < 0 || pos + 5 != codegen.opcodes.size() || codegen.opcodes[pos + 4] != p_condition_address) {
+		return; // Something else was emitted since.
+	}
+
+	switch (codegen.opcodes[pos + 1]) {
+		case Variant::OP_EQUAL:
+		case Variant::OP_NOT_EQUAL:
+		case Variant::OP_LESS:
+		case Variant::OP_LESS_EQUAL:
+		case Variant::OP_GREATER:
+		case Variant::OP_GREATER_EQUAL: {
+		} break;
+		default: {
+			return; // Result is not a bool.
+		}
+	}
+
+	if (codegen.opcodes[pos] == GDScriptFunction::OPCODE_OPERATOR_INT) {
+		codegen.opcodes.write[pos] = GDScriptFunction::OPCODE_OPERATOR_INT_JUMP_IF_NOT;
+	} else if (codegen.opcodes[pos] == GDScriptFunction::OPCODE_OPERATOR_FLOAT) {
+		codegen.opcodes.write[pos] = GDScriptFunction::OPCODE_OPERATOR_FLOAT_JUMP_IF_NOT;
+	}
+}
+
 int GDScriptCompiler::_parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::AssignmentNode *p_assignment, int p_stack_level, int p_index_addr) {
 	Variant::Operator var_op = Variant::OP_MAX;
 
@@ -725,6 +916,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 				// TODO: Use callables when possible if needed.
 				int ret = -1;
 				int super_address = -1;
+				int method_bind_pos = -1;
 				if (call->is_super) {
 					// Super call.
 					if (call->callee == nullptr) {
@@ -758,6 +950,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							}
 							arguments.push_back(ret);
 							arguments.push_back(codegen.get_name_map_pos(subscript->attribute->name));
+							method_bind_pos = _get_method_bind_pos(codegen, subscript->base, subscript->attribute->name);
 						} else {
 							_set_error("Cannot call something that isn't a function.", call->callee);
 							return -1;
@@ -788,6 +981,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 				} else if (p_root) {
 					opcode = GDScriptFunction::OPCODE_CALL;
 				}
+				if (method_bind_pos != -1 && (opcode == GDScriptFunction::OPCODE_CALL || opcode == GDScriptFunction::OPCODE_CALL_RETURN)) {
+					opcode = p_root ? GDScriptFunction::OPCODE_CALL_METHOD_BIND : GDScriptFunction::OPCODE_CALL_METHOD_BIND_RETURN;
+				}
 
 				codegen.opcodes.push_back(opcode); // perform operator
 				if (call->is_super) {
@@ -797,6 +993,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 				codegen.alloc_call(call->arguments.size());
 				for (int i = 0; i < arguments.size(); i++) {
 					codegen.opcodes.push_back(arguments[i]);
+					if (i == 1 && method_bind_pos != -1) {
+						codegen.opcodes.push_back(method_bind_pos); // After base and method name.
+					}
 				}
 			}
 			OPERATOR_RETURN;
@@ -912,7 +1111,17 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 				}
 			}
 
-			codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+			int axis = subscript->is_attribute ? _get_vector_component_axis(subscript->base, subscript->attribute->name) : -1;
+			int getter_pos = subscript->is_attribute && axis == -1 ? _get_property_method_bind_pos(codegen, subscript->base, subscript->attribute->name, false) : -1;
+			if (axis != -1) {
+				codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_VECTOR_COMPONENT); // perform operator
+				codegen.opcodes.push_back(axis);
+			} else if (getter_pos != -1) {
+				codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED_METHOD_BIND); // perform operator
+				codegen.opcodes.push_back(getter_pos);
+			} else {
+				codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+			}
 			codegen.opcodes.push_back(from); // argument 1
 			codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
 			OPERATOR_RETURN;
@@ -1323,7 +1532,17 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 					return set_value;
 				}
 
-				codegen.opcodes.push_back(subscript->is_attribute ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+				int axis = subscript->is_attribute ? _get_vector_component_axis(subscript->base, subscript->attribute->name) : -1;
+				int setter_pos = subscript->is_attribute && axis == -1 ? _get_property_method_bind_pos(codegen, subscript->base, subscript->attribute->name, true) : -1;
+				if (axis != -1) {
+					codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_VECTOR_COMPONENT);
+					codegen.opcodes.push_back(axis);
+				} else if (setter_pos != -1) {
+					codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_NAMED_METHOD_BIND);
+					codegen.opcodes.push_back(setter_pos);
+				} else {
+					codegen.opcodes.push_back(subscript->is_attribute ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+				}
 				codegen.opcodes.push_back(prev_pos);
 				codegen.opcodes.push_back(set_index);
 				codegen.opcodes.push_back(set_value);
@@ -1885,6 +2104,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Sui
 					return ERR_PARSE_ERROR;
 				}
 
+				_fuse_operator_jump_if_not(codegen, ret2);
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
 				codegen.opcodes.push_back(ret2);
 				int else_addr = codegen.opcodes.size();
@@ -1980,6 +2200,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Sui
 				if (ret2 < 0) {
 					return ERR_PARSE_ERROR;
 				}
+				_fuse_operator_jump_if_not(codegen, ret2);
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP_IF_NOT);
 				codegen.opcodes.push_back(ret2);
 				codegen.opcodes.push_back(break_addr);
@@ -2173,9 +2394,11 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 			}
 
 			if (field->initializer) {
+#ifdef DEBUG_ENABLED
 				// Emit proper line change.
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
 				codegen.opcodes.push_back(field->initializer->start_line);
+#endif
 
 				int src_address = _parse_expression(codegen, field->initializer, stack_level, false, true);
 				if (src_address < 0) {
@@ -2203,9 +2426,11 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 			}
 
 			if (field->initializer) {
+#ifdef DEBUG_ENABLED
 				// Emit proper line change.
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
 				codegen.opcodes.push_back(field->initializer->start_line);
+#endif
 
 				int src_address = _parse_expression(codegen, field->initializer, stack_level, false, true);
 				if (src_address < 0) {
@@ -2318,6 +2543,12 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_global_names_ptr = nullptr;
 		gdfunc->_global_names_count = 0;
 	}
+	//method binds
+	gdfunc->method_binds = codegen.method_binds;
+	gdfunc->method_bind_classes = codegen.method_bind_classes;
+	gdfunc->_method_binds_ptr = gdfunc->method_binds.ptr();
+	gdfunc->_method_bind_classes_ptr = gdfunc->method_bind_classes.ptr();
+	gdfunc->_method_binds_count = gdfunc->method_binds.size();
 
 #ifdef TOOLS_ENABLED
 	// Named globals
@@ -2491,6 +2722,12 @@ Error GDScriptCompiler::_parse_setter_getter(GDScript *p_script, const GDScriptP
 		gdfunc->_global_names_ptr = nullptr;
 		gdfunc->_global_names_count = 0;
 	}
+	//method binds
+	gdfunc->method_binds = codegen.method_binds;
+	gdfunc->method_bind_classes = codegen.method_bind_classes;
+	gdfunc->_method_binds_ptr = gdfunc->method_binds.ptr();
+	gdfunc->_method_bind_classes_ptr = gdfunc->method_bind_classes.ptr();
+	gdfunc->_method_binds_count = gdfunc->method_binds.size();
 
 #ifdef TOOLS_ENABLED
 	// Named globals
@@ -121,7 +121,23 @@ class GDScriptCompiler {
 			return pos | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS);
 		}
 
+		Vector<MethodBind *> method_binds;
+		Vector<void *> method_bind_classes;
+
+		int get_method_bind_pos(MethodBind *p_method, void *p_class_ptr) {
+			for (int i = 0; i < method_binds.size(); i++) {
+				if (method_binds[i] == p_method && method_bind_classes[i] == p_class_ptr) {
+					return i;
+				}
+			}
+			method_binds.push_back(p_method);
+			method_bind_classes.push_back(p_class_ptr);
+			return method_binds.size() - 1;
+		}
+
 		Vector<int> opcodes;
+		int last_operator_pos = -1; // Start of the last binary operator emitted, for fusing it with a jump.
+
 		void alloc_stack(int p_level) {
 			if (p_level >= stack_max) {
 				stack_max = p_level + 1;
@@ -149,6 +165,12 @@ class GDScriptCompiler {
 	bool _generate_typed_assign(CodeGen &codegen, int p_src_address, int p_dst_address, const GDScriptDataType &p_datatype, const GDScriptParser::DataType &p_value_type);
 
 	GDScriptDataType _gdtype_from_datatype(const GDScriptParser::DataType &p_datatype) const;
+	Variant::Type _get_hard_builtin_type(const GDScriptParser::ExpressionNode *p_expression) const;
+	GDScriptFunction::Opcode _get_operator_opcode(Variant::Operator p_op, const GDScriptParser::ExpressionNode *p_left_operand, const GDScriptParser::ExpressionNode *p_right_operand) const;
+	int _get_vector_component_axis(const GDScriptParser::ExpressionNode *p_base, const StringName &p_name) const;
+	int _get_method_bind_pos(CodeGen &codegen, const GDScriptParser::ExpressionNode *p_base, const StringName &p_method);
+	int _get_property_method_bind_pos(CodeGen &codegen, const GDScriptParser::ExpressionNode *p_base, const StringName &p_property, bool p_setter);
+	void _fuse_operator_jump_if_not(CodeGen &codegen, int p_condition_address);
 
 	int _parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::AssignmentNode *p_assignment, int p_stack_level, int p_index_addr = 0);
 	int _parse_expression(CodeGen &codegen, const GDScriptParser::ExpressionNode *p_expression, int p_stack_level, bool p_root = false, bool p_initializer = false, int p_index_addr = 0);
@@ -30,7 +30,9 @@
 
 #include "gdscript_function.h"
 
+#include "core/engine.h"
 #include "core/os/os.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
 
@@ -184,16 +186,286 @@ String GDScriptFunction::_get_call_error(const Callable::CallError &p_err, const
 	return err_text;
 }
 
+// Fast paths for operators emitted by the compiler when the operand types are
+// known. They return false when the operands are not the expected types after
+// all, or the result would be an error (like a division by zero), so the VM
+// can fall back to Variant::evaluate(), which also takes care of reporting.
+// Operands are read before writing, since the destination may alias them.
+
+static _FORCE_INLINE_ bool _evaluate_int_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+	if (unlikely(p_a->get_type() != Variant::INT || p_b->get_type() != Variant::INT)) {
+		return false;
+	}
+
+	const int64_t a = *VariantInternal::get_int(p_a);
+	const int64_t b = *VariantInternal::get_int(p_b);
+
+	switch (p_op) {
+		case Variant::OP_EQUAL: {
+			VariantInternal::set_bool(r_dst, a == b);
+		} break;
+		case Variant::OP_NOT_EQUAL: {
+			VariantInternal::set_bool(r_dst, a != b);
+		} break;
+		case Variant::OP_LESS: {
+			VariantInternal::set_bool(r_dst, a < b);
+		} break;
+		case Variant::OP_LESS_EQUAL: {
+			VariantInternal::set_bool(r_dst, a <= b);
+		} break;
+		case Variant::OP_GREATER: {
+			VariantInternal::set_bool(r_dst, a > b);
+		} break;
+		case Variant::OP_GREATER_EQUAL: {
+			VariantInternal::set_bool(r_dst, a >= b);
+		} break;
+		case Variant::OP_ADD: {
+			VariantInternal::set_int(r_dst, a + b);
+		} break;
+		case Variant::OP_SUBTRACT: {
+			VariantInternal::set_int(r_dst, a - b);
+		} break;
+		case Variant::OP_MULTIPLY: {
+			VariantInternal::set_int(r_dst, a * b);
+		} break;
+		case Variant::OP_DIVIDE: {
+			if (unlikely(b == 0)) {
+				return false;
+			}
+			VariantInternal::set_int(r_dst, a / b);
+		} break;
+		case Variant::OP_MODULE: {
+			if (unlikely(b == 0)) {
+				return false;
+			}
+			VariantInternal::set_int(r_dst, a % b);
+		} break;
+		case Variant::OP_NEGATE: {
+			VariantInternal::set_int(r_dst, -a);
+		} break;
+		case Variant::OP_POSITIVE: {
+			VariantInternal::set_int(r_dst, a);
+		} break;
+		case Variant::OP_SHIFT_LEFT: {
+			if (unlikely(b < 0 || b >= 64)) {
+				return false;
+			}
+			VariantInternal::set_int(r_dst, a << b);
+		} break;
+		case Variant::OP_SHIFT_RIGHT: {
+			if (unlikely(b < 0 || b >= 64)) {
+				return false;
+			}
+			VariantInternal::set_int(r_dst, a >> b);
+		} break;
+		case Variant::OP_BIT_AND: {
+			VariantInternal::set_int(r_dst, a & b);
+		} break;
+		case Variant::OP_BIT_OR: {
+			VariantInternal::set_int(r_dst, a | b);
+		} break;
+		case Variant::OP_BIT_XOR: {
+			VariantInternal::set_int(r_dst, a ^ b);
+		} break;
+		case Variant::OP_BIT_NEGATE: {
+			VariantInternal::set_int(r_dst, ~a);
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// At least one of the operands is a float, the other one may be an int.
+static _FORCE_INLINE_ bool _evaluate_float_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+	double a;
+	if (likely(p_a->get_type() == Variant::FLOAT)) {
+		a = *VariantInternal::get_float(p_a);
+	} else if (p_a->get_type() == Variant::INT && p_b->get_type() == Variant::FLOAT) {
+		a = *VariantInternal::get_int(p_a);
+	} else {
+		return false;
+	}
+
+	double b;
+	if (likely(p_b->get_type() == Variant::FLOAT)) {
+		b = *VariantInternal::get_float(p_b);
+	} else if (p_b->get_type() == Variant::INT) {
+		b = *VariantInternal::get_int(p_b);
+	} else {
+		return false;
+	}
+
+	switch (p_op) {
+		case Variant::OP_EQUAL: {
+			VariantInternal::set_bool(r_dst, a == b);
+		} break;
+		case Variant::OP_NOT_EQUAL: {
+			VariantInternal::set_bool(r_dst, a != b);
+		} break;
+		case Variant::OP_LESS: {
+			VariantInternal::set_bool(r_dst, a < b);
+		} break;
+		case Variant::OP_LESS_EQUAL: {
+			VariantInternal::set_bool(r_dst, a <= b);
+		} break;
+		case Variant::OP_GREATER: {
+			VariantInternal::set_bool(r_dst, a > b);
+		} break;
+		case Variant::OP_GREATER_EQUAL: {
+			VariantInternal::set_bool(r_dst, a >= b);
+		} break;
+		case Variant::OP_ADD: {
+			VariantInternal::set_float(r_dst, a + b);
+		} break;
+		case Variant::OP_SUBTRACT: {
+			VariantInternal::set_float(r_dst, a - b);
+		} break;
+		case Variant::OP_MULTIPLY: {
+			VariantInternal::set_float(r_dst, a * b);
+		} break;
+		case Variant::OP_DIVIDE: {
+			if (unlikely(b == 0)) {
+				return false;
+			}
+			VariantInternal::set_float(r_dst, a / b);
+		} break;
+		case Variant::OP_NEGATE: {
+			VariantInternal::set_float(r_dst, -a);
+		} break;
+		case Variant::OP_POSITIVE: {
+			VariantInternal::set_float(r_dst, a);
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Vector2 and Vector3, with the left operand being the vector.
+template <class T>
+static _FORCE_INLINE_ bool _evaluate_vector_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+	typedef VariantInternalAccessor<T> Accessor;
+
+	if (unlikely(p_a->get_type() != Accessor::type)) {
+		return false;
+	}
+
+	const T a = Accessor::get(p_a);
+	const Variant::Type b_type = p_b->get_type();
+
+	if (b_type == Accessor::type) {
+		const T b = Accessor::get(p_b);
+
+		switch (p_op) {
+			case Variant::OP_EQUAL: {
+				VariantInternal::set_bool(r_dst, a == b);
+			} break;
+			case Variant::OP_NOT_EQUAL: {
+				VariantInternal::set_bool(r_dst, a != b);
+			} break;
+			case Variant::OP_ADD: {
+				Accessor::set(r_dst, a + b);
+			} break;
+			case Variant::OP_SUBTRACT: {
+				Accessor::set(r_dst, a - b);
+			} break;
+			case Variant::OP_MULTIPLY: {
+				Accessor::set(r_dst, a * b);
+			} break;
+			case Variant::OP_DIVIDE: {
+				Accessor::set(r_dst, a / b);
+			} break;
+			case Variant::OP_NEGATE: {
+				Accessor::set(r_dst, -a);
+			} break;
+			case Variant::OP_POSITIVE: {
+				Accessor::set(r_dst, a);
+			} break;
+			default: {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	real_t b;
+	if (b_type == Variant::FLOAT) {
+		b = *VariantInternal::get_float(p_b);
+	} else if (b_type == Variant::INT) {
+		b = *VariantInternal::get_int(p_b);
+	} else {
+		return false;
+	}
+
+	switch (p_op) {
+		case Variant::OP_MULTIPLY: {
+			Accessor::set(r_dst, a * b);
+		} break;
+		case Variant::OP_DIVIDE: {
+			Accessor::set(r_dst, a / b);
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Method binds are resolved from the static type of the base, so they can only
+// be called directly when the base is still an instance of that class and
+// there is no script that could be overriding them. Returns the object if so.
+static _FORCE_INLINE_ Object *_get_method_bind_base(const Variant *p_base, void *p_class_ptr) {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return nullptr;
+	}
+
+#ifdef DEBUG_ENABLED
+	Object *object = p_base->get_validated_object();
+#else
+	Object *object = p_base->operator Object *();
+#endif
+	if (!object || object->get_script_instance() || !object->is_class_ptr(p_class_ptr)) {
+		return nullptr;
+	}
+	return object;
+}
+
+// Same as Object::call() once the method is found, including the lock that
+// keeps the object from being freed while the method runs.
+static _FORCE_INLINE_ Variant _call_method_bind(MethodBind *p_method, Object *p_object, const Variant **p_args, int p_argcount, Callable::CallError &r_error) {
+#ifdef DEBUG_ENABLED
+	_ObjectDebugLock debug_lock(p_object);
+#endif
+	r_error.error = Callable::CallError::CALL_OK;
+	return p_method->call(p_object, p_args, p_argcount, r_error);
+}
+
 #if defined(__GNUC__)
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_OPERATOR_INT,                \
+		&&OPCODE_OPERATOR_FLOAT,              \
+		&&OPCODE_OPERATOR_VECTOR2,            \
+		&&OPCODE_OPERATOR_VECTOR3,            \
+		&&OPCODE_OPERATOR_INT_JUMP_IF_NOT,    \
+		&&OPCODE_OPERATOR_FLOAT_JUMP_IF_NOT,  \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
 		&&OPCODE_GET,                         \
 		&&OPCODE_SET_NAMED,                   \
 		&&OPCODE_GET_NAMED,                   \
+		&&OPCODE_SET_VECTOR_COMPONENT,        \
+		&&OPCODE_GET_VECTOR_COMPONENT,        \
+		&&OPCODE_SET_NAMED_METHOD_BIND,       \
+		&&OPCODE_GET_NAMED_METHOD_BIND,       \
 		&&OPCODE_SET_MEMBER,                  \
 		&&OPCODE_GET_MEMBER,                  \
 		&&OPCODE_ASSIGN,                      \
@@ -211,6 +483,8 @@ String GDScriptFunction::_get_call_error(const Callable::CallError &p_err, const
 		&&OPCODE_CALL,                        \
 		&&OPCODE_CALL_RETURN,                 \
 		&&OPCODE_CALL_ASYNC,                  \
+		&&OPCODE_CALL_METHOD_BIND,            \
+		&&OPCODE_CALL_METHOD_BIND_RETURN,     \
 		&&OPCODE_CALL_BUILT_IN,               \
 		&&OPCODE_CALL_SELF,                   \
 		&&OPCODE_CALL_SELF_BASE,              \
@@ -366,6 +640,29 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	static_ref = script;
 
+	// Operand addresses are an index into a space selected by their type. The
+	// spaces that stay put for the whole call are resolved once here, so decoding
+	// most operands is a table lookup instead of going through _get_variant().
+	// Members, constants looked up by name and globals can be reallocated by
+	// code run from the function (like a script reload) and are not cached.
+	Variant *address_bases[ADDR_TYPE_MAX] = {};
+	address_bases[ADDR_TYPE_SELF] = &self;
+	address_bases[ADDR_TYPE_CLASS] = &static_ref;
+	address_bases[ADDR_TYPE_LOCAL_CONSTANT] = _constants_ptr;
+	address_bases[ADDR_TYPE_STACK] = stack;
+	address_bases[ADDR_TYPE_STACK_VARIABLE] = stack;
+	address_bases[ADDR_TYPE_NIL] = &nil;
+#ifdef DEBUG_ENABLED
+	// Out of range indices go through _get_variant(), which reports the error.
+	int address_limits[ADDR_TYPE_MAX] = {};
+	address_limits[ADDR_TYPE_SELF] = p_instance ? 1 : 0;
+	address_limits[ADDR_TYPE_CLASS] = 1;
+	address_limits[ADDR_TYPE_LOCAL_CONSTANT] = _constant_count;
+	address_limits[ADDR_TYPE_STACK] = _stack_size;
+	address_limits[ADDR_TYPE_STACK_VARIABLE] = _stack_size;
+	address_limits[ADDR_TYPE_NIL] = 1;
+#endif
+
 	String err_text;
 
 #ifdef DEBUG_ENABLED
@@ -385,18 +682,35 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #define CHECK_SPACE(m_space) \
 	GD_ERR_BREAK((ip + m_space) > _code_size)
 
-#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                                   \
-	Variant *m_v;                                                                                          \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, static_ref, stack, err_text); \
-	if (unlikely(!m_v))                                                                                    \
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                            \
+	Variant *m_v;                                                                                   \
+	{                                                                                               \
+		int address = _code_ptr[ip + m_code_ofs];                                                   \
+		uint32_t address_type = uint32_t(address) >> ADDR_BITS;                                     \
+		int address_index = address & ADDR_MASK;                                                    \
+		if (likely(address_type < ADDR_TYPE_MAX && address_index < address_limits[address_type])) { \
+			m_v = &address_bases[address_type][address_index];                                      \
+		} else {                                                                                    \
+			m_v = _get_variant(address, p_instance, script, self, static_ref, stack, err_text);     \
+		}                                                                                           \
+	}                                                                                               \
+	if (unlikely(!m_v))                                                                             \
 		OPCODE_BREAK;
 
 #else
 #define GD_ERR_BREAK(m_cond)
 #define CHECK_SPACE(m_space)
-#define GET_VARIANT_PTR(m_v, m_code_ofs) \
-	Variant *m_v;                        \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, static_ref, stack, err_text);
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                        \
+	Variant *m_v;                                                                               \
+	{                                                                                           \
+		int address = _code_ptr[ip + m_code_ofs];                                               \
+		Variant *address_base = address_bases[uint32_t(address) >> ADDR_BITS];                  \
+		if (likely(address_base)) {                                                             \
+			m_v = &address_base[address & ADDR_MASK];                                           \
+		} else {                                                                                \
+			m_v = _get_variant(address, p_instance, script, self, static_ref, stack, err_text); \
+		}                                                                                       \
+	}
 
 #endif
 
@@ -424,6 +738,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 		OPCODE_SWITCH(_code_ptr[ip]) {
 			OPCODE(OPCODE_OPERATOR) {
+			operator_generic: // Typed operators fall back here.
 				CHECK_SPACE(5);
 
 				bool valid;
@@ -458,6 +773,107 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_INT) {
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_int_operator((Variant::Operator)_code_ptr[ip + 1], a, b, dst))) {
+					goto operator_generic;
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_FLOAT) {
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_float_operator((Variant::Operator)_code_ptr[ip + 1], a, b, dst))) {
+					goto operator_generic;
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VECTOR2) {
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_vector_operator<Vector2>((Variant::Operator)_code_ptr[ip + 1], a, b, dst))) {
+					goto operator_generic;
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VECTOR3) {
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_vector_operator<Vector3>((Variant::Operator)_code_ptr[ip + 1], a, b, dst))) {
+					goto operator_generic;
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			// The operator is followed by an OPCODE_JUMP_IF_NOT on its destination, which
+			// is left in place for the fallback. On the fast path, the jump is taken here.
+
+			OPCODE(OPCODE_OPERATOR_INT_JUMP_IF_NOT) {
+				CHECK_SPACE(8);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_int_operator((Variant::Operator)_code_ptr[ip + 1], a, b, dst))) {
+					goto operator_generic;
+				}
+
+				if (*VariantInternal::get_bool(dst)) {
+					ip += 8;
+				} else {
+					int to = _code_ptr[ip + 7];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_FLOAT_JUMP_IF_NOT) {
+				CHECK_SPACE(8);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_float_operator((Variant::Operator)_code_ptr[ip + 1], a, b, dst))) {
+					goto operator_generic;
+				}
+
+				if (*VariantInternal::get_bool(dst)) {
+					ip += 8;
+				} else {
+					int to = _code_ptr[ip + 7];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 				CHECK_SPACE(4);
 
@@ -606,6 +1022,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_SET_NAMED) {
+			set_named_generic: // OPCODE_SET_VECTOR_COMPONENT and OPCODE_SET_NAMED_METHOD_BIND fall back here.
 				CHECK_SPACE(3);
 
 				GET_VARIANT_PTR(dst, 1);
@@ -631,6 +1048,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
+			get_named_generic: // OPCODE_GET_VECTOR_COMPONENT and OPCODE_GET_NAMED_METHOD_BIND fall back here.
 				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(src, 1);
@@ -664,6 +1082,119 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			// The axis goes right after the opcode, followed by the same operands as
+			// OPCODE_SET_NAMED/OPCODE_GET_NAMED. To fall back, skip the axis and run the
+			// generic opcode in place, which ends up advancing past the whole instruction.
+
+			OPCODE(OPCODE_SET_VECTOR_COMPONENT) {
+				CHECK_SPACE(5);
+
+				int axis = _code_ptr[ip + 1];
+				GD_ERR_BREAK(axis < 0 || axis > 2);
+				GET_VARIANT_PTR(dst, 2);
+				GET_VARIANT_PTR(value, 4);
+
+				real_t component;
+				if (likely(value->get_type() == Variant::FLOAT)) {
+					component = *VariantInternal::get_float(value);
+				} else if (value->get_type() == Variant::INT) {
+					component = *VariantInternal::get_int(value);
+				} else {
+					ip += 1;
+					goto set_named_generic;
+				}
+
+				if (dst->get_type() == Variant::VECTOR2 && axis < 2) {
+					(*VariantInternal::get_vector2(dst))[axis] = component;
+				} else if (dst->get_type() == Variant::VECTOR3) {
+					(*VariantInternal::get_vector3(dst))[axis] = component;
+				} else {
+					ip += 1;
+					goto set_named_generic;
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_VECTOR_COMPONENT) {
+				CHECK_SPACE(5);
+
+				int axis = _code_ptr[ip + 1];
+				GD_ERR_BREAK(axis < 0 || axis > 2);
+				GET_VARIANT_PTR(src, 2);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (src->get_type() == Variant::VECTOR2 && axis < 2) {
+					VariantInternal::set_float(dst, (*VariantInternal::get_vector2(src))[axis]);
+				} else if (src->get_type() == Variant::VECTOR3) {
+					VariantInternal::set_float(dst, (*VariantInternal::get_vector3(src))[axis]);
+				} else {
+					ip += 1;
+					goto get_named_generic;
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			// Same layout as the vector component opcodes, with the index of the
+			// property setter or getter in place of the axis.
+
+			OPCODE(OPCODE_SET_NAMED_METHOD_BIND) {
+				CHECK_SPACE(5);
+
+				int method_idx = _code_ptr[ip + 1];
+				GD_ERR_BREAK(method_idx < 0 || method_idx >= _method_binds_count);
+				GET_VARIANT_PTR(dst, 2);
+				GET_VARIANT_PTR(value, 4);
+
+				Object *object = _get_method_bind_base(dst, _method_bind_classes_ptr[method_idx]);
+#ifdef TOOLS_ENABLED
+				if (Engine::get_singleton()->is_editor_hint()) {
+					object = nullptr; // Object::set() also marks the object as edited.
+				}
+#endif
+				if (!object) {
+					ip += 1;
+					goto set_named_generic;
+				}
+
+				Callable::CallError err;
+				const Variant *args[1] = { value };
+				_call_method_bind(_method_binds_ptr[method_idx], object, args, 1, err);
+
+#ifdef DEBUG_ENABLED
+				if (err.error != Callable::CallError::CALL_OK) {
+					int indexname = _code_ptr[ip + 3];
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					err_text = "Invalid set index '" + String(_global_names_ptr[indexname]) + "' (on base: '" + _get_var_type(dst) + "') with value of type '" + _get_var_type(value) + "'.";
+					OPCODE_BREAK;
+				}
+#endif
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_NAMED_METHOD_BIND) {
+				CHECK_SPACE(5);
+
+				int method_idx = _code_ptr[ip + 1];
+				GD_ERR_BREAK(method_idx < 0 || method_idx >= _method_binds_count);
+				GET_VARIANT_PTR(src, 2);
+				GET_VARIANT_PTR(dst, 4);
+
+				Object *object = _get_method_bind_base(src, _method_bind_classes_ptr[method_idx]);
+				if (!object) {
+					ip += 1;
+					goto get_named_generic;
+				}
+
+				// Like ClassDB::get_property(), errors in the getter don't make the get invalid.
+				Callable::CallError err;
+				*dst = _call_method_bind(_method_binds_ptr[method_idx], object, nullptr, 0, err);
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_SET_MEMBER) {
 				CHECK_SPACE(3);
 				int indexname = _code_ptr[ip + 1];
@@ -1007,13 +1538,16 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_CALL_METHOD_BIND)
+			OPCODE(OPCODE_CALL_METHOD_BIND_RETURN)
 			OPCODE(OPCODE_CALL_ASYNC)
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
 				CHECK_SPACE(4);
-				bool call_ret = _code_ptr[ip] != OPCODE_CALL;
+				int call_opcode = _code_ptr[ip];
+				bool call_ret = call_opcode != OPCODE_CALL && call_opcode != OPCODE_CALL_METHOD_BIND;
 #ifdef DEBUG_ENABLED
-				bool call_async = _code_ptr[ip] == OPCODE_CALL_ASYNC;
+				bool call_async = call_opcode == OPCODE_CALL_ASYNC;
 #endif
 
 				int argc = _code_ptr[ip + 1];
@@ -1025,6 +1559,20 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				GD_ERR_BREAK(argc < 0);
 				ip += 4;
+
+				MethodBind *method_bind = nullptr;
+				Object *method_bind_base = nullptr;
+				if (call_opcode == OPCODE_CALL_METHOD_BIND || call_opcode == OPCODE_CALL_METHOD_BIND_RETURN) {
+					CHECK_SPACE(1);
+					int method_idx = _code_ptr[ip];
+					GD_ERR_BREAK(method_idx < 0 || method_idx >= _method_binds_count);
+					ip += 1;
+
+					method_bind_base = _get_method_bind_base(base, _method_bind_classes_ptr[method_idx]);
+					if (method_bind_base) {
+						method_bind = _method_binds_ptr[method_idx];
+					}
+				}
 				CHECK_SPACE(argc + 1);
 				Variant **argptrs = call_args;
 
@@ -1044,7 +1592,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Callable::CallError err;
 				if (call_ret) {
 					GET_VARIANT_PTR(ret, argc);
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
+					if (method_bind) {
+						*ret = _call_method_bind(method_bind, method_bind_base, (const Variant **)argptrs, argc, err);
+					} else {
+						base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
+					}
 #ifdef DEBUG_ENABLED
 					if (!call_async && ret->get_type() == Variant::OBJECT) {
 						// Check if getting a function state without await.
@@ -1061,6 +1613,8 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 						}
 					}
 #endif
+				} else if (method_bind) {
+					_call_method_bind(method_bind, method_bind_base, (const Variant **)argptrs, argc, err);
 				} else {
 					base->call_ptr(*methodname, (const Variant **)argptrs, argc, nullptr, err);
 				}
@@ -1703,6 +2257,9 @@ GDScriptFunction::GDScriptFunction() :
 		function_list(this) {
 	_stack_size = 0;
 	_call_size = 0;
+	_method_binds_ptr = nullptr;
+	_method_bind_classes_ptr = nullptr;
+	_method_binds_count = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
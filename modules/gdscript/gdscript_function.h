@@ -158,12 +158,22 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_INT, // Same layout as OPCODE_OPERATOR, for operands known to be of these types.
+		OPCODE_OPERATOR_FLOAT,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
+		OPCODE_OPERATOR_INT_JUMP_IF_NOT, // Typed comparison fused with the OPCODE_JUMP_IF_NOT on its result that follows it.
+		OPCODE_OPERATOR_FLOAT_JUMP_IF_NOT,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
 		OPCODE_GET,
 		OPCODE_SET_NAMED,
 		OPCODE_GET_NAMED,
+		OPCODE_SET_VECTOR_COMPONENT, // x, y or z of a Vector2 or Vector3, falls back to OPCODE_SET_NAMED.
+		OPCODE_GET_VECTOR_COMPONENT,
+		OPCODE_SET_NAMED_METHOD_BIND, // Property setter of a native class resolved at compile time, falls back to OPCODE_SET_NAMED.
+		OPCODE_GET_NAMED_METHOD_BIND,
 		OPCODE_SET_MEMBER,
 		OPCODE_GET_MEMBER,
 		OPCODE_ASSIGN,
@@ -181,6 +191,8 @@ public:
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
 		OPCODE_CALL_ASYNC,
+		OPCODE_CALL_METHOD_BIND, // Native method resolved at compile time, falls back to OPCODE_CALL.
+		OPCODE_CALL_METHOD_BIND_RETURN,
 		OPCODE_CALL_BUILT_IN,
 		OPCODE_CALL_SELF,
 		OPCODE_CALL_SELF_BASE,
@@ -212,7 +224,8 @@ public:
 		ADDR_TYPE_STACK_VARIABLE = 6,
 		ADDR_TYPE_GLOBAL = 7,
 		ADDR_TYPE_NAMED_GLOBAL = 8,
-		ADDR_TYPE_NIL = 9
+		ADDR_TYPE_NIL = 9,
+		ADDR_TYPE_MAX
 	};
 
 	struct StackDebug {
@@ -232,6 +245,9 @@ private:
 	int _constant_count;
 	const StringName *_global_names_ptr;
 	int _global_names_count;
+	MethodBind *const *_method_binds_ptr;
+	void *const *_method_bind_classes_ptr;
+	int _method_binds_count;
 #ifdef TOOLS_ENABLED
 	const StringName *_named_globals_ptr;
 	int _named_globals_count;
@@ -252,6 +268,8 @@ private:
 	StringName name;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
+	Vector<MethodBind *> method_binds;
+	Vector<void *> method_bind_classes; // Class pointer each method bind was resolved for.
 #ifdef TOOLS_ENABLED
 	Vector<StringName> named_globals;
 #endif
@@ -1264,6 +1264,7 @@ public:
 	bool is_tool() const { return _is_tool; }
 	static Variant::Type get_builtin_type(const StringName &p_type);
 	static GDScriptFunctions::Function get_builtin_function(const StringName &p_name);
+	static void cleanup();
 
 	CompletionContext get_completion_context() const { return completion_context; }
 	CompletionCall get_completion_call() const { return completion_call; }
@@ -237,6 +237,13 @@ void WSLPeer::poll() {
 	}
 }
 
+bool WSLPeer::wants_poll() const {
+	if (!_data) {
+		return false;
+	}
+	return _data->destroy || wslay_event_want_write(_data->ctx);
+}
+
 Error WSLPeer::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 	ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
 
@@ -93,6 +93,7 @@ public:
 	int close_code;
 	String close_reason;
 	void poll(); // Used by client and server.
+	bool wants_poll() const; // True when there is queued output, which socket readiness alone would not trigger.
 
 	virtual int get_available_packet_count() const;
 	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size);
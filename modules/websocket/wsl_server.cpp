@@ -176,20 +176,59 @@ Error WSLServer::listen(int p_port, const Vector<String> p_protocols, bool gd_mp
 	for (int i = 0; i < p_protocols.size(); i++) {
 		pw[i] = p_protocols[i].strip_edges();
 	}
-	return _server->listen(p_port, bind_ip);
+	Error err = _server->listen(p_port, bind_ip);
+	if (err != OK) {
+		return err;
+	}
+
+	_poll_group = NetSocket::create_poll_group();
+	if (_poll_group && _server->add_to_poll_group(_poll_group, POLL_ID_LISTENER) != OK) {
+		memdelete(_poll_group);
+		_poll_group = nullptr;
+	}
+	return OK;
 }
 
 void WSLServer::poll() {
+	bool accept = true;
+	_ready_ids.clear();
+	if (_poll_group) {
+		accept = false;
+		_poll_group->wait(_poll_events, 0);
+		for (uint32_t i = 0; i < _poll_events.size(); i++) {
+			if (_poll_events[i].id == POLL_ID_LISTENER) {
+				accept = true;
+			} else {
+				_ready_ids.push_back((int)_poll_events[i].id);
+			}
+		}
+		_ready_ids.sort();
+	}
+
+	// Both the peer map and the ready ids are sorted, walk them together.
 	List<int> remove_ids;
+	uint32_t ready_idx = 0;
 	for (Map<int, Ref<WebSocketPeer>>::Element *E = _peer_map.front(); E; E = E->next()) {
 		Ref<WSLPeer> peer = (WSLPeer *)E->get().ptr();
-		peer->poll();
+		bool ready = !_poll_group || !_poll_group->has(E->key());
+		while (ready_idx < _ready_ids.size() && _ready_ids[ready_idx] < E->key()) {
+			ready_idx++;
+		}
+		if (ready_idx < _ready_ids.size() && _ready_ids[ready_idx] == E->key()) {
+			ready = true;
+		}
+		if (ready || peer->wants_poll()) {
+			peer->poll();
+		}
 		if (!peer->is_connected_to_host()) {
 			_on_disconnect(E->key(), peer->close_code != -1);
 			remove_ids.push_back(E->key());
 		}
 	}
 	for (List<int>::Element *E = remove_ids.front(); E; E = E->next()) {
+		if (_poll_group && _poll_group->has(E->get())) {
+			_poll_group->remove(E->get());
+		}
 		_peer_map.erase(E->get());
 	}
 	remove_ids.clear();
@@ -219,6 +258,10 @@ void WSLServer::poll() {
 		ws_peer->set_no_delay(true);
 
 		_peer_map[id] = ws_peer;
+		if (_poll_group) {
+			// On failure the peer is simply polled every frame.
+			ppeer->tcp->add_to_poll_group(_poll_group, NetSocket::POLL_TYPE_IN, id);
+		}
 		remove_peers.push_back(ppeer);
 		_on_connect(id, ppeer->protocol);
 	}
@@ -227,7 +270,7 @@ void WSLServer::poll() {
 	}
 	remove_peers.clear();
 
-	if (!_server->is_listening()) {
+	if (!accept || !_server->is_listening()) {
 		return;
 	}
 
@@ -262,6 +305,10 @@ int WSLServer::get_max_packet_size() const {
 }
 
 void WSLServer::stop() {
+	if (_poll_group) {
+		memdelete(_poll_group);
+		_poll_group = nullptr;
+	}
 	_server->stop();
 	for (Map<int, Ref<WebSocketPeer>>::Element *E = _peer_map.front(); E; E = E->next()) {
 		Ref<WSLPeer> peer = (WSLPeer *)E->get().ptr();
@@ -78,6 +78,15 @@ private:
 	Ref<TCP_Server> _server;
 	Vector<String> _protocols;
 
+	// Connected peers and the listening socket are waited on together, only
+	// peers with readable sockets or queued output are polled.
+	enum {
+		POLL_ID_LISTENER = 0, // Never a valid peer id.
+	};
+	NetSocket::PollGroup *_poll_group = nullptr;
+	LocalVector<NetSocket::PollGroup::Event> _poll_events;
+	LocalVector<int> _ready_ids;
+
 public:
 	Error set_buffers(int p_in_buffer, int p_in_packets, int p_out_buffer, int p_out_packets);
 	Error listen(int p_port, const Vector<String> p_protocols = Vector<String>(), bool gd_mp_api = false);
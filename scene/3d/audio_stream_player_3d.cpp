@@ -96,7 +96,7 @@ static const Vector3 speaker_directions[7] = {
 	Vector3(1.0, 0.0, 0.0).normalized(), // side-right
 };
 
-void AudioStreamPlayer3D::_calc_output_vol(const Vector3 &source_dir, real_t tightness, AudioStreamPlayer3D::Output &output) {
+void AudioStreamPlayer3D::_calc_output_vol(const Vector3 &source_dir, real_t tightness, AudioServer::VoiceOutput &output) {
 	unsigned int speaker_count = 0; // only main speakers (no LFE)
 	switch (AudioServer::get_singleton()->get_speaker_mode()) {
 		case AudioServer::SPEAKER_MODE_STEREO:
@@ -137,166 +137,6 @@ void AudioStreamPlayer3D::_calc_output_vol(const Vector3 &source_dir, real_t tig
 	}
 }
 
-void AudioStreamPlayer3D::_mix_audio() {
-	if (!stream_playback.is_valid() || !active ||
-			(stream_paused && !stream_paused_fade_out)) {
-		return;
-	}
-
-	bool started = false;
-	if (setseek >= 0.0) {
-		stream_playback->start(setseek);
-		setseek = -1.0; //reset seek
-		started = true;
-	}
-
-	//get data
-	AudioFrame *buffer = mix_buffer.ptrw();
-	int buffer_size = mix_buffer.size();
-
-	if (stream_paused_fade_out) {
-		// Short fadeout ramp
-		buffer_size = MIN(buffer_size, 128);
-	}
-
-	// Mix if we're not paused or we're fading out
-	if ((output_count > 0 || out_of_range_mode == OUT_OF_RANGE_MIX)) {
-		float output_pitch_scale = 0.0;
-		if (output_count) {
-			//used for doppler, not realistic but good enough
-			for (int i = 0; i < output_count; i++) {
-				output_pitch_scale += outputs[i].pitch_scale;
-			}
-			output_pitch_scale /= float(output_count);
-		} else {
-			output_pitch_scale = 1.0;
-		}
-
-		stream_playback->mix(buffer, pitch_scale * output_pitch_scale, buffer_size);
-	}
-
-	//write all outputs
-	for (int i = 0; i < output_count; i++) {
-		Output current = outputs[i];
-
-		//see if current output exists, to keep volume ramp
-		bool found = false;
-		for (int j = i; j < prev_output_count; j++) {
-			if (prev_outputs[j].viewport == current.viewport) {
-				if (j != i) {
-					SWAP(prev_outputs[j], prev_outputs[i]);
-				}
-				found = true;
-				break;
-			}
-		}
-
-		bool interpolate_filter = !started;
-
-		if (!found) {
-			//create new if was not used before
-			if (prev_output_count < MAX_OUTPUTS) {
-				prev_outputs[prev_output_count] = prev_outputs[i]; //may be owned by another viewport
-				prev_output_count++;
-			}
-			prev_outputs[i] = current;
-			interpolate_filter = false;
-		}
-
-		//mix!
-
-		int buffers = AudioServer::get_singleton()->get_channel_count();
-
-		for (int k = 0; k < buffers; k++) {
-			AudioFrame target_volume = stream_paused_fade_out ? AudioFrame(0.f, 0.f) : current.vol[k];
-			AudioFrame vol_prev = stream_paused_fade_in ? AudioFrame(0.f, 0.f) : prev_outputs[i].vol[k];
-			AudioFrame vol_inc = (target_volume - vol_prev) / float(buffer_size);
-			AudioFrame vol = vol_prev;
-
-			if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.bus_index, k)) {
-				continue; //may have been deleted, will be updated on process
-			}
-
-			AudioFrame *target = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, k);
-			current.filter.set_mode(AudioFilterSW::HIGHSHELF);
-			current.filter.set_sampling_rate(AudioServer::get_singleton()->get_mix_rate());
-			current.filter.set_cutoff(attenuation_filter_cutoff_hz);
-			current.filter.set_resonance(1);
-			current.filter.set_stages(1);
-			current.filter.set_gain(current.filter_gain);
-
-			if (interpolate_filter) {
-				current.filter_process[k * 2 + 0] = prev_outputs[i].filter_process[k * 2 + 0];
-				current.filter_process[k * 2 + 1] = prev_outputs[i].filter_process[k * 2 + 1];
-
-				current.filter_process[k * 2 + 0].set_filter(&current.filter, false);
-				current.filter_process[k * 2 + 1].set_filter(&current.filter, false);
-
-				current.filter_process[k * 2 + 0].update_coeffs(buffer_size);
-				current.filter_process[k * 2 + 1].update_coeffs(buffer_size);
-				for (int j = 0; j < buffer_size; j++) {
-					AudioFrame f = buffer[j] * vol;
-					current.filter_process[k * 2 + 0].process_one_interp(f.l);
-					current.filter_process[k * 2 + 1].process_one_interp(f.r);
-
-					target[j] += f;
-					vol += vol_inc;
-				}
-			} else {
-				current.filter_process[k * 2 + 0].set_filter(&current.filter);
-				current.filter_process[k * 2 + 1].set_filter(&current.filter);
-
-				current.filter_process[k * 2 + 0].update_coeffs();
-				current.filter_process[k * 2 + 1].update_coeffs();
-				for (int j = 0; j < buffer_size; j++) {
-					AudioFrame f = buffer[j] * vol;
-					current.filter_process[k * 2 + 0].process_one(f.l);
-					current.filter_process[k * 2 + 1].process_one(f.r);
-
-					target[j] += f;
-					vol += vol_inc;
-				}
-			}
-
-			if (current.reverb_bus_index >= 0) {
-				if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.reverb_bus_index, k)) {
-					continue; //may have been deleted, will be updated on process
-				}
-
-				AudioFrame *rtarget = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.reverb_bus_index, k);
-
-				if (current.reverb_bus_index == prev_outputs[i].reverb_bus_index) {
-					AudioFrame rvol_inc = (current.reverb_vol[k] - prev_outputs[i].reverb_vol[k]) / float(buffer_size);
-					AudioFrame rvol = prev_outputs[i].reverb_vol[k];
-
-					for (int j = 0; j < buffer_size; j++) {
-						rtarget[j] += buffer[j] * rvol;
-						rvol += rvol_inc;
-					}
-				} else {
-					AudioFrame rvol = current.reverb_vol[k];
-					for (int j = 0; j < buffer_size; j++) {
-						rtarget[j] += buffer[j] * rvol;
-					}
-				}
-			}
-		}
-
-		prev_outputs[i] = current;
-	}
-
-	prev_output_count = output_count;
-
-	//stream is no longer active, disable this.
-	if (!stream_playback->is_playing()) {
-		active = false;
-	}
-
-	output_ready = false;
-	stream_paused_fade_in = false;
-	stream_paused_fade_out = false;
-}
-
 float AudioStreamPlayer3D::_get_attenuation_db(float p_distance) const {
 	float att = 0;
 	switch (attenuation_model) {
@@ -333,14 +173,18 @@ void _update_sound() {
 void AudioStreamPlayer3D::_notification(int p_what) {
 	if (p_what == NOTIFICATION_ENTER_TREE) {
 		velocity_tracker->reset(get_global_transform().origin);
-		AudioServer::get_singleton()->add_callback(_mix_audios, this);
 		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
 			play();
 		}
 	}
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
-		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+		if (AudioServer::get_singleton()->voice_is_playing(voice)) {
+			//resume from the same position when entering the tree again
+			setplay = stream_playback->get_playback_position();
+		}
+		AudioServer::get_singleton()->voice_stop(voice);
+		voice = AudioServer::INVALID_VOICE_ID;
 	}
 
 	if (p_what == NOTIFICATION_PAUSED) {
@@ -361,9 +205,25 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 	}
 
 	if (p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS) {
-		//update anything related to position first, if possible of course
+		//start playing if requested
+		if (setplay >= 0.0) {
+			if (AudioServer::get_singleton()->voice_is_playing(voice)) {
+				AudioServer::get_singleton()->voice_seek(voice, setplay);
+			} else {
+				AudioServer::get_singleton()->voice_stop(voice);
+				voice = AudioServer::get_singleton()->voice_play(stream_playback, setplay, priority);
+				if (stream_paused) {
+					AudioServer::get_singleton()->voice_set_paused(voice, true);
+				}
+			}
+			setplay = -1;
+			//do not update, this makes it easier to animate (will shut off otherwise)
+			///_change_notify("playing"); //update property in editor
+		}
 
-		if (!output_ready) {
+		//update anything related to position, unless the mixer did not take the previous update yet
+		if (AudioServer::get_singleton()->voice_needs_update(voice)) {
+			AudioServer::VoiceParams params;
 			Vector3 linear_velocity;
 
 			//compute linear velocity for doppler
@@ -454,10 +314,10 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 					multiplier *= MAX(0, 1.0 - (dist / max_distance));
 				}
 
-				Output output;
+				AudioServer::VoiceOutput output;
 				output.bus_index = bus_index;
 				output.reverb_bus_index = -1; //no reverb by default
-				output.viewport = vp;
+				output.listener = vp->get_instance_id();
 
 				float db_att = (1.0 - MIN(1.0, multiplier)) * attenuation_filter_db;
 
@@ -592,28 +452,25 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 					}
 				}
 
-				outputs[new_output_count] = output;
+				params.outputs[new_output_count] = output;
 				new_output_count++;
 				if (new_output_count == MAX_OUTPUTS) {
 					break;
 				}
 			}
 
-			output_count = new_output_count;
-			output_ready = true;
+			params.pitch_scale = pitch_scale;
+			params.filter_cutoff_hz = attenuation_filter_cutoff_hz;
+			params.mix_without_outputs = out_of_range_mode == OUT_OF_RANGE_MIX;
+			params.output_count = new_output_count;
+			AudioServer::get_singleton()->voice_update(voice, params);
 		}
 
-		//start playing if requested
-		if (setplay >= 0.0) {
-			setseek = setplay;
-			active = true;
-			setplay = -1;
-			//do not update, this makes it easier to animate (will shut off otherwise)
-			///_change_notify("playing"); //update property in editor
-		}
-
-		//stop playing if no longer active
-		if (!active) {
+		//stop playing once the stream ended, or the voice was stolen
+		if (!AudioServer::get_singleton()->voice_is_playing(voice)) {
+			AudioServer::get_singleton()->voice_stop(voice);
+			voice = AudioServer::INVALID_VOICE_ID;
+			active = false;
 			set_physics_process_internal(false);
 			//do not update, this makes it easier to animate (will shut off otherwise)
 			//_change_notify("playing"); //update property in editor
@@ -623,15 +480,15 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 }
 
 void AudioStreamPlayer3D::set_stream(Ref<AudioStream> p_stream) {
-	AudioServer::get_singleton()->lock();
-
-	mix_buffer.resize(AudioServer::get_singleton()->thread_get_mix_buffer_size());
+	//the voice keeps its own reference to the playback, so stop it first
+	AudioServer::get_singleton()->voice_stop(voice);
+	voice = AudioServer::INVALID_VOICE_ID;
 
 	if (stream_playback.is_valid()) {
 		stream_playback.unref();
 		stream.unref();
 		active = false;
-		setseek = -1;
+		setplay = -1;
 	}
 
 	if (p_stream.is_valid()) {
@@ -639,8 +496,6 @@ void AudioStreamPlayer3D::set_stream(Ref<AudioStream> p_stream) {
 		stream_playback = p_stream->instance_playback();
 	}
 
-	AudioServer::get_singleton()->unlock();
-
 	if (p_stream.is_valid() && stream_playback.is_null()) {
 		stream.unref();
 	}
@@ -684,27 +539,27 @@ float AudioStreamPlayer3D::get_pitch_scale() const {
 }
 
 void AudioStreamPlayer3D::play(float p_from_pos) {
-	if (!is_playing()) {
-		// Reset the prev_output_count if the stream is stopped
-		prev_output_count = 0;
-	}
-
 	if (stream_playback.is_valid()) {
 		active = true;
 		setplay = p_from_pos;
-		output_ready = false;
 		set_physics_process_internal(true);
 	}
 }
 
 void AudioStreamPlayer3D::seek(float p_seconds) {
 	if (stream_playback.is_valid()) {
-		setseek = p_seconds;
+		if (setplay >= 0.0) {
+			setplay = p_seconds; //voice not started yet
+		} else {
+			AudioServer::get_singleton()->voice_seek(voice, p_seconds);
+		}
 	}
 }
 
 void AudioStreamPlayer3D::stop() {
 	if (stream_playback.is_valid()) {
+		AudioServer::get_singleton()->voice_stop(voice);
+		voice = AudioServer::INVALID_VOICE_ID;
 		active = false;
 		set_physics_process_internal(false);
 		setplay = -1;
@@ -728,10 +583,7 @@ float AudioStreamPlayer3D::get_playback_position() {
 }
 
 void AudioStreamPlayer3D::set_bus(const StringName &p_bus) {
-	//if audio is active, must lock this
-	AudioServer::get_singleton()->lock();
 	bus = p_bus;
-	AudioServer::get_singleton()->unlock();
 }
 
 StringName AudioStreamPlayer3D::get_bus() const {
@@ -743,6 +595,14 @@ StringName AudioStreamPlayer3D::get_bus() const {
 	return "Master";
 }
 
+void AudioStreamPlayer3D::set_priority(int p_priority) {
+	priority = p_priority;
+}
+
+int AudioStreamPlayer3D::get_priority() const {
+	return priority;
+}
+
 void AudioStreamPlayer3D::set_autoplay(bool p_enable) {
 	autoplay = p_enable;
 }
@@ -886,8 +746,7 @@ AudioStreamPlayer3D::DopplerTracking AudioStreamPlayer3D::get_doppler_tracking()
 void AudioStreamPlayer3D::set_stream_paused(bool p_pause) {
 	if (p_pause != stream_paused) {
 		stream_paused = p_pause;
-		stream_paused_fade_in = !stream_paused;
-		stream_paused_fade_out = stream_paused;
+		AudioServer::get_singleton()->voice_set_paused(voice, stream_paused);
 	}
 }
 
@@ -925,6 +784,9 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_bus", "bus"), &AudioStreamPlayer3D::set_bus);
 	ClassDB::bind_method(D_METHOD("get_bus"), &AudioStreamPlayer3D::get_bus);
 
+	ClassDB::bind_method(D_METHOD("set_priority", "priority"), &AudioStreamPlayer3D::set_priority);
+	ClassDB::bind_method(D_METHOD("get_priority"), &AudioStreamPlayer3D::get_priority);
+
 	ClassDB::bind_method(D_METHOD("set_autoplay", "enable"), &AudioStreamPlayer3D::set_autoplay);
 	ClassDB::bind_method(D_METHOD("is_autoplay_enabled"), &AudioStreamPlayer3D::is_autoplay_enabled);
 
@@ -978,6 +840,7 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_distance", PROPERTY_HINT_EXP_RANGE, "0,4096,1,or_greater"), "set_max_distance", "get_max_distance");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "out_of_range_mode", PROPERTY_HINT_ENUM, "Mix,Pause"), "set_out_of_range_mode", "get_out_of_range_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING_NAME, "bus", PROPERTY_HINT_ENUM, ""), "set_bus", "get_bus");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "priority", PROPERTY_HINT_RANGE, "-128,128,1"), "set_priority", "get_priority");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "area_mask", PROPERTY_HINT_LAYERS_2D_PHYSICS), "set_area_mask", "get_area_mask");
 	ADD_GROUP("Emission Angle", "emission_angle");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "emission_angle_enabled"), "set_emission_angle_enabled", "is_emission_angle_enabled");
@@ -1011,13 +874,11 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 	max_db = 3;
 	pitch_scale = 1.0;
 	autoplay = false;
-	setseek = -1;
+	voice = AudioServer::INVALID_VOICE_ID;
+	priority = 0;
 	active = false;
-	output_count = 0;
-	prev_output_count = 0;
 	max_distance = 0;
 	setplay = -1;
-	output_ready = false;
 	area_mask = 1;
 	emission_angle = 45;
 	emission_angle_enabled = false;
@@ -1027,8 +888,6 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 	out_of_range_mode = OUT_OF_RANGE_MIX;
 	doppler_tracking = DOPPLER_TRACKING_DISABLED;
 	stream_paused = false;
-	stream_paused_fade_in = false;
-	stream_paused_fade_out = false;
 
 	velocity_tracker.instance();
 	AudioServer::get_singleton()->connect("bus_layout_changed", callable_mp(this, &AudioStreamPlayer3D::_bus_layout_changed));
@@ -1036,4 +895,7 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 }
 
 AudioStreamPlayer3D::~AudioStreamPlayer3D() {
+	if (voice != AudioServer::INVALID_VOICE_ID) {
+		AudioServer::get_singleton()->voice_stop(voice);
+	}
 }
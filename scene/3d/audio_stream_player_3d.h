@@ -33,7 +33,6 @@
 
 #include "scene/3d/node_3d.h"
 #include "scene/3d/velocity_tracker_3d.h"
-#include "servers/audio/audio_filter_sw.h"
 #include "servers/audio/audio_stream.h"
 #include "servers/audio_server.h"
 
@@ -62,45 +61,20 @@ public:
 
 private:
 	enum {
-		MAX_OUTPUTS = 8,
+		MAX_OUTPUTS = AudioServer::VOICE_MAX_OUTPUTS,
 		MAX_INTERSECT_AREAS = 32
 
 	};
 
-	struct Output {
-		AudioFilterSW filter;
-		AudioFilterSW::Processor filter_process[8];
-		AudioFrame vol[4];
-		float filter_gain;
-		float pitch_scale;
-		int bus_index;
-		int reverb_bus_index;
-		AudioFrame reverb_vol[4];
-		Viewport *viewport; //pointer only used for reference to previous mix
-
-		Output() {
-			filter_gain = 0;
-			viewport = nullptr;
-			reverb_bus_index = -1;
-			bus_index = -1;
-		}
-	};
-
-	Output outputs[MAX_OUTPUTS];
-	volatile int output_count;
-	volatile bool output_ready;
-
-	//these are used by audio thread to have a reference of previous volumes (for ramping volume and avoiding clicks)
-	Output prev_outputs[MAX_OUTPUTS];
-	int prev_output_count;
+	//mixed by the audio server, this only computes the outputs
+	AudioServer::VoiceID voice;
+	int priority;
 
 	Ref<AudioStreamPlayback> stream_playback;
 	Ref<AudioStream> stream;
-	Vector<AudioFrame> mix_buffer;
 
-	volatile float setseek;
-	volatile bool active;
-	volatile float setplay;
+	float setplay;
+	bool active;
 
 	AttenuationModel attenuation_model;
 	float unit_db;
@@ -109,13 +83,9 @@ private:
 	float pitch_scale;
 	bool autoplay;
 	bool stream_paused;
-	bool stream_paused_fade_in;
-	bool stream_paused_fade_out;
 	StringName bus;
 
-	static void _calc_output_vol(const Vector3 &source_dir, real_t tightness, Output &output);
-	void _mix_audio();
-	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer3D *>(self)->_mix_audio(); }
+	static void _calc_output_vol(const Vector3 &source_dir, real_t tightness, AudioServer::VoiceOutput &output);
 
 	void _set_playing(bool p_enable);
 	bool _is_active() const;
@@ -170,6 +140,9 @@ public:
 	void set_bus(const StringName &p_bus);
 	StringName get_bus() const;
 
+	void set_priority(int p_priority);
+	int get_priority() const;
+
 	void set_autoplay(bool p_enable);
 	bool is_autoplay_enabled();
 
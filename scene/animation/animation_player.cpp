@@ -171,6 +171,20 @@ void AnimationPlayer::advance(float p_time) {
 	_animation_process(p_time);
 }
 
+bool AnimationPlayer::threaded_processing = false;
+
+void AnimationPlayer::set_threaded_processing(bool p_enable) {
+	threaded_processing = p_enable;
+}
+
+bool AnimationPlayer::is_threaded_processing() {
+	return threaded_processing;
+}
+
+bool AnimationPlayer::_use_threads() const {
+	return threaded_processing && ThreadWorkPool::get_singleton() && !Engine::get_singleton()->is_editor_hint();
+}
+
 void AnimationPlayer::_notification(int p_what) {
 	switch (p_what) {
 		case NOTIFICATION_ENTER_TREE: {
@@ -195,7 +209,7 @@ void AnimationPlayer::_notification(int p_what) {
 			}
 
 			if (processing) {
-				_animation_process(get_process_delta_time());
+				_animation_process(get_process_delta_time(), _use_threads());
 			}
 		} break;
 		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS: {
@@ -204,7 +218,7 @@ void AnimationPlayer::_notification(int p_what) {
 			}
 
 			if (processing) {
-				_animation_process(get_physics_process_delta_time());
+				_animation_process(get_physics_process_delta_time(), _use_threads());
 			}
 		} break;
 		case NOTIFICATION_EXIT_TREE: {
@@ -219,6 +233,8 @@ void AnimationPlayer::_ensure_node_caches(AnimationData *p_anim) {
 		return;
 	}
 
+	_finish_threaded_process();
+
 	Node *parent = get_node(root);
 
 	ERR_FAIL_COND(!parent);
@@ -226,9 +242,11 @@ void AnimationPlayer::_ensure_node_caches(AnimationData *p_anim) {
 	Animation *a = p_anim->animation.operator->();
 
 	p_anim->node_cache.resize(a->get_track_count());
+	p_anim->key_cursors.resize(a->get_track_count());
 
 	for (int i = 0; i < a->get_track_count(); i++) {
 		p_anim->node_cache.write[i] = nullptr;
+		p_anim->key_cursors.write[i] = 0;
 		RES resource;
 		Vector<StringName> leftover_path;
 		Node *child = parent->get_node_and_resource(a->track_get_path(i), resource, leftover_path);
@@ -321,10 +339,45 @@ void AnimationPlayer::_ensure_node_caches(AnimationData *p_anim) {
 	}
 }
 
+void AnimationPlayer::_accumulate_transform(TrackNodeCache *p_nc, const Animation *p_animation, int p_track, float p_time, float p_interp, int *p_key_cursor) {
+	Vector3 loc;
+	Quat rot;
+	Vector3 scale;
+
+	Error err = p_animation->transform_track_interpolate(p_track, p_time, &loc, &rot, &scale, p_key_cursor);
+	//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+
+	if (err != OK) {
+		return;
+	}
+
+	if (p_nc->accum_pass != accum_pass) {
+		ERR_FAIL_COND(cache_update_size >= NODE_CACHE_UPDATE_MAX);
+		cache_update[cache_update_size++] = p_nc;
+		p_nc->accum_pass = accum_pass;
+		p_nc->loc_accum = loc;
+		p_nc->rot_accum = rot;
+		p_nc->scale_accum = scale;
+
+	} else {
+		p_nc->loc_accum = p_nc->loc_accum.lerp(loc, p_interp);
+		p_nc->rot_accum = p_nc->rot_accum.slerp(rot, p_interp);
+		p_nc->scale_accum = p_nc->scale_accum.lerp(scale, p_interp);
+	}
+}
+
 void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float p_time, float p_delta, float p_interp, bool p_is_current, bool p_seeked, bool p_started) {
 	_ensure_node_caches(p_anim);
 	ERR_FAIL_COND(p_anim->node_cache.size() != p_anim->animation->get_track_count());
 
+	if (defer_transforms) {
+		TransformSampling sampling;
+		sampling.anim = p_anim;
+		sampling.time = p_time;
+		sampling.interp = p_interp;
+		transform_samplings.push_back(sampling);
+	}
+
 	Animation *a = p_anim->animation.operator->();
 	bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
 
@@ -351,34 +404,11 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 
 		switch (a->track_get_type(i)) {
 			case Animation::TYPE_TRANSFORM: {
-				if (!nc->spatial) {
-					continue;
-				}
-
-				Vector3 loc;
-				Quat rot;
-				Vector3 scale;
-
-				Error err = a->transform_track_interpolate(i, p_time, &loc, &rot, &scale);
-				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
-
-				if (err != OK) {
+				if (!nc->spatial || defer_transforms) {
 					continue;
 				}
 
-				if (nc->accum_pass != accum_pass) {
-					ERR_CONTINUE(cache_update_size >= NODE_CACHE_UPDATE_MAX);
-					cache_update[cache_update_size++] = nc;
-					nc->accum_pass = accum_pass;
-					nc->loc_accum = loc;
-					nc->rot_accum = rot;
-					nc->scale_accum = scale;
-
-				} else {
-					nc->loc_accum = nc->loc_accum.lerp(loc, p_interp);
-					nc->rot_accum = nc->rot_accum.slerp(rot, p_interp);
-					nc->scale_accum = nc->scale_accum.lerp(scale, p_interp);
-				}
+				_accumulate_transform(nc, a, i, p_time, p_interp, &p_anim->key_cursors.write[i]);
 
 			} break;
 			case Animation::TYPE_VALUE: {
@@ -440,7 +470,7 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 
 				if (update_mode == Animation::UPDATE_CONTINUOUS || update_mode == Animation::UPDATE_CAPTURE || (p_delta == 0 && update_mode == Animation::UPDATE_DISCRETE)) { //delta == 0 means seek
 
-					Variant value = a->value_track_interpolate(i, p_time);
+					Variant value = a->value_track_interpolate(i, p_time, &p_anim->key_cursors.write[i]);
 
 					if (value == Variant()) {
 						continue;
@@ -569,7 +599,7 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 
 				TrackNodeCache::BezierAnim *ba = &E->get();
 
-				float bezier = a->bezier_track_interpolate(i, p_time);
+				float bezier = a->bezier_track_interpolate(i, p_time, &p_anim->key_cursors.write[i]);
 				if (ba->accum_pass != accum_pass) {
 					ERR_CONTINUE(cache_update_bezier_size >= NODE_CACHE_UPDATE_MAX);
 					cache_update_bezier[cache_update_bezier_size++] = ba;
@@ -822,26 +852,58 @@ void AnimationPlayer::_animation_process2(float p_delta, bool p_started) {
 	}
 }
 
-void AnimationPlayer::_animation_update_transforms() {
-	{
-		Transform t;
-		for (int i = 0; i < cache_update_size; i++) {
-			TrackNodeCache *nc = cache_update[i];
+void AnimationPlayer::_apply_transforms() {
+	Transform t;
+	for (int i = 0; i < cache_update_size; i++) {
+		TrackNodeCache *nc = cache_update[i];
 
-			ERR_CONTINUE(nc->accum_pass != accum_pass);
+		ERR_CONTINUE(nc->accum_pass != accum_pass);
 
-			t.origin = nc->loc_accum;
-			t.basis.set_quat_scale(nc->rot_accum, nc->scale_accum);
-			if (nc->skeleton && nc->bone_idx >= 0) {
-				nc->skeleton->set_bone_pose(nc->bone_idx, t);
+		t.origin = nc->loc_accum;
+		t.basis.set_quat_scale(nc->rot_accum, nc->scale_accum);
+		if (nc->skeleton && nc->bone_idx >= 0) {
+			nc->skeleton->set_bone_pose(nc->bone_idx, t);
 
-			} else if (nc->spatial) {
-				nc->spatial->set_transform(t);
-			}
+		} else if (nc->spatial) {
+			nc->spatial->set_transform(t);
 		}
 	}
 
 	cache_update_size = 0;
+}
+
+void AnimationPlayer::_sample_transforms_task(uint32_t p_index, void *p_userdata) {
+	for (uint32_t i = 0; i < transform_samplings.size(); i++) {
+		const TransformSampling &sampling = transform_samplings[i];
+		AnimationData *anim = sampling.anim;
+		const Animation *a = anim->animation.operator->();
+
+		for (int j = 0; j < anim->node_cache.size(); j++) {
+			TrackNodeCache *nc = anim->node_cache[j];
+			if (!nc || !nc->spatial || a->track_get_type(j) != Animation::TYPE_TRANSFORM || !a->track_is_enabled(j) || a->track_get_key_count(j) == 0) {
+				continue;
+			}
+
+			_accumulate_transform(nc, a, j, sampling.time, sampling.interp, &anim->key_cursors.write[j]);
+		}
+	}
+}
+
+void AnimationPlayer::_finish_threaded_process() {
+	if (transform_task == ThreadWorkPool::INVALID_GROUP_ID) {
+		return;
+	}
+
+	ThreadWorkPool::get_singleton()->wait_for_group(transform_task);
+	transform_task = ThreadWorkPool::INVALID_GROUP_ID;
+	transform_samplings.clear();
+	_apply_transforms();
+}
+
+void AnimationPlayer::_animation_update_transforms() {
+	if (!defer_transforms) {
+		_apply_transforms();
+	}
 
 	for (int i = 0; i < cache_update_prop_size; i++) {
 		TrackNodeCache::PropertyAnim *pa = cache_update_prop[i];
@@ -900,10 +962,13 @@ void AnimationPlayer::_animation_update_transforms() {
 	cache_update_bezier_size = 0;
 }
 
-void AnimationPlayer::_animation_process(float p_delta) {
+void AnimationPlayer::_animation_process(float p_delta, bool p_threaded) {
+	_finish_threaded_process();
+
 	if (playback.current.from) {
 		end_reached = false;
 		end_notify = false;
+		defer_transforms = p_threaded;
 		_animation_process2(p_delta, playback.started);
 
 		if (playback.started) {
@@ -911,6 +976,18 @@ void AnimationPlayer::_animation_process(float p_delta) {
 		}
 
 		_animation_update_transforms();
+
+		if (defer_transforms) {
+			// Everything else was processed already, sample the transform
+			// tracks in the worker pool. The poses are set after the frame's
+			// process notifications, or as soon as the caches are needed.
+			defer_transforms = false;
+			if (transform_samplings.size()) {
+				transform_task = ThreadWorkPool::get_singleton()->add_task(this, &AnimationPlayer::_sample_transforms_task, nullptr);
+				MessageQueue::get_singleton()->push_callable(callable_mp(this, &AnimationPlayer::_finish_threaded_process));
+			}
+		}
+
 		if (end_reached) {
 			if (queued.size()) {
 				String old = playback.assigned;
@@ -943,6 +1020,8 @@ Error AnimationPlayer::add_animation(const StringName &p_name, const Ref<Animati
 
 	ERR_FAIL_COND_V(p_animation.is_null(), ERR_INVALID_PARAMETER);
 
+	_finish_threaded_process();
+
 	if (animation_set.has(p_name)) {
 		_unref_anim(animation_set[p_name].animation);
 		animation_set[p_name].animation = p_animation;
@@ -962,6 +1041,8 @@ Error AnimationPlayer::add_animation(const StringName &p_name, const Ref<Animati
 void AnimationPlayer::remove_animation(const StringName &p_name) {
 	ERR_FAIL_COND(!animation_set.has(p_name));
 
+	_finish_threaded_process();
+
 	stop();
 	_unref_anim(animation_set[p_name].animation);
 	animation_set.erase(p_name);
@@ -983,6 +1064,8 @@ void AnimationPlayer::rename_animation(const StringName &p_name, const StringNam
 	ERR_FAIL_COND(String(p_new_name).find("/") != -1 || String(p_new_name).find(":") != -1);
 	ERR_FAIL_COND(animation_set.has(p_new_name));
 
+	_finish_threaded_process();
+
 	stop();
 	AnimationData ad = animation_set[p_name];
 	ad.name = p_new_name;
@@ -1333,6 +1416,13 @@ void AnimationPlayer::_node_removed(Node *p_node) {
 }
 
 void AnimationPlayer::clear_caches() {
+	if (transform_task != ThreadWorkPool::INVALID_GROUP_ID) {
+		// The pending results point to the caches, drop them.
+		ThreadWorkPool::get_singleton()->wait_for_group(transform_task);
+		transform_task = ThreadWorkPool::INVALID_GROUP_ID;
+		transform_samplings.clear();
+	}
+
 	_stop_playing_caches();
 
 	node_cache_map.clear();
@@ -31,6 +31,8 @@
 #ifndef ANIMATION_PLAYER_H
 #define ANIMATION_PLAYER_H
 
+#include "core/local_vector.h"
+#include "core/thread_work_pool.h"
 #include "scene/2d/node_2d.h"
 #include "scene/3d/node_3d.h"
 #include "scene/3d/skeleton_3d.h"
@@ -166,6 +168,7 @@ private:
 		String name;
 		StringName next;
 		Vector<TrackNodeCache *> node_cache;
+		Vector<int> key_cursors; // Last key sampled per track, speeds up the next lookup.
 		Ref<Animation> animation;
 	};
 
@@ -229,7 +232,25 @@ private:
 	void _animation_process_data(PlaybackData &cd, float p_delta, float p_blend, bool p_seeked, bool p_started);
 	void _animation_process2(float p_delta, bool p_started);
 	void _animation_update_transforms();
-	void _animation_process(float p_delta);
+	void _animation_process(float p_delta, bool p_threaded = false);
+	void _accumulate_transform(TrackNodeCache *p_nc, const Animation *p_animation, int p_track, float p_time, float p_interp, int *p_key_cursor);
+	void _apply_transforms();
+
+	// With threaded processing, transform tracks are sampled in the worker
+	// pool and the poses are set once the task is finished.
+	struct TransformSampling {
+		AnimationData *anim = nullptr;
+		float time = 0.0;
+		float interp = 0.0;
+	};
+
+	static bool threaded_processing;
+	bool defer_transforms = false;
+	LocalVector<TransformSampling> transform_samplings;
+	ThreadWorkPool::GroupID transform_task = ThreadWorkPool::INVALID_GROUP_ID;
+	bool _use_threads() const;
+	void _sample_transforms_task(uint32_t p_index, void *p_userdata);
+	void _finish_threaded_process();
 
 	void _node_removed(Node *p_node);
 	void _stop_playing_caches();
@@ -331,6 +352,9 @@ public:
 	void restore_animated_values(const AnimatedValuesBackup &p_backup);
 #endif
 
+	static void set_threaded_processing(bool p_enable);
+	static bool is_threaded_processing();
+
 	AnimationPlayer();
 	~AnimationPlayer();
 };
@@ -32,6 +32,7 @@
 
 #include "animation_blend_tree.h"
 #include "core/engine.h"
+#include "core/message_queue.h"
 #include "core/method_bind_ext.gen.inc"
 #include "scene/scene_string_names.h"
 #include "servers/audio/audio_stream.h"
@@ -107,7 +108,7 @@ void AnimationNode::blend_animation(const StringName &p_animation, float p_time,
 
 	AnimationState anim_state;
 	anim_state.blend = p_blend;
-	anim_state.track_blends = &blends;
+	anim_state.track_blends = blends;
 	anim_state.delta = p_delta;
 	anim_state.time = p_time;
 	anim_state.animation = animation;
@@ -707,6 +708,12 @@ bool AnimationTree::_update_caches(AnimationPlayer *player) {
 }
 
 void AnimationTree::_clear_caches() {
+	if (blend_task != ThreadWorkPool::INVALID_GROUP_ID) {
+		// The pending results point to the caches, drop them.
+		ThreadWorkPool::get_singleton()->wait_for_group(blend_task);
+		blend_task = ThreadWorkPool::INVALID_GROUP_ID;
+	}
+
 	const NodePath *K = nullptr;
 	while ((K = track_cache.next(K))) {
 		memdelete(track_cache[*K]);
@@ -714,10 +721,13 @@ void AnimationTree::_clear_caches() {
 	playing_caches.clear();
 
 	track_cache.clear();
+	key_cursors.clear();
 	cache_valid = false;
 }
 
-void AnimationTree::_process_graph(float p_delta) {
+void AnimationTree::_process_graph(float p_delta, bool p_threaded) {
+	_finish_threaded_process();
+
 	_update_properties(); //if properties need updating, update them
 
 	//check all tracks, see if they need modification
@@ -810,90 +820,118 @@ void AnimationTree::_process_graph(float p_delta) {
 	if (!state.valid) {
 		return; //state is not valid. do nothing.
 	}
-	//apply value/transform/bezier blends to track caches and execute method/audio/animation tracks
 
-	{
-		bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
+	if (p_threaded) {
+		// Run anything with side effects here, then sample and blend in the
+		// worker pool. The results are applied after the frame's process
+		// notifications, or as soon as something needs them.
+		_process_tracks(false, true);
+		blend_task = ThreadWorkPool::get_singleton()->add_task(this, &AnimationTree::_blend_tracks_task, nullptr);
+		MessageQueue::get_singleton()->push_callable(callable_mp(this, &AnimationTree::_finish_threaded_process));
+		return;
+	}
 
-		for (List<AnimationNode::AnimationState>::Element *E = state.animation_states.front(); E; E = E->next()) {
-			const AnimationNode::AnimationState &as = E->get();
+	//apply value/transform/bezier blends to track caches and execute method/audio/animation tracks
+	_process_tracks(true, true);
+	_apply_tracks();
+}
 
-			Ref<Animation> a = as.animation;
-			float time = as.time;
-			float delta = as.delta;
-			bool seeked = as.seeked;
+bool AnimationTree::_is_track_blended(const Animation *p_animation, int p_track) {
+	switch (p_animation->track_get_type(p_track)) {
+		case Animation::TYPE_TRANSFORM:
+		case Animation::TYPE_BEZIER: {
+			return true;
+		} break;
+		case Animation::TYPE_VALUE: {
+			Animation::UpdateMode update_mode = p_animation->value_track_get_update_mode(p_track);
+			return update_mode == Animation::UPDATE_CONTINUOUS || update_mode == Animation::UPDATE_CAPTURE;
+		} break;
+		default: {
+			return false;
+		}
+	}
+}
 
-			for (int i = 0; i < a->get_track_count(); i++) {
-				NodePath path = a->track_get_path(i);
+void AnimationTree::_process_tracks(bool p_blend, bool p_trigger) {
+	bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
 
-				ERR_CONTINUE(!track_cache.has(path));
+	for (List<AnimationNode::AnimationState>::Element *E = state.animation_states.front(); E; E = E->next()) {
+		const AnimationNode::AnimationState &as = E->get();
 
-				TrackCache *track = track_cache[path];
-				if (track->type != a->track_get_type(i)) {
-					continue; //may happen should not
-				}
+		Ref<Animation> a = as.animation;
+		float time = as.time;
+		float delta = as.delta;
+		bool seeked = as.seeked;
 
-				track->root_motion = root_motion_track == path;
+		Vector<int> &cursors = key_cursors[a->get_instance_id()];
+		if (cursors.size() != a->get_track_count()) {
+			cursors.resize(a->get_track_count());
+			for (int i = 0; i < cursors.size(); i++) {
+				cursors.write[i] = 0;
+			}
+		}
+		int *cursor = cursors.ptrw();
 
-				ERR_CONTINUE(!state.track_map.has(path));
-				int blend_idx = state.track_map[path];
+		for (int i = 0; i < a->get_track_count(); i++) {
+			NodePath path = a->track_get_path(i);
 
-				ERR_CONTINUE(blend_idx < 0 || blend_idx >= state.track_count);
+			ERR_CONTINUE(!track_cache.has(path));
 
-				float blend = (*as.track_blends)[blend_idx];
+			TrackCache *track = track_cache[path];
+			if (track->type != a->track_get_type(i)) {
+				continue; //may happen should not
+			}
 
-				if (blend < CMP_EPSILON) {
-					continue; //nothing to blend
-				}
+			if (!(_is_track_blended(a.ptr(), i) ? p_blend : p_trigger)) {
+				continue; //handled by the other pass
+			}
 
-				switch (track->type) {
-					case Animation::TYPE_TRANSFORM: {
-						TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
-
-						if (track->root_motion) {
-							if (t->process_pass != process_pass) {
-								t->process_pass = process_pass;
-								t->loc = Vector3();
-								t->rot = Quat();
-								t->rot_blend_accum = 0;
-								t->scale = Vector3(1, 1, 1);
-							}
+			track->root_motion = root_motion_track == path;
 
-							float prev_time = time - delta;
-							if (prev_time < 0) {
-								if (!a->has_loop()) {
-									prev_time = 0;
-								} else {
-									prev_time = a->get_length() + prev_time;
-								}
-							}
+			ERR_CONTINUE(!state.track_map.has(path));
+			int blend_idx = state.track_map[path];
 
-							Vector3 loc[2];
-							Quat rot[2];
-							Vector3 scale[2];
+			ERR_CONTINUE(blend_idx < 0 || blend_idx >= state.track_count);
 
-							if (prev_time > time) {
-								Error err = a->transform_track_interpolate(i, prev_time, &loc[0], &rot[0], &scale[0]);
-								if (err != OK) {
-									continue;
-								}
+			float blend = as.track_blends[blend_idx];
 
-								a->transform_track_interpolate(i, a->get_length(), &loc[1], &rot[1], &scale[1]);
+			if (blend < CMP_EPSILON) {
+				continue; //nothing to blend
+			}
 
-								t->loc += (loc[1] - loc[0]) * blend;
-								t->scale += (scale[1] - scale[0]) * blend;
-								Quat q = Quat().slerp(rot[0].normalized().inverse() * rot[1].normalized(), blend).normalized();
-								t->rot = (t->rot * q).normalized();
+			switch (track->type) {
+				case Animation::TYPE_TRANSFORM: {
+					TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
 
+					if (track->root_motion) {
+						if (t->process_pass != process_pass) {
+							t->process_pass = process_pass;
+							t->loc = Vector3();
+							t->rot = Quat();
+							t->rot_blend_accum = 0;
+							t->scale = Vector3(1, 1, 1);
+						}
+
+						float prev_time = time - delta;
+						if (prev_time < 0) {
+							if (!a->has_loop()) {
 								prev_time = 0;
+							} else {
+								prev_time = a->get_length() + prev_time;
 							}
+						}
 
-							Error err = a->transform_track_interpolate(i, prev_time, &loc[0], &rot[0], &scale[0]);
+						Vector3 loc[2];
+						Quat rot[2];
+						Vector3 scale[2];
+
+						if (prev_time > time) {
+							Error err = a->transform_track_interpolate(i, prev_time, &loc[0], &rot[0], &scale[0], &cursor[i]);
 							if (err != OK) {
 								continue;
 							}
 
-							a->transform_track_interpolate(i, time, &loc[1], &rot[1], &scale[1]);
+							a->transform_track_interpolate(i, a->get_length(), &loc[1], &rot[1], &scale[1], &cursor[i]);
 
 							t->loc += (loc[1] - loc[0]) * blend;
 							t->scale += (scale[1] - scale[0]) * blend;
@@ -901,123 +939,177 @@ void AnimationTree::_process_graph(float p_delta) {
 							t->rot = (t->rot * q).normalized();
 
 							prev_time = 0;
+						}
 
-						} else {
-							Vector3 loc;
-							Quat rot;
-							Vector3 scale;
-
-							Error err = a->transform_track_interpolate(i, time, &loc, &rot, &scale);
-							//ERR_CONTINUE(err!=OK); //used for testing, should be removed
-
-							if (t->process_pass != process_pass) {
-								t->process_pass = process_pass;
-								t->loc = loc;
-								t->rot = rot;
-								t->rot_blend_accum = 0;
-								t->scale = scale;
-							}
+						Error err = a->transform_track_interpolate(i, prev_time, &loc[0], &rot[0], &scale[0], &cursor[i]);
+						if (err != OK) {
+							continue;
+						}
 
-							if (err != OK) {
-								continue;
-							}
+						a->transform_track_interpolate(i, time, &loc[1], &rot[1], &scale[1], &cursor[i]);
 
-							t->loc = t->loc.lerp(loc, blend);
-							if (t->rot_blend_accum == 0) {
-								t->rot = rot;
-								t->rot_blend_accum = blend;
-							} else {
-								float rot_total = t->rot_blend_accum + blend;
-								t->rot = rot.slerp(t->rot, t->rot_blend_accum / rot_total).normalized();
-								t->rot_blend_accum = rot_total;
-							}
-							t->scale = t->scale.lerp(scale, blend);
-						}
+						t->loc += (loc[1] - loc[0]) * blend;
+						t->scale += (scale[1] - scale[0]) * blend;
+						Quat q = Quat().slerp(rot[0].normalized().inverse() * rot[1].normalized(), blend).normalized();
+						t->rot = (t->rot * q).normalized();
 
-					} break;
-					case Animation::TYPE_VALUE: {
-						TrackCacheValue *t = static_cast<TrackCacheValue *>(track);
+						prev_time = 0;
 
-						Animation::UpdateMode update_mode = a->value_track_get_update_mode(i);
+					} else {
+						Vector3 loc;
+						Quat rot;
+						Vector3 scale;
 
-						if (update_mode == Animation::UPDATE_CONTINUOUS || update_mode == Animation::UPDATE_CAPTURE) { //delta == 0 means seek
+						Error err = a->transform_track_interpolate(i, time, &loc, &rot, &scale, &cursor[i]);
+						//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
-							Variant value = a->value_track_interpolate(i, time);
+						if (t->process_pass != process_pass) {
+							t->process_pass = process_pass;
+							t->loc = loc;
+							t->rot = rot;
+							t->rot_blend_accum = 0;
+							t->scale = scale;
+						}
 
-							if (value == Variant()) {
-								continue;
-							}
+						if (err != OK) {
+							continue;
+						}
 
-							if (t->process_pass != process_pass) {
-								t->value = value;
-								t->process_pass = process_pass;
-							}
+						t->loc = t->loc.lerp(loc, blend);
+						if (t->rot_blend_accum == 0) {
+							t->rot = rot;
+							t->rot_blend_accum = blend;
+						} else {
+							float rot_total = t->rot_blend_accum + blend;
+							t->rot = rot.slerp(t->rot, t->rot_blend_accum / rot_total).normalized();
+							t->rot_blend_accum = rot_total;
+						}
+						t->scale = t->scale.lerp(scale, blend);
+					}
 
-							Variant::interpolate(t->value, value, blend, t->value);
+				} break;
+				case Animation::TYPE_VALUE: {
+					TrackCacheValue *t = static_cast<TrackCacheValue *>(track);
 
-						} else if (delta != 0) {
-							List<int> indices;
-							a->value_track_get_key_indices(i, time, delta, &indices);
+					Animation::UpdateMode update_mode = a->value_track_get_update_mode(i);
 
-							for (List<int>::Element *F = indices.front(); F; F = F->next()) {
-								Variant value = a->track_get_key_value(i, F->get());
-								t->object->set_indexed(t->subpath, value);
-							}
-						}
+					if (update_mode == Animation::UPDATE_CONTINUOUS || update_mode == Animation::UPDATE_CAPTURE) { //delta == 0 means seek
 
-					} break;
-					case Animation::TYPE_METHOD: {
-						if (delta == 0) {
+						Variant value = a->value_track_interpolate(i, time, &cursor[i]);
+
+						if (value == Variant()) {
 							continue;
 						}
-						TrackCacheMethod *t = static_cast<TrackCacheMethod *>(track);
 
-						List<int> indices;
+						if (t->process_pass != process_pass) {
+							t->value = value;
+							t->process_pass = process_pass;
+						}
 
-						a->method_track_get_key_indices(i, time, delta, &indices);
+						Variant::interpolate(t->value, value, blend, t->value);
+
+					} else if (delta != 0) {
+						List<int> indices;
+						a->value_track_get_key_indices(i, time, delta, &indices);
 
 						for (List<int>::Element *F = indices.front(); F; F = F->next()) {
-							StringName method = a->method_track_get_name(i, F->get());
-							Vector<Variant> params = a->method_track_get_params(i, F->get());
-
-							int s = params.size();
-
-							ERR_CONTINUE(s > VARIANT_ARG_MAX);
-							if (can_call) {
-								t->object->call_deferred(
-										method,
-										s >= 1 ? params[0] : Variant(),
-										s >= 2 ? params[1] : Variant(),
-										s >= 3 ? params[2] : Variant(),
-										s >= 4 ? params[3] : Variant(),
-										s >= 5 ? params[4] : Variant());
-							}
+							Variant value = a->track_get_key_value(i, F->get());
+							t->object->set_indexed(t->subpath, value);
 						}
+					}
 
-					} break;
-					case Animation::TYPE_BEZIER: {
-						TrackCacheBezier *t = static_cast<TrackCacheBezier *>(track);
+				} break;
+				case Animation::TYPE_METHOD: {
+					if (delta == 0) {
+						continue;
+					}
+					TrackCacheMethod *t = static_cast<TrackCacheMethod *>(track);
 
-						float bezier = a->bezier_track_interpolate(i, time);
+					List<int> indices;
 
-						if (t->process_pass != process_pass) {
-							t->value = bezier;
-							t->process_pass = process_pass;
+					a->method_track_get_key_indices(i, time, delta, &indices);
+
+					for (List<int>::Element *F = indices.front(); F; F = F->next()) {
+						StringName method = a->method_track_get_name(i, F->get());
+						Vector<Variant> params = a->method_track_get_params(i, F->get());
+
+						int s = params.size();
+
+						ERR_CONTINUE(s > VARIANT_ARG_MAX);
+						if (can_call) {
+							t->object->call_deferred(
+									method,
+									s >= 1 ? params[0] : Variant(),
+									s >= 2 ? params[1] : Variant(),
+									s >= 3 ? params[2] : Variant(),
+									s >= 4 ? params[3] : Variant(),
+									s >= 5 ? params[4] : Variant());
 						}
+					}
 
-						t->value = Math::lerp(t->value, bezier, blend);
+				} break;
+				case Animation::TYPE_BEZIER: {
+					TrackCacheBezier *t = static_cast<TrackCacheBezier *>(track);
 
-					} break;
-					case Animation::TYPE_AUDIO: {
-						TrackCacheAudio *t = static_cast<TrackCacheAudio *>(track);
+					float bezier = a->bezier_track_interpolate(i, time, &cursor[i]);
 
-						if (seeked) {
-							//find whathever should be playing
-							int idx = a->track_find_key(i, time);
-							if (idx < 0) {
+					if (t->process_pass != process_pass) {
+						t->value = bezier;
+						t->process_pass = process_pass;
+					}
+
+					t->value = Math::lerp(t->value, bezier, blend);
+
+				} break;
+				case Animation::TYPE_AUDIO: {
+					TrackCacheAudio *t = static_cast<TrackCacheAudio *>(track);
+
+					if (seeked) {
+						//find whathever should be playing
+						int idx = a->track_find_key(i, time);
+						if (idx < 0) {
+							continue;
+						}
+
+						Ref<AudioStream> stream = a->audio_track_get_key_stream(i, idx);
+						if (!stream.is_valid()) {
+							t->object->call("stop");
+							t->playing = false;
+							playing_caches.erase(t);
+						} else {
+							float start_ofs = a->audio_track_get_key_start_offset(i, idx);
+							start_ofs += time - a->track_get_key_time(i, idx);
+							float end_ofs = a->audio_track_get_key_end_offset(i, idx);
+							float len = stream->get_length();
+
+							if (start_ofs > len - end_ofs) {
+								t->object->call("stop");
+								t->playing = false;
+								playing_caches.erase(t);
 								continue;
 							}
 
+							t->object->call("set_stream", stream);
+							t->object->call("play", start_ofs);
+
+							t->playing = true;
+							playing_caches.insert(t);
+							if (len && end_ofs > 0) { //force a end at a time
+								t->len = len - start_ofs - end_ofs;
+							} else {
+								t->len = 0;
+							}
+
+							t->start = time;
+						}
+
+					} else {
+						//find stuff to play
+						List<int> to_play;
+						a->track_get_key_indices_in_range(i, time, delta, &to_play);
+						if (to_play.size()) {
+							int idx = to_play.back()->get();
+
 							Ref<AudioStream> stream = a->audio_track_get_key_stream(i, idx);
 							if (!stream.is_valid()) {
 								t->object->call("stop");
@@ -1025,17 +1117,9 @@ void AnimationTree::_process_graph(float p_delta) {
 								playing_caches.erase(t);
 							} else {
 								float start_ofs = a->audio_track_get_key_start_offset(i, idx);
-								start_ofs += time - a->track_get_key_time(i, idx);
 								float end_ofs = a->audio_track_get_key_end_offset(i, idx);
 								float len = stream->get_length();
 
-								if (start_ofs > len - end_ofs) {
-									t->object->call("stop");
-									t->playing = false;
-									playing_caches.erase(t);
-									continue;
-								}
-
 								t->object->call("set_stream", stream);
 								t->object->call("play", start_ofs);
 
@@ -1049,185 +1133,167 @@ void AnimationTree::_process_graph(float p_delta) {
 
 								t->start = time;
 							}
+						} else if (t->playing) {
+							bool loop = a->has_loop();
 
-						} else {
-							//find stuff to play
-							List<int> to_play;
-							a->track_get_key_indices_in_range(i, time, delta, &to_play);
-							if (to_play.size()) {
-								int idx = to_play.back()->get();
-
-								Ref<AudioStream> stream = a->audio_track_get_key_stream(i, idx);
-								if (!stream.is_valid()) {
-									t->object->call("stop");
-									t->playing = false;
-									playing_caches.erase(t);
-								} else {
-									float start_ofs = a->audio_track_get_key_start_offset(i, idx);
-									float end_ofs = a->audio_track_get_key_end_offset(i, idx);
-									float len = stream->get_length();
-
-									t->object->call("set_stream", stream);
-									t->object->call("play", start_ofs);
-
-									t->playing = true;
-									playing_caches.insert(t);
-									if (len && end_ofs > 0) { //force a end at a time
-										t->len = len - start_ofs - end_ofs;
-									} else {
-										t->len = 0;
-									}
-
-									t->start = time;
-								}
-							} else if (t->playing) {
-								bool loop = a->has_loop();
+							bool stop = false;
 
-								bool stop = false;
+							if (!loop && time < t->start) {
+								stop = true;
+							} else if (t->len > 0) {
+								float len = t->start > time ? (a->get_length() - t->start) + time : time - t->start;
 
-								if (!loop && time < t->start) {
+								if (len > t->len) {
 									stop = true;
-								} else if (t->len > 0) {
-									float len = t->start > time ? (a->get_length() - t->start) + time : time - t->start;
-
-									if (len > t->len) {
-										stop = true;
-									}
 								}
+							}
 
-								if (stop) {
-									//time to stop
-									t->object->call("stop");
-									t->playing = false;
-									playing_caches.erase(t);
-								}
+							if (stop) {
+								//time to stop
+								t->object->call("stop");
+								t->playing = false;
+								playing_caches.erase(t);
 							}
 						}
+					}
 
-						float db = Math::linear2db(MAX(blend, 0.00001));
-						if (t->object->has_method("set_unit_db")) {
-							t->object->call("set_unit_db", db);
-						} else {
-							t->object->call("set_volume_db", db);
-						}
-					} break;
-					case Animation::TYPE_ANIMATION: {
-						TrackCacheAnimation *t = static_cast<TrackCacheAnimation *>(track);
+					float db = Math::linear2db(MAX(blend, 0.00001));
+					if (t->object->has_method("set_unit_db")) {
+						t->object->call("set_unit_db", db);
+					} else {
+						t->object->call("set_volume_db", db);
+					}
+				} break;
+				case Animation::TYPE_ANIMATION: {
+					TrackCacheAnimation *t = static_cast<TrackCacheAnimation *>(track);
 
-						AnimationPlayer *player2 = Object::cast_to<AnimationPlayer>(t->object);
+					AnimationPlayer *player2 = Object::cast_to<AnimationPlayer>(t->object);
 
-						if (!player2) {
+					if (!player2) {
+						continue;
+					}
+
+					if (delta == 0 || seeked) {
+						//seek
+						int idx = a->track_find_key(i, time);
+						if (idx < 0) {
 							continue;
 						}
 
-						if (delta == 0 || seeked) {
-							//seek
-							int idx = a->track_find_key(i, time);
-							if (idx < 0) {
-								continue;
-							}
+						float pos = a->track_get_key_time(i, idx);
 
-							float pos = a->track_get_key_time(i, idx);
+						StringName anim_name = a->animation_track_get_key_animation(i, idx);
+						if (String(anim_name) == "[stop]" || !player2->has_animation(anim_name)) {
+							continue;
+						}
 
-							StringName anim_name = a->animation_track_get_key_animation(i, idx);
-							if (String(anim_name) == "[stop]" || !player2->has_animation(anim_name)) {
-								continue;
-							}
+						Ref<Animation> anim = player2->get_animation(anim_name);
 
-							Ref<Animation> anim = player2->get_animation(anim_name);
+						float at_anim_pos;
 
-							float at_anim_pos;
+						if (anim->has_loop()) {
+							at_anim_pos = Math::fposmod(time - pos, anim->get_length()); //seek to loop
+						} else {
+							at_anim_pos = MAX(anim->get_length(), time - pos); //seek to end
+						}
 
-							if (anim->has_loop()) {
-								at_anim_pos = Math::fposmod(time - pos, anim->get_length()); //seek to loop
-							} else {
-								at_anim_pos = MAX(anim->get_length(), time - pos); //seek to end
-							}
+						if (player2->is_playing() || seeked) {
+							player2->play(anim_name);
+							player2->seek(at_anim_pos);
+							t->playing = true;
+							playing_caches.insert(t);
+						} else {
+							player2->set_assigned_animation(anim_name);
+							player2->seek(at_anim_pos, true);
+						}
+					} else {
+						//find stuff to play
+						List<int> to_play;
+						a->track_get_key_indices_in_range(i, time, delta, &to_play);
+						if (to_play.size()) {
+							int idx = to_play.back()->get();
 
-							if (player2->is_playing() || seeked) {
+							StringName anim_name = a->animation_track_get_key_animation(i, idx);
+							if (String(anim_name) == "[stop]" || !player2->has_animation(anim_name)) {
+								if (playing_caches.has(t)) {
+									playing_caches.erase(t);
+									player2->stop();
+									t->playing = false;
+								}
+							} else {
 								player2->play(anim_name);
-								player2->seek(at_anim_pos);
 								t->playing = true;
 								playing_caches.insert(t);
-							} else {
-								player2->set_assigned_animation(anim_name);
-								player2->seek(at_anim_pos, true);
-							}
-						} else {
-							//find stuff to play
-							List<int> to_play;
-							a->track_get_key_indices_in_range(i, time, delta, &to_play);
-							if (to_play.size()) {
-								int idx = to_play.back()->get();
-
-								StringName anim_name = a->animation_track_get_key_animation(i, idx);
-								if (String(anim_name) == "[stop]" || !player2->has_animation(anim_name)) {
-									if (playing_caches.has(t)) {
-										playing_caches.erase(t);
-										player2->stop();
-										t->playing = false;
-									}
-								} else {
-									player2->play(anim_name);
-									t->playing = true;
-									playing_caches.insert(t);
-								}
 							}
 						}
+					}
 
-					} break;
-				}
+				} break;
 			}
 		}
 	}
+}
 
-	{
-		// finally, set the tracks
-		const NodePath *K = nullptr;
-		while ((K = track_cache.next(K))) {
-			TrackCache *track = track_cache[*K];
-			if (track->process_pass != process_pass) {
-				continue; //not processed, ignore
-			}
+void AnimationTree::_blend_tracks_task(uint32_t p_index, void *p_userdata) {
+	_process_tracks(true, false);
+}
 
-			switch (track->type) {
-				case Animation::TYPE_TRANSFORM: {
-					TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
+void AnimationTree::_finish_threaded_process() {
+	if (blend_task == ThreadWorkPool::INVALID_GROUP_ID) {
+		return;
+	}
+
+	ThreadWorkPool::get_singleton()->wait_for_group(blend_task);
+	blend_task = ThreadWorkPool::INVALID_GROUP_ID;
+	_apply_tracks();
+}
 
-					Transform xform;
-					xform.origin = t->loc;
+void AnimationTree::_apply_tracks() {
+	// finally, set the tracks
+	const NodePath *K = nullptr;
+	while ((K = track_cache.next(K))) {
+		TrackCache *track = track_cache[*K];
+		if (track->process_pass != process_pass) {
+			continue; //not processed, ignore
+		}
 
-					xform.basis.set_quat_scale(t->rot, t->scale);
+		switch (track->type) {
+			case Animation::TYPE_TRANSFORM: {
+				TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
 
-					if (t->root_motion) {
-						root_motion_transform = xform;
+				Transform xform;
+				xform.origin = t->loc;
 
-						if (t->skeleton && t->bone_idx >= 0) {
-							root_motion_transform = (t->skeleton->get_bone_rest(t->bone_idx) * root_motion_transform) * t->skeleton->get_bone_rest(t->bone_idx).affine_inverse();
-						}
-					} else if (t->skeleton && t->bone_idx >= 0) {
-						t->skeleton->set_bone_pose(t->bone_idx, xform);
+				xform.basis.set_quat_scale(t->rot, t->scale);
 
-					} else {
-						t->spatial->set_transform(xform);
+				if (t->root_motion) {
+					root_motion_transform = xform;
+
+					if (t->skeleton && t->bone_idx >= 0) {
+						root_motion_transform = (t->skeleton->get_bone_rest(t->bone_idx) * root_motion_transform) * t->skeleton->get_bone_rest(t->bone_idx).affine_inverse();
 					}
+				} else if (t->skeleton && t->bone_idx >= 0) {
+					t->skeleton->set_bone_pose(t->bone_idx, xform);
 
-				} break;
-				case Animation::TYPE_VALUE: {
-					TrackCacheValue *t = static_cast<TrackCacheValue *>(track);
+				} else {
+					t->spatial->set_transform(xform);
+				}
 
-					t->object->set_indexed(t->subpath, t->value);
+			} break;
+			case Animation::TYPE_VALUE: {
+				TrackCacheValue *t = static_cast<TrackCacheValue *>(track);
 
-				} break;
-				case Animation::TYPE_BEZIER: {
-					TrackCacheBezier *t = static_cast<TrackCacheBezier *>(track);
+				t->object->set_indexed(t->subpath, t->value);
 
-					t->object->set_indexed(t->subpath, t->value);
+			} break;
+			case Animation::TYPE_BEZIER: {
+				TrackCacheBezier *t = static_cast<TrackCacheBezier *>(track);
 
-				} break;
-				default: {
-				} //the rest don't matter
-			}
+				t->object->set_indexed(t->subpath, t->value);
+
+			} break;
+			default: {
+			} //the rest don't matter
 		}
 	}
 }
@@ -1236,13 +1302,27 @@ void AnimationTree::advance(float p_time) {
 	_process_graph(p_time);
 }
 
+bool AnimationTree::threaded_processing = false;
+
+void AnimationTree::set_threaded_processing(bool p_enable) {
+	threaded_processing = p_enable;
+}
+
+bool AnimationTree::is_threaded_processing() {
+	return threaded_processing;
+}
+
+bool AnimationTree::_use_threads() const {
+	return threaded_processing && ThreadWorkPool::get_singleton() && !Engine::get_singleton()->is_editor_hint();
+}
+
 void AnimationTree::_notification(int p_what) {
 	if (active && p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS && process_mode == ANIMATION_PROCESS_PHYSICS) {
-		_process_graph(get_physics_process_delta_time());
+		_process_graph(get_physics_process_delta_time(), _use_threads());
 	}
 
 	if (active && p_what == NOTIFICATION_INTERNAL_PROCESS && process_mode == ANIMATION_PROCESS_IDLE) {
-		_process_graph(get_process_delta_time());
+		_process_graph(get_process_delta_time(), _use_threads());
 	}
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
@@ -1327,6 +1407,7 @@ String AnimationTree::get_configuration_warning() const {
 }
 
 void AnimationTree::set_root_motion_track(const NodePath &p_track) {
+	_finish_threaded_process();
 	root_motion_track = p_track;
 }
 
@@ -1335,6 +1416,7 @@ NodePath AnimationTree::get_root_motion_track() const {
 }
 
 Transform AnimationTree::get_root_motion_transform() const {
+	const_cast<AnimationTree *>(this)->_finish_threaded_process();
 	return root_motion_transform;
 }
 
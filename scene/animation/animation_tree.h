@@ -32,6 +32,7 @@
 #define ANIMATION_GRAPH_PLAYER_H
 
 #include "animation_player.h"
+#include "core/thread_work_pool.h"
 #include "scene/3d/node_3d.h"
 #include "scene/3d/skeleton_3d.h"
 #include "scene/resources/animation.h"
@@ -65,7 +66,7 @@ public:
 		Ref<Animation> animation;
 		float time;
 		float delta;
-		const Vector<float> *track_blends;
+		Vector<float> track_blends; // Copied, as the node may be shared and blend again before this is sampled.
 		float blend;
 		bool seeked;
 	};
@@ -247,6 +248,7 @@ private:
 
 	HashMap<NodePath, TrackCache *> track_cache;
 	Set<TrackCache *> playing_caches;
+	HashMap<ObjectID, Vector<int>> key_cursors; // Last key sampled per animation track.
 
 	Ref<AnimationNode> root;
 
@@ -261,7 +263,17 @@ private:
 
 	void _clear_caches();
 	bool _update_caches(AnimationPlayer *player);
-	void _process_graph(float p_delta);
+	void _process_graph(float p_delta, bool p_threaded = false);
+
+	static bool _is_track_blended(const Animation *p_animation, int p_track);
+	void _process_tracks(bool p_blend, bool p_trigger);
+	void _apply_tracks();
+
+	static bool threaded_processing;
+	ThreadWorkPool::GroupID blend_task = ThreadWorkPool::INVALID_GROUP_ID;
+	bool _use_threads() const;
+	void _blend_tracks_task(uint32_t p_index, void *p_userdata);
+	void _finish_threaded_process();
 
 	uint64_t setup_pass;
 	uint64_t process_pass;
@@ -328,6 +340,10 @@ public:
 	void rename_parameter(const String &p_base, const String &p_new_base);
 
 	uint64_t get_last_process_pass() const;
+
+	static void set_threaded_processing(bool p_enable);
+	static bool is_threaded_processing();
+
 	AnimationTree();
 	~AnimationTree();
 };
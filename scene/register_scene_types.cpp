@@ -408,6 +408,10 @@ void register_scene_types() {
 	ClassDB::register_class<AnimationNodeTimeSeek>();
 	ClassDB::register_class<AnimationNodeTransition>();
 
+	bool animation_threads = GLOBAL_DEF("animation/processing/use_threads", false);
+	AnimationPlayer::set_threaded_processing(animation_threads);
+	AnimationTree::set_threaded_processing(animation_threads);
+
 	ClassDB::register_class<ShaderGlobalsOverride>(); //can be used in any shader
 
 	OS::get_singleton()->yield(); //may take time to init
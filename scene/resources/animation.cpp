@@ -1413,12 +1413,28 @@ void Animation::track_set_key_transition(int p_track, int p_key_idx, float p_tra
 }
 
 template <class K>
-int Animation::_find(const Vector<K> &p_keys, float p_time) const {
+int Animation::_find(const Vector<K> &p_keys, float p_time, int *p_key_cursor) const {
 	int len = p_keys.size();
 	if (len == 0) {
 		return -2;
 	}
 
+	if (p_key_cursor) {
+		// Check the last key found and the one after it before searching,
+		// which covers continuous playback. The result must be the same as
+		// the search below: the last key at or before p_time, or -1.
+		const K *keys = &p_keys[0];
+		int cursor = CLAMP(*p_key_cursor, -1, len - 1);
+		for (int i = cursor; i <= cursor + 1 && i < len; i++) {
+			bool after_key = i < 0 || p_time > keys[i].time || Math::is_equal_approx(p_time, keys[i].time);
+			bool before_next = i + 1 == len || (p_time < keys[i + 1].time && !Math::is_equal_approx(p_time, keys[i + 1].time));
+			if (after_key && before_next) {
+				*p_key_cursor = i;
+				return i;
+			}
+		}
+	}
+
 	int low = 0;
 	int high = len - 1;
 	int middle = 0;
@@ -1435,6 +1451,9 @@ int Animation::_find(const Vector<K> &p_keys, float p_time) const {
 		middle = (low + high) / 2;
 
 		if (Math::is_equal_approx(p_time, keys[middle].time)) { //match
+			if (p_key_cursor) {
+				*p_key_cursor = middle;
+			}
 			return middle;
 		} else if (p_time < keys[middle].time) {
 			high = middle - 1; //search low end of array
@@ -1447,9 +1466,22 @@ int Animation::_find(const Vector<K> &p_keys, float p_time) const {
 		middle--;
 	}
 
+	if (p_key_cursor) {
+		*p_key_cursor = middle;
+	}
+
 	return middle;
 }
 
+template <class K>
+int Animation::_get_key_count_in_length(const Vector<K> &p_keys) const {
+	int len = p_keys.size();
+	if (len > 0 && (p_keys[len - 1].time < length || Math::is_equal_approx(p_keys[len - 1].time, length))) {
+		return len; // No keys past the end, the common case, so skip the search.
+	}
+	return _find(p_keys, length) + 1; // There may be keys past the end.
+}
+
 Animation::TransformKey Animation::_interpolate(const Animation::TransformKey &p_a, const Animation::TransformKey &p_b, float p_c) const {
 	TransformKey ret;
 	ret.loc = _interpolate(p_a.loc, p_b.loc, p_c);
@@ -1585,8 +1617,8 @@ float Animation::_cubic_interpolate(const float &p_pre_a, const float &p_a, cons
 }
 
 template <class T>
-T Animation::_interpolate(const Vector<TKey<T>> &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok) const {
-	int len = _find(p_keys, length) + 1; // try to find last key (there may be more past the end)
+T Animation::_interpolate(const Vector<TKey<T>> &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok, int *p_key_cursor) const {
+	int len = _get_key_count_in_length(p_keys);
 
 	if (len <= 0) {
 		// (-1 or -2 returned originally) (plus one above)
@@ -1603,7 +1635,7 @@ T Animation::_interpolate(const Vector<TKey<T>> &p_keys, float p_time, Interpola
 		return p_keys[0].value;
 	}
 
-	int idx = _find(p_keys, p_time);
+	int idx = _find(p_keys, p_time, p_key_cursor);
 
 	ERR_FAIL_COND_V(idx == -2, T());
 
@@ -1729,7 +1761,7 @@ T Animation::_interpolate(const Vector<TKey<T>> &p_keys, float p_time, Interpola
 	// do a barrel roll
 }
 
-Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale) const {
+Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale, int *p_key_cursor) const {
 	ERR_FAIL_INDEX_V(p_track, tracks.size(), ERR_INVALID_PARAMETER);
 	Track *t = tracks[p_track];
 	ERR_FAIL_COND_V(t->type != TYPE_TRANSFORM, ERR_INVALID_PARAMETER);
@@ -1738,7 +1770,7 @@ Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3
 
 	bool ok = false;
 
-	TransformKey tk = _interpolate(tt->transforms, p_time, tt->interpolation, tt->loop_wrap, &ok);
+	TransformKey tk = _interpolate(tt->transforms, p_time, tt->interpolation, tt->loop_wrap, &ok, p_key_cursor);
 
 	if (!ok) {
 		return ERR_UNAVAILABLE;
@@ -1759,7 +1791,7 @@ Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3
 	return OK;
 }
 
-Variant Animation::value_track_interpolate(int p_track, float p_time) const {
+Variant Animation::value_track_interpolate(int p_track, float p_time, int *p_key_cursor) const {
 	ERR_FAIL_INDEX_V(p_track, tracks.size(), 0);
 	Track *t = tracks[p_track];
 	ERR_FAIL_COND_V(t->type != TYPE_VALUE, Variant());
@@ -1767,7 +1799,7 @@ Variant Animation::value_track_interpolate(int p_track, float p_time) const {
 
 	bool ok = false;
 
-	Variant res = _interpolate(vt->values, p_time, (vt->update_mode == UPDATE_CONTINUOUS || vt->update_mode == UPDATE_CAPTURE) ? vt->interpolation : INTERPOLATION_NEAREST, vt->loop_wrap, &ok);
+	Variant res = _interpolate(vt->values, p_time, (vt->update_mode == UPDATE_CONTINUOUS || vt->update_mode == UPDATE_CAPTURE) ? vt->interpolation : INTERPOLATION_NEAREST, vt->loop_wrap, &ok, p_key_cursor);
 
 	if (ok) {
 		return res;
@@ -2247,7 +2279,7 @@ static _FORCE_INLINE_ Vector2 _bezier_interp(real_t t, const Vector2 &start, con
 	return start * omt3 + control_1 * omt2 * t * 3.0 + control_2 * omt * t2 * 3.0 + end * t3;
 }
 
-float Animation::bezier_track_interpolate(int p_track, float p_time) const {
+float Animation::bezier_track_interpolate(int p_track, float p_time, int *p_key_cursor) const {
 	//this uses a different interpolation scheme
 	ERR_FAIL_INDEX_V(p_track, tracks.size(), 0);
 	Track *track = tracks[p_track];
@@ -2255,7 +2287,7 @@ float Animation::bezier_track_interpolate(int p_track, float p_time) const {
 
 	BezierTrack *bt = static_cast<BezierTrack *>(track);
 
-	int len = _find(bt->values, length) + 1; // try to find last key (there may be more past the end)
+	int len = _get_key_count_in_length(bt->values);
 
 	if (len <= 0) {
 		// (-1 or -2 returned originally) (plus one above)
@@ -2264,7 +2296,7 @@ float Animation::bezier_track_interpolate(int p_track, float p_time) const {
 		return bt->values[0].value.value;
 	}
 
-	int idx = _find(bt->values, p_time);
+	int idx = _find(bt->values, p_time, p_key_cursor);
 
 	ERR_FAIL_COND_V(idx == -2, 0);
 
@@ -2648,7 +2680,7 @@ void Animation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("bezier_track_get_key_in_handle", "track_idx", "key_idx"), &Animation::bezier_track_get_key_in_handle);
 	ClassDB::bind_method(D_METHOD("bezier_track_get_key_out_handle", "track_idx", "key_idx"), &Animation::bezier_track_get_key_out_handle);
 
-	ClassDB::bind_method(D_METHOD("bezier_track_interpolate", "track_idx", "time"), &Animation::bezier_track_interpolate);
+	ClassDB::bind_method(D_METHOD("bezier_track_interpolate", "track_idx", "time"), &Animation::_bezier_track_interpolate);
 
 	ClassDB::bind_method(D_METHOD("audio_track_insert_key", "track_idx", "time", "stream", "start_offset", "end_offset"), &Animation::audio_track_insert_key, DEFVAL(0), DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("audio_track_set_key_stream", "track_idx", "key_idx", "stream"), &Animation::audio_track_set_key_stream);
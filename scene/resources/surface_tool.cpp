@@ -30,6 +30,7 @@
 
 #include "surface_tool.h"
 
+#include "core/math/mesh_simplifier.h"
 #include "core/method_bind_ext.gen.inc"
 
 #define _VERTEX_SNAP 0.0001
@@ -885,6 +886,41 @@ void SurfaceTool::generate_tangents() {
 	format |= Mesh::ARRAY_FORMAT_TANGENT;
 }
 
+Vector<int> SurfaceTool::generate_lod(float p_max_error, int p_target_index_count) {
+	Vector<int> lod;
+
+	ERR_FAIL_COND_V(primitive != Mesh::PRIMITIVE_TRIANGLES, lod);
+	ERR_FAIL_COND_V_MSG(index_array.size() == 0, lod, "LODs can only be generated for indexed surfaces, call index() first.");
+
+	Vector<Vector3> vertices;
+	Vector<Vector3> normals;
+	vertices.resize(vertex_array.size());
+	if (format & Mesh::ARRAY_FORMAT_NORMAL) {
+		normals.resize(vertex_array.size());
+	}
+
+	Vector3 *vw = vertices.ptrw();
+	Vector3 *nw = normals.ptrw();
+	int idx = 0;
+	for (List<Vertex>::Element *E = vertex_array.front(); E; E = E->next()) {
+		vw[idx] = E->get().vertex;
+		if (nw) {
+			nw[idx] = E->get().normal;
+		}
+		idx++;
+	}
+
+	Vector<int> indices;
+	indices.resize(index_array.size());
+	int *iw = indices.ptrw();
+	idx = 0;
+	for (List<int>::Element *E = index_array.front(); E; E = E->next()) {
+		iw[idx++] = E->get();
+	}
+
+	return MeshSimplifier::simplify(vertices, normals, indices, p_target_index_count, p_max_error);
+}
+
 void SurfaceTool::generate_normals(bool p_flip) {
 	ERR_FAIL_COND(primitive != Mesh::PRIMITIVE_TRIANGLES);
 
@@ -1000,6 +1036,7 @@ void SurfaceTool::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("deindex"), &SurfaceTool::deindex);
 	ClassDB::bind_method(D_METHOD("generate_normals", "flip"), &SurfaceTool::generate_normals, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("generate_tangents"), &SurfaceTool::generate_tangents);
+	ClassDB::bind_method(D_METHOD("generate_lod", "max_error", "target_index_count"), &SurfaceTool::generate_lod, DEFVAL(3));
 
 	ClassDB::bind_method(D_METHOD("set_material", "material"), &SurfaceTool::set_material);
 
@@ -123,6 +123,7 @@ public:
 	void deindex();
 	void generate_normals(bool p_flip = false);
 	void generate_tangents();
+	Vector<int> generate_lod(float p_max_error, int p_target_index_count = 3);
 
 	void set_material(const Ref<Material> &p_material);
 
@@ -37,6 +37,7 @@
 class SceneStringNames {
 	friend void register_scene_types();
 	friend void unregister_scene_types();
+	friend int test_main(int argc, char *argv[]);
 
 	static SceneStringNames *singleton;
 
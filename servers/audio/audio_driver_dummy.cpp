@@ -33,6 +33,8 @@
 #include "core/os/os.h"
 #include "core/project_settings.h"
 
+AudioDriverDummy *AudioDriverDummy::singleton = nullptr;
+
 Error AudioDriverDummy::init() {
 	active = false;
 	thread_exited = false;
@@ -48,11 +50,59 @@ Error AudioDriverDummy::init() {
 
 	samples_in = memnew_arr(int32_t, buffer_frames * channels);
 
-	thread = Thread::create(AudioDriverDummy::thread_func, this);
+	frames_pending = 0;
+	mixed_frames = 0;
+	mix_usec = 0;
+
+	if (output_path != String()) {
+		output_file = FileAccess::open(output_path, FileAccess::WRITE);
+		if (output_file) {
+			// 16 bits PCM, sizes are patched in finish().
+			output_file->store_string("RIFF"); //ChunkID
+			output_file->store_32(36); //ChunkSize
+			output_file->store_string("WAVE"); //Format
+			output_file->store_string("fmt "); //Subchunk1ID
+			output_file->store_32(16); //Subchunk1Size
+			output_file->store_16(1); //AudioFormat
+			output_file->store_16(channels); //Number of Channels
+			output_file->store_32(mix_rate); //SampleRate
+			output_file->store_32(mix_rate * channels * 2); //ByteRate
+			output_file->store_16(channels * 2); //BlockAlign
+			output_file->store_16(16); //BitsPerSample
+			output_file->store_string("data"); //Subchunk2ID
+			output_file->store_32(0); //Subchunk2Size
+			output_data_size = 0;
+		} else {
+			ERR_PRINT("Can't open audio output file for writing: " + output_path);
+		}
+	}
+
+	if (use_threads) {
+		thread = Thread::create(AudioDriverDummy::thread_func, this);
+	}
 
 	return OK;
 };
 
+void AudioDriverDummy::mix_audio(int p_frames, int32_t *p_buffer) {
+	lock();
+
+	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+	audio_server_process(p_frames, p_buffer);
+	mix_usec += OS::get_singleton()->get_ticks_usec() - ticks;
+	mixed_frames += p_frames;
+
+	if (output_file) {
+		int samples = p_frames * channels;
+		for (int i = 0; i < samples; i++) {
+			output_file->store_16(uint16_t(p_buffer[i] >> 16));
+		}
+		output_data_size += samples * 2;
+	}
+
+	unlock();
+}
+
 void AudioDriverDummy::thread_func(void *p_udata) {
 	AudioDriverDummy *ad = (AudioDriverDummy *)p_udata;
 
@@ -60,11 +110,7 @@ void AudioDriverDummy::thread_func(void *p_udata) {
 
 	while (!ad->exit_thread) {
 		if (ad->active) {
-			ad->lock();
-
-			ad->audio_server_process(ad->buffer_frames, ad->samples_in);
-
-			ad->unlock();
+			ad->mix_audio(ad->buffer_frames, ad->samples_in);
 		};
 
 		OS::get_singleton()->delay_usec(usdelay);
@@ -74,9 +120,33 @@ void AudioDriverDummy::thread_func(void *p_udata) {
 };
 
 void AudioDriverDummy::start() {
+	if (!use_threads) {
+		AudioServer::get_singleton()->set_mix_cost_tracking(true);
+	}
 	active = true;
 };
 
+void AudioDriverDummy::set_use_threads(bool p_use_threads) {
+	use_threads = p_use_threads;
+}
+
+void AudioDriverDummy::set_output_file(const String &p_path) {
+	output_path = p_path;
+}
+
+void AudioDriverDummy::advance(double p_time) {
+	ERR_FAIL_COND(thread);
+	if (!active) {
+		return;
+	}
+
+	frames_pending += p_time * mix_rate;
+	while (frames_pending >= buffer_frames) {
+		mix_audio(buffer_frames, samples_in);
+		frames_pending -= buffer_frames;
+	}
+}
+
 int AudioDriverDummy::get_mix_rate() const {
 	return mix_rate;
 };
@@ -99,18 +169,49 @@ void AudioDriverDummy::unlock() {
 	mutex.unlock();
 };
 
-void AudioDriverDummy::finish() {
-	if (!thread) {
+void AudioDriverDummy::print_mix_costs() {
+	AudioServer *as = AudioServer::get_singleton();
+	if (!mixed_frames || !as || !as->is_mix_cost_tracking()) {
 		return;
 	}
 
-	exit_thread = true;
-	Thread::wait_to_finish(thread);
+	double audio_usec = mixed_frames * 1000000.0 / mix_rate;
+	print_line(vformat("Audio: rendered %.2f s in %.2f s (%.1fx realtime).", audio_usec / 1000000.0, mix_usec / 1000000.0, mix_usec ? audio_usec / mix_usec : 0.0));
+	print_line(vformat("  Voices: %.2f%%", as->get_voices_mix_cost() * 100.0 / audio_usec));
+	for (int i = 0; i < as->get_bus_count(); i++) {
+		print_line(vformat("  Bus \"%s\": %.2f%%", as->get_bus_name(i), as->get_bus_mix_cost(i) * 100.0 / audio_usec));
+		for (int j = 0; j < as->get_bus_effect_count(i); j++) {
+			Ref<AudioEffect> effect = as->get_bus_effect(i, j);
+			print_line(vformat("    %s: %.2f%%", effect->get_class(), as->get_bus_effect_mix_cost(i, j) * 100.0 / audio_usec));
+		}
+	}
+}
+
+void AudioDriverDummy::finish() {
+	if (thread) {
+		exit_thread = true;
+		Thread::wait_to_finish(thread);
+
+		memdelete(thread);
+		thread = nullptr;
+	}
+
+	if (output_file) {
+		output_file->seek(4);
+		output_file->store_32(output_data_size + 36);
+		output_file->seek(40);
+		output_file->store_32(output_data_size);
+		output_file->close();
+		memdelete(output_file);
+		output_file = nullptr;
+	}
+
+	if (!use_threads) {
+		print_mix_costs();
+	}
 
 	if (samples_in) {
 		memdelete_arr(samples_in);
+		samples_in = nullptr;
 	};
-
-	memdelete(thread);
-	thread = nullptr;
 };
@@ -33,17 +33,32 @@
 
 #include "servers/audio_server.h"
 
+#include "core/os/file_access.h"
 #include "core/os/mutex.h"
 #include "core/os/thread.h"
 
 class AudioDriverDummy : public AudioDriver {
+	static AudioDriverDummy *singleton;
+
 	Thread *thread = nullptr;
 	Mutex mutex;
 
-	int32_t *samples_in;
+	int32_t *samples_in = nullptr;
 
 	static void thread_func(void *p_udata);
 
+	// Offline rendering, mixing is driven by advance() instead of the thread.
+	bool use_threads = true;
+	String output_path;
+	FileAccess *output_file = nullptr;
+	uint64_t output_data_size = 0;
+	double frames_pending = 0;
+	uint64_t mixed_frames = 0;
+	uint64_t mix_usec = 0;
+
+	void mix_audio(int p_frames, int32_t *p_buffer);
+	void print_mix_costs();
+
 	unsigned int buffer_frames;
 	unsigned int mix_rate;
 	SpeakerMode speaker_mode;
@@ -67,7 +82,15 @@ public:
 	virtual void unlock();
 	virtual void finish();
 
-	AudioDriverDummy() {}
+	// Must be called before init(). Without threads, audio is only mixed
+	// when calling advance(), as fast as the caller goes.
+	void set_use_threads(bool p_use_threads);
+	void set_output_file(const String &p_path);
+	void advance(double p_time);
+
+	static AudioDriverDummy *get_dummy_singleton() { return singleton; }
+
+	AudioDriverDummy() { singleton = this; }
 	~AudioDriverDummy() {}
 };
 
@@ -244,17 +244,20 @@ void AudioFilterSW::Processor::update_coeffs(int p_interp_buffer_len) {
 		return;
 	}
 
+	Coeffs new_coeffs;
+	filter->prepare_coefficients(&new_coeffs);
+	update_coeffs(new_coeffs, p_interp_buffer_len);
+}
+
+void AudioFilterSW::Processor::update_coeffs(const Coeffs &p_coeffs, int p_interp_buffer_len) {
 	if (p_interp_buffer_len) { //interpolate
-		Coeffs old_coeffs = coeffs;
-		filter->prepare_coefficients(&coeffs);
-		incr_coeffs.a1 = (coeffs.a1 - old_coeffs.a1) / p_interp_buffer_len;
-		incr_coeffs.a2 = (coeffs.a2 - old_coeffs.a2) / p_interp_buffer_len;
-		incr_coeffs.b0 = (coeffs.b0 - old_coeffs.b0) / p_interp_buffer_len;
-		incr_coeffs.b1 = (coeffs.b1 - old_coeffs.b1) / p_interp_buffer_len;
-		incr_coeffs.b2 = (coeffs.b2 - old_coeffs.b2) / p_interp_buffer_len;
-		coeffs = old_coeffs;
+		incr_coeffs.a1 = (p_coeffs.a1 - coeffs.a1) / p_interp_buffer_len;
+		incr_coeffs.a2 = (p_coeffs.a2 - coeffs.a2) / p_interp_buffer_len;
+		incr_coeffs.b0 = (p_coeffs.b0 - coeffs.b0) / p_interp_buffer_len;
+		incr_coeffs.b1 = (p_coeffs.b1 - coeffs.b1) / p_interp_buffer_len;
+		incr_coeffs.b2 = (p_coeffs.b2 - coeffs.b2) / p_interp_buffer_len;
 	} else {
-		filter->prepare_coefficients(&coeffs);
+		coeffs = p_coeffs;
 	}
 }
 
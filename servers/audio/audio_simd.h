@@ -0,0 +1,166 @@
+/*************************************************************************/
+/*  audio_simd.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AUDIO_SIMD_H
+#define AUDIO_SIMD_H
+
+#include "core/math/audio_frame.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_USE_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AUDIO_USE_NEON
+#include <arm_neon.h>
+#endif
+
+// Kernels for the hot loops of the mixer, working on buffers of AudioFrame.
+// A frame is two packed floats, so a 128 bits register holds two of them.
+// Buffers don't need to be aligned, odd frame counts finish on scalar code.
+class AudioSIMD {
+public:
+	static const int INT32_SCALE_BITS = 11;
+
+	// p_dst += p_src
+	static void mix(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) {
+		int i = 0;
+#if defined(AUDIO_USE_SSE)
+		for (; i + 2 <= p_frames; i += 2) {
+			_mm_storeu_ps(&p_dst[i].l, _mm_add_ps(_mm_loadu_ps(&p_dst[i].l), _mm_loadu_ps(&p_src[i].l)));
+		}
+#elif defined(AUDIO_USE_NEON)
+		for (; i + 2 <= p_frames; i += 2) {
+			vst1q_f32(&p_dst[i].l, vaddq_f32(vld1q_f32(&p_dst[i].l), vld1q_f32(&p_src[i].l)));
+		}
+#endif
+		for (; i < p_frames; i++) {
+			p_dst[i] += p_src[i];
+		}
+	}
+
+	// p_dst += p_src * p_vol, with p_vol increasing by p_vol_inc after every frame.
+	static void mix_ramp(AudioFrame *p_dst, const AudioFrame *p_src, AudioFrame p_vol, const AudioFrame &p_vol_inc, int p_frames) {
+		int i = 0;
+#if defined(AUDIO_USE_SSE)
+		__m128 vol = _mm_setr_ps(p_vol.l, p_vol.r, p_vol.l + p_vol_inc.l, p_vol.r + p_vol_inc.r);
+		__m128 inc = _mm_setr_ps(p_vol_inc.l * 2.0, p_vol_inc.r * 2.0, p_vol_inc.l * 2.0, p_vol_inc.r * 2.0);
+		for (; i + 2 <= p_frames; i += 2) {
+			_mm_storeu_ps(&p_dst[i].l, _mm_add_ps(_mm_loadu_ps(&p_dst[i].l), _mm_mul_ps(_mm_loadu_ps(&p_src[i].l), vol)));
+			vol = _mm_add_ps(vol, inc);
+		}
+		p_vol = p_vol + p_vol_inc * float(i);
+#elif defined(AUDIO_USE_NEON)
+		const float vol_init[4] = { p_vol.l, p_vol.r, p_vol.l + p_vol_inc.l, p_vol.r + p_vol_inc.r };
+		const float inc_init[4] = { p_vol_inc.l * 2.0f, p_vol_inc.r * 2.0f, p_vol_inc.l * 2.0f, p_vol_inc.r * 2.0f };
+		float32x4_t vol = vld1q_f32(vol_init);
+		float32x4_t inc = vld1q_f32(inc_init);
+		for (; i + 2 <= p_frames; i += 2) {
+			vst1q_f32(&p_dst[i].l, vmlaq_f32(vld1q_f32(&p_dst[i].l), vld1q_f32(&p_src[i].l), vol));
+			vol = vaddq_f32(vol, inc);
+		}
+		p_vol = p_vol + p_vol_inc * float(i);
+#endif
+		for (; i < p_frames; i++) {
+			p_dst[i] += p_src[i] * p_vol;
+			p_vol += p_vol_inc;
+		}
+	}
+
+	// p_buffer *= p_vol, returns the peak absolute value of each side.
+	static AudioFrame scale_peak(AudioFrame *p_buffer, float p_vol, int p_frames) {
+		AudioFrame peak(0, 0);
+		int i = 0;
+#if defined(AUDIO_USE_SSE)
+		__m128 vol = _mm_set1_ps(p_vol);
+		__m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		__m128 vpeak = _mm_setzero_ps();
+		for (; i + 2 <= p_frames; i += 2) {
+			__m128 v = _mm_mul_ps(_mm_loadu_ps(&p_buffer[i].l), vol);
+			_mm_storeu_ps(&p_buffer[i].l, v);
+			vpeak = _mm_max_ps(vpeak, _mm_and_ps(v, abs_mask));
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, vpeak);
+		peak = AudioFrame(MAX(lanes[0], lanes[2]), MAX(lanes[1], lanes[3]));
+#elif defined(AUDIO_USE_NEON)
+		float32x4_t vpeak = vdupq_n_f32(0);
+		for (; i + 2 <= p_frames; i += 2) {
+			float32x4_t v = vmulq_n_f32(vld1q_f32(&p_buffer[i].l), p_vol);
+			vst1q_f32(&p_buffer[i].l, v);
+			vpeak = vmaxq_f32(vpeak, vabsq_f32(v));
+		}
+		float lanes[4];
+		vst1q_f32(lanes, vpeak);
+		peak = AudioFrame(MAX(lanes[0], lanes[2]), MAX(lanes[1], lanes[3]));
+#endif
+		for (; i < p_frames; i++) {
+			p_buffer[i] *= p_vol;
+			peak.l = MAX(peak.l, ABS(p_buffer[i].l));
+			peak.r = MAX(peak.r, ABS(p_buffer[i].r));
+		}
+		return peak;
+	}
+
+	// Clamps to [-1, 1] and converts to the 32 bits format drivers take, with
+	// 20 bits of precision. Consecutive frames are p_dst_stride samples apart.
+	static void to_int32(const AudioFrame *p_src, int32_t *p_dst, int p_dst_stride, int p_frames) {
+		int i = 0;
+#if defined(AUDIO_USE_SSE)
+		__m128 one = _mm_set1_ps(1.0);
+		__m128 minus_one = _mm_set1_ps(-1.0);
+		__m128 scale = _mm_set1_ps((1 << 20) - 1);
+		for (; i + 2 <= p_frames; i += 2) {
+			__m128 v = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(&p_src[i].l), one), minus_one);
+			__m128i s = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(v, scale)), INT32_SCALE_BITS);
+			if (p_dst_stride == 2) {
+				_mm_storeu_si128((__m128i *)&p_dst[i * 2], s);
+			} else {
+				_mm_storel_epi64((__m128i *)&p_dst[i * p_dst_stride], s);
+				_mm_storel_epi64((__m128i *)&p_dst[(i + 1) * p_dst_stride], _mm_unpackhi_epi64(s, s));
+			}
+		}
+#elif defined(AUDIO_USE_NEON)
+		for (; i + 2 <= p_frames; i += 2) {
+			float32x4_t v = vmaxq_f32(vminq_f32(vld1q_f32(&p_src[i].l), vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f));
+			int32x4_t s = vshlq_n_s32(vcvtq_s32_f32(vmulq_n_f32(v, (1 << 20) - 1)), INT32_SCALE_BITS);
+			vst1_s32(&p_dst[i * p_dst_stride], vget_low_s32(s));
+			vst1_s32(&p_dst[(i + 1) * p_dst_stride], vget_high_s32(s));
+		}
+#endif
+		for (; i < p_frames; i++) {
+			float l = CLAMP(p_src[i].l, -1.0, 1.0);
+			float r = CLAMP(p_src[i].r, -1.0, 1.0);
+			p_dst[i * p_dst_stride + 0] = int32_t(l * ((1 << 20) - 1)) * (1 << INT32_SCALE_BITS);
+			p_dst[i * p_dst_stride + 1] = int32_t(r * ((1 << 20) - 1)) * (1 << INT32_SCALE_BITS);
+		}
+	}
+};
+
+#endif // AUDIO_SIMD_H
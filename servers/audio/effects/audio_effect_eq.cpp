@@ -29,45 +29,103 @@
 /*************************************************************************/
 
 #include "audio_effect_eq.h"
+#include "servers/audio/audio_simd.h"
 #include "servers/audio_server.h"
 
 void AudioEffectEQInstance::process(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) {
-	int band_count = bands[0].size();
-	EQ::BandProcess *proc_l = bands[0].ptrw();
-	EQ::BandProcess *proc_r = bands[1].ptrw();
-	float *bgain = gains.ptrw();
+	BandPair *pairs = band_pairs.ptr();
+	int pair_count = band_pairs.size();
+
 	for (int i = 0; i < band_count; i++) {
-		bgain[i] = Math::db2linear(base->gain[i]);
+		float gain = Math::db2linear(base->gain[i]);
+		pairs[i / 2].gain[(i % 2) * 2 + 0] = gain;
+		pairs[i / 2].gain[(i % 2) * 2 + 1] = gain;
 	}
 
+	AudioFrame a2 = input_history[0];
+	AudioFrame a3 = input_history[1];
+
 	for (int i = 0; i < p_frame_count; i++) {
 		AudioFrame src = p_src_frames[i];
-		AudioFrame dst = AudioFrame(0, 0);
-
-		for (int j = 0; j < band_count; j++) {
-			float l = src.l;
-			float r = src.r;
-
-			proc_l[j].process_one(l);
-			proc_r[j].process_one(r);
-
-			dst.l += l * bgain[j];
-			dst.r += r * bgain[j];
+		AudioFrame dst;
+
+#if defined(AUDIO_USE_SSE)
+		__m128 in = _mm_setr_ps(src.l - a3.l, src.r - a3.r, src.l - a3.l, src.r - a3.r);
+		__m128 acc = _mm_setzero_ps();
+		for (int j = 0; j < pair_count; j++) {
+			BandPair &p = pairs[j];
+			__m128 b2 = _mm_loadu_ps(p.b2);
+			__m128 b1 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p.c1), in), _mm_mul_ps(_mm_loadu_ps(p.c3), b2)), _mm_mul_ps(_mm_loadu_ps(p.c2), _mm_loadu_ps(p.b3)));
+			_mm_storeu_ps(p.b3, b2);
+			_mm_storeu_ps(p.b2, b1);
+			acc = _mm_add_ps(acc, _mm_mul_ps(b1, _mm_loadu_ps(p.gain)));
 		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, acc);
+		dst = AudioFrame(lanes[0] + lanes[2], lanes[1] + lanes[3]);
+#elif defined(AUDIO_USE_NEON)
+		const float in_lanes[4] = { src.l - a3.l, src.r - a3.r, src.l - a3.l, src.r - a3.r };
+		float32x4_t in = vld1q_f32(in_lanes);
+		float32x4_t acc = vdupq_n_f32(0);
+		for (int j = 0; j < pair_count; j++) {
+			BandPair &p = pairs[j];
+			float32x4_t b2 = vld1q_f32(p.b2);
+			float32x4_t b1 = vmlsq_f32(vmlaq_f32(vmulq_f32(vld1q_f32(p.c1), in), vld1q_f32(p.c3), b2), vld1q_f32(p.c2), vld1q_f32(p.b3));
+			vst1q_f32(p.b3, b2);
+			vst1q_f32(p.b2, b1);
+			acc = vmlaq_f32(acc, b1, vld1q_f32(p.gain));
+		}
+		float lanes[4];
+		vst1q_f32(lanes, acc);
+		dst = AudioFrame(lanes[0] + lanes[2], lanes[1] + lanes[3]);
+#else
+		const float in[4] = { src.l - a3.l, src.r - a3.r, src.l - a3.l, src.r - a3.r };
+		float acc[4] = { 0, 0, 0, 0 };
+		for (int j = 0; j < pair_count; j++) {
+			BandPair &p = pairs[j];
+			for (int k = 0; k < 4; k++) {
+				float b1 = p.c1[k] * in[k] + p.c3[k] * p.b2[k] - p.c2[k] * p.b3[k];
+				p.b3[k] = p.b2[k];
+				p.b2[k] = b1;
+				acc[k] += b1 * p.gain[k];
+			}
+		}
+		dst = AudioFrame(acc[0] + acc[2], acc[1] + acc[3]);
+#endif
+
+		a3 = a2;
+		a2 = src;
 
 		p_dst_frames[i] = dst;
 	}
+
+	input_history[0] = a2;
+	input_history[1] = a3;
 }
 
 Ref<AudioEffectInstance> AudioEffectEQ::instance() {
 	Ref<AudioEffectEQInstance> ins;
 	ins.instance();
 	ins->base = Ref<AudioEffectEQ>(this);
-	ins->gains.resize(eq.get_band_count());
-	for (int i = 0; i < 2; i++) {
-		ins->bands[i].resize(eq.get_band_count());
-		for (int j = 0; j < ins->bands[i].size(); j++) {
-			ins->bands[i].write[j] = eq.get_band_processor(j);
+	ins->band_count = eq.get_band_count();
+	ins->band_pairs.resize((ins->band_count + 1) / 2);
+	ins->input_history[0] = AudioFrame(0, 0);
+	ins->input_history[1] = AudioFrame(0, 0);
+
+	for (uint32_t i = 0; i < ins->band_pairs.size(); i++) {
+		AudioEffectEQInstance::BandPair &pair = ins->band_pairs[i];
+		for (int k = 0; k < 4; k++) {
+			int band = i * 2 + k / 2;
+			float c1 = 0, c2 = 0, c3 = 0; // A missing last band stays silent.
+			if (band < ins->band_count) {
+				eq.get_band_coefficients(band, c1, c2, c3);
+			}
+			pair.c1[k] = c1;
+			pair.c2[k] = c2;
+			pair.c3[k] = c3;
+			pair.gain[k] = 0;
+			pair.b2[k] = 0;
+			pair.b3[k] = 0;
 		}
 	}
 
@@ -31,6 +31,7 @@
 #ifndef AUDIOEFFECTEQ_H
 #define AUDIOEFFECTEQ_H
 
+#include "core/local_vector.h"
 #include "servers/audio/audio_effect.h"
 #include "servers/audio/effects/eq.h"
 
@@ -41,8 +42,21 @@ class AudioEffectEQInstance : public AudioEffectInstance {
 	friend class AudioEffectEQ;
 	Ref<AudioEffectEQ> base;
 
-	Vector<EQ::BandProcess> bands[2];
-	Vector<float> gains;
+	// Bands are all fed the same input, so they are processed side by side:
+	// two bands for both channels at once, laid out as [band L, band R,
+	// next band L, next band R] to fill a SIMD register.
+	struct BandPair {
+		float c1[4];
+		float c2[4];
+		float c3[4];
+		float gain[4];
+		float b2[4];
+		float b3[4];
+	};
+
+	LocalVector<BandPair> band_pairs;
+	int band_count = 0;
+	AudioFrame input_history[2]; // Previous two inputs, shared by every band.
 
 public:
 	virtual void process(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) override;
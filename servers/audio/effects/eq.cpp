@@ -195,6 +195,14 @@ EQ::BandProcess EQ::get_band_processor(int p_band) const {
 	return band_proc;
 }
 
+void EQ::get_band_coefficients(int p_band, float &r_c1, float &r_c2, float &r_c3) const {
+	ERR_FAIL_INDEX(p_band, band.size());
+
+	r_c1 = band[p_band].c1;
+	r_c2 = band[p_band].c2;
+	r_c3 = band[p_band].c3;
+}
+
 EQ::EQ() {
 	mix_rate = 44100;
 }
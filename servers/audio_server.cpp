@@ -35,8 +35,11 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "core/thread_work_pool.h"
 #include "scene/resources/audio_stream_sample.h"
 #include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_simd.h"
+#include "servers/audio/audio_stream.h"
 #include "servers/audio/effects/audio_effect_compressor.h"
 
 #ifdef TOOLS_ENABLED
@@ -256,18 +259,7 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 		for (int k = 0; k < cs; k++) {
 			if (master->channels[k].active) {
 				const AudioFrame *buf = master->channels[k].buffer.ptr();
-
-				for (int j = 0; j < to_copy; j++) {
-					float l = CLAMP(buf[from + j].l, -1.0, 1.0);
-					int32_t vl = l * ((1 << 20) - 1);
-					int32_t vl2 = (vl < 0 ? -1 : 1) * (ABS(vl) << 11);
-					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 0] = vl2;
-
-					float r = CLAMP(buf[from + j].r, -1.0, 1.0);
-					int32_t vr = r * ((1 << 20) - 1);
-					int32_t vr2 = (vr < 0 ? -1 : 1) * (ABS(vr) << 11);
-					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 1] = vr2;
-				}
+				AudioSIMD::to_int32(&buf[from], &p_buffer[from_buf * (cs * 2) + k * 2], cs * 2, to_copy);
 
 			} else {
 				for (int j = 0; j < to_copy; j++) {
@@ -287,7 +279,8 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 }
 
 void AudioServer::_mix_step() {
-	bool solo_mode = false;
+	uint64_t step_ticks = track_mix_costs ? OS::get_singleton()->get_ticks_usec() : 0;
+	solo_mode = false;
 
 	for (int i = 0; i < buses.size(); i++) {
 		Bus *bus = buses[i];
@@ -325,134 +318,398 @@ void AudioServer::_mix_step() {
 	}
 
 	//make callbacks for mixing the audio
-	for (Set<CallbackItem>::Element *E = callbacks.front(); E; E = E->next()) {
-		E->get().callback(E->get().userdata);
+	for (uint32_t i = 0; i < callbacks.size(); i++) {
+		callbacks[i].callback(callbacks[i].userdata);
+	}
+
+	if (track_mix_costs) {
+		uint64_t voice_ticks = OS::get_singleton()->get_ticks_usec();
+		_mix_voices();
+		voices_mix_cost += OS::get_singleton()->get_ticks_usec() - voice_ticks;
+	} else {
+		_mix_voices();
+	}
+
+	//build the mix graph, a bus is ready once every bus sending to it was mixed
+	int level_count = 1;
+	for (int i = 0; i < buses.size(); i++) {
+		buses[i]->level = 0;
+		buses[i]->inputs.clear();
 	}
 
 	for (int i = buses.size() - 1; i >= 0; i--) {
-		//go bus by bus
 		Bus *bus = buses[i];
 
-		for (int k = 0; k < bus->channels.size(); k++) {
-			if (bus->channels[k].active && !bus->channels[k].used) {
-				//buffer was not used, but it's still active, so it must be cleaned
-				AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
-
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					buf[j] = AudioFrame(0, 0);
+		bus->has_effects = false;
+		if (!bus->bypass) {
+			for (int j = 0; j < bus->effects.size(); j++) {
+				if (bus->effects[j].enabled) {
+					bus->has_effects = true;
+					break;
 				}
 			}
 		}
 
-		//process effects
-		if (!bus->bypass) {
-			for (int j = 0; j < bus->effects.size(); j++) {
-				if (!bus->effects[j].enabled) {
-					continue;
+		bus->send_index = -1;
+		if (i > 0) {
+			//everything has a send save for master bus
+			Bus *send = buses[0];
+			if (bus_map.has(bus->send)) {
+				send = bus_map[bus->send];
+				if (send->index_cache >= bus->index_cache) { //invalid, send to master
+					send = buses[0];
 				}
+			}
+
+			bus->send_index = send->index_cache;
+			send->inputs.push_back(i); // Descending, the order buses used to be sent in.
+			send->level = MAX(send->level, bus->level + 1);
+			level_count = MAX(level_count, send->level + 1);
+		}
+	}
+
+	mix_level_offsets.resize(level_count + 1);
+	for (int i = 0; i <= level_count; i++) {
+		mix_level_offsets[i] = 0;
+	}
+	for (int i = 0; i < buses.size(); i++) {
+		mix_level_offsets[buses[i]->level + 1]++;
+	}
+	for (int i = 0; i < level_count; i++) {
+		mix_level_offsets[i + 1] += mix_level_offsets[i];
+	}
+
+	mix_order.resize(buses.size());
+	for (int i = buses.size() - 1; i >= 0; i--) {
+		mix_order[mix_level_offsets[buses[i]->level]++] = i;
+	}
+	for (int i = level_count; i > 0; i--) {
+		mix_level_offsets[i] = mix_level_offsets[i - 1];
+	}
+	mix_level_offsets[0] = 0;
+
+	//buses on the same level don't depend on each other
+	for (int i = 0; i < level_count; i++) {
+		uint32_t from = mix_level_offsets[i];
+		uint32_t count = mix_level_offsets[i + 1] - from;
+
+		int with_effects = 0;
+		for (uint32_t j = from; j < from + count; j++) {
+			if (buses[mix_order[j]]->has_effects) {
+				with_effects++;
+			}
+		}
+
+		// Only worth it when there are several effect chains to run.
+		ThreadWorkPool *pool = use_threads && with_effects > 1 ? ThreadWorkPool::get_singleton() : nullptr;
+		if (pool) {
+			pool->do_work(count, this, &AudioServer::_mix_bus_task, mix_order.ptr() + from);
+		} else {
+			for (uint32_t j = from; j < from + count; j++) {
+				_mix_bus(mix_order[j]);
+			}
+		}
+	}
+
+	mix_frames += buffer_size;
+	to_mix = buffer_size;
+
+	if (track_mix_costs) {
+		mix_cost += OS::get_singleton()->get_ticks_usec() - step_ticks;
+	}
+}
+
+void AudioServer::_mix_bus_task(uint32_t p_index, const int *p_buses) {
+	_mix_bus(p_buses[p_index]);
+}
+
+void AudioServer::_mix_bus(int p_bus) {
+	Bus *bus = buses[p_bus];
+	uint64_t bus_ticks = track_mix_costs ? OS::get_singleton()->get_ticks_usec() : 0;
+
+	//take what the buses sending here mixed
+	for (uint32_t i = 0; i < bus->inputs.size(); i++) {
+		const Bus *input = buses[bus->inputs[i]];
+		for (int k = 0; k < input->channels.size(); k++) {
+			if (input->channels[k].sending) {
+				AudioSIMD::mix(thread_get_channel_mix_buffer(p_bus, k), input->channels[k].buffer.ptr(), buffer_size);
+			}
+		}
+	}
+
+	for (int k = 0; k < bus->channels.size(); k++) {
+		if (bus->channels[k].active && !bus->channels[k].used) {
+			//buffer was not used, but it's still active, so it must be cleaned
+			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+
+			for (uint32_t j = 0; j < buffer_size; j++) {
+				buf[j] = AudioFrame(0, 0);
+			}
+		}
+	}
 
+	//process effects
+	if (!bus->bypass) {
+		for (int j = 0; j < bus->effects.size(); j++) {
+			if (!bus->effects[j].enabled) {
+				continue;
+			}
+
+			bool timed = track_mix_costs;
 #ifdef DEBUG_ENABLED
-				uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+			timed = true;
 #endif
+			uint64_t ticks = timed ? OS::get_singleton()->get_ticks_usec() : 0;
 
-				for (int k = 0; k < bus->channels.size(); k++) {
-					if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
-						continue;
-					}
-					bus->channels.write[k].effect_instances.write[j]->process(bus->channels[k].buffer.ptr(), temp_buffer.write[k].ptrw(), buffer_size);
+			for (int k = 0; k < bus->channels.size(); k++) {
+				if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
+					continue;
 				}
+				Bus::Channel &channel = bus->channels.write[k];
+				channel.effect_instances.write[j]->process(channel.buffer.ptr(), channel.effect_buffer.ptrw(), buffer_size);
 
 				//swap buffers, so internal buffer always has the right data
-				for (int k = 0; k < bus->channels.size(); k++) {
-					if (!(buses[i]->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
-						continue;
-					}
-					SWAP(bus->channels.write[k].buffer, temp_buffer.write[k]);
-				}
+				SWAP(channel.buffer, channel.effect_buffer);
+			}
 
+			if (timed) {
+				uint64_t time = OS::get_singleton()->get_ticks_usec() - ticks;
 #ifdef DEBUG_ENABLED
-				bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - ticks;
+				bus->effects.write[j].prof_time += time;
 #endif
+				if (track_mix_costs) {
+					bus->effects.write[j].mix_cost += time;
+				}
 			}
 		}
+	}
 
-		//process send
+	for (int k = 0; k < bus->channels.size(); k++) {
+		bus->channels.write[k].sending = false;
 
-		Bus *send = nullptr;
+		if (!bus->channels[k].active) {
+			continue;
+		}
 
-		if (i > 0) {
-			//everything has a send save for master bus
-			if (!bus_map.has(bus->send)) {
-				send = buses[0];
-			} else {
-				send = bus_map[bus->send];
-				if (send->index_cache >= bus->index_cache) { //invalid, send to master
-					send = buses[0];
-				}
+		AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+
+		float volume = Math::db2linear(bus->volume_db);
+
+		if (solo_mode) {
+			if (!bus->soloed) {
+				volume = 0.0;
+			}
+		} else {
+			if (bus->mute) {
+				volume = 0.0;
 			}
 		}
 
-		for (int k = 0; k < bus->channels.size(); k++) {
-			if (!bus->channels[k].active) {
-				continue;
+		//apply volume and compute peak
+		AudioFrame peak = AudioSIMD::scale_peak(buf, volume, buffer_size);
+
+		bus->channels.write[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+
+		if (!bus->channels[k].used) {
+			//see if any audio is contained, because channel was not used
+
+			if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
+				bus->channels.write[k].last_mix_with_audio = mix_frames;
+			} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
+				bus->channels.write[k].active = false;
+				continue; //went inactive, don't mix.
 			}
+		}
 
-			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+		//if not master bus, the send bus takes it
+		bus->channels.write[k].sending = bus->send_index >= 0;
+	}
 
-			AudioFrame peak = AudioFrame(0, 0);
+	if (track_mix_costs) {
+		bus->mix_cost += OS::get_singleton()->get_ticks_usec() - bus_ticks;
+	}
+}
 
-			float volume = Math::db2linear(bus->volume_db);
+void AudioServer::_mix_voices() {
+	mixing_voices.clear();
 
-			if (solo_mode) {
-				if (!bus->soloed) {
-					volume = 0.0;
-				}
-			} else {
-				if (bus->mute) {
-					volume = 0.0;
-				}
+	for (uint32_t i = 0; i < voice_capacity; i++) {
+		Voice &voice = voices[i];
+		if (!voice.used || !voice.active) {
+			continue;
+		}
+
+		if (voice.params_pending.load(std::memory_order_acquire)) {
+			voice.params = voice.pending_params;
+			voice.has_params = true;
+			voice.params_pending.store(false, std::memory_order_release);
+		}
+
+		if (!voice.has_params || (voice.paused && !voice.fade_out)) {
+			continue;
+		}
+
+		VoiceSort vs;
+		vs.index = i;
+		vs.bus_index = voice.params.output_count ? voice.params.outputs[0].bus_index : -1;
+		mixing_voices.push_back(vs);
+	}
+
+	// Voices sending to the same bus are mixed one after the other, so its buffers stay in cache.
+	mixing_voices.sort();
+
+	for (uint32_t i = 0; i < mixing_voices.size(); i++) {
+		_mix_voice(voices[mixing_voices[i].index]);
+	}
+}
+
+void AudioServer::_mix_voice(Voice &p_voice) {
+	const VoiceParams &params = p_voice.params;
+
+	bool started = false;
+	if (p_voice.seek_pos >= 0.0) {
+		p_voice.playback->start(p_voice.seek_pos);
+		p_voice.seek_pos = -1.0; //reset seek
+		started = true;
+	}
+
+	AudioFrame *buffer = voice_buffer.ptrw();
+	int frames = buffer_size;
+
+	if (p_voice.fade_out) {
+		// Short fadeout ramp
+		frames = MIN(frames, 128);
+	}
+
+	if (params.output_count > 0 || params.mix_without_outputs) {
+		float output_pitch_scale = 1.0;
+		if (params.output_count) {
+			//used for doppler, not realistic but good enough
+			output_pitch_scale = 0.0;
+			for (int i = 0; i < params.output_count; i++) {
+				output_pitch_scale += params.outputs[i].pitch_scale;
 			}
+			output_pitch_scale /= float(params.output_count);
+		}
 
-			//apply volume and compute peak
-			for (uint32_t j = 0; j < buffer_size; j++) {
-				buf[j] *= volume;
+		p_voice.playback->mix(buffer, params.pitch_scale * output_pitch_scale, frames);
+	}
 
-				float l = ABS(buf[j].l);
-				if (l > peak.l) {
-					peak.l = l;
-				}
-				float r = ABS(buf[j].r);
-				if (r > peak.r) {
-					peak.r = r;
+	float mix_rate = get_mix_rate();
+	float audibility = 0.0;
+
+	//write all outputs
+	for (int i = 0; i < params.output_count; i++) {
+		const VoiceOutput &current = params.outputs[i];
+
+		//see if current output exists, to keep volume ramp
+		bool found = false;
+		for (int j = i; j < p_voice.prev_output_count; j++) {
+			if (p_voice.prev_outputs[j].output.listener == current.listener) {
+				if (j != i) {
+					SWAP(p_voice.prev_outputs[j], p_voice.prev_outputs[i]);
 				}
+				found = true;
+				break;
+			}
+		}
+
+		Voice::OutputState &state = p_voice.prev_outputs[i];
+		bool interpolate_filter = !started;
+
+		if (!found) {
+			//create new if was not used before
+			if (p_voice.prev_output_count < VOICE_MAX_OUTPUTS) {
+				p_voice.prev_outputs[p_voice.prev_output_count] = state; //may be owned by another listener
+				p_voice.prev_output_count++;
 			}
+			state.output = current;
+			interpolate_filter = false;
+		}
+
+		// Same filter for every channel, so coefficients are only prepared once.
+		state.filter.set_mode(AudioFilterSW::HIGHSHELF);
+		state.filter.set_sampling_rate(mix_rate);
+		state.filter.set_cutoff(params.filter_cutoff_hz);
+		state.filter.set_resonance(1);
+		state.filter.set_stages(1);
+		state.filter.set_gain(current.filter_gain);
+
+		AudioFilterSW::Coeffs coeffs;
+		state.filter.prepare_coefficients(&coeffs);
+
+		for (int k = 0; k < channel_count; k++) {
+			AudioFrame target_volume = p_voice.fade_out ? AudioFrame(0.f, 0.f) : current.vol[k];
+			AudioFrame vol_prev = p_voice.fade_in ? AudioFrame(0.f, 0.f) : state.output.vol[k];
+			AudioFrame vol_inc = (target_volume - vol_prev) / float(frames);
+			AudioFrame vol = vol_prev;
+
+			audibility = MAX(audibility, MAX(current.vol[k].l, current.vol[k].r));
+
+			if (!thread_has_channel_mix_buffer(current.bus_index, k)) {
+				continue; //may have been deleted, will be updated on process
+			}
+
+			AudioFrame *target = thread_get_channel_mix_buffer(current.bus_index, k);
+			AudioFilterSW::Processor &process_l = state.filter_process[k * 2 + 0];
+			AudioFilterSW::Processor &process_r = state.filter_process[k * 2 + 1];
 
-			bus->channels.write[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+			process_l.set_filter(&state.filter, !interpolate_filter);
+			process_r.set_filter(&state.filter, !interpolate_filter);
 
-			if (!bus->channels[k].used) {
-				//see if any audio is contained, because channel was not used
+			if (interpolate_filter) {
+				process_l.update_coeffs(coeffs, frames);
+				process_r.update_coeffs(coeffs, frames);
+				for (int j = 0; j < frames; j++) {
+					AudioFrame f = buffer[j] * vol;
+					process_l.process_one_interp(f.l);
+					process_r.process_one_interp(f.r);
 
-				if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
-					bus->channels.write[k].last_mix_with_audio = mix_frames;
-				} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
-					bus->channels.write[k].active = false;
-					continue; //went inactive, don't mix.
+					target[j] += f;
+					vol += vol_inc;
+				}
+			} else {
+				process_l.update_coeffs(coeffs);
+				process_r.update_coeffs(coeffs);
+				for (int j = 0; j < frames; j++) {
+					AudioFrame f = buffer[j] * vol;
+					process_l.process_one(f.l);
+					process_r.process_one(f.r);
+
+					target[j] += f;
+					vol += vol_inc;
 				}
 			}
 
-			if (send) {
-				//if not master bus, send
-				AudioFrame *target_buf = thread_get_channel_mix_buffer(send->index_cache, k);
+			if (current.reverb_bus_index >= 0) {
+				if (!thread_has_channel_mix_buffer(current.reverb_bus_index, k)) {
+					continue; //may have been deleted, will be updated on process
+				}
+
+				AudioFrame *rtarget = thread_get_channel_mix_buffer(current.reverb_bus_index, k);
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					target_buf[j] += buf[j];
+				if (current.reverb_bus_index == state.output.reverb_bus_index) {
+					AudioFrame rvol_inc = (current.reverb_vol[k] - state.output.reverb_vol[k]) / float(frames);
+					AudioSIMD::mix_ramp(rtarget, buffer, state.output.reverb_vol[k], rvol_inc, frames);
+				} else {
+					AudioSIMD::mix_ramp(rtarget, buffer, current.reverb_vol[k], AudioFrame(0, 0), frames);
 				}
 			}
 		}
+
+		state.output = current;
 	}
 
-	mix_frames += buffer_size;
-	to_mix = buffer_size;
+	p_voice.prev_output_count = params.output_count;
+	p_voice.audibility = audibility;
+
+	//stream is no longer active, disable this.
+	if (!p_voice.playback->is_playing()) {
+		p_voice.active = false;
+	}
+
+	p_voice.fade_in = false;
+	p_voice.fade_out = false;
 }
 
 bool AudioServer::thread_has_channel_mix_buffer(int p_bus, int p_buffer) const {
@@ -537,6 +794,7 @@ void AudioServer::set_bus_count(int p_count) {
 		buses.write[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].effect_buffer.resize(buffer_size);
 		}
 		buses[i]->name = attempt;
 		buses[i]->solo = false;
@@ -606,6 +864,7 @@ void AudioServer::add_bus(int p_at_pos) {
 	bus->channels.resize(channel_count);
 	for (int j = 0; j < channel_count; j++) {
 		bus->channels.write[j].buffer.resize(buffer_size);
+		bus->channels.write[j].effect_buffer.resize(buffer_size);
 	}
 	bus->name = attempt;
 	bus->solo = false;
@@ -914,16 +1173,12 @@ float AudioServer::get_global_rate_scale() const {
 
 void AudioServer::init_channels_and_buffers() {
 	channel_count = get_channel_count();
-	temp_buffer.resize(channel_count);
-
-	for (int i = 0; i < temp_buffer.size(); i++) {
-		temp_buffer.write[i].resize(buffer_size);
-	}
 
 	for (int i = 0; i < buses.size(); i++) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].effect_buffer.resize(buffer_size);
 		}
 	}
 }
@@ -936,6 +1191,18 @@ void AudioServer::init() {
 
 	init_channels_and_buffers();
 
+	use_threads = GLOBAL_DEF_RST("audio/buses/use_threads", true);
+
+	voice_capacity = MAX(1, int(GLOBAL_DEF_RST("audio/voices/max_voices", 256)));
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/voices/max_voices", PropertyInfo(Variant::INT, "audio/voices/max_voices", PROPERTY_HINT_RANGE, "1,4096,1,or_greater"));
+	voices = memnew_arr(Voice, voice_capacity);
+	free_voices.resize(voice_capacity);
+	for (uint32_t i = 0; i < voice_capacity; i++) {
+		free_voices[i] = voice_capacity - i - 1; // Lowest indices are handed out first.
+	}
+	mixing_voices.reserve(voice_capacity);
+	voice_buffer.resize(buffer_size);
+
 	mix_count = 0;
 	set_bus_count(1);
 	set_bus_name(0, "Master");
@@ -1045,6 +1312,13 @@ void AudioServer::finish() {
 	}
 
 	buses.clear();
+
+	if (voices) {
+		memdelete_arr(voices);
+		voices = nullptr;
+	}
+	voice_capacity = 0;
+	free_voices.clear();
 }
 
 /* MISC config */
@@ -1092,7 +1366,9 @@ void AudioServer::add_callback(AudioCallback p_callback, void *p_userdata) {
 	CallbackItem ci;
 	ci.callback = p_callback;
 	ci.userdata = p_userdata;
-	callbacks.insert(ci);
+	if (callbacks.find(ci) == -1) {
+		callbacks.push_back(ci);
+	}
 	unlock();
 }
 
@@ -1101,7 +1377,12 @@ void AudioServer::remove_callback(AudioCallback p_callback, void *p_userdata) {
 	CallbackItem ci;
 	ci.callback = p_callback;
 	ci.userdata = p_userdata;
-	callbacks.erase(ci);
+	int64_t index = callbacks.find(ci);
+	if (index != -1) {
+		// Mixing is additive, so the order of callbacks does not matter.
+		callbacks[index] = callbacks[callbacks.size() - 1];
+		callbacks.resize(callbacks.size() - 1);
+	}
 	unlock();
 }
 
@@ -1123,6 +1404,180 @@ void AudioServer::remove_update_callback(AudioCallback p_callback, void *p_userd
 	unlock();
 }
 
+/* MIX COSTS */
+
+void AudioServer::set_mix_cost_tracking(bool p_enable) {
+	lock();
+	track_mix_costs = p_enable;
+	unlock();
+}
+
+bool AudioServer::is_mix_cost_tracking() const {
+	return track_mix_costs;
+}
+
+void AudioServer::reset_mix_costs() {
+	lock();
+	mix_cost = 0;
+	voices_mix_cost = 0;
+	for (int i = 0; i < buses.size(); i++) {
+		buses[i]->mix_cost = 0;
+		for (int j = 0; j < buses[i]->effects.size(); j++) {
+			buses[i]->effects.write[j].mix_cost = 0;
+		}
+	}
+	unlock();
+}
+
+uint64_t AudioServer::get_mix_cost() const {
+	return mix_cost;
+}
+
+uint64_t AudioServer::get_voices_mix_cost() const {
+	return voices_mix_cost;
+}
+
+uint64_t AudioServer::get_bus_mix_cost(int p_bus) const {
+	ERR_FAIL_INDEX_V(p_bus, buses.size(), 0);
+	return buses[p_bus]->mix_cost;
+}
+
+uint64_t AudioServer::get_bus_effect_mix_cost(int p_bus, int p_effect) const {
+	ERR_FAIL_INDEX_V(p_bus, buses.size(), 0);
+	ERR_FAIL_INDEX_V(p_effect, buses[p_bus]->effects.size(), 0);
+	return buses[p_bus]->effects[p_effect].mix_cost;
+}
+
+/* VOICES */
+
+AudioServer::Voice *AudioServer::_get_voice(VoiceID p_voice) const {
+	uint32_t index = p_voice & 0xFFFFFFFF;
+	if (index >= voice_capacity) {
+		return nullptr;
+	}
+
+	Voice *voice = &voices[index];
+	if (!voice->used || voice->generation != uint32_t(p_voice >> 32)) {
+		return nullptr;
+	}
+	return voice;
+}
+
+void AudioServer::_release_voice(Voice *p_voice) {
+	p_voice->playback.unref();
+	p_voice->used = false;
+	p_voice->active = false;
+	p_voice->generation++;
+	if (p_voice->generation == 0) {
+		p_voice->generation = 1; // Keep IDs from ever being INVALID_VOICE_ID.
+	}
+	free_voices.push_back(p_voice - voices);
+}
+
+AudioServer::VoiceID AudioServer::voice_play(const Ref<AudioStreamPlayback> &p_playback, float p_from_pos, int p_priority) {
+	ERR_FAIL_COND_V(p_playback.is_null(), INVALID_VOICE_ID);
+
+	lock();
+
+	if (free_voices.empty()) {
+		// Steal a voice: ended ones first, then the lowest priority, then the quietest.
+		Voice *steal = nullptr;
+		for (uint32_t i = 0; i < voice_capacity; i++) {
+			Voice *voice = &voices[i];
+			if (!voice->active) {
+				steal = voice;
+				break;
+			}
+			if (voice->priority > p_priority) {
+				continue;
+			}
+			if (!steal || voice->priority < steal->priority || (voice->priority == steal->priority && voice->audibility < steal->audibility)) {
+				steal = voice;
+			}
+		}
+
+		if (!steal) {
+			unlock();
+			return INVALID_VOICE_ID; // Every voice is more important than this one.
+		}
+		_release_voice(steal);
+	}
+
+	uint32_t index = free_voices[free_voices.size() - 1];
+	free_voices.resize(free_voices.size() - 1);
+
+	Voice &voice = voices[index];
+	voice.used = true;
+	voice.priority = p_priority;
+	voice.playback = p_playback;
+	voice.seek_pos = p_from_pos;
+	voice.paused = false;
+	voice.fade_in = false;
+	voice.fade_out = false;
+	voice.active = true;
+	voice.params_pending.store(false);
+	voice.has_params = false;
+	voice.prev_output_count = 0;
+	voice.audibility = 1.0; // Assume it is heard until it was mixed once.
+
+	VoiceID id = (uint64_t(voice.generation) << 32) | uint64_t(index);
+
+	unlock();
+
+	return id;
+}
+
+void AudioServer::voice_stop(VoiceID p_voice) {
+	lock();
+	Voice *voice = _get_voice(p_voice);
+	if (voice) {
+		_release_voice(voice);
+	}
+	unlock();
+}
+
+bool AudioServer::voice_is_playing(VoiceID p_voice) const {
+	Voice *voice = _get_voice(p_voice);
+	return voice && voice->active;
+}
+
+void AudioServer::voice_seek(VoiceID p_voice, float p_from_pos) {
+	lock();
+	Voice *voice = _get_voice(p_voice);
+	if (voice) {
+		voice->seek_pos = p_from_pos;
+	}
+	unlock();
+}
+
+void AudioServer::voice_set_paused(VoiceID p_voice, bool p_paused) {
+	lock();
+	Voice *voice = _get_voice(p_voice);
+	if (voice && voice->paused != p_paused) {
+		voice->paused = p_paused;
+		voice->fade_in = !p_paused;
+		voice->fade_out = p_paused;
+	}
+	unlock();
+}
+
+bool AudioServer::voice_needs_update(VoiceID p_voice) const {
+	Voice *voice = _get_voice(p_voice);
+	return voice && !voice->params_pending.load(std::memory_order_acquire);
+}
+
+void AudioServer::voice_update(VoiceID p_voice, const VoiceParams &p_params) {
+	ERR_FAIL_INDEX(p_params.output_count, VOICE_MAX_OUTPUTS + 1);
+
+	Voice *voice = _get_voice(p_voice);
+	if (!voice || voice->params_pending.load(std::memory_order_acquire)) {
+		return; // Stolen, or the mixer did not take the previous parameters yet.
+	}
+
+	voice->pending_params = p_params;
+	voice->params_pending.store(true, std::memory_order_release);
+}
+
 void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 	ERR_FAIL_COND(p_bus_layout.is_null() || p_bus_layout->buses.size() == 0);
 
@@ -1163,6 +1618,7 @@ void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].effect_buffer.resize(buffer_size);
 		}
 		_update_bus_effects(i);
 	}
@@ -34,11 +34,16 @@
 #include "core/math/audio_frame.h"
 #include "core/object.h"
 #include "core/os/os.h"
+#include "core/local_vector.h"
 #include "core/variant.h"
 #include "servers/audio/audio_effect.h"
+#include "servers/audio/audio_filter_sw.h"
+
+#include <atomic>
 
 class AudioDriverDummy;
 class AudioStream;
+class AudioStreamPlayback;
 class AudioStreamSample;
 
 class AudioDriver {
@@ -161,6 +166,33 @@ public:
 
 	typedef void (*AudioCallback)(void *p_userdata);
 
+	/* VOICES */
+
+	typedef uint64_t VoiceID;
+	static const VoiceID INVALID_VOICE_ID = 0;
+
+	enum {
+		VOICE_MAX_OUTPUTS = 8, // Listeners a single voice can be heard from.
+	};
+
+	struct VoiceOutput {
+		uint64_t listener = 0; // Matches outputs between updates, so volume and filter changes are ramped.
+		int bus_index = -1;
+		int reverb_bus_index = -1;
+		float filter_gain = 1.0;
+		float pitch_scale = 1.0;
+		AudioFrame vol[4];
+		AudioFrame reverb_vol[4];
+	};
+
+	struct VoiceParams {
+		float pitch_scale = 1.0;
+		float filter_cutoff_hz = 5000.0;
+		bool mix_without_outputs = true; // Keep the stream advancing while no listener hears it.
+		int output_count = 0;
+		VoiceOutput outputs[VOICE_MAX_OUTPUTS];
+	};
+
 private:
 	uint64_t mix_time;
 	int mix_size;
@@ -192,14 +224,17 @@ private:
 		struct Channel {
 			bool used;
 			bool active;
+			bool sending; // Mixed this step, the send bus takes it.
 			AudioFrame peak_volume;
 			Vector<AudioFrame> buffer;
+			Vector<AudioFrame> effect_buffer; // Effects write here, then it's swapped with buffer.
 			Vector<Ref<AudioEffectInstance>> effect_instances;
 			uint64_t last_mix_with_audio;
 			Channel() {
 				last_mix_with_audio = 0;
 				used = false;
 				active = false;
+				sending = false;
 				peak_volume = AudioFrame(0, 0);
 			}
 		};
@@ -212,18 +247,35 @@ private:
 #ifdef DEBUG_ENABLED
 			uint64_t prof_time;
 #endif
+			uint64_t mix_cost = 0;
 		};
 
 		Vector<Effect> effects;
 		float volume_db;
 		StringName send;
 		int index_cache;
+
+		// Mix graph, rebuilt every step.
+		int send_index = -1;
+		int level = 0; // Longest chain of buses sending here.
+		bool has_effects = false;
+		LocalVector<int> inputs;
+
+		uint64_t mix_cost = 0;
 	};
 
-	Vector<Vector<AudioFrame>> temp_buffer; //temp_buffer for each level
 	Vector<Bus *> buses;
 	Map<StringName, Bus *> bus_map;
 
+	bool use_threads = false;
+	bool solo_mode = false;
+	LocalVector<int> mix_order; // Bus indices sorted by level.
+	LocalVector<uint32_t> mix_level_offsets;
+
+	bool track_mix_costs = false;
+	uint64_t mix_cost = 0;
+	uint64_t voices_mix_cost = 0;
+
 	void _update_bus_effects(int p_bus);
 
 	static AudioServer *singleton;
@@ -231,6 +283,8 @@ private:
 	void init_channels_and_buffers();
 
 	void _mix_step();
+	void _mix_bus(int p_bus);
+	void _mix_bus_task(uint32_t p_index, const int *p_buses);
 
 	struct CallbackItem {
 		AudioCallback callback;
@@ -239,11 +293,62 @@ private:
 		bool operator<(const CallbackItem &p_item) const {
 			return (callback == p_item.callback ? userdata < p_item.userdata : callback < p_item.callback);
 		}
+		bool operator==(const CallbackItem &p_item) const {
+			return callback == p_item.callback && userdata == p_item.userdata;
+		}
 	};
 
-	Set<CallbackItem> callbacks;
+	LocalVector<CallbackItem> callbacks;
 	Set<CallbackItem> update_callbacks;
 
+	struct Voice {
+		struct OutputState {
+			VoiceOutput output;
+			AudioFilterSW filter;
+			AudioFilterSW::Processor filter_process[8];
+		};
+
+		// Protected by the driver lock.
+		uint32_t generation = 1;
+		bool used = false;
+		int priority = 0;
+		Ref<AudioStreamPlayback> playback;
+		float seek_pos = -1.0;
+		bool paused = false;
+		bool fade_in = false;
+		bool fade_out = false;
+		volatile bool active = false; // Cleared by the mixer once the stream ends.
+
+		// Parameters are handed over without locking: the owner only writes
+		// them while params_pending is false, the mixer takes them and clears it.
+		std::atomic<bool> params_pending = { false };
+		VoiceParams pending_params;
+
+		// Audio thread state.
+		bool has_params = false;
+		VoiceParams params;
+		OutputState prev_outputs[VOICE_MAX_OUTPUTS];
+		int prev_output_count = 0;
+		float audibility = 0.0; // Loudest output volume of the last mix, used to pick voices to steal.
+	};
+
+	struct VoiceSort {
+		uint32_t index;
+		int bus_index;
+		_FORCE_INLINE_ bool operator<(const VoiceSort &p_other) const { return bus_index < p_other.bus_index; }
+	};
+
+	Voice *voices = nullptr;
+	uint32_t voice_capacity = 0;
+	LocalVector<uint32_t> free_voices;
+	LocalVector<VoiceSort> mixing_voices;
+	Vector<AudioFrame> voice_buffer;
+
+	Voice *_get_voice(VoiceID p_voice) const;
+	void _release_voice(Voice *p_voice);
+	void _mix_voices();
+	void _mix_voice(Voice &p_voice);
+
 	friend class AudioDriver;
 	void _driver_process(int p_frames, int32_t *p_buffer);
 
@@ -347,6 +452,31 @@ public:
 	void add_update_callback(AudioCallback p_callback, void *p_userdata);
 	void remove_update_callback(AudioCallback p_callback, void *p_userdata);
 
+	// Voices are mixed by the server itself from a fixed size pool. When the pool
+	// is full, playing a voice steals the least important one: lowest priority
+	// first, then the quietest. Voices with a higher priority are never stolen.
+	VoiceID voice_play(const Ref<AudioStreamPlayback> &p_playback, float p_from_pos = 0.0, int p_priority = 0);
+	void voice_stop(VoiceID p_voice);
+	bool voice_is_playing(VoiceID p_voice) const;
+	void voice_seek(VoiceID p_voice, float p_from_pos);
+	void voice_set_paused(VoiceID p_voice, bool p_paused);
+
+	// Returns false while the mixer has not taken the previous parameters yet.
+	bool voice_needs_update(VoiceID p_voice) const;
+	void voice_update(VoiceID p_voice, const VoiceParams &p_params);
+
+	int get_voice_capacity() const { return voice_capacity; }
+
+	// Time spent mixing, in microseconds, accumulated while tracking is enabled.
+	// Unlike the profiler, this is available in release builds too.
+	void set_mix_cost_tracking(bool p_enable);
+	bool is_mix_cost_tracking() const;
+	void reset_mix_costs();
+	uint64_t get_mix_cost() const;
+	uint64_t get_voices_mix_cost() const;
+	uint64_t get_bus_mix_cost(int p_bus) const; // Includes its effects, but not the buses sending to it.
+	uint64_t get_bus_effect_mix_cost(int p_bus, int p_effect) const;
+
 	void set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout);
 	Ref<AudioBusLayout> generate_bus_layout() const;
 
@@ -95,6 +95,20 @@ public:
 	virtual Vector3 map_get_closest_point_normal(RID p_map, const Vector3 &p_point) const = 0;
 	virtual RID map_get_closest_point_owner(RID p_map, const Vector3 &p_point) const = 0;
 
+	/// Queues a path query for each origin and destination pair. They are
+	/// solved in parallel on worker threads, using the map as it was at the
+	/// last sync, so the map can keep changing meanwhile.
+	/// With a callback, the paths are sent to it during `process` as an
+	/// `Array` of `PackedVector3Array`, and the query is freed afterwards.
+	/// Without, poll the query and free it once done.
+	virtual RID map_query_paths(RID p_map, const Vector<Vector3> &p_origins, const Vector<Vector3> &p_destinations, bool p_optimize, const Callable &p_callback = Callable()) const = 0;
+
+	/// Returns true when all the paths of the query are solved.
+	virtual bool path_query_is_done(RID p_query) const = 0;
+
+	/// Returns the paths of the query, in the order of the pairs, waiting for them if needed.
+	virtual Array path_query_get_paths(RID p_query) const = 0;
+
 	/// Creates a new region.
 	virtual RID region_create() const = 0;
 
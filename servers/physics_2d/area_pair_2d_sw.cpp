@@ -30,6 +30,7 @@
 
 #include "area_pair_2d_sw.h"
 #include "collision_solver_2d_sw.h"
+#include "space_2d_sw.h"
 
 bool AreaPair2DSW::setup(real_t p_step) {
 	bool result = false;
@@ -41,6 +42,9 @@ bool AreaPair2DSW::setup(real_t p_step) {
 	}
 
 	if (result != colliding) {
+		// The area can overlap bodies from several islands.
+		area->get_space()->lock_shared_state();
+
 		if (result) {
 			if (area->get_space_override_mode() != PhysicsServer2D::AREA_SPACE_OVERRIDE_DISABLED) {
 				body->add_area(area);
@@ -58,6 +62,8 @@ bool AreaPair2DSW::setup(real_t p_step) {
 			}
 		}
 
+		area->get_space()->unlock_shared_state();
+
 		colliding = result;
 	}
 
@@ -104,6 +110,8 @@ bool Area2Pair2DSW::setup(real_t p_step) {
 	}
 
 	if (result != colliding) {
+		area_a->get_space()->lock_shared_state();
+
 		if (result) {
 			if (area_b->has_area_monitor_callback() && area_a->is_monitorable()) {
 				area_b->add_area_to_query(area_a, shape_a, shape_b);
@@ -123,6 +131,8 @@ bool Area2Pair2DSW::setup(real_t p_step) {
 			}
 		}
 
+		area_a->get_space()->unlock_shared_state();
+
 		colliding = result;
 	}
 
@@ -30,6 +30,7 @@
 
 #include "body_2d_sw.h"
 #include "area_2d_sw.h"
+#include "core/sort_array.h"
 #include "physics_server_2d_sw.h"
 #include "space_2d_sw.h"
 
@@ -583,6 +584,27 @@ void Body2DSW::wakeup_neighbours() {
 	}
 }
 
+bool Body2DSW::ContactComparator::operator()(const Contact &p_a, const Contact &p_b) const {
+	if (p_a.collider != p_b.collider) {
+		return p_a.collider < p_b.collider;
+	}
+	if (p_a.collider_shape != p_b.collider_shape) {
+		return p_a.collider_shape < p_b.collider_shape;
+	}
+	if (p_a.local_shape != p_b.local_shape) {
+		return p_a.local_shape < p_b.local_shape;
+	}
+	if (p_a.local_pos.x != p_b.local_pos.x) {
+		return p_a.local_pos.x < p_b.local_pos.x;
+	}
+	return p_a.local_pos.y < p_b.local_pos.y;
+}
+
+void Body2DSW::sort_contacts() {
+	SortArray<Contact, ContactComparator> sorter;
+	sorter.sort(contacts.ptrw(), contact_count);
+}
+
 void Body2DSW::call_queries() {
 	if (fi_callback) {
 		PhysicsDirectBodyState2DSW *dbs = PhysicsDirectBodyState2DSW::singleton;
@@ -111,6 +111,10 @@ class Body2DSW : public CollisionObject2DSW {
 		Vector2 collider_velocity_at_pos;
 	};
 
+	struct ContactComparator {
+		bool operator()(const Contact &p_a, const Contact &p_b) const;
+	};
+
 	Vector<Contact> contacts; //no contacts by default
 	int contact_count;
 
@@ -164,6 +168,7 @@ public:
 
 	_FORCE_INLINE_ bool can_report_contacts() const { return !contacts.empty(); }
 	_FORCE_INLINE_ void add_contact(const Vector2 &p_local_pos, const Vector2 &p_local_normal, real_t p_depth, int p_local_shape, const Vector2 &p_collider_pos, int p_collider_shape, ObjectID p_collider_instance_id, const RID &p_collider, const Vector2 &p_collider_velocity_at_pos);
+	void sort_contacts();
 
 	_FORCE_INLINE_ void add_exception(const RID &p_exception) { exceptions.insert(p_exception); }
 	_FORCE_INLINE_ void remove_exception(const RID &p_exception) { exceptions.erase(p_exception); }
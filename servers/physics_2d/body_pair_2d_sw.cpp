@@ -219,34 +219,34 @@ real_t combine_friction(Body2DSW *A, Body2DSW *B) {
 	return ABS(MIN(A->get_friction(), B->get_friction()));
 }
 
-bool BodyPair2DSW::setup(real_t p_step) {
+void BodyPair2DSW::narrowphase(real_t p_step) {
+	prev_collided = collided;
+	can_collide = false;
+
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer2D::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer2D::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
-		return false;
+		return;
 	}
 
 	if (A->is_shape_set_as_disabled(shape_A) || B->is_shape_set_as_disabled(shape_B)) {
 		collided = false;
-		return false;
+		return;
 	}
 
+	can_collide = true;
+
 	//use local A coordinates to avoid numerical issues on collision detection
 	offset_B = B->get_transform().get_origin() - A->get_transform().get_origin();
 
 	_validate_contacts();
 
-	Vector2 offset_A = A->get_transform().get_origin();
-	Transform2D xform_Au = A->get_transform().untranslated();
-	Transform2D xform_A = xform_Au * A->get_shape_transform(shape_A);
+	Transform2D xform_A = A->get_transform().untranslated() * A->get_shape_transform(shape_A);
 
 	Transform2D xform_Bu = B->get_transform();
 	xform_Bu.elements[2] -= A->get_transform().get_origin();
 	Transform2D xform_B = xform_Bu * B->get_shape_transform(shape_B);
 
-	Shape2DSW *shape_A_ptr = A->get_shape(shape_A);
-	Shape2DSW *shape_B_ptr = B->get_shape(shape_B);
-
 	Vector2 motion_A, motion_B;
 
 	if (A->get_continuous_collision_detection_mode() == PhysicsServer2D::CCD_MODE_CAST_SHAPE) {
@@ -256,19 +256,39 @@ bool BodyPair2DSW::setup(real_t p_step) {
 		motion_B = B->get_motion();
 	}
 
-	bool prev_collided = collided;
+	collided = CollisionSolver2DSW::solve(A->get_shape(shape_A), xform_A, motion_A, B->get_shape(shape_B), xform_B, motion_B, _add_contact, this, &sep_axis);
+}
+
+bool BodyPair2DSW::setup(real_t p_step) {
+	if (!can_collide) {
+		return false;
+	}
+
+	collide_A = (A->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+	collide_B = (B->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+
+	Vector2 offset_A = A->get_transform().get_origin();
+	Transform2D xform_Au = A->get_transform().untranslated();
+	Transform2D xform_A = xform_Au * A->get_shape_transform(shape_A);
+
+	Transform2D xform_Bu = B->get_transform();
+	xform_Bu.elements[2] -= A->get_transform().get_origin();
+	Transform2D xform_B = xform_Bu * B->get_shape_transform(shape_B);
+
+	Shape2DSW *shape_A_ptr = A->get_shape(shape_A);
+	Shape2DSW *shape_B_ptr = B->get_shape(shape_B);
 
-	collided = CollisionSolver2DSW::solve(shape_A_ptr, xform_A, motion_A, shape_B_ptr, xform_B, motion_B, _add_contact, this, &sep_axis);
 	if (!collided) {
 		//test ccd (currently just a raycast)
+		//done here rather than in narrowphase(), as it depends on the velocities left by constraints set up before
 
-		if (A->get_continuous_collision_detection_mode() == PhysicsServer2D::CCD_MODE_CAST_RAY && A->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC) {
+		if (A->get_continuous_collision_detection_mode() == PhysicsServer2D::CCD_MODE_CAST_RAY && collide_A) {
 			if (_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B)) {
 				collided = true;
 			}
 		}
 
-		if (B->get_continuous_collision_detection_mode() == PhysicsServer2D::CCD_MODE_CAST_RAY && B->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC) {
+		if (B->get_continuous_collision_detection_mode() == PhysicsServer2D::CCD_MODE_CAST_RAY && collide_B) {
 			if (_test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A, true)) {
 				collided = true;
 			}
@@ -386,17 +406,33 @@ bool BodyPair2DSW::setup(real_t p_step) {
 			global_A += offset_A;
 			global_B += offset_A;
 
+			// Immovable bodies may be touched by several islands at once.
+
 			if (gather_A) {
 				Vector2 crB(-B->get_angular_velocity() * c.rB.y, B->get_angular_velocity() * c.rB.x);
+				if (!collide_A) {
+					space->lock_shared_state();
+				}
 				A->add_contact(global_A, -c.normal, depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crB + B->get_linear_velocity());
+				if (!collide_A) {
+					space->add_shared_contact_body(A);
+					space->unlock_shared_state();
+				}
 			}
 			if (gather_B) {
 				Vector2 crA(-A->get_angular_velocity() * c.rA.y, A->get_angular_velocity() * c.rA.x);
+				if (!collide_B) {
+					space->lock_shared_state();
+				}
 				B->add_contact(global_B, c.normal, depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crA + A->get_linear_velocity());
+				if (!collide_B) {
+					space->add_shared_contact_body(B);
+					space->unlock_shared_state();
+				}
 			}
 		}
 
-		if ((A->get_mode() <= PhysicsServer2D::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer2D::BODY_MODE_KINEMATIC)) {
+		if (!collide_A && !collide_B) {
 			c.active = false;
 			collided = false;
 			continue;
@@ -425,8 +461,12 @@ bool BodyPair2DSW::setup(real_t p_step) {
 			// Apply normal + friction impulse
 			Vector2 P = c.acc_normal_impulse * c.normal + c.acc_tangent_impulse * tangent;
 
-			A->apply_impulse(-P, c.rA);
-			B->apply_impulse(P, c.rB);
+			if (collide_A) {
+				A->apply_impulse(-P, c.rA);
+			}
+			if (collide_B) {
+				B->apply_impulse(P, c.rB);
+			}
 		}
 #endif
 
@@ -478,8 +518,12 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 jb = c.normal * (c.acc_bias_impulse - jbnOld);
 
-		A->apply_bias_impulse(c.rA, -jb);
-		B->apply_bias_impulse(c.rB, jb);
+		if (collide_A) {
+			A->apply_bias_impulse(c.rA, -jb);
+		}
+		if (collide_B) {
+			B->apply_bias_impulse(c.rB, jb);
+		}
 
 		real_t jn = -(c.bounce + vn) * c.mass_normal;
 		real_t jnOld = c.acc_normal_impulse;
@@ -494,8 +538,12 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 j = c.normal * (c.acc_normal_impulse - jnOld) + tangent * (c.acc_tangent_impulse - jtOld);
 
-		A->apply_impulse(-j, c.rA);
-		B->apply_impulse(j, c.rB);
+		if (collide_A) {
+			A->apply_impulse(-j, c.rA);
+		}
+		if (collide_B) {
+			B->apply_impulse(j, c.rB);
+		}
 	}
 }
 
@@ -510,6 +558,10 @@ BodyPair2DSW::BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_sh
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	prev_collided = false;
+	can_collide = false;
+	collide_A = false;
+	collide_B = false;
 	oneway_disabled = false;
 }
 
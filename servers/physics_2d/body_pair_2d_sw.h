@@ -75,6 +75,11 @@ class BodyPair2DSW : public Constraint2DSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	bool prev_collided;
+	bool can_collide; // Set by narrowphase(), false when the pair is filtered out this step.
+	// Only dynamic bodies get impulses, static and kinematic ones can be shared between islands solved in parallel.
+	bool collide_A;
+	bool collide_B;
 	bool oneway_disabled;
 	int cc;
 
@@ -84,6 +89,7 @@ class BodyPair2DSW : public Constraint2DSW {
 	_FORCE_INLINE_ void _contact_added_callback(const Vector2 &p_point_A, const Vector2 &p_point_B);
 
 public:
+	virtual void narrowphase(real_t p_step);
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
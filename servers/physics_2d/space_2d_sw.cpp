@@ -1238,6 +1238,21 @@ void Space2DSW::call_queries() {
 	}
 }
 
+void Space2DSW::sort_shared_contacts() {
+	if (shared_contact_bodies.empty()) {
+		return;
+	}
+
+	// A body is added once per contact, only sort each one once.
+	shared_contact_bodies.sort();
+	for (uint32_t i = 0; i < shared_contact_bodies.size(); i++) {
+		if (i == 0 || shared_contact_bodies[i] != shared_contact_bodies[i - 1]) {
+			shared_contact_bodies[i]->sort_contacts();
+		}
+	}
+	shared_contact_bodies.clear();
+}
+
 void Space2DSW::setup() {
 	contact_debug_count = 0;
 
@@ -27,9 +27,10 @@
 /* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
-
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 	p_body->set_island_step(_step);
@@ -44,6 +45,7 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 		c->set_island_step(_step);
 		c->set_island_next(*p_constraint_island);
 		*p_constraint_island = c;
+		all_constraints.push_back(c);
 
 		for (int i = 0; i < c->get_body_count(); i++) {
 			if (i == E->get()) {
@@ -58,28 +60,31 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 	}
 }
 
-bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
-	Constraint2DSW *ci = p_island;
+Constraint2DSW *Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
+	//remove from the island every constraint that does not need processing, returns the new root (if any is left)
+	Constraint2DSW *root = nullptr;
 	Constraint2DSW *prev_ci = nullptr;
-	bool removed_root = false;
+	Constraint2DSW *ci = p_island;
 	while (ci) {
-		bool process = ci->setup(p_delta);
+		Constraint2DSW *next = ci->get_island_next();
 
-		if (!process) {
-			//remove from island if process fails
+		if (ci->setup(p_delta)) {
 			if (prev_ci) {
-				prev_ci->set_island_next(ci->get_island_next());
+				prev_ci->set_island_next(ci);
 			} else {
-				removed_root = true;
-				prev_ci = ci;
+				root = ci;
 			}
-		} else {
 			prev_ci = ci;
 		}
-		ci = ci->get_island_next();
+
+		ci = next;
 	}
 
-	return removed_root;
+	if (prev_ci) {
+		prev_ci->set_island_next(nullptr);
+	}
+
+	return root;
 }
 
 void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta) {
@@ -92,7 +97,7 @@ void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t
 	}
 }
 
-void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
+bool Step2DSW::_test_suspend(Body2DSW *p_island, real_t p_delta) {
 	bool can_sleep = true;
 
 	Body2DSW *b = p_island;
@@ -109,9 +114,13 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 		b = b->get_island_next();
 	}
 
+	return can_sleep;
+}
+
+void Step2DSW::_apply_suspend(Body2DSW *p_island, bool p_can_sleep) {
 	//put all to sleep or wake up everyoen
 
-	b = p_island;
+	Body2DSW *b = p_island;
 	while (b) {
 		if (b->get_mode() == PhysicsServer2D::BODY_MODE_STATIC || b->get_mode() == PhysicsServer2D::BODY_MODE_KINEMATIC) {
 			b = b->get_island_next();
@@ -120,14 +129,32 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 
 		bool active = b->is_active();
 
-		if (active == can_sleep) {
-			b->set_active(!can_sleep);
+		if (active == p_can_sleep) {
+			b->set_active(!p_can_sleep);
 		}
 
 		b = b->get_island_next();
 	}
 }
 
+void Step2DSW::_narrowphase_job(uint32_t p_index, void *p_userdata) {
+	all_constraints[p_index]->narrowphase(island_delta);
+}
+
+void Step2DSW::_setup_island_job(uint32_t p_index, void *p_userdata) {
+	constraint_islands[p_index] = _setup_island(constraint_islands[p_index], island_delta);
+}
+
+void Step2DSW::_solve_island_job(uint32_t p_index, void *p_userdata) {
+	if (constraint_islands[p_index]) {
+		_solve_island(constraint_islands[p_index], island_iterations, island_delta);
+	}
+}
+
+void Step2DSW::_test_suspend_job(uint32_t p_index, void *p_userdata) {
+	body_island_can_sleep[p_index] = _test_suspend(body_islands[p_index], island_delta);
+}
+
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	p_space->lock(); // can't access space during this
 
@@ -159,8 +186,9 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
-	Body2DSW *island_list = nullptr;
-	Constraint2DSW *constraint_island_list = nullptr;
+	body_islands.clear();
+	constraint_islands.clear();
+	all_constraints.clear();
 	b = body_list->first();
 
 	int island_count = 0;
@@ -173,12 +201,10 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 			Constraint2DSW *constraint_island = nullptr;
 			_populate_island(body, &island, &constraint_island);
 
-			island->set_island_list_next(island_list);
-			island_list = island;
+			body_islands.push_back(island);
 
 			if (constraint_island) {
-				constraint_island->set_island_list_next(constraint_island_list);
-				constraint_island_list = constraint_island;
+				constraint_islands.push_back(constraint_island);
 				island_count++;
 			}
 		}
@@ -197,8 +223,8 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 			}
 			c->set_island_step(_step);
 			c->set_island_next(nullptr);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			constraint_islands.push_back(c);
+			all_constraints.push_back(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<Area2DSW> *)aml.first()); //faster to remove here
 	}
@@ -209,43 +235,36 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 		profile_begtime = profile_endtime;
 	}
 
-	/* SETUP CONSTRAINT ISLANDS */
+	ThreadWorkPool *work_pool = ThreadWorkPool::get_singleton();
+	bool parallel = parallel_islands && work_pool && work_pool->get_thread_count() > 1;
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		Constraint2DSW *prev_ci = nullptr;
-		while (ci) {
-			if (_setup_island(ci, p_delta)) {
-				//removed the root from the island graph because it is not to be processed
-
-				Constraint2DSW *next = ci->get_island_next();
-
-				if (next) {
-					//root from list being deleted no longer exists, replace by next
-					next->set_island_list_next(ci->get_island_list_next());
-					if (prev_ci) {
-						prev_ci->set_island_list_next(next);
-					} else {
-						constraint_island_list = next;
-					}
-					prev_ci = next;
-				} else {
-					//list is empty, just skip
-					if (prev_ci) {
-						prev_ci->set_island_list_next(ci->get_island_list_next());
-
-					} else {
-						constraint_island_list = ci->get_island_list_next();
-					}
-				}
-			} else {
-				prev_ci = ci;
-			}
+	island_delta = p_delta;
+	island_iterations = p_iterations;
+
+	/* NARROWPHASE */
+
+	// Pairs are independent of each other, so collision detection runs over all of them at once.
+	if (parallel && all_constraints.size() > 1) {
+		work_pool->do_work(all_constraints.size(), this, &Step2DSW::_narrowphase_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < all_constraints.size(); i++) {
+			all_constraints[i]->narrowphase(p_delta);
+		}
+	}
+
+	/* SETUP CONSTRAINT ISLANDS */
 
-			ci = ci->get_island_list_next();
+	if (parallel && constraint_islands.size() > 1) {
+		work_pool->do_work(constraint_islands.size(), this, &Step2DSW::_setup_island_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			constraint_islands[i] = _setup_island(constraint_islands[i], p_delta);
 		}
 	}
 
+	// Reported contacts must not depend on the order islands were set up in.
+	p_space->sort_shared_contacts();
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -254,12 +273,14 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+	if (parallel && constraint_islands.size() > 1) {
+		work_pool->do_work(constraint_islands.size(), this, &Step2DSW::_solve_island_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			if (constraint_islands[i]) {
+				//iterating each island separatedly improves cache efficiency
+				_solve_island(constraint_islands[i], p_iterations, p_delta);
+			}
 		}
 	}
 
@@ -280,14 +301,20 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SLEEP / WAKE UP ISLANDS */
 
-	{
-		Body2DSW *bi = island_list;
-		while (bi) {
-			_check_suspend(bi, p_delta);
-			bi = bi->get_island_list_next();
+	body_island_can_sleep.resize(body_islands.size());
+	if (parallel && body_islands.size() > 1) {
+		work_pool->do_work(body_islands.size(), this, &Step2DSW::_test_suspend_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < body_islands.size(); i++) {
+			body_island_can_sleep[i] = _test_suspend(body_islands[i], p_delta);
 		}
 	}
 
+	// Changing the active state modifies the space lists, so it's always done here.
+	for (uint32_t i = 0; i < body_islands.size(); i++) {
+		_apply_suspend(body_islands[i], body_island_can_sleep[i]);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
@@ -301,4 +328,5 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 Step2DSW::Step2DSW() {
 	_step = 1;
+	parallel_islands = GLOBAL_DEF("physics/2d/parallel_islands", true);
 }
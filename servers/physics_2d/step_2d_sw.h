@@ -33,13 +33,33 @@
 
 #include "space_2d_sw.h"
 
+#include "core/local_vector.h"
+
 class Step2DSW {
 	uint64_t _step;
 
+	// Islands never share dynamic bodies or constraints, so they can be set up,
+	// solved and tested for sleep independently on the worker pool.
+	bool parallel_islands = true;
+
+	LocalVector<Body2DSW *> body_islands;
+	LocalVector<Constraint2DSW *> constraint_islands;
+	LocalVector<Constraint2DSW *> all_constraints;
+	LocalVector<uint8_t> body_island_can_sleep;
+
+	real_t island_delta = 0.0;
+	int island_iterations = 0;
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
-	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
+	Constraint2DSW *_setup_island(Constraint2DSW *p_island, real_t p_delta);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
-	void _check_suspend(Body2DSW *p_island, real_t p_delta);
+	bool _test_suspend(Body2DSW *p_island, real_t p_delta);
+	void _apply_suspend(Body2DSW *p_island, bool p_can_sleep);
+
+	void _narrowphase_job(uint32_t p_index, void *p_userdata);
+	void _setup_island_job(uint32_t p_index, void *p_userdata);
+	void _solve_island_job(uint32_t p_index, void *p_userdata);
+	void _test_suspend_job(uint32_t p_index, void *p_userdata);
 
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
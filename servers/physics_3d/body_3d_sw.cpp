@@ -30,6 +30,7 @@
 
 #include "body_3d_sw.h"
 #include "area_3d_sw.h"
+#include "core/sort_array.h"
 #include "space_3d_sw.h"
 
 void Body3DSW::_update_inertia() {
@@ -683,6 +684,30 @@ void Body3DSW::wakeup_neighbours() {
 	}
 }
 
+bool Body3DSW::ContactComparator::operator()(const Contact &p_a, const Contact &p_b) const {
+	if (p_a.collider != p_b.collider) {
+		return p_a.collider < p_b.collider;
+	}
+	if (p_a.collider_shape != p_b.collider_shape) {
+		return p_a.collider_shape < p_b.collider_shape;
+	}
+	if (p_a.local_shape != p_b.local_shape) {
+		return p_a.local_shape < p_b.local_shape;
+	}
+	if (p_a.local_pos.x != p_b.local_pos.x) {
+		return p_a.local_pos.x < p_b.local_pos.x;
+	}
+	if (p_a.local_pos.y != p_b.local_pos.y) {
+		return p_a.local_pos.y < p_b.local_pos.y;
+	}
+	return p_a.local_pos.z < p_b.local_pos.z;
+}
+
+void Body3DSW::sort_contacts() {
+	SortArray<Contact, ContactComparator> sorter;
+	sorter.sort(contacts.ptrw(), contact_count);
+}
+
 void Body3DSW::call_queries() {
 	if (fi_callback) {
 		PhysicsDirectBodyState3DSW *dbs = PhysicsDirectBodyState3DSW::singleton;
@@ -123,6 +123,10 @@ class Body3DSW : public CollisionObject3DSW {
 		Vector3 collider_velocity_at_pos;
 	};
 
+	struct ContactComparator {
+		bool operator()(const Contact &p_a, const Contact &p_b) const;
+	};
+
 	Vector<Contact> contacts; //no contacts by default
 	int contact_count;
 
@@ -180,6 +184,7 @@ public:
 
 	_FORCE_INLINE_ bool can_report_contacts() const { return !contacts.empty(); }
 	_FORCE_INLINE_ void add_contact(const Vector3 &p_local_pos, const Vector3 &p_local_normal, real_t p_depth, int p_local_shape, const Vector3 &p_collider_pos, int p_collider_shape, ObjectID p_collider_instance_id, const RID &p_collider, const Vector3 &p_collider_velocity_at_pos);
+	void sort_contacts();
 
 	_FORCE_INLINE_ void add_exception(const RID &p_exception) { exceptions.insert(p_exception); }
 	_FORCE_INLINE_ void remove_exception(const RID &p_exception) { exceptions.erase(p_exception); }
@@ -75,6 +75,9 @@ class BodyPair3DSW : public Constraint3DSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	// Only dynamic bodies get impulses, static and kinematic ones can be shared between islands solved in parallel.
+	bool collide_A;
+	bool collide_B;
 
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
 
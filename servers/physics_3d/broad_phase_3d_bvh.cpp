@@ -0,0 +1,577 @@
+/*************************************************************************/
+/*  broad_phase_3d_bvh.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_3d_bvh.h"
+#include "collision_object_3d_sw.h"
+#include "core/project_settings.h"
+
+uint32_t BroadPhase3DBVH::_alloc_node() {
+	uint32_t index;
+	if (free_nodes.size()) {
+		index = free_nodes[free_nodes.size() - 1];
+		free_nodes.resize(free_nodes.size() - 1);
+		nodes[index] = Node();
+	} else {
+		index = nodes.size();
+		nodes.push_back(Node());
+	}
+	return index;
+}
+
+void BroadPhase3DBVH::_free_node(uint32_t p_node) {
+	nodes[p_node].height = -1;
+	free_nodes.push_back(p_node);
+}
+
+void BroadPhase3DBVH::_insert_leaf(uint32_t p_leaf, uint32_t p_start) {
+	if (root == INVALID_INDEX) {
+		root = p_leaf;
+		nodes[p_leaf].parent = INVALID_INDEX;
+		return;
+	}
+
+	// Find the best sibling, using the surface area heuristic.
+	const AABB leaf_aabb = nodes[p_leaf].aabb;
+	uint32_t index = p_start;
+	while (!nodes[index].is_leaf()) {
+		const Node &node = nodes[index];
+
+		real_t area = _get_surface(node.aabb);
+		real_t combined_area = _get_surface(node.aabb.merge(leaf_aabb));
+
+		// Cost of creating a new parent for this node and the new leaf.
+		real_t cost = 2.0 * combined_area;
+		// Minimum cost of pushing the leaf further down the tree.
+		real_t inheritance_cost = 2.0 * (combined_area - area);
+
+		real_t child_cost[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = nodes[node.children[i]];
+			real_t merged_area = _get_surface(child.aabb.merge(leaf_aabb));
+			if (child.is_leaf()) {
+				child_cost[i] = merged_area + inheritance_cost;
+			} else {
+				child_cost[i] = (merged_area - _get_surface(child.aabb)) + inheritance_cost;
+			}
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1]) {
+			break;
+		}
+
+		index = child_cost[0] < child_cost[1] ? node.children[0] : node.children[1];
+	}
+
+	uint32_t sibling = index;
+	uint32_t old_parent = nodes[sibling].parent;
+	uint32_t new_parent = _alloc_node();
+
+	Node &parent = nodes[new_parent];
+	parent.parent = old_parent;
+	parent.aabb = leaf_aabb.merge(nodes[sibling].aabb);
+	parent.height = nodes[sibling].height + 1;
+	parent.children[0] = sibling;
+	parent.children[1] = p_leaf;
+
+	if (old_parent != INVALID_INDEX) {
+		Node &op = nodes[old_parent];
+		op.children[op.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		root = new_parent;
+	}
+
+	nodes[sibling].parent = new_parent;
+	nodes[p_leaf].parent = new_parent;
+
+	_refit(new_parent);
+}
+
+uint32_t BroadPhase3DBVH::_remove_leaf(uint32_t p_leaf) {
+	if (p_leaf == root) {
+		root = INVALID_INDEX;
+		return INVALID_INDEX;
+	}
+
+	uint32_t parent = nodes[p_leaf].parent;
+	uint32_t grand_parent = nodes[parent].parent;
+	uint32_t sibling = nodes[parent].children[nodes[parent].children[0] == p_leaf ? 1 : 0];
+
+	_free_node(parent);
+	nodes[p_leaf].parent = INVALID_INDEX;
+
+	if (grand_parent == INVALID_INDEX) {
+		root = sibling;
+		nodes[sibling].parent = INVALID_INDEX;
+		return sibling;
+	}
+
+	Node &gp = nodes[grand_parent];
+	gp.children[gp.children[0] == parent ? 0 : 1] = sibling;
+	nodes[sibling].parent = grand_parent;
+
+	_refit(grand_parent);
+	return grand_parent;
+}
+
+void BroadPhase3DBVH::_refit(uint32_t p_node) {
+	uint32_t index = p_node;
+	while (index != INVALID_INDEX) {
+		index = _balance(index);
+
+		Node &node = nodes[index];
+		const Node &a = nodes[node.children[0]];
+		const Node &b = nodes[node.children[1]];
+		node.height = 1 + MAX(a.height, b.height);
+		node.aabb = a.aabb.merge(b.aabb);
+
+		index = node.parent;
+	}
+}
+
+uint32_t BroadPhase3DBVH::_balance(uint32_t p_node) {
+	// AVL style rotation: promotes the grandchild of the taller side when
+	// the heights of both children differ by more than one.
+
+	Node &a = nodes[p_node];
+	if (a.is_leaf() || a.height < 2) {
+		return p_node;
+	}
+
+	int balance = nodes[a.children[1]].height - nodes[a.children[0]].height;
+	if (balance >= -1 && balance <= 1) {
+		return p_node;
+	}
+
+	int up_side = balance > 1 ? 1 : 0; // Child that gets rotated up.
+	uint32_t up = a.children[up_side];
+	uint32_t other = a.children[1 - up_side];
+	Node &c = nodes[up];
+	uint32_t f = c.children[0];
+	uint32_t g = c.children[1];
+
+	// Swap A and C.
+	c.children[0] = p_node;
+	c.parent = a.parent;
+	a.parent = up;
+
+	if (c.parent != INVALID_INDEX) {
+		Node &cp = nodes[c.parent];
+		cp.children[cp.children[0] == p_node ? 0 : 1] = up;
+	} else {
+		root = up;
+	}
+
+	// Keep the taller grandchild under C, give the other to A.
+	if (nodes[f].height < nodes[g].height) {
+		SWAP(f, g);
+	}
+	c.children[1] = f;
+	a.children[up_side] = g;
+	nodes[g].parent = p_node;
+
+	a.aabb = nodes[other].aabb.merge(nodes[g].aabb);
+	a.height = 1 + MAX(nodes[other].height, nodes[g].height);
+	c.aabb = a.aabb.merge(nodes[f].aabb);
+	c.height = 1 + MAX(a.height, nodes[f].height);
+
+	return up;
+}
+
+template <class Q>
+void BroadPhase3DBVH::_traverse(Q &p_query) const {
+	if (root == INVALID_INDEX) {
+		return;
+	}
+
+	uint32_t stack[STACK_MAX];
+	uint32_t stack_size = 0;
+	stack[stack_size++] = root;
+
+	while (stack_size) {
+		const Node &node = nodes[stack[--stack_size]];
+		if (!p_query.test(node.aabb)) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+			if (p_query.leaf(node.element + 1)) {
+				return;
+			}
+		} else {
+			ERR_FAIL_COND(stack_size + 2 > STACK_MAX);
+			stack[stack_size++] = node.children[1];
+			stack[stack_size++] = node.children[0];
+		}
+	}
+}
+
+uint32_t BroadPhase3DBVH::_find_pair(ID p_a, ID p_b) const {
+	// Look in the shorter list.
+	const Element &a = elements[p_a - 1];
+	const Element &b = elements[p_b - 1];
+	const LocalVector<uint32_t> &list = a.pairs.size() < b.pairs.size() ? a.pairs : b.pairs;
+
+	for (uint32_t i = 0; i < list.size(); i++) {
+		const Pair &pair = pairs[list[i]];
+		if ((pair.a == p_a && pair.b == p_b) || (pair.a == p_b && pair.b == p_a)) {
+			return list[i];
+		}
+	}
+	return INVALID_INDEX;
+}
+
+void BroadPhase3DBVH::_pair(ID p_a, ID p_b) {
+	uint32_t index;
+	if (free_pairs.size()) {
+		index = free_pairs[free_pairs.size() - 1];
+		free_pairs.resize(free_pairs.size() - 1);
+	} else {
+		index = pairs.size();
+		pairs.push_back(Pair());
+	}
+
+	Element &a = _get_element(p_a);
+	Element &b = _get_element(p_b);
+
+	Pair &pair = pairs[index];
+	pair.a = p_a;
+	pair.b = p_b;
+	pair.data = pair_callback ? pair_callback(a.owner, a.subindex, b.owner, b.subindex, pair_userdata) : nullptr;
+
+	a.pairs.push_back(index);
+	b.pairs.push_back(index);
+}
+
+static _FORCE_INLINE_ void _erase_pair_index(LocalVector<uint32_t> &r_list, uint32_t p_pair) {
+	// Order doesn't matter, swap with the last one.
+	for (uint32_t i = 0; i < r_list.size(); i++) {
+		if (r_list[i] == p_pair) {
+			r_list[i] = r_list[r_list.size() - 1];
+			r_list.resize(r_list.size() - 1);
+			return;
+		}
+	}
+}
+
+void BroadPhase3DBVH::_unpair(uint32_t p_pair) {
+	Pair pair = pairs[p_pair];
+	Element &a = _get_element(pair.a);
+	Element &b = _get_element(pair.b);
+
+	_erase_pair_index(a.pairs, p_pair);
+	_erase_pair_index(b.pairs, p_pair);
+
+	pairs[p_pair] = Pair();
+	free_pairs.push_back(p_pair);
+
+	if (unpair_callback) {
+		unpair_callback(a.owner, a.subindex, b.owner, b.subindex, pair.data, unpair_userdata);
+	}
+}
+
+struct BroadPhase3DBVH::PairQuery {
+	AABB aabb;
+	LocalVector<ID> *results;
+
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return aabb.intersects_inclusive(p_aabb); }
+	_FORCE_INLINE_ bool leaf(ID p_id) {
+		results->push_back(p_id);
+		return false;
+	}
+};
+
+void BroadPhase3DBVH::_update_pairs(ID p_id) {
+	Element &e = _get_element(p_id);
+
+	// Drop the pairs that don't overlap anymore.
+	for (int i = int(e.pairs.size()) - 1; i >= 0; i--) {
+		const Pair &pair = pairs[e.pairs[i]];
+		const Element &other = _get_element(pair.a == p_id ? pair.b : pair.a);
+		if ((e._static && other._static) || !e.aabb.intersects_inclusive(other.aabb)) {
+			_unpair(e.pairs[i]);
+		}
+	}
+
+	// Add the new ones.
+	PairQuery query;
+	query.aabb = e.aabb;
+	query.results = &candidates;
+	candidates.clear();
+	_traverse(query);
+
+	for (uint32_t i = 0; i < candidates.size(); i++) {
+		ID other_id = candidates[i];
+		if (other_id == p_id) {
+			continue;
+		}
+
+		const Element &other = _get_element(other_id);
+		if (other.owner == e.owner || (e._static && other._static) || !e.aabb.intersects_inclusive(other.aabb)) {
+			continue;
+		}
+
+		if (_find_pair(p_id, other_id) == INVALID_INDEX) {
+			_pair(p_id, other_id);
+		}
+	}
+}
+
+BroadPhase3DSW::ID BroadPhase3DBVH::create(CollisionObject3DSW *p_object, int p_subindex) {
+	uint32_t index;
+	if (free_elements.size()) {
+		index = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		index = elements.size();
+		elements.push_back(Element());
+	}
+
+	Element &e = elements[index];
+	e.owner = p_object;
+	e.subindex = p_subindex;
+	e._static = false;
+	e.moved = false;
+	e.aabb = AABB();
+	e.node = INVALID_INDEX; // Inserted on the first move.
+
+	return index + 1;
+}
+
+void BroadPhase3DBVH::move(ID p_id, const AABB &p_aabb) {
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size());
+	Element &e = _get_element(p_id);
+	ERR_FAIL_COND(!e.owner);
+
+	e.aabb = p_aabb;
+
+	if (e.node == INVALID_INDEX) {
+		e.node = _alloc_node();
+		Node &leaf = nodes[e.node];
+		leaf.element = p_id - 1;
+		leaf.aabb = e._static ? p_aabb : p_aabb.grow(aabb_margin);
+		_insert_leaf(e.node, root);
+	} else if (!nodes[e.node].aabb.encloses(p_aabb)) {
+		// Static objects are expected to stay where they are, so they don't get a margin.
+		nodes[e.node].aabb = e._static ? p_aabb : p_aabb.grow(aabb_margin);
+
+		uint32_t start = _remove_leaf(e.node);
+		for (uint32_t i = 0; i < REINSERT_LEVELS && start != INVALID_INDEX && nodes[start].parent != INVALID_INDEX; i++) {
+			start = nodes[start].parent;
+		}
+		_insert_leaf(e.node, start == INVALID_INDEX ? root : start);
+	}
+
+	if (!e.moved) {
+		e.moved = true;
+		moved_elements.push_back(p_id);
+	}
+}
+
+void BroadPhase3DBVH::set_static(ID p_id, bool p_static) {
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size());
+	Element &e = _get_element(p_id);
+	ERR_FAIL_COND(!e.owner);
+
+	if (e._static == p_static) {
+		return;
+	}
+
+	e._static = p_static;
+
+	// Pairs are reevaluated on update.
+	if (!e.moved && e.node != INVALID_INDEX) {
+		e.moved = true;
+		moved_elements.push_back(p_id);
+	}
+}
+
+void BroadPhase3DBVH::remove(ID p_id) {
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size());
+	Element &e = _get_element(p_id);
+	ERR_FAIL_COND(!e.owner);
+
+	while (e.pairs.size()) {
+		_unpair(e.pairs[e.pairs.size() - 1]);
+	}
+
+	if (e.node != INVALID_INDEX) {
+		_remove_leaf(e.node);
+		_free_node(e.node);
+	}
+
+	// Entries left in the moved list are skipped, as the element is not flagged anymore.
+	e = Element();
+	free_elements.push_back(p_id - 1);
+}
+
+CollisionObject3DSW *BroadPhase3DBVH::get_object(ID p_id) const {
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size(), nullptr);
+	const Element &e = elements[p_id - 1];
+	ERR_FAIL_COND_V(!e.owner, nullptr);
+	return e.owner;
+}
+
+bool BroadPhase3DBVH::is_static(ID p_id) const {
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size(), false);
+	return elements[p_id - 1]._static;
+}
+
+int BroadPhase3DBVH::get_subindex(ID p_id) const {
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size(), -1);
+	return elements[p_id - 1].subindex;
+}
+
+struct BroadPhase3DBVH::CullQuery {
+	const BroadPhase3DBVH *bvh;
+	CollisionObject3DSW **results;
+	int *result_indices;
+	int max_results;
+	int result_count = 0;
+
+	_FORCE_INLINE_ bool add(const Element &p_element) {
+		results[result_count] = p_element.owner;
+		if (result_indices) {
+			result_indices[result_count] = p_element.subindex;
+		}
+		result_count++;
+		return result_count >= max_results;
+	}
+};
+
+struct BroadPhase3DBVH::PointCullQuery : public CullQuery {
+	Vector3 point;
+
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+	_FORCE_INLINE_ bool leaf(ID p_id) {
+		const Element &e = bvh->elements[p_id - 1];
+		return e.aabb.has_point(point) && add(e);
+	}
+};
+
+struct BroadPhase3DBVH::SegmentCullQuery : public CullQuery {
+	Vector3 from;
+	Vector3 to;
+
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+	_FORCE_INLINE_ bool leaf(ID p_id) {
+		const Element &e = bvh->elements[p_id - 1];
+		return e.aabb.intersects_segment(from, to) && add(e);
+	}
+};
+
+struct BroadPhase3DBVH::AABBCullQuery : public CullQuery {
+	AABB aabb;
+
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.intersects_inclusive(aabb); }
+	_FORCE_INLINE_ bool leaf(ID p_id) {
+		const Element &e = bvh->elements[p_id - 1];
+		return e.aabb.intersects_inclusive(aabb) && add(e);
+	}
+};
+
+int BroadPhase3DBVH::cull_point(const Vector3 &p_point, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
+	if (p_max_results <= 0) {
+		return 0;
+	}
+
+	PointCullQuery query;
+	query.bvh = this;
+	query.results = p_results;
+	query.result_indices = p_result_indices;
+	query.max_results = p_max_results;
+	query.point = p_point;
+	_traverse(query);
+	return query.result_count;
+}
+
+int BroadPhase3DBVH::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
+	if (p_max_results <= 0) {
+		return 0;
+	}
+
+	SegmentCullQuery query;
+	query.bvh = this;
+	query.results = p_results;
+	query.result_indices = p_result_indices;
+	query.max_results = p_max_results;
+	query.from = p_from;
+	query.to = p_to;
+	_traverse(query);
+	return query.result_count;
+}
+
+int BroadPhase3DBVH::cull_aabb(const AABB &p_aabb, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
+	if (p_max_results <= 0) {
+		return 0;
+	}
+
+	AABBCullQuery query;
+	query.bvh = this;
+	query.results = p_results;
+	query.result_indices = p_result_indices;
+	query.max_results = p_max_results;
+	query.aabb = p_aabb;
+	_traverse(query);
+	return query.result_count;
+}
+
+void BroadPhase3DBVH::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+
+void BroadPhase3DBVH::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhase3DBVH::update() {
+	for (uint32_t i = 0; i < moved_elements.size(); i++) {
+		Element &e = _get_element(moved_elements[i]);
+		if (!e.moved) {
+			continue; // Removed since.
+		}
+		e.moved = false;
+		_update_pairs(moved_elements[i]);
+	}
+	moved_elements.clear();
+}
+
+BroadPhase3DSW *BroadPhase3DBVH::_create() {
+	return memnew(BroadPhase3DBVH);
+}
+
+BroadPhase3DBVH::BroadPhase3DBVH() {
+	aabb_margin = GLOBAL_DEF("physics/3d/bvh_aabb_margin", 0.1);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/bvh_aabb_margin", PropertyInfo(Variant::FLOAT, "physics/3d/bvh_aabb_margin", PROPERTY_HINT_RANGE, "0,1,0.01,or_greater"));
+}
+
+BroadPhase3DBVH::~BroadPhase3DBVH() {
+}
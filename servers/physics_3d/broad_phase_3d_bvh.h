@@ -0,0 +1,159 @@
+/*************************************************************************/
+/*  broad_phase_3d_bvh.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_3D_BVH_H
+#define BROAD_PHASE_3D_BVH_H
+
+#include "broad_phase_3d_sw.h"
+#include "core/local_vector.h"
+
+/*
+ * Dynamic bounding volume tree broadphase.
+ *
+ * Leaves store AABBs fattened by a margin, so objects moving a little don't
+ * touch the tree at all. Objects leaving their fat AABB are removed and
+ * reinserted starting a few levels above their old position, and the tree is
+ * refitted and rebalanced on the way up.
+ *
+ * Moves are only recorded, pairs are generated in batch on update() by
+ * querying the tree once per moved element. Pairs are created and destroyed
+ * from the real (not fattened) AABBs, same as BroadPhaseOctree.
+ */
+
+class BroadPhase3DBVH : public BroadPhase3DSW {
+	enum {
+		INVALID_INDEX = 0xFFFFFFFF,
+		REINSERT_LEVELS = 2, // How far up from the old position reinsertion starts.
+		STACK_MAX = 128, // Way above the height of a balanced tree.
+	};
+
+	struct Node {
+		AABB aabb; // Fattened, for leaves.
+		uint32_t parent = INVALID_INDEX;
+		uint32_t children[2] = { INVALID_INDEX, INVALID_INDEX };
+		uint32_t element = INVALID_INDEX; // Leaves only.
+		int32_t height = 0;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == INVALID_INDEX; }
+	};
+
+	struct Element {
+		CollisionObject3DSW *owner = nullptr;
+		int subindex = 0;
+		bool _static = false;
+		bool moved = false;
+		AABB aabb;
+		uint32_t node = INVALID_INDEX;
+		LocalVector<uint32_t> pairs;
+	};
+
+	struct Pair {
+		ID a = 0;
+		ID b = 0;
+		void *data = nullptr;
+	};
+
+	LocalVector<Node> nodes;
+	LocalVector<uint32_t> free_nodes;
+	uint32_t root = INVALID_INDEX;
+
+	LocalVector<Element> elements;
+	LocalVector<uint32_t> free_elements;
+
+	LocalVector<Pair> pairs;
+	LocalVector<uint32_t> free_pairs;
+
+	LocalVector<ID> moved_elements;
+	LocalVector<ID> candidates;
+
+	real_t aabb_margin = 0.1;
+
+	PairCallback pair_callback = nullptr;
+	void *pair_userdata = nullptr;
+	UnpairCallback unpair_callback = nullptr;
+	void *unpair_userdata = nullptr;
+
+	_FORCE_INLINE_ static real_t _get_surface(const AABB &p_aabb) {
+		const Vector3 &s = p_aabb.size;
+		return 2.0 * (s.x * s.y + s.y * s.z + s.z * s.x);
+	}
+
+	_FORCE_INLINE_ Element &_get_element(ID p_id) { return elements[p_id - 1]; }
+
+	uint32_t _alloc_node();
+	void _free_node(uint32_t p_node);
+
+	void _insert_leaf(uint32_t p_leaf, uint32_t p_start);
+	uint32_t _remove_leaf(uint32_t p_leaf);
+	void _refit(uint32_t p_node);
+	uint32_t _balance(uint32_t p_node);
+
+	// Tree queries, see the .cpp.
+	struct PairQuery;
+	struct CullQuery;
+	struct PointCullQuery;
+	struct SegmentCullQuery;
+	struct AABBCullQuery;
+
+	// Calls p_query.leaf() for every element whose fat AABB passes p_query.test(), stops when leaf() returns true.
+	template <class Q>
+	void _traverse(Q &p_query) const;
+
+	uint32_t _find_pair(ID p_a, ID p_b) const;
+	void _pair(ID p_a, ID p_b);
+	void _unpair(uint32_t p_pair);
+	void _update_pairs(ID p_id);
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObject3DSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObject3DSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices = nullptr);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices = nullptr);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices = nullptr);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhase3DSW *_create();
+	BroadPhase3DBVH();
+	~BroadPhase3DBVH();
+};
+
+#endif // BROAD_PHASE_3D_BVH_H
@@ -138,8 +138,10 @@ real_t G6DOFRotationalLimitMotor3DSW::solveAngularLimits(
 
 	Vector3 motorImp = clippedMotorImpulse * axis;
 
-	body0->apply_torque_impulse(motorImp);
-	if (body1) {
+	if (body0->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC) {
+		body0->apply_torque_impulse(motorImp);
+	}
+	if (body1 && body1->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC) {
 		body1->apply_torque_impulse(-motorImp);
 	}
 
@@ -205,8 +207,12 @@ real_t G6DOFTranslationalLimitMotor3DSW::solveLinearAxis(
 	normalImpulse = m_accumulatedImpulse[limit_index] - oldNormalImpulse;
 
 	Vector3 impulse_vector = axis_normal_on_a * normalImpulse;
-	body1->apply_impulse(impulse_vector, rel_pos1);
-	body2->apply_impulse(-impulse_vector, rel_pos2);
+	if (body1->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC) {
+		body1->apply_impulse(impulse_vector, rel_pos1);
+	}
+	if (body2->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC) {
+		body2->apply_impulse(-impulse_vector, rel_pos2);
+	}
 	return normalImpulse;
 }
 
@@ -35,6 +35,12 @@
 #include "constraint_3d_sw.h"
 
 class Joint3DSW : public Constraint3DSW {
+protected:
+	// Static and kinematic bodies can be shared by islands that are solved in
+	// parallel, impulses are only ever applied to dynamic bodies.
+	bool dynamic_A = false;
+	bool dynamic_B = false;
+
 public:
 	virtual PhysicsServer3D::JointType get_type() const = 0;
 	_FORCE_INLINE_ Joint3DSW(Body3DSW **p_body_ptr = nullptr, int p_body_count = 0) :
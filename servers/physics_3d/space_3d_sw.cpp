@@ -1113,8 +1113,27 @@ void Space3DSW::call_queries() {
 	}
 }
 
+void Space3DSW::sort_shared_contacts() {
+	if (shared_contact_bodies.empty()) {
+		return;
+	}
+
+	// A body is added once per contact, only sort each one once.
+	shared_contact_bodies.sort();
+	for (uint32_t i = 0; i < shared_contact_bodies.size(); i++) {
+		if (i == 0 || shared_contact_bodies[i] != shared_contact_bodies[i - 1]) {
+			shared_contact_bodies[i]->sort_contacts();
+		}
+	}
+	shared_contact_bodies.clear();
+}
+
 void Space3DSW::setup() {
 	contact_debug_count = 0;
+
+	// Broadphases that defer pair generation need to catch up with objects moved since the last step.
+	broadphase->update();
+
 	while (inertia_update_list.first()) {
 		inertia_update_list.first()->self()->update_inertias();
 		inertia_update_list.remove(inertia_update_list.first());
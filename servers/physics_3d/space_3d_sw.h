@@ -38,7 +38,9 @@
 #include "broad_phase_3d_sw.h"
 #include "collision_object_3d_sw.h"
 #include "core/hash_map.h"
+#include "core/local_vector.h"
 #include "core/project_settings.h"
+#include "core/spin_lock.h"
 #include "core/typedefs.h"
 
 class PhysicsDirectSpaceState3DSW : public PhysicsDirectSpaceState3D {
@@ -120,6 +122,9 @@ private:
 	Vector<Vector3> contact_debug;
 	int contact_debug_count;
 
+	SpinLock shared_state_lock;
+	LocalVector<Body3DSW *> shared_contact_bodies;
+
 	friend class PhysicsDirectSpaceState3DSW;
 
 	int _cull_aabb_for_body(Body3DSW *p_body, const AABB &p_aabb);
@@ -169,6 +174,16 @@ public:
 	void lock();
 	void unlock();
 
+	// Guards state reachable from more than one island while they are solved in parallel
+	// (areas, static and kinematic bodies, debug contacts).
+	_FORCE_INLINE_ void lock_shared_state() { shared_state_lock.lock(); }
+	_FORCE_INLINE_ void unlock_shared_state() { shared_state_lock.unlock(); }
+
+	// Contacts reported to an immovable body can come from several islands, in any order.
+	// Call with the shared state locked.
+	_FORCE_INLINE_ void add_shared_contact_body(Body3DSW *p_body) { shared_contact_bodies.push_back(p_body); }
+	void sort_shared_contacts();
+
 	void set_param(PhysicsServer3D::SpaceParameter p_param, real_t p_value);
 	real_t get_param(PhysicsServer3D::SpaceParameter p_param) const;
 
@@ -185,9 +200,11 @@ public:
 	void set_debug_contacts(int p_amount) { contact_debug.resize(p_amount); }
 	_FORCE_INLINE_ bool is_debugging_contacts() const { return !contact_debug.empty(); }
 	_FORCE_INLINE_ void add_debug_contact(const Vector3 &p_contact) {
+		shared_state_lock.lock();
 		if (contact_debug_count < contact_debug.size()) {
 			contact_debug.write[contact_debug_count++] = p_contact;
 		}
+		shared_state_lock.unlock();
 	}
 	_FORCE_INLINE_ Vector<Vector3> get_debug_contacts() { return contact_debug; }
 	_FORCE_INLINE_ int get_debug_contact_count() { return contact_debug_count; }
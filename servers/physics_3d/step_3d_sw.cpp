@@ -32,6 +32,8 @@
 #include "joints_3d_sw.h"
 
 #include "core/os/os.h"
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
 
 void Step3DSW::_populate_island(Body3DSW *p_body, Body3DSW **p_island, Constraint3DSW **p_constraint_island) {
 	p_body->set_island_step(_step);
@@ -103,7 +105,7 @@ void Step3DSW::_solve_island(Constraint3DSW *p_island, int p_iterations, real_t
 	}
 }
 
-void Step3DSW::_check_suspend(Body3DSW *p_island, real_t p_delta) {
+bool Step3DSW::_test_suspend(Body3DSW *p_island, real_t p_delta) {
 	bool can_sleep = true;
 
 	Body3DSW *b = p_island;
@@ -120,9 +122,13 @@ void Step3DSW::_check_suspend(Body3DSW *p_island, real_t p_delta) {
 		b = b->get_island_next();
 	}
 
+	return can_sleep;
+}
+
+void Step3DSW::_apply_suspend(Body3DSW *p_island, bool p_can_sleep) {
 	//put all to sleep or wake up everyoen
 
-	b = p_island;
+	Body3DSW *b = p_island;
 	while (b) {
 		if (b->get_mode() == PhysicsServer3D::BODY_MODE_STATIC || b->get_mode() == PhysicsServer3D::BODY_MODE_KINEMATIC) {
 			b = b->get_island_next();
@@ -131,14 +137,26 @@ void Step3DSW::_check_suspend(Body3DSW *p_island, real_t p_delta) {
 
 		bool active = b->is_active();
 
-		if (active == can_sleep) {
-			b->set_active(!can_sleep);
+		if (active == p_can_sleep) {
+			b->set_active(!p_can_sleep);
 		}
 
 		b = b->get_island_next();
 	}
 }
 
+void Step3DSW::_setup_island_job(uint32_t p_index, void *p_userdata) {
+	_setup_island(constraint_islands[p_index], island_delta);
+}
+
+void Step3DSW::_solve_island_job(uint32_t p_index, void *p_userdata) {
+	_solve_island(constraint_islands[p_index], island_iterations, island_delta);
+}
+
+void Step3DSW::_test_suspend_job(uint32_t p_index, void *p_userdata) {
+	body_island_can_sleep[p_index] = _test_suspend(body_islands[p_index], island_delta);
+}
+
 void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 	p_space->lock(); // can't access space during this
 
@@ -170,8 +188,8 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
-	Body3DSW *island_list = nullptr;
-	Constraint3DSW *constraint_island_list = nullptr;
+	body_islands.clear();
+	constraint_islands.clear();
 	b = body_list->first();
 
 	int island_count = 0;
@@ -184,12 +202,10 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 			Constraint3DSW *constraint_island = nullptr;
 			_populate_island(body, &island, &constraint_island);
 
-			island->set_island_list_next(island_list);
-			island_list = island;
+			body_islands.push_back(island);
 
 			if (constraint_island) {
-				constraint_island->set_island_list_next(constraint_island_list);
-				constraint_island_list = constraint_island;
+				constraint_islands.push_back(constraint_island);
 				island_count++;
 			}
 		}
@@ -208,8 +224,7 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 			}
 			c->set_island_step(_step);
 			c->set_island_next(nullptr);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			constraint_islands.push_back(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<Area3DSW> *)aml.first()); //faster to remove here
 	}
@@ -220,16 +235,25 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 		profile_begtime = profile_endtime;
 	}
 
+	ThreadWorkPool *work_pool = ThreadWorkPool::get_singleton();
+	bool parallel = parallel_islands && work_pool && work_pool->get_thread_count() > 1;
+
+	island_delta = p_delta;
+	island_iterations = p_iterations;
+
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint3DSW *ci = constraint_island_list;
-		while (ci) {
-			_setup_island(ci, p_delta);
-			ci = ci->get_island_list_next();
+	if (parallel && constraint_islands.size() > 1) {
+		work_pool->do_work(constraint_islands.size(), this, &Step3DSW::_setup_island_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			_setup_island(constraint_islands[i], p_delta);
 		}
 	}
 
+	// Reported contacts must not depend on the order islands were set up in.
+	p_space->sort_shared_contacts();
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space3DSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -238,12 +262,12 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint3DSW *ci = constraint_island_list;
-		while (ci) {
+	if (parallel && constraint_islands.size() > 1) {
+		work_pool->do_work(constraint_islands.size(), this, &Step3DSW::_solve_island_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
 			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+			_solve_island(constraint_islands[i], p_iterations, p_delta);
 		}
 	}
 
@@ -264,14 +288,20 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SLEEP / WAKE UP ISLANDS */
 
-	{
-		Body3DSW *bi = island_list;
-		while (bi) {
-			_check_suspend(bi, p_delta);
-			bi = bi->get_island_list_next();
+	body_island_can_sleep.resize(body_islands.size());
+	if (parallel && body_islands.size() > 1) {
+		work_pool->do_work(body_islands.size(), this, &Step3DSW::_test_suspend_job, nullptr, 0);
+	} else {
+		for (uint32_t i = 0; i < body_islands.size(); i++) {
+			body_island_can_sleep[i] = _test_suspend(body_islands[i], p_delta);
 		}
 	}
 
+	// Changing the active state modifies the space lists, so it's always done here.
+	for (uint32_t i = 0; i < body_islands.size(); i++) {
+		_apply_suspend(body_islands[i], body_island_can_sleep[i]);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space3DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES, profile_endtime - profile_begtime);
@@ -285,4 +315,5 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 Step3DSW::Step3DSW() {
 	_step = 1;
+	parallel_islands = GLOBAL_DEF("physics/3d/parallel_islands", true);
 }
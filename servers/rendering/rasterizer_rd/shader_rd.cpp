@@ -31,6 +31,7 @@
 #include "shader_rd.h"
 
 #include "core/string_builder.h"
+#include "core/thread_work_pool.h"
 #include "rasterizer_rd.h"
 #include "servers/rendering/rendering_device.h"
 
@@ -354,14 +355,16 @@ void ShaderRD::_compile_version(Version *p_version) {
 	p_version->dirty = false;
 
 	p_version->variants = memnew_arr(RID, variant_defines.size());
-#if 1
 
-	RasterizerRD::thread_work_pool.do_work(variant_defines.size(), this, &ShaderRD::_compile_variant, p_version);
-#else
-	for (int i = 0; i < variant_defines.size(); i++) {
-		_compile_variant(i, p_version);
+	// The pool doesn't exist yet when running tests or some tools.
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (pool) {
+		pool->do_work(variant_defines.size(), this, &ShaderRD::_compile_variant, p_version);
+	} else {
+		for (int i = 0; i < variant_defines.size(); i++) {
+			_compile_variant(i, p_version);
+		}
 	}
-#endif
 
 	bool all_valid = true;
 	for (int i = 0; i < variant_defines.size(); i++) {
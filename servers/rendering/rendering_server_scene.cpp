@@ -31,11 +31,17 @@
 #include "rendering_server_scene.h"
 
 #include "core/os/os.h"
+#include "core/thread_work_pool.h"
 #include "rendering_server_globals.h"
 #include "rendering_server_raster.h"
 
 #include <new>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 /* CAMERA API */
 
 RID RenderingServerScene::camera_create() {
@@ -364,6 +370,7 @@ void RenderingServerScene::instance_set_base(RID p_instance, RID p_base) {
 		if (scenario && instance->octree_id) {
 			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
 			instance->octree_id = 0;
+			_instance_remove_cull_bounds(instance);
 		}
 
 		switch (instance->base_type) {
@@ -519,6 +526,7 @@ void RenderingServerScene::instance_set_scenario(RID p_instance, RID p_scenario)
 		if (instance->octree_id) {
 			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
 			instance->octree_id = 0;
+			_instance_remove_cull_bounds(instance);
 		}
 
 		switch (instance->base_type) {
@@ -856,6 +864,7 @@ void RenderingServerScene::instance_geometry_set_flag(RID p_instance, RS::Instan
 				//remove from octree, it needs to be re-paired
 				instance->scenario->octree.erase(instance->octree_id);
 				instance->octree_id = 0;
+				_instance_remove_cull_bounds(instance);
 				_instance_queue_update(instance, true, true);
 			}
 
@@ -1102,6 +1111,41 @@ void RenderingServerScene::_update_instance(Instance *p_instance) {
 
 		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
 	}
+
+	_instance_update_cull_bounds(p_instance);
+}
+
+void RenderingServerScene::_instance_update_cull_bounds(Instance *p_instance) {
+	Scenario *scenario = p_instance->scenario;
+
+	if (p_instance->cull_index < 0) {
+		p_instance->cull_index = scenario->instance_bounds.size();
+		scenario->instance_bounds.push_back(InstanceBounds());
+		scenario->instance_cull_list.push_back(p_instance);
+	}
+
+	scenario->instance_bounds[p_instance->cull_index].set(p_instance->transformed_aabb);
+}
+
+void RenderingServerScene::_instance_remove_cull_bounds(Instance *p_instance) {
+	if (p_instance->cull_index < 0) {
+		return;
+	}
+
+	Scenario *scenario = p_instance->scenario;
+	uint32_t index = p_instance->cull_index;
+	uint32_t last = scenario->instance_bounds.size() - 1;
+
+	if (index != last) {
+		//move the last one in place of the removed one
+		scenario->instance_bounds[index] = scenario->instance_bounds[last];
+		scenario->instance_cull_list[index] = scenario->instance_cull_list[last];
+		scenario->instance_cull_list[index]->cull_index = index;
+	}
+
+	scenario->instance_bounds.resize(last);
+	scenario->instance_cull_list.resize(last);
+	p_instance->cull_index = -1;
 }
 
 void RenderingServerScene::_update_instance_aabb(Instance *p_instance) {
@@ -1281,7 +1325,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			if (depth_range_mode == RS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
 				//optimize min/max
 				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+				_cull_convex(p_scenario, planes, RS::INSTANCE_GEOMETRY_MASK, instance_shadow_cull_result);
+				int cull_count = instance_shadow_cull_result.size();
 				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
 				//check distance max and min
 
@@ -1505,7 +1550,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+				_cull_convex(p_scenario, light_frustum_planes, RS::INSTANCE_GEOMETRY_MASK, instance_shadow_cull_result);
+				int cull_count = instance_shadow_cull_result.size();
 
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
@@ -1628,7 +1674,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					RSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, z_max - z_min_cam, distances[i + 1], i, radius * 2.0 / texture_size, bias_scale * aspect_bias_scale * min_distance_bias_scale, z_max, uv_scale);
 				}
 
-				RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+				RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result.ptr(), cull_count);
 			}
 
 		} break;
@@ -1652,7 +1698,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 					planes.write[5] = light_transform.xform(Plane(Vector3(0, 0, -z), 0));
 
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+					_cull_convex_octree(p_scenario, planes, RS::INSTANCE_GEOMETRY_MASK, instance_shadow_cull_result);
+					int cull_count = instance_shadow_cull_result.size();
 					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
 
 					for (int j = 0; j < cull_count; j++) {
@@ -1672,7 +1719,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					}
 
 					RSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i, 0);
-					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result.ptr(), cull_count);
 				}
 			} else { //shadow cube
 
@@ -1705,7 +1752,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 
 					Vector<Plane> planes = cm.get_projection_planes(xform);
 
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+					_cull_convex_octree(p_scenario, planes, RS::INSTANCE_GEOMETRY_MASK, instance_shadow_cull_result);
+					int cull_count = instance_shadow_cull_result.size();
 
 					Plane near_plane(xform.origin, -xform.basis.get_axis(2));
 					for (int j = 0; j < cull_count; j++) {
@@ -1724,7 +1772,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					}
 
 					RSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i, 0);
-					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result.ptr(), cull_count);
 				}
 
 				//restore the regular DP matrix
@@ -1742,7 +1790,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+			_cull_convex_octree(p_scenario, planes, RS::INSTANCE_GEOMETRY_MASK, instance_shadow_cull_result);
+			int cull_count = instance_shadow_cull_result.size();
 
 			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
 			for (int j = 0; j < cull_count; j++) {
@@ -1761,7 +1810,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			}
 
 			RSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0, 0);
-			RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+			RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result.ptr(), cull_count);
 
 		} break;
 	}
@@ -1903,6 +1952,300 @@ void RenderingServerScene::render_camera(RID p_render_buffers, Ref<XRInterface>
 	_render_scene(p_render_buffers, cam_transform, camera_matrix, false, environment, camera->effects, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
+/* CULLING */
+
+bool RenderingServerScene::CullPlanes::setup(const Vector<Plane> &p_planes) {
+	ERR_FAIL_COND_V(p_planes.size() > CULL_MAX_PLANES, false);
+
+	if (p_planes.empty()) {
+		return false;
+	}
+
+	Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(p_planes.ptr(), p_planes.size());
+	if (points.empty()) {
+		return false; //empty shape, nothing can be inside
+	}
+
+	AABB shape_aabb(points[0], Vector3());
+	for (int i = 1; i < points.size(); i++) {
+		shape_aabb.expand_to(points[i]);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		shape_min[i] = shape_aabb.position[i];
+		shape_max[i] = shape_aabb.position[i] + shape_aabb.size[i];
+	}
+	shape_min[3] = 0;
+	shape_max[3] = 0;
+
+	pack_count = (p_planes.size() + 3) / 4;
+
+	for (uint32_t i = 0; i < pack_count * 4; i++) {
+		if (i < (uint32_t)p_planes.size()) {
+			const Plane &p = p_planes[i];
+			normal_x[i] = p.normal.x;
+			normal_y[i] = p.normal.y;
+			normal_z[i] = p.normal.z;
+			d[i] = p.d;
+		} else {
+			normal_x[i] = 0;
+			normal_y[i] = 0;
+			normal_z[i] = 0;
+			d[i] = 1e20;
+		}
+		abs_normal_x[i] = Math::abs(normal_x[i]);
+		abs_normal_y[i] = Math::abs(normal_y[i]);
+		abs_normal_z[i] = Math::abs(normal_z[i]);
+	}
+
+	return true;
+}
+
+// Same test as AABB::intersects_convex_shape(): a box is outside when it is
+// fully in front of any plane, or fully on one side of the shape's points.
+bool RenderingServerScene::_cull_bounds_test(const CullPlanes &p_planes, const InstanceBounds &p_bounds) {
+#ifdef CULL_USE_SSE
+	__m128 center = _mm_load_ps(p_bounds.center);
+	__m128 extents = _mm_load_ps(p_bounds.extents);
+
+	__m128 above = _mm_cmpgt_ps(_mm_sub_ps(center, extents), _mm_load_ps(p_planes.shape_max));
+	__m128 below = _mm_cmplt_ps(_mm_add_ps(center, extents), _mm_load_ps(p_planes.shape_min));
+	if (_mm_movemask_ps(_mm_or_ps(above, below))) {
+		return false;
+	}
+
+	__m128 cx = _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 cy = _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 cz = _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 ex = _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 ey = _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 ez = _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(2, 2, 2, 2));
+
+	for (uint32_t i = 0; i < p_planes.pack_count; i++) {
+		uint32_t ofs = i * 4;
+		__m128 dist = _mm_mul_ps(cx, _mm_load_ps(&p_planes.normal_x[ofs]));
+		dist = _mm_add_ps(dist, _mm_mul_ps(cy, _mm_load_ps(&p_planes.normal_y[ofs])));
+		dist = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_load_ps(&p_planes.normal_z[ofs])));
+
+		__m128 radius = _mm_mul_ps(ex, _mm_load_ps(&p_planes.abs_normal_x[ofs]));
+		radius = _mm_add_ps(radius, _mm_mul_ps(ey, _mm_load_ps(&p_planes.abs_normal_y[ofs])));
+		radius = _mm_add_ps(radius, _mm_mul_ps(ez, _mm_load_ps(&p_planes.abs_normal_z[ofs])));
+
+		if (_mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(dist, radius), _mm_load_ps(&p_planes.d[ofs])))) {
+			return false;
+		}
+	}
+
+	return true;
+#else
+	for (uint32_t i = 0; i < 3; i++) {
+		if (p_bounds.center[i] - p_bounds.extents[i] > p_planes.shape_max[i] || p_bounds.center[i] + p_bounds.extents[i] < p_planes.shape_min[i]) {
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < p_planes.pack_count; i++) {
+		uint32_t ofs = i * 4;
+		bool outside = false;
+		// Written so each pack of four planes can be vectorized by the compiler.
+		for (uint32_t j = ofs; j < ofs + 4; j++) {
+			float dist = p_bounds.center[0] * p_planes.normal_x[j] + p_bounds.center[1] * p_planes.normal_y[j] + p_bounds.center[2] * p_planes.normal_z[j];
+			float radius = p_bounds.extents[0] * p_planes.abs_normal_x[j] + p_bounds.extents[1] * p_planes.abs_normal_y[j] + p_bounds.extents[2] * p_planes.abs_normal_z[j];
+			outside |= dist - radius > p_planes.d[j];
+		}
+		if (outside) {
+			return false;
+		}
+	}
+
+	return true;
+#endif
+}
+
+void RenderingServerScene::_cull_prepare_instance(Instance *p_instance, CullChunk &r_chunk, const CullData *p_data) {
+	if ((p_data->layer_mask & p_instance->layer_mask) == 0) {
+		p_instance->last_render_pass = 0; // make invalid
+
+	} else if (((1 << p_instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) && p_instance->visible && p_instance->cast_shadows != RS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(p_instance->base_data);
+
+		if (geom->lighting_dirty) {
+			int l = 0;
+			//only called when lights AABB enter/exit this geometry
+			p_instance->light_instances.resize(geom->lighting.size());
+
+			for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+
+				p_instance->light_instances.write[l++] = light->instance;
+			}
+
+			geom->lighting_dirty = false;
+		}
+
+		if (geom->reflection_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			p_instance->reflection_probe_instances.resize(geom->reflection_probes.size());
+
+			for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
+				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+
+				p_instance->reflection_probe_instances.write[l++] = reflection_probe->instance;
+			}
+
+			geom->reflection_dirty = false;
+		}
+
+		if (geom->gi_probes_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			p_instance->gi_probe_instances.resize(geom->gi_probes.size());
+
+			for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+
+				p_instance->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+			}
+
+			geom->gi_probes_dirty = false;
+		}
+
+		if (p_instance->last_frame_pass != p_data->frame_number && !p_instance->lightmap_target_sh.empty() && !p_instance->lightmap_sh.empty()) {
+			Color *sh = p_instance->lightmap_sh.ptrw();
+			const Color *target_sh = p_instance->lightmap_target_sh.ptr();
+			for (uint32_t j = 0; j < 9; j++) {
+				sh[j] = sh[j].lerp(target_sh[j], MIN(1.0, p_data->lightmap_probe_update_speed));
+			}
+		}
+
+		p_instance->depth = p_data->near_plane.distance_to(p_instance->transform.origin);
+		p_instance->depth_layer = CLAMP(int(p_instance->depth * 16 / p_data->z_far), 0, 15);
+
+		if (p_instance->redraw_if_visible || p_instance->base_type == RS::INSTANCE_PARTICLES) {
+			//needs the storage or a redraw, finished on the render thread
+			p_instance->last_render_pass = 0;
+			r_chunk.deferred.push_back(p_instance);
+		} else {
+			p_instance->last_render_pass = render_pass;
+			r_chunk.result.push_back(p_instance);
+		}
+
+	} else {
+		p_instance->last_render_pass = 0; // make invalid
+
+		if (p_instance->visible && !((1 << p_instance->base_type) & RS::INSTANCE_GEOMETRY_MASK)) {
+			//lights, probes, decals and lightmaps
+			r_chunk.deferred.push_back(p_instance);
+		}
+	}
+
+	p_instance->last_frame_pass = p_data->frame_number;
+}
+
+void RenderingServerScene::_cull_chunk_job(uint32_t p_chunk, CullData *p_data) {
+	CullChunk &chunk = cull_chunks[p_chunk];
+	chunk.result.clear();
+	chunk.deferred.clear();
+
+	const Scenario *scenario = p_data->scenario;
+	const InstanceBounds *bounds = scenario->instance_bounds.ptr();
+	Instance *const *instances = scenario->instance_cull_list.ptr();
+
+	uint32_t from = p_chunk * CULL_CHUNK_SIZE;
+	uint32_t to = MIN(from + CULL_CHUNK_SIZE, scenario->instance_bounds.size());
+
+	for (uint32_t i = from; i < to; i++) {
+		if (!_cull_bounds_test(p_data->planes, bounds[i])) {
+			continue;
+		}
+
+		Instance *instance = instances[i];
+		if (!((1 << instance->base_type) & p_data->type_mask)) {
+			continue;
+		}
+
+		if (p_data->prepare_scene) {
+			_cull_prepare_instance(instance, chunk, p_data);
+		} else {
+			chunk.result.push_back(instance);
+		}
+	}
+}
+
+uint32_t RenderingServerScene::_cull_chunks(CullData *p_data) {
+	uint32_t chunk_count = (p_data->scenario->instance_bounds.size() + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+	if (cull_chunks.size() < chunk_count) {
+		cull_chunks.resize(chunk_count);
+	}
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+
+	if (chunk_count > 1 && pool && pool->get_thread_count() > 1) {
+		pool->do_work(chunk_count, this, &RenderingServerScene::_cull_chunk_job, p_data);
+	} else {
+		for (uint32_t i = 0; i < chunk_count; i++) {
+			_cull_chunk_job(i, p_data);
+		}
+	}
+
+	return chunk_count;
+}
+
+void RenderingServerScene::_cull_append(LocalVector<Instance *> &r_result, const LocalVector<Instance *> &p_chunk_result) {
+	if (p_chunk_result.empty()) {
+		return;
+	}
+
+	uint32_t ofs = r_result.size();
+	r_result.resize(ofs + p_chunk_result.size());
+	memcpy(&r_result[ofs], p_chunk_result.ptr(), sizeof(Instance *) * p_chunk_result.size());
+}
+
+void RenderingServerScene::_cull_convex(Scenario *p_scenario, const Vector<Plane> &p_convex, uint32_t p_type_mask, LocalVector<Instance *> &r_result) {
+	r_result.clear();
+
+	CullData data;
+	if (!data.planes.setup(p_convex)) {
+		return;
+	}
+	data.scenario = p_scenario;
+	data.type_mask = p_type_mask;
+
+	uint32_t chunk_count = _cull_chunks(&data);
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		_cull_append(r_result, cull_chunks[i].result);
+	}
+}
+
+void RenderingServerScene::_cull_aabb(Scenario *p_scenario, const AABB &p_aabb, uint32_t p_type_mask, LocalVector<Instance *> &r_result) {
+	Vector3 end = p_aabb.position + p_aabb.size;
+
+	Vector<Plane> planes;
+	planes.resize(6);
+	planes.write[0] = Plane(Vector3(1, 0, 0), end.x);
+	planes.write[1] = Plane(Vector3(-1, 0, 0), -p_aabb.position.x);
+	planes.write[2] = Plane(Vector3(0, 1, 0), end.y);
+	planes.write[3] = Plane(Vector3(0, -1, 0), -p_aabb.position.y);
+	planes.write[4] = Plane(Vector3(0, 0, 1), end.z);
+	planes.write[5] = Plane(Vector3(0, 0, -1), -p_aabb.position.z);
+
+	_cull_convex(p_scenario, planes, p_type_mask, r_result);
+}
+
+// Omni and spot light volumes are usually a small part of the scenario. The
+// octree skips most of it, where the chunked scan tests every instance.
+void RenderingServerScene::_cull_convex_octree(Scenario *p_scenario, const Vector<Plane> &p_convex, uint32_t p_type_mask, LocalVector<Instance *> &r_result) {
+	uint32_t max_count = p_scenario->instance_cull_list.size();
+	r_result.resize(max_count);
+	if (max_count == 0) {
+		return;
+	}
+
+	int count = p_scenario->octree.cull_convex(p_convex, r_result.ptr(), max_count, p_type_mask);
+	r_result.resize(count);
+}
+
 void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, RID p_render_buffers, RID p_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
@@ -1925,11 +2268,30 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 
 	Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
 
-	Plane near_plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
-	float z_far = p_cam_projection.get_z_far();
-
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+
+	// Visible geometry is prepared for drawing by the cull jobs, everything
+	// else that was found is processed below, in chunk order.
+	CullData cull_data;
+	cull_data.scenario = scenario;
+	cull_data.type_mask = 0xFFFFFFFF;
+	cull_data.prepare_scene = true;
+	cull_data.layer_mask = camera_layer_mask;
+	cull_data.near_plane = Plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
+	cull_data.z_far = p_cam_projection.get_z_far();
+	cull_data.frame_number = RSG::rasterizer->get_frame_number();
+	cull_data.lightmap_probe_update_speed = RSG::storage->lightmap_get_probe_capture_update_speed() * RSG::rasterizer->get_frame_delta_time();
+
+	uint32_t cull_chunk_count = 0;
+	if (cull_data.planes.setup(planes)) {
+		cull_chunk_count = _cull_chunks(&cull_data);
+	}
+
+	instance_cull_result.clear();
+	for (uint32_t i = 0; i < cull_chunk_count; i++) {
+		_cull_append(instance_cull_result, cull_chunks[i].result);
+	}
+
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -1949,170 +2311,107 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
 	//removed, will replace with culling
 
-	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
-	uint64_t frame_number = RSG::rasterizer->get_frame_number();
-	float lightmap_probe_update_speed = RSG::storage->lightmap_get_probe_capture_update_speed() * RSG::rasterizer->get_frame_delta_time();
+	/* STEP 4 - ADD LIGHTS, PROBES AND GEOMETRY THAT NEEDS THE RASTERIZER */
 
-	for (int i = 0; i < instance_cull_count; i++) {
-		Instance *ins = instance_cull_result[i];
+	for (uint32_t i = 0; i < cull_chunk_count; i++) {
+		const LocalVector<Instance *> &deferred = cull_chunks[i].deferred;
 
-		bool keep = false;
+		for (uint32_t j = 0; j < deferred.size(); j++) {
+			Instance *ins = deferred[j];
 
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
-			//failure
-		} else if (ins->base_type == RS::INSTANCE_LIGHT && ins->visible) {
-			if (light_cull_count < MAX_LIGHTS_CULLED) {
-				InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
+			if (ins->base_type == RS::INSTANCE_LIGHT) {
+				if (light_cull_count < MAX_LIGHTS_CULLED) {
+					InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
 
-				if (!light->geometries.empty()) {
-					//do not add this light if no geometry is affected by it..
-					light_cull_result[light_cull_count] = ins;
-					light_instance_cull_result[light_cull_count] = light->instance;
-					if (p_shadow_atlas.is_valid() && RSG::storage->light_has_shadow(ins->base)) {
-						RSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
-					}
+					if (!light->geometries.empty()) {
+						//do not add this light if no geometry is affected by it..
+						light_cull_result[light_cull_count] = ins;
+						light_instance_cull_result[light_cull_count] = light->instance;
+						if (p_shadow_atlas.is_valid() && RSG::storage->light_has_shadow(ins->base)) {
+							RSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
+						}
 
-					light_cull_count++;
+						light_cull_count++;
+					}
 				}
-			}
-		} else if (ins->base_type == RS::INSTANCE_REFLECTION_PROBE && ins->visible) {
-			if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
-				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
+			} else if (ins->base_type == RS::INSTANCE_REFLECTION_PROBE) {
+				if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
+					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
 
-				if (p_reflection_probe != reflection_probe->instance) {
-					//avoid entering The Matrix
+					if (p_reflection_probe != reflection_probe->instance) {
+						//avoid entering The Matrix
 
-					if (!reflection_probe->geometries.empty()) {
-						//do not add this light if no geometry is affected by it..
+						if (!reflection_probe->geometries.empty()) {
+							//do not add this light if no geometry is affected by it..
 
-						if (reflection_probe->reflection_dirty || RSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
-							if (!reflection_probe->update_list.in_list()) {
-								reflection_probe->render_step = 0;
-								reflection_probe_render_list.add_last(&reflection_probe->update_list);
-							}
+							if (reflection_probe->reflection_dirty || RSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
+								if (!reflection_probe->update_list.in_list()) {
+									reflection_probe->render_step = 0;
+									reflection_probe_render_list.add_last(&reflection_probe->update_list);
+								}
 
-							reflection_probe->reflection_dirty = false;
-						}
+								reflection_probe->reflection_dirty = false;
+							}
 
-						if (RSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
-							reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
-							reflection_probe_cull_count++;
+							if (RSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
+								reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
+								reflection_probe_cull_count++;
+							}
 						}
 					}
 				}
-			}
-		} else if (ins->base_type == RS::INSTANCE_DECAL && ins->visible) {
-			if (decal_cull_count < MAX_DECALS_CULLED) {
-				InstanceDecalData *decal = static_cast<InstanceDecalData *>(ins->base_data);
-
-				if (!decal->geometries.empty()) {
-					//do not add this decal if no geometry is affected by it..
-					decal_instance_cull_result[decal_cull_count] = decal->instance;
-					decal_cull_count++;
+			} else if (ins->base_type == RS::INSTANCE_DECAL) {
+				if (decal_cull_count < MAX_DECALS_CULLED) {
+					InstanceDecalData *decal = static_cast<InstanceDecalData *>(ins->base_data);
+
+					if (!decal->geometries.empty()) {
+						//do not add this decal if no geometry is affected by it..
+						decal_instance_cull_result[decal_cull_count] = decal->instance;
+						decal_cull_count++;
+					}
 				}
-			}
-
-		} else if (ins->base_type == RS::INSTANCE_GI_PROBE && ins->visible) {
-			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
-			if (!gi_probe->update_element.in_list()) {
-				gi_probe_update_list.add(&gi_probe->update_element);
-			}
-
-			if (gi_probe_cull_count < MAX_GI_PROBES_CULLED) {
-				gi_probe_instance_cull_result[gi_probe_cull_count] = gi_probe->probe_instance;
-				gi_probe_cull_count++;
-			}
-		} else if (ins->base_type == RS::INSTANCE_LIGHTMAP && ins->visible) {
-			if (lightmap_cull_count < MAX_LIGHTMAPS_CULLED) {
-				lightmap_cull_result[lightmap_cull_count] = ins;
-				lightmap_cull_count++;
-			}
-
-		} else if (((1 << ins->base_type) & RS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != RS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
-			keep = true;
-
-			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
-
-			if (ins->redraw_if_visible) {
-				RenderingServerRaster::redraw_request();
-			}
 
-			if (ins->base_type == RS::INSTANCE_PARTICLES) {
-				//particles visible? process them
-				if (RSG::storage->particles_is_inactive(ins->base)) {
-					//but if nothing is going on, don't do it.
-					keep = false;
-				} else {
-					RSG::storage->particles_request_process(ins->base);
-					//particles visible? request redraw
-					RenderingServerRaster::redraw_request();
+			} else if (ins->base_type == RS::INSTANCE_GI_PROBE) {
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
+				if (!gi_probe->update_element.in_list()) {
+					gi_probe_update_list.add(&gi_probe->update_element);
 				}
-			}
 
-			if (geom->lighting_dirty) {
-				int l = 0;
-				//only called when lights AABB enter/exit this geometry
-				ins->light_instances.resize(geom->lighting.size());
-
-				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
-					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
-
-					ins->light_instances.write[l++] = light->instance;
+				if (gi_probe_cull_count < MAX_GI_PROBES_CULLED) {
+					gi_probe_instance_cull_result[gi_probe_cull_count] = gi_probe->probe_instance;
+					gi_probe_cull_count++;
 				}
-
-				geom->lighting_dirty = false;
-			}
-
-			if (geom->reflection_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
-
-				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
-					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
-
-					ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
+			} else if (ins->base_type == RS::INSTANCE_LIGHTMAP) {
+				if (lightmap_cull_count < MAX_LIGHTMAPS_CULLED) {
+					lightmap_cull_result[lightmap_cull_count] = ins;
+					lightmap_cull_count++;
 				}
 
-				geom->reflection_dirty = false;
-			}
-
-			if (geom->gi_probes_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->gi_probe_instances.resize(geom->gi_probes.size());
+			} else if ((1 << ins->base_type) & RS::INSTANCE_GEOMETRY_MASK) {
+				bool keep = true;
 
-				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
-					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
-
-					ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+				if (ins->redraw_if_visible) {
+					RenderingServerRaster::redraw_request();
 				}
 
-				geom->gi_probes_dirty = false;
-			}
+				if (ins->base_type == RS::INSTANCE_PARTICLES) {
+					//particles visible? process them
+					if (RSG::storage->particles_is_inactive(ins->base)) {
+						//but if nothing is going on, don't do it.
+						keep = false;
+					} else {
+						RSG::storage->particles_request_process(ins->base);
+						//particles visible? request redraw
+						RenderingServerRaster::redraw_request();
+					}
+				}
 
-			if (ins->last_frame_pass != frame_number && !ins->lightmap_target_sh.empty() && !ins->lightmap_sh.empty()) {
-				Color *sh = ins->lightmap_sh.ptrw();
-				const Color *target_sh = ins->lightmap_target_sh.ptr();
-				for (uint32_t j = 0; j < 9; j++) {
-					sh[j] = sh[j].lerp(target_sh[j], MIN(1.0, lightmap_probe_update_speed));
+				if (keep) {
+					ins->last_render_pass = render_pass;
+					instance_cull_result.push_back(ins);
 				}
 			}
-
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
 		}
-
-		if (!keep) {
-			// remove, no reason to keep
-			instance_cull_count--;
-			SWAP(instance_cull_result[i], instance_cull_result[instance_cull_count]);
-			i--;
-			ins->last_render_pass = 0; // make invalid
-		} else {
-			ins->last_render_pass = render_pass;
-		}
-		ins->last_frame_pass = frame_number;
 	}
 
 	/* STEP 5 - PROCESS LIGHTS */
@@ -2279,7 +2578,8 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 				sdfgi_light_cull_pass++;
 				prev_cascade = region_cascade;
 			}
-			uint32_t sdfgi_cull_count = scenario->octree.cull_aabb(region, instance_shadow_cull_result, MAX_INSTANCE_CULL);
+			_cull_aabb(scenario, region, RS::INSTANCE_GEOMETRY_MASK | (1 << RS::INSTANCE_LIGHT), instance_shadow_cull_result);
+			uint32_t sdfgi_cull_count = instance_shadow_cull_result.size();
 
 			for (uint32_t j = 0; j < sdfgi_cull_count; j++) {
 				Instance *ins = instance_shadow_cull_result[j];
@@ -2311,7 +2611,7 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 				}
 			}
 
-			RSG::scene_render->render_sdfgi(p_render_buffers, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, sdfgi_cull_count);
+			RSG::scene_render->render_sdfgi(p_render_buffers, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result.ptr(), sdfgi_cull_count);
 			//have to save updated cascades, then update static lights.
 		}
 
@@ -2356,7 +2656,7 @@ void RenderingServerScene::_render_scene(RID p_render_buffers, const Transform p
 	/* PROCESS GEOMETRY AND DRAW SCENE */
 
 	RENDER_TIMESTAMP("Render Scene ");
-	RSG::scene_render->render_scene(p_render_buffers, p_cam_transform, p_cam_projection, p_cam_orthogonal, (RasterizerScene::InstanceBase **)instance_cull_result, instance_cull_count, light_instance_cull_result, light_cull_count + directional_light_count, reflection_probe_instance_cull_result, reflection_probe_cull_count, gi_probe_instance_cull_result, gi_probe_cull_count, decal_instance_cull_result, decal_cull_count, (RasterizerScene::InstanceBase **)lightmap_cull_result, lightmap_cull_count, p_environment, camera_effects, p_shadow_atlas, p_reflection_probe.is_valid() ? RID() : scenario->reflection_atlas, p_reflection_probe, p_reflection_probe_pass);
+	RSG::scene_render->render_scene(p_render_buffers, p_cam_transform, p_cam_projection, p_cam_orthogonal, (RasterizerScene::InstanceBase **)instance_cull_result.ptr(), instance_cull_result.size(), light_instance_cull_result, light_cull_count + directional_light_count, reflection_probe_instance_cull_result, reflection_probe_cull_count, gi_probe_instance_cull_result, gi_probe_cull_count, decal_instance_cull_result, decal_cull_count, (RasterizerScene::InstanceBase **)lightmap_cull_result, lightmap_cull_count, p_environment, camera_effects, p_shadow_atlas, p_reflection_probe.is_valid() ? RID() : scenario->reflection_atlas, p_reflection_probe, p_reflection_probe_pass);
 }
 
 void RenderingServerScene::render_empty_scene(RID p_render_buffers, RID p_scenario, RID p_shadow_atlas) {
@@ -2642,35 +2942,33 @@ void RenderingServerScene::render_probes() {
 			update_lights = true;
 		}
 
-		instance_cull_count = 0;
+		instance_cull_result.clear();
 		for (List<InstanceGIProbeData::PairInfo>::Element *E = probe->dynamic_geometries.front(); E; E = E->next()) {
-			if (instance_cull_count < MAX_INSTANCE_CULL) {
-				Instance *ins = E->get().geometry;
-				if (!ins->visible) {
-					continue;
-				}
-				InstanceGeometryData *geom = (InstanceGeometryData *)ins->base_data;
-
-				if (geom->gi_probes_dirty) {
-					//giprobes may be dirty, so update
-					int l = 0;
-					//only called when reflection probe AABB enter/exit this geometry
-					ins->gi_probe_instances.resize(geom->gi_probes.size());
+			Instance *ins = E->get().geometry;
+			if (!ins->visible) {
+				continue;
+			}
+			InstanceGeometryData *geom = (InstanceGeometryData *)ins->base_data;
 
-					for (List<Instance *>::Element *F = geom->gi_probes.front(); F; F = F->next()) {
-						InstanceGIProbeData *gi_probe2 = static_cast<InstanceGIProbeData *>(F->get()->base_data);
+			if (geom->gi_probes_dirty) {
+				//giprobes may be dirty, so update
+				int l = 0;
+				//only called when reflection probe AABB enter/exit this geometry
+				ins->gi_probe_instances.resize(geom->gi_probes.size());
 
-						ins->gi_probe_instances.write[l++] = gi_probe2->probe_instance;
-					}
+				for (List<Instance *>::Element *F = geom->gi_probes.front(); F; F = F->next()) {
+					InstanceGIProbeData *gi_probe2 = static_cast<InstanceGIProbeData *>(F->get()->base_data);
 
-					geom->gi_probes_dirty = false;
+					ins->gi_probe_instances.write[l++] = gi_probe2->probe_instance;
 				}
 
-				instance_cull_result[instance_cull_count++] = E->get().geometry;
+				geom->gi_probes_dirty = false;
 			}
+
+			instance_cull_result.push_back(ins);
 		}
 
-		RSG::scene_render->gi_probe_update(probe->probe_instance, update_lights, probe->light_instances, instance_cull_count, (RasterizerScene::InstanceBase **)instance_cull_result);
+		RSG::scene_render->gi_probe_update(probe->probe_instance, update_lights, probe->light_instances, instance_cull_result.size(), (RasterizerScene::InstanceBase **)instance_cull_result.ptr());
 
 		gi_probe_update_list.remove(gi_probe);
 
@@ -46,7 +46,6 @@ class RenderingServerScene {
 public:
 	enum {
 
-		MAX_INSTANCE_CULL = 65536,
 		MAX_LIGHTS_CULLED = 4096,
 		MAX_REFLECTION_PROBES_CULLED = 4096,
 		MAX_DECALS_CULLED = 4096,
@@ -108,6 +107,26 @@ public:
 
 	struct Instance;
 
+	// World space bounds of an instance as float center and half extents,
+	// padded so each vector can be loaded directly into a SIMD register.
+	struct InstanceBounds {
+		alignas(16) float center[4];
+		alignas(16) float extents[4];
+
+		_FORCE_INLINE_ void set(const AABB &p_aabb) {
+			Vector3 half_extents = p_aabb.size * 0.5;
+			Vector3 c = p_aabb.position + half_extents;
+			center[0] = c.x;
+			center[1] = c.y;
+			center[2] = c.z;
+			center[3] = 0;
+			extents[0] = Math::abs(half_extents.x);
+			extents[1] = Math::abs(half_extents.y);
+			extents[2] = Math::abs(half_extents.z);
+			extents[3] = 0;
+		}
+	};
+
 	struct Scenario {
 		RS::ScenarioDebugMode debug;
 		RID self;
@@ -123,6 +142,11 @@ public:
 
 		SelfList<Instance>::List instances;
 
+		// Flat copy of everything in the octree, used for culling. It is split in
+		// chunks that are tested in parallel, so it has no upper size limit.
+		LocalVector<InstanceBounds> instance_bounds;
+		LocalVector<Instance *> instance_cull_list;
+
 		LocalVector<RID> dynamic_lights;
 
 		Scenario() { debug = RS::SCENARIO_DEBUG_DISABLED; }
@@ -151,6 +175,7 @@ public:
 		RID self;
 		//scenario stuff
 		OctreeElementID octree_id;
+		int32_t cull_index; // Index in Scenario::instance_bounds, -1 when not in the octree.
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -197,6 +222,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 			octree_id = 0;
+			cull_index = -1;
 			scenario = nullptr;
 
 			update_aabb = false;
@@ -385,9 +411,8 @@ public:
 		}
 	};
 
-	int instance_cull_count;
-	Instance *instance_cull_result[MAX_INSTANCE_CULL];
-	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
+	LocalVector<Instance *> instance_cull_result;
+	LocalVector<Instance *> instance_shadow_cull_result; //used for generating shadowmaps
 	Instance *light_cull_result[MAX_LIGHTS_CULLED];
 	RID sdfgi_light_cull_result[MAX_LIGHTS_CULLED];
 	RID light_instance_cull_result[MAX_LIGHTS_CULLED];
@@ -443,6 +468,65 @@ public:
 	virtual Variant instance_geometry_get_shader_parameter(RID p_instance, const StringName &p_parameter) const;
 	virtual Variant instance_geometry_get_shader_parameter_default_value(RID p_instance, const StringName &p_parameter) const;
 
+	/* CULLING */
+
+	enum {
+		CULL_CHUNK_SIZE = 1024, // Instances tested by a single job.
+		CULL_MAX_PLANES = 8,
+	};
+
+	// Convex shape prepared for testing four planes at a time. Unused plane
+	// slots never reject. The bounds of the shape's points catch boxes that
+	// are outside the shape but not fully behind any of its planes.
+	struct CullPlanes {
+		alignas(16) float normal_x[CULL_MAX_PLANES];
+		alignas(16) float normal_y[CULL_MAX_PLANES];
+		alignas(16) float normal_z[CULL_MAX_PLANES];
+		alignas(16) float abs_normal_x[CULL_MAX_PLANES];
+		alignas(16) float abs_normal_y[CULL_MAX_PLANES];
+		alignas(16) float abs_normal_z[CULL_MAX_PLANES];
+		alignas(16) float d[CULL_MAX_PLANES];
+		alignas(16) float shape_min[4];
+		alignas(16) float shape_max[4];
+		uint32_t pack_count = 0;
+
+		bool setup(const Vector<Plane> &p_planes);
+	};
+
+	struct CullData {
+		Scenario *scenario = nullptr;
+		CullPlanes planes;
+		uint32_t type_mask = 0;
+
+		// Camera pass only, geometry is prepared for drawing in the cull jobs.
+		bool prepare_scene = false;
+		uint32_t layer_mask = 0;
+		Plane near_plane;
+		float z_far = 0;
+		uint64_t frame_number = 0;
+		float lightmap_probe_update_speed = 0;
+	};
+
+	// Results of a single job, merged in chunk order so results are deterministic.
+	struct CullChunk {
+		LocalVector<Instance *> result;
+		LocalVector<Instance *> deferred; // Needs processing on the render thread.
+	};
+
+	LocalVector<CullChunk> cull_chunks;
+
+	static _FORCE_INLINE_ bool _cull_bounds_test(const CullPlanes &p_planes, const InstanceBounds &p_bounds);
+	_FORCE_INLINE_ void _cull_prepare_instance(Instance *p_instance, CullChunk &r_chunk, const CullData *p_data);
+	void _cull_chunk_job(uint32_t p_chunk, CullData *p_data);
+	uint32_t _cull_chunks(CullData *p_data);
+	static void _cull_append(LocalVector<Instance *> &r_result, const LocalVector<Instance *> &p_chunk_result);
+	void _cull_convex(Scenario *p_scenario, const Vector<Plane> &p_convex, uint32_t p_type_mask, LocalVector<Instance *> &r_result);
+	void _cull_aabb(Scenario *p_scenario, const AABB &p_aabb, uint32_t p_type_mask, LocalVector<Instance *> &r_result);
+	void _cull_convex_octree(Scenario *p_scenario, const Vector<Plane> &p_convex, uint32_t p_type_mask, LocalVector<Instance *> &r_result);
+
+	void _instance_update_cull_bounds(Instance *p_instance);
+	void _instance_remove_cull_bounds(Instance *p_instance);
+
 	_FORCE_INLINE_ void _update_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_aabb(Instance *p_instance);
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);